@@ -0,0 +1,567 @@
+#include "batch.h"
+#include "../diff/diff.h"
+#include "../geometry/bounds.h"
+#include "../geometry/cull.h"
+#include "../geometry/lod.h"
+#include "../generate/generate.h"
+#include "../hash/dedupe.h"
+#include "../geometry/metrics.h"
+#include "../html/html.h"
+#include "../models/shapes/symbol.h"
+#include "../script/query.h"
+#include "../script/script.h"
+#include "../serde/deserialize/parse_patch.h"
+#include "../serde/deserialize/parser.h"
+#include "../serde/serialize/export.h"
+#include "../serde/serialize/export_patch.h"
+#include "../server/server.h"
+#include "../watch/watch.h"
+#include "pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LOD_LEVEL_COUNT 10
+#define HTML_EXTENSION ".html"
+#define BATCH_MEMORY 256
+#define QUERY_PATH_BUFFER_SIZE 200
+#define MEGABYTE (1024 * 1024)
+
+void batch_print_usage() {
+  fprintf(stderr,
+          "Usage: main [command] [options]\n"
+          "Without command, opens the interactive menu.\n\n"
+          "Commands:\n"
+          "  convert <input> <output>  converts an svg, to html if the output "
+          "ends with .html\n"
+          "  convert-all <paths...>    converts files and directories on "
+          "threads\n"
+          "  diff <a> <b> <patch>      writes down the patch turning an svg "
+          "into another\n"
+          "  edit <in> <script> <out>  runs an edit script on an svg\n"
+          "  generate <output>         writes down a synthetic svg, with "
+          "the generate options\n"
+          "  patch <in> <patch> <out>  applies a patch to an svg\n"
+          "  query <query> <files...>  lists the shapes matching a query\n"
+          "  render <files...>         writes down svgs to the standard "
+          "output\n"
+          "  serve <socket>            keeps svgs in memory for the clients "
+          "of a socket\n"
+          "  stats <files...>          displays the measures of svgs\n"
+          "  validate <files...>       checks that svgs can be parsed\n"
+          "  watch <input> <output>    converts an svg again each time it "
+          "is saved\n\n"
+          "Options:\n"
+          "  --tab <size>              number of spaces per tab\n"
+          "  --line-break              new line for each parameter\n"
+          "  --cull                    skips the shapes outside the viewport\n"
+          "  --bake                    bakes the transforms into the "
+          "coordinates\n"
+          "  --simplify <tolerance>    simplifies the lines and paths\n"
+          "  --visvalingam             simplifies with Visvalingam-Whyatt\n"
+          "  --dedupe                  writes down the copied groups once, "
+          "as symbols\n"
+          "  --scale <percent>         output scale, from 1 to 100\n"
+          "  --jobs <count>            number of threads of convert-all "
+          "and serve\n"
+          "  --memory <megabytes>      size of the files converted at once, "
+          "or kept by serve\n"
+          "  --output <directory>      directory of the converted files\n"
+          "  --list <file>             file listing the files to convert\n"
+          "  --html                    converts to html with convert-all\n\n");
+  generate_print_usage();
+}
+
+int batch_parse_options(int argc, char **argv, batch_options_t *options) {
+  options->tab_size = 2;
+  options->line_break = false;
+  options->cull = false;
+  options->bake = false;
+  options->simplify = 0;
+  options->method = SIMPLIFY_DOUGLAS_PEUCKER;
+  options->dedupe = false;
+  options->scale = 1;
+  options->jobs = 0;
+  options->memory = BATCH_MEMORY;
+  options->output = NULL;
+  options->list = NULL;
+  options->html = false;
+
+  int files = 0, n;
+  for (int i = 0; i < argc; i++) {
+    if (strncmp(argv[i], "--", 2) != 0)
+      argv[files++] = argv[i];
+    else if (strcmp(argv[i], "--line-break") == 0)
+      options->line_break = true;
+    else if (strcmp(argv[i], "--cull") == 0)
+      options->cull = true;
+    else if (strcmp(argv[i], "--bake") == 0)
+      options->bake = true;
+    else if (strcmp(argv[i], "--visvalingam") == 0)
+      options->method = SIMPLIFY_VISVALINGAM;
+    else if (strcmp(argv[i], "--dedupe") == 0)
+      options->dedupe = true;
+    else if (strcmp(argv[i], "--html") == 0)
+      options->html = true;
+    else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+      options->output = argv[++i];
+    else if (strcmp(argv[i], "--list") == 0 && i + 1 < argc)
+      options->list = argv[++i];
+    else if (i + 1 < argc && sscanf(argv[i + 1], "%d", &n) == 1) {
+      // Options with a value.
+      if (strcmp(argv[i], "--tab") == 0 && n >= 0)
+        options->tab_size = n;
+      else if (strcmp(argv[i], "--simplify") == 0 && n >= 0)
+        options->simplify = n;
+      else if (strcmp(argv[i], "--scale") == 0 && n > 0 && n <= 100)
+        options->scale = n / 100.0;
+      else if (strcmp(argv[i], "--jobs") == 0 && n >= 0)
+        options->jobs = n;
+      else if (strcmp(argv[i], "--memory") == 0 && n > 0)
+        options->memory = n;
+      else {
+        fprintf(stderr, "Invalid option: %s %s\n", argv[i], argv[i + 1]);
+        return -1;
+      }
+      i++;
+    } else {
+      fprintf(stderr, "Invalid option: %s\n", argv[i]);
+      return -1;
+    }
+  }
+  return files;
+}
+
+svg_t *batch_open_svg(char *path) {
+  FILE *file = fopen(path, "r");
+  if (file == NULL) {
+    fprintf(stderr, "Could not open %s\n", path);
+    return NULL;
+  }
+  serdelizer_t *serdelizer = new_serdelizer(file);
+  svg_t *svg = parse_svg(serdelizer);
+  free_serdelizer(serdelizer);
+  return svg;
+}
+
+lod_pyramid_t *new_batch_lod_pyramid(batch_options_t *options) {
+  if (options->scale >= 1)
+    return NULL;
+  return new_lod_pyramid(LOD_LEVEL_COUNT, options->method);
+}
+
+bool batch_write_svg(svg_t *svg, FILE *file, batch_options_t *options,
+                     lod_pyramid_t *pyramid, unsigned int *culled) {
+  // Without a pyramid, the level of this export is built then freed.
+  lod_pyramid_t *levels =
+      (pyramid != NULL) ? pyramid : new_batch_lod_pyramid(options);
+  export_config_t *config = new_export_config(
+      options->tab_size, options->line_break, options->cull, options->bake,
+      options->simplify, options->method);
+  config->scale = options->scale;
+  config->lod = levels;
+  serdelizer_t *serdelizer = new_serdelizer(file);
+  bool success = export_svg(svg, serdelizer, config);
+  if (culled != NULL)
+    *culled = config->culled;
+  // The file belongs to the caller.
+  free(serdelizer);
+  free_export_config(config);
+  if (levels != pyramid)
+    free_lod_pyramid(levels);
+  return success;
+}
+
+unsigned int batch_dedupe_svg(svg_t *svg, batch_options_t *options) {
+  if (!options->dedupe)
+    return 0;
+  dedupe_report_t *report = dedupe_svg(svg);
+  unsigned int replaced = instantiate_duplicates(svg, report);
+  free_dedupe_report(report);
+  return replaced;
+}
+
+bool is_batch_html_path(char *path) {
+  size_t length = strlen(path), extension = strlen(HTML_EXTENSION);
+  return length >= extension &&
+         strcmp(path + length - extension, HTML_EXTENSION) == 0;
+}
+
+bool batch_export_svg(svg_t *svg, char *path, batch_options_t *options,
+                      lod_pyramid_t *pyramid, unsigned int *culled) {
+  if (!is_batch_html_path(path)) {
+    // The standard output is written to but never closed.
+    FILE *file = (strcmp(path, "-") == 0) ? stdout : fopen(path, "w");
+    if (file == NULL) {
+      fprintf(stderr, "Could not open %s\n", path);
+      return false;
+    }
+    bool success = batch_write_svg(svg, file, options, pyramid, culled);
+    if (file == stdout)
+      fflush(stdout);
+    else
+      fclose(file);
+    return success;
+  }
+
+  lod_pyramid_t *levels =
+      (pyramid != NULL) ? pyramid : new_batch_lod_pyramid(options);
+  html_config_t *config = new_html_config(options->cull, options->bake,
+                                          options->simplify, options->method);
+  config->scale = options->scale;
+  config->lod = levels;
+  bool success = export_to_html(svg, path, config);
+  if (culled != NULL)
+    *culled = config->culled;
+  free_html_config(config);
+  if (levels != pyramid)
+    free_lod_pyramid(levels);
+  return success;
+}
+
+void batch_print_culled_shapes(char *path, unsigned int culled) {
+  fprintf(stderr, "%s: %u shape(s) outside the viewport were skipped.\n",
+          path, culled);
+}
+
+int batch_convert(int argc, char **argv) {
+  batch_options_t options;
+  if (batch_parse_options(argc, argv, &options) != 2) {
+    batch_print_usage();
+    return EXIT_FAILURE;
+  }
+  svg_t *svg = batch_open_svg(argv[0]);
+  if (svg == NULL)
+    return EXIT_FAILURE;
+  unsigned int culled, replaced = batch_dedupe_svg(svg, &options);
+  if (options.dedupe)
+    fprintf(stderr, "%s: %u copied group(s) replaced by instances.\n",
+            argv[0], replaced);
+  bool success = batch_export_svg(svg, argv[1], &options, NULL, &culled);
+  if (success && options.cull)
+    batch_print_culled_shapes(argv[0], culled);
+  free_svg(svg);
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int batch_convert_all(int argc, char **argv) {
+  batch_options_t options;
+  int files = batch_parse_options(argc, argv, &options);
+  if (files < 0 || (files == 0 && options.list == NULL)) {
+    batch_print_usage();
+    return EXIT_FAILURE;
+  }
+
+  batch_pool_t *pool = new_batch_pool(&options);
+  bool success = options.list == NULL || add_batch_list(pool, options.list);
+  for (int i = 0; i < files; i++)
+    success = add_batch_path(pool, argv[i]) && success;
+
+  if (!run_batch_pool(pool, options.jobs)) {
+    fprintf(stderr, "Could not start the conversion threads\n");
+    free_batch_pool(pool);
+    return EXIT_FAILURE;
+  }
+  print_batch_summary(pool);
+  success = success && pool->failed == 0;
+  free_batch_pool(pool);
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int batch_diff(int argc, char **argv) {
+  batch_options_t options;
+  if (batch_parse_options(argc, argv, &options) != 3) {
+    batch_print_usage();
+    return EXIT_FAILURE;
+  }
+  svg_t *a = batch_open_svg(argv[0]);
+  if (a == NULL)
+    return EXIT_FAILURE;
+  svg_t *b = batch_open_svg(argv[1]);
+  if (b == NULL) {
+    free_svg(a);
+    return EXIT_FAILURE;
+  }
+  // The standard output is written to but never closed.
+  FILE *file = (strcmp(argv[2], "-") == 0) ? stdout : fopen(argv[2], "w");
+  if (file == NULL) {
+    fprintf(stderr, "Could not open %s\n", argv[2]);
+    free_svg(a);
+    free_svg(b);
+    return EXIT_FAILURE;
+  }
+
+  svg_patch_t *patch = diff_svg(a, b);
+  export_config_t *config = new_export_config(
+      options.tab_size, options.line_break, false, false, 0, options.method);
+  serdelizer_t *serdelizer = new_serdelizer(file);
+  bool success = export_svg_patch(patch, serdelizer, config);
+  // The file is closed below.
+  free(serdelizer);
+  free_export_config(config);
+  if (file == stdout)
+    success = fflush(stdout) == 0 && success;
+  else
+    success = fclose(file) == 0 && success;
+  if (!success)
+    fprintf(stderr, "Could not write %s\n", argv[2]);
+  free_svg_patch(patch);
+  free_svg(a);
+  free_svg(b);
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int batch_edit(int argc, char **argv) {
+  batch_options_t options;
+  if (batch_parse_options(argc, argv, &options) != 3) {
+    batch_print_usage();
+    return EXIT_FAILURE;
+  }
+  FILE *file = fopen(argv[1], "r");
+  if (file == NULL) {
+    fprintf(stderr, "Could not open %s\n", argv[1]);
+    return EXIT_FAILURE;
+  }
+  svg_t *svg = batch_open_svg(argv[0]);
+  if (svg == NULL) {
+    fclose(file);
+    return EXIT_FAILURE;
+  }
+
+  script_report_t report;
+  serdelizer_t *serdelizer = new_serdelizer(file);
+  bool success = run_script(svg, serdelizer, &report);
+  free_serdelizer(serdelizer);
+  fprintf(stderr, "%u statement(s), %u shape(s) edited, %u deleted.\n",
+          report.statements, report.edited, report.deleted);
+  if (success)
+    batch_dedupe_svg(svg, &options);
+  success = success && batch_export_svg(svg, argv[2], &options, NULL, NULL);
+  free_svg(svg);
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int batch_generate(int argc, char **argv) {
+  generate_config_t config;
+  if (generate_parse_options(argc, argv, &config) != 1) {
+    batch_print_usage();
+    return EXIT_FAILURE;
+  }
+  // The standard output is written to but never closed.
+  FILE *file = (strcmp(argv[0], "-") == 0) ? stdout : fopen(argv[0], "w");
+  if (file == NULL) {
+    fprintf(stderr, "Could not open %s\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  bool success = generate_svg(file, &config);
+  if (file == stdout)
+    success = fflush(stdout) == 0 && success;
+  else
+    success = fclose(file) == 0 && success;
+  if (!success)
+    fprintf(stderr, "Could not write %s\n", argv[0]);
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int batch_patch(int argc, char **argv) {
+  batch_options_t options;
+  if (batch_parse_options(argc, argv, &options) != 3) {
+    batch_print_usage();
+    return EXIT_FAILURE;
+  }
+  FILE *file = fopen(argv[1], "r");
+  if (file == NULL) {
+    fprintf(stderr, "Could not open %s\n", argv[1]);
+    return EXIT_FAILURE;
+  }
+  svg_t *svg = batch_open_svg(argv[0]);
+  if (svg == NULL) {
+    fclose(file);
+    return EXIT_FAILURE;
+  }
+
+  serdelizer_t *serdelizer = new_serdelizer(file);
+  svg_patch_t *patch = parse_svg_patch(serdelizer, svg->symbols);
+  free_serdelizer(serdelizer);
+  if (patch == NULL) {
+    fprintf(stderr, "Could not parse %s\n", argv[1]);
+    free_svg(svg);
+    return EXIT_FAILURE;
+  }
+  svg_t *patched = patch_svg(svg, patch);
+  free_svg_patch(patch);
+  if (patched == NULL) {
+    fprintf(stderr, "The patch %s does not apply to %s\n", argv[1], argv[0]);
+    free_svg(svg);
+    return EXIT_FAILURE;
+  }
+  batch_dedupe_svg(patched, &options);
+  bool success = batch_export_svg(patched, argv[2], &options, NULL, NULL);
+  free_svg(patched);
+  free_svg(svg);
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int batch_query(int argc, char **argv) {
+  batch_options_t options;
+  query_t query;
+  int files = batch_parse_options(argc, argv, &options);
+  if (files <= 1) {
+    batch_print_usage();
+    return EXIT_FAILURE;
+  }
+  if (!parse_query(argv[0], &query)) {
+    fprintf(stderr, "Invalid query: %s\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  // A single query is cheaper than indexing the shapes, only the groups'
+  // cached bounding boxes prune the search.
+  char buffer[QUERY_PATH_BUFFER_SIZE];
+  int status = EXIT_SUCCESS;
+  for (int i = 1; i < files; i++) {
+    svg_t *svg = batch_open_svg(argv[i]);
+    if (svg == NULL) {
+      fprintf(stdout, "%s: invalid\n", argv[i]);
+      status = EXIT_FAILURE;
+      continue;
+    }
+    query_results_t *results = query_shapes(svg->shapes, &query, NULL);
+    for (int j = 0; j < results->count; j++) {
+      format_query_path(&results->matches[j], buffer, QUERY_PATH_BUFFER_SIZE);
+      fprintf(stdout, "%s: %s %s\n", argv[i], buffer,
+              get_shape_name(results->matches[j].shape));
+    }
+    fprintf(stdout, "%s: %d match(es), %u shape(s) tested\n", argv[i],
+            results->count, results->tested);
+    free_query_results(results);
+    free_svg(svg);
+  }
+  return status;
+}
+
+int batch_render(int argc, char **argv) {
+  batch_options_t options;
+  int files = batch_parse_options(argc, argv, &options);
+  if (files <= 0) {
+    batch_print_usage();
+    return EXIT_FAILURE;
+  }
+  int status = EXIT_SUCCESS;
+  unsigned int culled;
+  for (int i = 0; i < files; i++) {
+    svg_t *svg = batch_open_svg(argv[i]);
+    if (svg != NULL)
+      batch_dedupe_svg(svg, &options);
+    if (svg == NULL || !batch_export_svg(svg, "-", &options, NULL, &culled))
+      status = EXIT_FAILURE;
+    else if (options.cull)
+      batch_print_culled_shapes(argv[i], culled);
+    if (svg != NULL)
+      free_svg(svg);
+  }
+  return status;
+}
+
+int batch_serve(int argc, char **argv) {
+  batch_options_t options;
+  if (batch_parse_options(argc, argv, &options) != 1) {
+    batch_print_usage();
+    return EXIT_FAILURE;
+  }
+  return run_server(argv[0], options.jobs, (size_t)options.memory * MEGABYTE)
+             ? EXIT_SUCCESS
+             : EXIT_FAILURE;
+}
+
+int batch_stats(int argc, char **argv) {
+  batch_options_t options;
+  int files = batch_parse_options(argc, argv, &options);
+  if (files <= 0) {
+    batch_print_usage();
+    return EXIT_FAILURE;
+  }
+  int status = EXIT_SUCCESS;
+  for (int i = 0; i < files; i++) {
+    svg_t *svg = batch_open_svg(argv[i]);
+    if (svg == NULL) {
+      fprintf(stdout, "%s: invalid\n", argv[i]);
+      status = EXIT_FAILURE;
+      continue;
+    }
+    unsigned int shapes = 0;
+    for (shape_node_t *node = svg->shapes; node != NULL; node = node->next)
+      shapes += count_shapes(node->shape);
+    metrics_t metrics = measure_svg(svg);
+    bbox_t *bbox = compute_svg_bbox(svg);
+    fprintf(stdout,
+            "%s: shapes=%u symbols=%d points=%u area=%.2f length=%.2f",
+            argv[i], shapes, get_symbol_node_length(svg->symbols),
+            metrics.point_count, metrics.area, metrics.length);
+    if (is_bbox_empty(bbox))
+      fprintf(stdout, " bbox=none\n");
+    else
+      fprintf(stdout, " bbox=%g,%g,%g,%g\n", bbox->min_x, bbox->min_y,
+              bbox->max_x, bbox->max_y);
+    free_bbox(bbox);
+    free_svg(svg);
+  }
+  return status;
+}
+
+int batch_validate(int argc, char **argv) {
+  batch_options_t options;
+  int files = batch_parse_options(argc, argv, &options);
+  if (files <= 0) {
+    batch_print_usage();
+    return EXIT_FAILURE;
+  }
+  int status = EXIT_SUCCESS;
+  for (int i = 0; i < files; i++) {
+    svg_t *svg = batch_open_svg(argv[i]);
+    fprintf(stdout, "%s: %s\n", argv[i], (svg != NULL) ? "valid" : "invalid");
+    if (svg != NULL)
+      free_svg(svg);
+    else
+      status = EXIT_FAILURE;
+  }
+  return status;
+}
+
+int batch_watch(int argc, char **argv) {
+  batch_options_t options;
+  if (batch_parse_options(argc, argv, &options) != 2) {
+    batch_print_usage();
+    return EXIT_FAILURE;
+  }
+  return run_watch(argv[0], argv[1], &options) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int batch_main(int argc, char **argv) {
+  if (strcmp(argv[1], "convert") == 0)
+    return batch_convert(argc - 2, argv + 2);
+  if (strcmp(argv[1], "convert-all") == 0)
+    return batch_convert_all(argc - 2, argv + 2);
+  if (strcmp(argv[1], "diff") == 0)
+    return batch_diff(argc - 2, argv + 2);
+  if (strcmp(argv[1], "edit") == 0)
+    return batch_edit(argc - 2, argv + 2);
+  if (strcmp(argv[1], "generate") == 0)
+    return batch_generate(argc - 2, argv + 2);
+  if (strcmp(argv[1], "patch") == 0)
+    return batch_patch(argc - 2, argv + 2);
+  if (strcmp(argv[1], "query") == 0)
+    return batch_query(argc - 2, argv + 2);
+  if (strcmp(argv[1], "render") == 0)
+    return batch_render(argc - 2, argv + 2);
+  if (strcmp(argv[1], "serve") == 0)
+    return batch_serve(argc - 2, argv + 2);
+  if (strcmp(argv[1], "stats") == 0)
+    return batch_stats(argc - 2, argv + 2);
+  if (strcmp(argv[1], "validate") == 0)
+    return batch_validate(argc - 2, argv + 2);
+  if (strcmp(argv[1], "watch") == 0)
+    return batch_watch(argc - 2, argv + 2);
+  batch_print_usage();
+  return EXIT_FAILURE;
+}
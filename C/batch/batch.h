@@ -0,0 +1,284 @@
+#ifndef CODA_BATCH
+#define CODA_BATCH
+
+#include "../geometry/lod.h"
+#include "../geometry/simplify.h"
+#include "../models/shapes/svg.h"
+#include <stdbool.h>
+#include <stdio.h>
+
+/**
+ * Defines the batch options type, read from the command line.
+ * @param tab_size   the number of spaces per tab.
+ * @param line_break indicates if a new line is created for each parameter.
+ * @param cull       indicates if the shapes outside the svg's viewport are
+ * skipped.
+ * @param bake       indicates if the transformations are baked into the
+ * shapes coordinates.
+ * @param simplify   the tolerance used to simplify the lines and paths, 0 to
+ * write them down as is.
+ * @param method     the simplification algorithm.
+ * @param dedupe     indicates if the groups having copies are written down
+ * once as symbols, their occurrences becoming instances.
+ * @param scale      the output scale, used to select the level of detail.
+ * @param jobs       the number of conversion threads, 0 for one per processor.
+ * @param memory     the maximum size in megabytes of the files being converted
+ * at once.
+ * @param output     the directory of the converted files, NULL for the
+ * current directory.
+ * @param list       the path of a file listing the files to convert, one per
+ * line, NULL if there is none.
+ * @param html       indicates if the files are converted to html instead of
+ * svg.
+ */
+typedef struct batch_options_s {
+  unsigned int tab_size;
+  bool line_break;
+  bool cull;
+  bool bake;
+  double simplify;
+  simplify_method_t method;
+  bool dedupe;
+  double scale;
+  unsigned int jobs;
+  unsigned int memory;
+  char *output;
+  char *list;
+  bool html;
+} batch_options_t;
+
+/**
+ * Displays the batch commands and options.
+ */
+void batch_print_usage();
+
+/**
+ * Reads the options of a batch command and moves its other arguments, the
+ * files, to the front of the given arguments.
+ * The options are:
+ * - --tab <size> : the number of spaces per tab.
+ * - --line-break : creates a new line for each parameter.
+ * - --cull : skips the shapes outside the viewport.
+ * - --bake : bakes the transforms into the coordinates.
+ * - --simplify <tolerance> : simplifies the lines and paths.
+ * - --visvalingam : simplifies with the Visvalingam-Whyatt algorithm.
+ * - --dedupe : writes down the groups having copies once, as symbols.
+ * - --scale <percent> : the output scale, from 1 to 100.
+ * - --jobs <count> : the number of conversion threads.
+ * - --memory <megabytes> : the size of the files being converted at once.
+ * - --output <directory> : the directory of the converted files.
+ * - --list <file> : a file listing the files to convert.
+ * - --html : converts the files to html.
+ * @param argc    the number of arguments.
+ * @param argv    the arguments, reordered by the function.
+ * @param options the options to set.
+ * @return the number of files, -1 if an option is invalid.
+ * @see batch_options_t.
+ */
+int batch_parse_options(int argc, char **argv, batch_options_t *options);
+
+/**
+ * Opens and parses the svg file at the given path.
+ * Note that this function allocates memory.
+ * @param path the svg file's path.
+ * @return the new svg's pointer, NULL if the file could not be opened or
+ * parsed.
+ * @see svg_t.
+ */
+svg_t *batch_open_svg(char *path);
+
+/**
+ * Creates the level of detail pyramid used by the given export options, whose
+ * levels are built by the exports needing them.
+ * Note that this function allocates memory.
+ * @param options the export options.
+ * @return the new pyramid's pointer, NULL if the options ask for the full
+ * detail.
+ * @see new_lod_pyramid.
+ */
+lod_pyramid_t *new_batch_lod_pyramid(batch_options_t *options);
+
+/**
+ * Writes down the given svg to the given file as an svg.
+ * @param svg     the svg to write down.
+ * @param file    the destination file, which is left open.
+ * @param options the export options.
+ * @param pyramid the svg's level of detail pyramid, which keeps the levels
+ * built by the export, NULL to build the level of this export only.
+ * @param culled  a pointer to the number of shapes skipped by the export to
+ * set, NULL if it is not needed.
+ * @return returns true if the operation succeeded.
+ * @see batch_options_t.
+ */
+bool batch_write_svg(svg_t *svg, FILE *file, batch_options_t *options,
+                     lod_pyramid_t *pyramid, unsigned int *culled);
+
+/**
+ * Replaces the groups having copies in the given svg by instances of new
+ * symbols if the options ask for it.
+ * Note that this function allocates and frees memory.
+ * @param svg     the svg, which must not be shared.
+ * @param options the export options.
+ * @return the number of replaced groups.
+ * @see instantiate_duplicates.
+ */
+unsigned int batch_dedupe_svg(svg_t *svg, batch_options_t *options);
+
+/**
+ * Tests if the given path is the path of an html file, i.e. ends with
+ * ".html".
+ * @param path the path.
+ * @return returns true if the path ends with ".html".
+ */
+bool is_batch_html_path(char *path);
+
+/**
+ * Writes down the given svg to the given file path, as html if the path ends
+ * with ".html" and as an svg otherwise.
+ * @param svg     the svg to write down.
+ * @param path    the destination file's path.
+ * @param options the export options.
+ * @param pyramid the svg's level of detail pyramid, which keeps the levels
+ * built by the export, NULL to build the level of this export only.
+ * @param culled  a pointer to the number of shapes skipped by the export to
+ * set, NULL if it is not needed.
+ * @return returns true if the operation succeeded.
+ * @see batch_options_t.
+ */
+bool batch_export_svg(svg_t *svg, char *path, batch_options_t *options,
+                      lod_pyramid_t *pyramid, unsigned int *culled);
+
+/**
+ * Displays on the standard error the number of shapes of the given file
+ * skipped by an export because they are outside its viewport.
+ * @param path   the file's path.
+ * @param culled the number of skipped shapes.
+ */
+void batch_print_culled_shapes(char *path, unsigned int culled);
+
+/**
+ * Converts an svg file, i.e. `convert <input> <output> [options]`.
+ * @param argc the number of arguments, the command excluded.
+ * @param argv the arguments.
+ * @return the process exit status.
+ */
+int batch_convert(int argc, char **argv);
+
+/**
+ * Converts many svg files on a pool of threads then displays the throughput
+ * and the failures, i.e. `convert-all <files or directories...> [options]`.
+ * The directories are searched recursively for ".xml" files, which keep
+ * their path relative to the directory in the output directory. A file
+ * written to the destination of another one fails.
+ * @param argc the number of arguments, the command excluded.
+ * @param argv the arguments.
+ * @return the process exit status, a failure if any file failed.
+ * @see batch_pool_t.
+ */
+int batch_convert_all(int argc, char **argv);
+
+/**
+ * Writes down the patch turning an svg file into another one, to the standard
+ * output if the patch's path is `-`, i.e. `diff <a> <b> <patch> [options]`.
+ * @param argc the number of arguments, the command excluded.
+ * @param argv the arguments.
+ * @return the process exit status.
+ * @see diff_svg.
+ */
+int batch_diff(int argc, char **argv);
+
+/**
+ * Runs an edit script on an svg file then writes it down, i.e. `edit <input>
+ * <script> <output> [options]`. Nothing is written if the script is invalid.
+ * @param argc the number of arguments, the command excluded.
+ * @param argv the arguments.
+ * @return the process exit status.
+ * @see run_script.
+ */
+int batch_edit(int argc, char **argv);
+
+/**
+ * Writes down a synthetic svg file, to the standard output if the output is
+ * `-`, i.e. `generate <output> [generate options]`.
+ * @param argc the number of arguments, the command excluded.
+ * @param argv the arguments.
+ * @return the process exit status.
+ * @see generate_svg.
+ */
+int batch_generate(int argc, char **argv);
+
+/**
+ * Applies a patch file to an svg file then writes the result down, i.e.
+ * `patch <input> <patch> <output> [options]`. Nothing is written if the
+ * patch is invalid or does not apply.
+ * @param argc the number of arguments, the command excluded.
+ * @param argv the arguments.
+ * @return the process exit status.
+ * @see patch_svg.
+ */
+int batch_patch(int argc, char **argv);
+
+/**
+ * Reports the paths of the shapes of svg files matching a query, i.e.
+ * `query <query> <files...>`, and the number of shapes tested per file.
+ * @param argc the number of arguments, the command excluded.
+ * @param argv the arguments.
+ * @return the process exit status.
+ * @see query_shapes.
+ */
+int batch_query(int argc, char **argv);
+
+/**
+ * Writes down svg files to the standard output, i.e. `render <files...>
+ * [options]`.
+ * @param argc the number of arguments, the command excluded.
+ * @param argv the arguments.
+ * @return the process exit status.
+ */
+int batch_render(int argc, char **argv);
+
+/**
+ * Runs a daemon keeping svgs in memory for the clients of a Unix socket, i.e.
+ * `serve <socket> [--jobs <count>] [--memory <megabytes>]`.
+ * @param argc the number of arguments, the command excluded.
+ * @param argv the arguments.
+ * @return the process exit status.
+ * @see run_server.
+ */
+int batch_serve(int argc, char **argv);
+
+/**
+ * Displays one line of measures per svg file, i.e. `stats <files...>`.
+ * @param argc the number of arguments, the command excluded.
+ * @param argv the arguments.
+ * @return the process exit status, a failure if any file is invalid.
+ */
+int batch_stats(int argc, char **argv);
+
+/**
+ * Checks that svg files can be parsed, i.e. `validate <files...>`.
+ * @param argc the number of arguments, the command excluded.
+ * @param argv the arguments.
+ * @return the process exit status, a failure if any file is invalid.
+ */
+int batch_validate(int argc, char **argv);
+
+/**
+ * Converts an svg file each time it is saved, i.e.
+ * `watch <input> <output> [options]`.
+ * @param argc the number of arguments, the command excluded.
+ * @param argv the arguments.
+ * @return the process exit status.
+ * @see run_watch.
+ */
+int batch_watch(int argc, char **argv);
+
+/**
+ * Runs the batch command given on the command line, without any prompt.
+ * @param argc the number of arguments, the program's name included.
+ * @param argv the arguments.
+ * @return the process exit status.
+ */
+int batch_main(int argc, char **argv);
+
+#endif
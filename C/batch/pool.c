@@ -0,0 +1,276 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "pool.h"
+#include "../models/shapes/svg.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BATCH_JOB_CAPACITY 64
+#define BATCH_PATH_BUFFER_SIZE 4096
+#define SOURCE_EXTENSION ".xml"
+#define MEGABYTE (1024 * 1024)
+
+batch_pool_t *new_batch_pool(batch_options_t *options) {
+  batch_pool_t *pool = malloc(sizeof(batch_pool_t));
+  pool->jobs = malloc(sizeof(batch_job_t) * BATCH_JOB_CAPACITY);
+  pool->count = 0;
+  pool->capacity = BATCH_JOB_CAPACITY;
+  pool->next = 0;
+  pool->options = options;
+  pool->memory = (size_t)options->memory * MEGABYTE;
+  pool->in_flight = 0;
+  pool->converted = 0;
+  pool->failed = 0;
+  pool->bytes = 0;
+  pool->culled = 0;
+  pool->seconds = 0;
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->released, NULL);
+  return pool;
+}
+
+char *get_batch_file_name(char *path) {
+  char *name = strrchr(path, '/');
+  return (name != NULL) ? name + 1 : path;
+}
+
+bool add_batch_job(batch_pool_t *pool, char *path, char *name) {
+  struct stat status;
+  if (stat(path, &status) != 0 || !S_ISREG(status.st_mode)) {
+    fprintf(stderr, "Could not open %s\n", path);
+    return false;
+  }
+
+  // Replaces the extension of the destination's file name.
+  char *file_name = strrchr(name, '/');
+  file_name = (file_name != NULL) ? file_name + 1 : name;
+  size_t length = strlen(name);
+  char *extension = strrchr(file_name, '.');
+  if (extension != NULL && extension != file_name)
+    length = extension - name;
+  char *directory = (pool->options->output != NULL) ? pool->options->output
+                                                    : ".";
+  char *output = malloc(strlen(directory) + length + 7);
+  sprintf(output, "%s/%.*s%s", directory, (int)length, name,
+          pool->options->html ? ".html" : SOURCE_EXTENSION);
+
+  if (pool->count == pool->capacity) {
+    pool->capacity *= 2;
+    pool->jobs = realloc(pool->jobs, sizeof(batch_job_t) * pool->capacity);
+  }
+  batch_job_t *job = &pool->jobs[pool->count++];
+  job->input = malloc(strlen(path) + 1);
+  strcpy(job->input, path);
+  job->output = output;
+  job->size = status.st_size;
+  job->failed = false;
+  job->culled = 0;
+  return true;
+}
+
+bool add_batch_directory(batch_pool_t *pool, char *path, size_t root) {
+  DIR *directory = opendir(path);
+  if (directory == NULL) {
+    fprintf(stderr, "Could not open %s\n", path);
+    return false;
+  }
+
+  char buffer[BATCH_PATH_BUFFER_SIZE];
+  struct dirent *entry;
+  struct stat status;
+  size_t extension = strlen(SOURCE_EXTENSION), length;
+  while ((entry = readdir(directory)) != NULL) {
+    if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+      continue;
+    snprintf(buffer, BATCH_PATH_BUFFER_SIZE, "%s/%s", path, entry->d_name);
+    if (stat(buffer, &status) != 0)
+      continue;
+    length = strlen(entry->d_name);
+    if (S_ISDIR(status.st_mode))
+      add_batch_directory(pool, buffer, root);
+    else if (length > extension &&
+             strcmp(entry->d_name + length - extension, SOURCE_EXTENSION) ==
+                 0)
+      add_batch_job(pool, buffer, buffer + root);
+  }
+  closedir(directory);
+  return true;
+}
+
+bool add_batch_path(batch_pool_t *pool, char *path) {
+  struct stat status;
+  if (stat(path, &status) == 0 && S_ISDIR(status.st_mode))
+    return add_batch_directory(pool, path, strlen(path) + 1);
+  return add_batch_job(pool, path, get_batch_file_name(path));
+}
+
+bool add_batch_list(batch_pool_t *pool, char *path) {
+  FILE *file = (strcmp(path, "-") == 0) ? stdin : fopen(path, "r");
+  if (file == NULL) {
+    fprintf(stderr, "Could not open %s\n", path);
+    return false;
+  }
+
+  char buffer[BATCH_PATH_BUFFER_SIZE];
+  while (fgets(buffer, BATCH_PATH_BUFFER_SIZE, file) != NULL) {
+    buffer[strcspn(buffer, "\r\n")] = '\0';
+    if (buffer[0] != '\0')
+      add_batch_job(pool, buffer, get_batch_file_name(buffer));
+  }
+  if (file != stdin)
+    fclose(file);
+  return true;
+}
+
+int compare_batch_jobs(const void *a, const void *b) {
+  batch_job_t *first = *(batch_job_t **)a, *second = *(batch_job_t **)b;
+  int order = strcmp(first->output, second->output);
+  if (order != 0)
+    return order;
+  // The earlier job comes first, it is the one converted.
+  return (first > second) - (first < second);
+}
+
+int mark_batch_collisions(batch_pool_t *pool) {
+  batch_job_t **jobs = malloc(sizeof(batch_job_t *) * (pool->count + 1));
+  for (int i = 0; i < pool->count; i++)
+    jobs[i] = &pool->jobs[i];
+  qsort(jobs, pool->count, sizeof(batch_job_t *), compare_batch_jobs);
+
+  int marked = 0;
+  for (int i = 1, first = 0; i < pool->count; i++) {
+    if (strcmp(jobs[i]->output, jobs[first]->output) != 0) {
+      first = i;
+      continue;
+    }
+    fprintf(stderr, "Could not convert %s, %s is also converted to %s\n",
+            jobs[i]->input, jobs[first]->input, jobs[i]->output);
+    jobs[i]->failed = true;
+    marked++;
+  }
+  free(jobs);
+  return marked;
+}
+
+void create_batch_directories(char *path) {
+  char *directory = malloc(strlen(path) + 1);
+  strcpy(directory, path);
+  for (char *separator = strchr(directory + 1, '/'); separator != NULL;
+       separator = strchr(separator + 1, '/')) {
+    *separator = '\0';
+    // The directory may already exist or be created by another thread.
+    mkdir(directory, 0777);
+    *separator = '/';
+  }
+  free(directory);
+}
+
+bool run_batch_job(batch_job_t *job, batch_options_t *options) {
+  struct stat input, output;
+  if (stat(job->input, &input) == 0 && stat(job->output, &output) == 0 &&
+      input.st_dev == output.st_dev && input.st_ino == output.st_ino) {
+    fprintf(stderr, "Could not convert %s onto itself\n", job->input);
+    return false;
+  }
+
+  svg_t *svg = batch_open_svg(job->input);
+  if (svg == NULL)
+    return false;
+  batch_dedupe_svg(svg, options);
+  create_batch_directories(job->output);
+  bool success = batch_export_svg(svg, job->output, options, NULL,
+                                  &job->culled);
+  free_svg(svg);
+  return success;
+}
+
+void *run_batch_worker(void *data) {
+  batch_pool_t *pool = data;
+  batch_job_t *job;
+  bool success;
+  pthread_mutex_lock(&pool->lock);
+  while (pool->next < pool->count) {
+    job = &pool->jobs[pool->next++];
+    if (job->failed)
+      continue;
+    // Waits for the other files to fit under the bound with this one, a file
+    // larger than the bound being converted alone.
+    while (pool->in_flight > 0 && pool->in_flight + job->size > pool->memory)
+      pthread_cond_wait(&pool->released, &pool->lock);
+    pool->in_flight += job->size;
+    pthread_mutex_unlock(&pool->lock);
+
+    success = run_batch_job(job, pool->options);
+
+    pthread_mutex_lock(&pool->lock);
+    pool->in_flight -= job->size;
+    job->failed = !success;
+    if (success) {
+      pool->converted++;
+      pool->bytes += job->size;
+      pool->culled += job->culled;
+    } else
+      pool->failed++;
+    pthread_cond_broadcast(&pool->released);
+  }
+  pthread_mutex_unlock(&pool->lock);
+  return NULL;
+}
+
+bool run_batch_pool(batch_pool_t *pool, int threads) {
+  if (threads <= 0)
+    threads = sysconf(_SC_NPROCESSORS_ONLN);
+  if (threads <= 0)
+    threads = 1;
+  if (pool->options->output != NULL)
+    mkdir(pool->options->output, 0777);
+  pool->failed += mark_batch_collisions(pool);
+
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  pthread_t *workers = malloc(sizeof(pthread_t) * threads);
+  int started = 0;
+  while (started < threads &&
+         pthread_create(&workers[started], NULL, run_batch_worker, pool) == 0)
+    started++;
+  for (int i = 0; i < started; i++)
+    pthread_join(workers[i], NULL);
+  free(workers);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  pool->seconds =
+      (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+  return started > 0;
+}
+
+void print_batch_summary(batch_pool_t *pool) {
+  double seconds = (pool->seconds > 0) ? pool->seconds : 1e-9;
+  fprintf(stdout,
+          "Converted %u/%d file(s) in %.3f s (%.1f files/s, %.2f MB/s), %u "
+          "failed.\n",
+          pool->converted, pool->count, pool->seconds,
+          pool->converted / seconds, pool->bytes / seconds / MEGABYTE,
+          pool->failed);
+  if (pool->options->cull)
+    fprintf(stderr, "%u shape(s) outside the viewport were skipped.\n",
+            pool->culled);
+  for (int i = 0; i < pool->count; i++)
+    if (pool->jobs[i].failed)
+      fprintf(stdout, "- %s\n", pool->jobs[i].input);
+}
+
+void free_batch_pool(batch_pool_t *pool) {
+  for (int i = 0; i < pool->count; i++) {
+    free(pool->jobs[i].input);
+    free(pool->jobs[i].output);
+  }
+  free(pool->jobs);
+  pthread_mutex_destroy(&pool->lock);
+  pthread_cond_destroy(&pool->released);
+  free(pool);
+}
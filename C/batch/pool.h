@@ -0,0 +1,207 @@
+#ifndef CODA_POOL
+#define CODA_POOL
+
+#include "batch.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Defines the batch job type, the conversion of one file.
+ * @param input  the source file's path.
+ * @param output the destination file's path.
+ * @param size   the source file's size in bytes.
+ * @param failed indicates if the conversion failed.
+ * @param culled the number of shapes outside the viewport skipped by the
+ * conversion.
+ */
+typedef struct batch_job_s {
+  char *input;
+  char *output;
+  size_t size;
+  bool failed;
+  unsigned int culled;
+} batch_job_t;
+
+/**
+ * Defines the batch pool type, a fixed set of threads converting a list of
+ * jobs.
+ * Each thread takes the next job, parses, exports and frees its svg before
+ * taking another one, so a file's memory is only ever owned by one thread.
+ * A job only starts when the size of the files being converted stays under
+ * the pool's memory bound, a larger file being converted alone.
+ * @param jobs      the jobs.
+ * @param count     the number of jobs.
+ * @param capacity  the number of allocated jobs.
+ * @param next      the index of the next job to start.
+ * @param options   the export options.
+ * @param memory    the maximum size in bytes of the files being converted.
+ * @param in_flight the size in bytes of the files being converted.
+ * @param converted the number of converted files.
+ * @param failed    the number of failed files.
+ * @param bytes     the size in bytes of the converted files.
+ * @param culled    the number of shapes outside the viewport skipped by the
+ * conversions.
+ * @param seconds   the duration of the last run.
+ * @param lock      the mutex guarding the pool's state.
+ * @param released  the condition signaled when a job ends.
+ * @see batch_job_t.
+ */
+typedef struct batch_pool_s {
+  batch_job_t *jobs;
+  int count;
+  int capacity;
+  int next;
+  batch_options_t *options;
+  size_t memory;
+  size_t in_flight;
+  unsigned int converted;
+  unsigned int failed;
+  size_t bytes;
+  unsigned int culled;
+  double seconds;
+  pthread_mutex_t lock;
+  pthread_cond_t released;
+} batch_pool_t;
+
+/**
+ * Creates a new empty batch pool.
+ * Note that this function allocates memory.
+ * @param options the export options, which must outlive the pool.
+ * @return the new pool's pointer.
+ * @see batch_pool_t.
+ */
+batch_pool_t *new_batch_pool(batch_options_t *options);
+
+/**
+ * Gets the file name at the end of the given path.
+ * @param path the path.
+ * @return the pointer to the file name in the path.
+ */
+char *get_batch_file_name(char *path);
+
+/**
+ * Adds the conversion of the given file to the given pool.
+ * The destination is the given name in the options' output directory, with
+ * the ".html" or ".xml" extension.
+ * Note that this function allocates memory.
+ * @param pool the pool.
+ * @param path the source file's path.
+ * @param name the destination's path relative to the output directory,
+ * usually the end of the source's path.
+ * @return returns true if the file exists.
+ * @see batch_job_t.
+ */
+bool add_batch_job(batch_pool_t *pool, char *path, char *name);
+
+/**
+ * Adds the conversion of the ".xml" files in the given directory and its
+ * subdirectories to the given pool.
+ * The files keep their path relative to the root directory in the output
+ * directory.
+ * Note that this function allocates memory.
+ * @param pool the pool.
+ * @param path the directory's path.
+ * @param root the length of the root directory's path, separator included.
+ * @return returns true if the directory could be read.
+ * @see add_batch_job.
+ */
+bool add_batch_directory(batch_pool_t *pool, char *path, size_t root);
+
+/**
+ * Adds the conversion of the given file, or of the ".xml" files in the given
+ * directory, to the given pool.
+ * Note that this function allocates memory.
+ * @param pool the pool.
+ * @param path the file's or directory's path.
+ * @return returns true if the path could be read.
+ * @see add_batch_job.
+ * @see add_batch_directory.
+ */
+bool add_batch_path(batch_pool_t *pool, char *path);
+
+/**
+ * Adds the conversion of the files listed in the given file, one path per
+ * line, to the given pool.
+ * Note that this function allocates memory.
+ * @param pool the pool.
+ * @param path the list's path, "-" for the standard input.
+ * @return returns true if the list could be read.
+ * @see add_batch_job.
+ */
+bool add_batch_list(batch_pool_t *pool, char *path);
+
+/**
+ * Compares two pointers to batch jobs by destination, then by position in the
+ * pool.
+ * @param a the pointer to the first job's pointer.
+ * @param b the pointer to the second job's pointer.
+ * @return a negative number if the first job comes first, a positive number
+ * if it comes last, 0 otherwise.
+ */
+int compare_batch_jobs(const void *a, const void *b);
+
+/**
+ * Marks as failed the jobs writing to the destination of an earlier job, so
+ * that no file is written by two jobs.
+ * @param pool the pool.
+ * @return the number of marked jobs.
+ * @see batch_job_t.
+ */
+int mark_batch_collisions(batch_pool_t *pool);
+
+/**
+ * Creates the missing directories of the given file's path.
+ * @param path the file's path.
+ */
+void create_batch_directories(char *path);
+
+/**
+ * Converts the file of the given job.
+ * The destination's directories are created if they do not exist.
+ * A file is never converted onto itself.
+ * @param job     the job.
+ * @param options the export options.
+ * @return returns true if the file was converted.
+ * @see batch_job_t.
+ */
+bool run_batch_job(batch_job_t *job, batch_options_t *options);
+
+/**
+ * Runs the jobs of the given pool until there is none left.
+ * This function is the entry point of the pool's threads.
+ * @param pool the pool.
+ * @return NULL.
+ * @see batch_pool_t.
+ */
+void *run_batch_worker(void *pool);
+
+/**
+ * Converts all the jobs of the given pool on the given number of threads and
+ * measures the duration of the conversion. The jobs colliding with an earlier
+ * one fail without being converted.
+ * The output directory is created if it does not exist.
+ * @param pool    the pool.
+ * @param threads the number of threads, 0 for one per processor.
+ * @return returns true if the threads could be started.
+ * @see batch_pool_t.
+ */
+bool run_batch_pool(batch_pool_t *pool, int threads);
+
+/**
+ * Displays the throughput of the given pool's last run and its failed files,
+ * and on the standard error the number of skipped shapes if they are culled.
+ * @param pool the pool.
+ * @see batch_pool_t.
+ */
+void print_batch_summary(batch_pool_t *pool);
+
+/**
+ * Destroys the given pool and its jobs.
+ * Note that this function frees memory.
+ * @param pool the pool to destroy.
+ * @see batch_pool_t.
+ */
+void free_batch_pool(batch_pool_t *pool);
+
+#endif
@@ -0,0 +1,388 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench.h"
+#include "../geometry/cull.h"
+#include "../html/html.h"
+#include "../serde/deserialize/parser.h"
+#include "../serde/serialize/export.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+
+#define BENCH_RUNS 5
+#define BENCH_WALK_POINTS 1000000
+#define BENCH_WALK_STEP 10
+#define BENCH_NULL_PATH "/dev/null"
+#define NANOSECONDS 1000000000ULL
+#define MEGABYTE (1024 * 1024)
+
+static const char *BENCH_VARIANT_NAMES[GENERATE_VARIANT_COUNT] = {
+    "ellipse", "rectangle", "line", "multiline", "polygon", "draw", "group"};
+
+static const char *BENCH_OPERATION_NAMES[BENCH_OPERATION_COUNT] = {
+    "parse_svg", "export_svg", "export_to_html",
+    "clone_svg", "copy_svg",   "free_svg"};
+
+static const double BENCH_SIMPLIFY_TOLERANCES[] = {1, 10, 100};
+
+void bench_print_usage() {
+  fprintf(stderr,
+          "Usage: bench [options] [generate options]\n"
+          "Times the operations on a generated svg.\n\n"
+          "Options:\n"
+          "  --runs <count>            number of times each operation is "
+          "timed\n"
+          "  --walk <points>           points of the simplified random walk, "
+          "0 to skip it\n"
+          "  --output <file>           writes down the results as JSON\n"
+          "  --commit <name>           commit written down with the "
+          "results\n\n");
+  generate_print_usage();
+}
+
+bool bench_parse_options(int argc, char **argv, bench_config_t *config) {
+  config->runs = BENCH_RUNS;
+  config->walk = BENCH_WALK_POINTS;
+  config->output = NULL;
+  config->commit = NULL;
+
+  // The generate options are moved to the front and read afterwards.
+  int others = 0, n;
+  for (int i = 0; i < argc; i++) {
+    if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+      config->output = argv[++i];
+    else if (strcmp(argv[i], "--commit") == 0 && i + 1 < argc)
+      config->commit = argv[++i];
+    else if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+      if (sscanf(argv[i + 1], "%d", &n) != 1 || n <= 0) {
+        fprintf(stderr, "Invalid option: %s %s\n", argv[i], argv[i + 1]);
+        return false;
+      }
+      config->runs = n;
+      i++;
+    } else if (strcmp(argv[i], "--walk") == 0 && i + 1 < argc) {
+      if (sscanf(argv[i + 1], "%d", &n) != 1 || n < 0) {
+        fprintf(stderr, "Invalid option: %s %s\n", argv[i], argv[i + 1]);
+        return false;
+      }
+      config->walk = n;
+      i++;
+    } else
+      argv[others++] = argv[i];
+  }
+  return generate_parse_options(others, argv, &config->generate) == 0;
+}
+
+char *generate_bench_source(bench_config_t *config, size_t *length) {
+  char *source = NULL;
+  FILE *file = open_memstream(&source, length);
+  generate_svg(file, &config->generate);
+  fclose(file);
+  return source;
+}
+
+uint64_t get_bench_time() {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return (uint64_t)time.tv_sec * NANOSECONDS + time.tv_nsec;
+}
+
+void add_bench_run(bench_result_t *result, uint64_t start) {
+  uint64_t duration = get_bench_time() - start;
+  if (result->runs == 0 || duration < result->best)
+    result->best = duration;
+  result->total += duration;
+  result->runs++;
+}
+
+svg_t *parse_bench_source(char *source, size_t length) {
+  FILE *file = fmemopen(source, length, "r");
+  if (file == NULL)
+    return NULL;
+  serdelizer_t *serdelizer = new_serdelizer(file);
+  svg_t *svg = parse_svg(serdelizer);
+  free_serdelizer(serdelizer);
+  return svg;
+}
+
+bool measure_bench_exports(svg_t *svg, size_t *svg_bytes, size_t *html_bytes) {
+  char *data = NULL;
+  FILE *file = open_memstream(&data, svg_bytes);
+  export_config_t *config =
+      new_export_config(2, false, false, false, 0, SIMPLIFY_DOUGLAS_PEUCKER);
+  serdelizer_t *serdelizer = new_serdelizer(file);
+  bool success = export_svg(svg, serdelizer, config);
+  // The file is closed here to read its size.
+  free(serdelizer);
+  free_export_config(config);
+  fclose(file);
+  free(data);
+
+  // The same steps as export_to_html, to a file whose size can be read.
+  data = NULL;
+  file = open_memstream(&data, html_bytes);
+  html_config_t *html_config =
+      new_html_config(false, false, 0, SIMPLIFY_DOUGLAS_PEUCKER);
+  export_start_html(file, svg, html_config);
+  export_svg_shapes_html(file, svg->shapes, html_config, NULL);
+  export_end_html(file);
+  free_html_config(html_config);
+  fclose(file);
+  free(data);
+  return success;
+}
+
+bool run_bench_operations(bench_config_t *config, char *source, size_t length,
+                          bench_result_t *results, unsigned int *shapes) {
+  for (int i = 0; i < BENCH_OPERATION_COUNT; i++) {
+    results[i].name = (char *)BENCH_OPERATION_NAMES[i];
+    results[i].bytes = length;
+    results[i].best = 0;
+    results[i].total = 0;
+    results[i].runs = 0;
+  }
+
+  svg_t *svg = parse_bench_source(source, length);
+  if (svg == NULL)
+    return false;
+  *shapes = 0;
+  for (shape_node_t *node = svg->shapes; node != NULL; node = node->next)
+    *shapes += count_shapes(node->shape);
+  bool success =
+      measure_bench_exports(svg, &results[1].bytes, &results[2].bytes);
+  free_svg(svg);
+
+  FILE *output = fopen(BENCH_NULL_PATH, "w");
+  if (output == NULL) {
+    fprintf(stderr, "Could not open %s\n", BENCH_NULL_PATH);
+    return false;
+  }
+  export_config_t *export_config =
+      new_export_config(2, false, false, false, 0, SIMPLIFY_DOUGLAS_PEUCKER);
+  html_config_t *html_config =
+      new_html_config(false, false, 0, SIMPLIFY_DOUGLAS_PEUCKER);
+  serdelizer_t *serdelizer = new_serdelizer(output);
+  for (unsigned int run = 0; success && run < config->runs; run++) {
+    uint64_t start = get_bench_time();
+    svg = parse_bench_source(source, length);
+    add_bench_run(&results[0], start);
+    if (svg == NULL) {
+      success = false;
+      break;
+    }
+
+    start = get_bench_time();
+    success = export_svg(svg, serdelizer, export_config);
+    fflush(output);
+    add_bench_run(&results[1], start);
+
+    start = get_bench_time();
+    success = export_to_html(svg, BENCH_NULL_PATH, html_config) && success;
+    add_bench_run(&results[2], start);
+
+    // A clone shares the svg, its release only drops the reference.
+    start = get_bench_time();
+    svg_t *clone = clone_svg(svg);
+    free_svg(clone);
+    add_bench_run(&results[3], start);
+
+    start = get_bench_time();
+    svg_t *copy = copy_svg(svg);
+    add_bench_run(&results[4], start);
+    free_svg(copy);
+
+    start = get_bench_time();
+    free_svg(svg);
+    add_bench_run(&results[5], start);
+  }
+  // The file is closed by the serdelizer.
+  free_serdelizer(serdelizer);
+  free_export_config(export_config);
+  free_html_config(html_config);
+  return success;
+}
+
+vector_t *new_bench_walk(uint64_t seed, unsigned int count) {
+  vector_t *points = malloc(sizeof(vector_t) * (count + 1));
+  vector_t point = {.x = 0, .y = 0};
+  for (unsigned int i = 0; i < count; i++) {
+    points[i] = point;
+    point.x += draw_generate_random(&seed, 2 * BENCH_WALK_STEP + 1) -
+               BENCH_WALK_STEP;
+    point.y += draw_generate_random(&seed, 2 * BENCH_WALK_STEP + 1) -
+               BENCH_WALK_STEP;
+  }
+  return points;
+}
+
+void run_bench_simplify(bench_config_t *config, bench_simplify_case_t *cases) {
+  vector_t *points = new_bench_walk(config->generate.seed, config->walk);
+  bool *keep = malloc(sizeof(bool) * config->walk);
+  for (int i = 0; i < BENCH_SIMPLIFY_CASE_COUNT; i++) {
+    bench_simplify_case_t *simplify_case = &cases[i];
+    simplify_case->method =
+        (i < BENCH_SIMPLIFY_CASE_COUNT / 2) ? SIMPLIFY_DOUGLAS_PEUCKER
+                                            : SIMPLIFY_VISVALINGAM;
+    simplify_case->tolerance =
+        BENCH_SIMPLIFY_TOLERANCES[i % (BENCH_SIMPLIFY_CASE_COUNT / 2)];
+    simplify_case->result.name =
+        (simplify_case->method == SIMPLIFY_VISVALINGAM) ? "visvalingam"
+                                                        : "douglas_peucker";
+    simplify_case->result.bytes = sizeof(vector_t) * config->walk;
+    simplify_case->result.best = 0;
+    simplify_case->result.total = 0;
+    simplify_case->result.runs = 0;
+    for (unsigned int run = 0; run < config->runs; run++) {
+      uint64_t start = get_bench_time();
+      simplify_case->kept =
+          simplify_vectors(points, config->walk, simplify_case->tolerance,
+                           simplify_case->method, false, keep);
+      add_bench_run(&simplify_case->result, start);
+    }
+  }
+  free(keep);
+  free(points);
+}
+
+long get_bench_peak_memory() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+  return usage.ru_maxrss;
+}
+
+void write_bench_string(FILE *file, char *value) {
+  fputc('"', file);
+  for (char *c = value; *c != '\0'; c++)
+    if (*c != '"' && *c != '\\' && (unsigned char)*c >= ' ')
+      fputc(*c, file);
+  fputc('"', file);
+}
+
+void write_bench_json(FILE *file, bench_config_t *config, size_t length,
+                      unsigned int shapes, bench_result_t *results,
+                      bench_simplify_case_t *cases, long memory) {
+  fprintf(file, "{\n  \"commit\": ");
+  if (config->commit != NULL && config->commit[0] != '\0')
+    write_bench_string(file, config->commit);
+  else
+    fprintf(file, "null");
+  generate_config_t *generate = &config->generate;
+  fprintf(file,
+          ",\n  \"shapes\": %u,\n  \"source_bytes\": %zu,\n"
+          "  \"runs\": %u,\n  \"seed\": %llu,\n  \"group_size\": %u,\n"
+          "  \"depth\": %u,\n  \"points\": %u,\n  \"elements\": %u,\n"
+          "  \"style_rate\": %u,\n  \"palette\": %u,\n  \"counts\": {",
+          shapes, length, config->runs, (unsigned long long)generate->seed,
+          generate->group_size, generate->depth, generate->points,
+          generate->elements, generate->style_rate, generate->palette);
+  for (int i = 0; i < GENERATE_VARIANT_COUNT; i++)
+    fprintf(file, "%s\"%s\": %lu", (i > 0) ? ", " : "",
+            BENCH_VARIANT_NAMES[i], generate->counts[i]);
+  fprintf(file, "},\n  \"peak_rss_kb\": %ld,\n  \"operations\": [\n", memory);
+  for (int i = 0; i < BENCH_OPERATION_COUNT; i++) {
+    bench_result_t *result = &results[i];
+    double seconds = (double)result->best / NANOSECONDS;
+    fprintf(file,
+            "    {\"name\": \"%s\", \"bytes\": %zu, \"best_ns\": %llu, "
+            "\"mean_ns\": %llu, \"ns_per_shape\": %.3f, "
+            "\"mb_per_s\": %.3f}%s\n",
+            result->name, result->bytes, (unsigned long long)result->best,
+            (unsigned long long)(result->total / result->runs),
+            (double)result->best / shapes,
+            (seconds > 0) ? result->bytes / seconds / MEGABYTE : 0,
+            (i + 1 < BENCH_OPERATION_COUNT) ? "," : "");
+  }
+  fprintf(file, "  ]");
+  if (config->walk > 0) {
+    fprintf(file, ",\n  \"simplify\": {\"points\": %u, \"cases\": [\n",
+            config->walk);
+    for (int i = 0; i < BENCH_SIMPLIFY_CASE_COUNT; i++) {
+      bench_result_t *result = &cases[i].result;
+      fprintf(file,
+              "    {\"name\": \"%s\", \"tolerance\": %g, \"kept\": %d, "
+              "\"best_ns\": %llu, \"mean_ns\": %llu, "
+              "\"ns_per_point\": %.3f}%s\n",
+              result->name, cases[i].tolerance, cases[i].kept,
+              (unsigned long long)result->best,
+              (unsigned long long)(result->total / result->runs),
+              (double)result->best / config->walk,
+              (i + 1 < BENCH_SIMPLIFY_CASE_COUNT) ? "," : "");
+    }
+    fprintf(file, "  ]}");
+  }
+  fprintf(file, "\n}\n");
+}
+
+void print_bench_results(size_t length, unsigned int shapes,
+                         bench_result_t *results, long memory) {
+  fprintf(stdout, "%u shapes, %zu bytes, peak memory %ld KB\n", shapes,
+          length, memory);
+  fprintf(stdout, "%-16s %14s %14s %12s %10s\n", "operation", "best (ns)",
+          "mean (ns)", "ns/shape", "MB/s");
+  for (int i = 0; i < BENCH_OPERATION_COUNT; i++) {
+    bench_result_t *result = &results[i];
+    double seconds = (double)result->best / NANOSECONDS;
+    fprintf(stdout, "%-16s %14llu %14llu %12.3f %10.2f\n", result->name,
+            (unsigned long long)result->best,
+            (unsigned long long)(result->total / result->runs),
+            (double)result->best / shapes,
+            (seconds > 0) ? result->bytes / seconds / MEGABYTE : 0);
+  }
+}
+
+void print_bench_simplify(unsigned int walk, bench_simplify_case_t *cases) {
+  fprintf(stdout, "\nRandom walk of %u points\n", walk);
+  fprintf(stdout, "%-16s %9s %9s %14s %14s %12s\n", "simplify", "tolerance",
+          "kept", "best (ns)", "mean (ns)", "ns/point");
+  for (int i = 0; i < BENCH_SIMPLIFY_CASE_COUNT; i++) {
+    bench_result_t *result = &cases[i].result;
+    fprintf(stdout, "%-16s %9g %9d %14llu %14llu %12.3f\n", result->name,
+            cases[i].tolerance, cases[i].kept,
+            (unsigned long long)result->best,
+            (unsigned long long)(result->total / result->runs),
+            (double)result->best / walk);
+  }
+}
+
+int bench_main(int argc, char **argv) {
+  bench_config_t config;
+  if (!bench_parse_options(argc, argv, &config)) {
+    bench_print_usage();
+    return EXIT_FAILURE;
+  }
+
+  size_t length;
+  char *source = generate_bench_source(&config, &length);
+  bench_result_t results[BENCH_OPERATION_COUNT];
+  unsigned int shapes = 0;
+  bool success = run_bench_operations(&config, source, length, results,
+                                      &shapes);
+  free(source);
+  if (!success) {
+    fprintf(stderr, "Could not run the benchmark\n");
+    return EXIT_FAILURE;
+  }
+
+  // The walk is simplified after the svg is freed, the peak memory is the
+  // largest of both.
+  bench_simplify_case_t cases[BENCH_SIMPLIFY_CASE_COUNT];
+  if (config.walk > 0)
+    run_bench_simplify(&config, cases);
+
+  long memory = get_bench_peak_memory();
+  print_bench_results(length, shapes, results, memory);
+  if (config.walk > 0)
+    print_bench_simplify(config.walk, cases);
+  if (config.output == NULL)
+    return EXIT_SUCCESS;
+  FILE *file = fopen(config.output, "w");
+  if (file == NULL) {
+    fprintf(stderr, "Could not open %s\n", config.output);
+    return EXIT_FAILURE;
+  }
+  write_bench_json(file, &config, length, shapes, results, cases, memory);
+  fclose(file);
+  return EXIT_SUCCESS;
+}
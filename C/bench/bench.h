@@ -0,0 +1,232 @@
+#ifndef CODA_BENCH
+#define CODA_BENCH
+
+#include "../generate/generate.h"
+#include "../geometry/simplify.h"
+#include "../models/shapes/svg.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define BENCH_OPERATION_COUNT 6
+#define BENCH_SIMPLIFY_CASE_COUNT 6
+
+/**
+ * Defines the benchmark config type, read from the command line.
+ * @param generate the generator config of the timed svg.
+ * @param runs     the number of times each operation is timed.
+ * @param walk     the number of points of the simplified random walk, 0 to
+ * skip the simplification cases.
+ * @param output   the path of the JSON results, NULL if there is none.
+ * @param commit   the commit written down with the results, NULL if unknown.
+ * @see generate_config_t.
+ */
+typedef struct bench_config_s {
+  generate_config_t generate;
+  unsigned int runs;
+  unsigned int walk;
+  char *output;
+  char *commit;
+} bench_config_t;
+
+/**
+ * Defines the benchmark result type, the timings of an operation.
+ * @param name  the operation's name.
+ * @param bytes the number of bytes read or written by the operation.
+ * @param best  the fastest run's duration, in nanoseconds.
+ * @param total the sum of the runs' durations, in nanoseconds.
+ * @param runs  the number of runs.
+ */
+typedef struct bench_result_s {
+  char *name;
+  size_t bytes;
+  uint64_t best;
+  uint64_t total;
+  unsigned int runs;
+} bench_result_t;
+
+/**
+ * Defines the benchmark simplification case type, the timings of the
+ * simplification of the random walk.
+ * @param result    the case's timings, named after the algorithm.
+ * @param method    the simplification algorithm.
+ * @param tolerance the simplification tolerance.
+ * @param kept      the number of kept points.
+ * @see bench_result_t.
+ */
+typedef struct bench_simplify_case_s {
+  bench_result_t result;
+  simplify_method_t method;
+  double tolerance;
+  int kept;
+} bench_simplify_case_t;
+
+/**
+ * Displays the benchmark options.
+ */
+void bench_print_usage();
+
+/**
+ * Reads the options of the benchmark, the generate options describing the
+ * timed svg.
+ * The other options are:
+ * - --runs <count> : the number of times each operation is timed.
+ * - --walk <points> : the number of points of the simplified random walk, 0
+ * to skip it.
+ * - --output <file> : writes down the results as JSON.
+ * - --commit <name> : the commit written down with the results.
+ * @param argc   the number of arguments.
+ * @param argv   the arguments.
+ * @param config the config to set.
+ * @return returns true if the options are valid.
+ * @see generate_parse_options.
+ */
+bool bench_parse_options(int argc, char **argv, bench_config_t *config);
+
+/**
+ * Generates the svg file described by the given config.
+ * The same config always generates the same file.
+ * Note that this function allocates memory.
+ * @param config the benchmark config.
+ * @param length a pointer to the file's length, set by the function.
+ * @return the file's null terminated content.
+ * @see generate_svg.
+ */
+char *generate_bench_source(bench_config_t *config, size_t *length);
+
+/**
+ * Reads the monotonic clock.
+ * @return the clock's time, in nanoseconds.
+ */
+uint64_t get_bench_time();
+
+/**
+ * Adds a run to the given result.
+ * @param result the operation's result.
+ * @param start  the run's start time, in nanoseconds.
+ * @see get_bench_time.
+ */
+void add_bench_run(bench_result_t *result, uint64_t start);
+
+/**
+ * Parses the given svg file's content.
+ * Note that this function allocates memory.
+ * @param source the file's content.
+ * @param length the content's length.
+ * @return the new svg's pointer, NULL if the content is invalid.
+ * @see parse_svg.
+ */
+svg_t *parse_bench_source(char *source, size_t length);
+
+/**
+ * Measures the number of bytes of the given svg written down as an svg and in
+ * HTML format.
+ * Note that this function allocates and frees memory.
+ * @param svg        the svg.
+ * @param svg_bytes  a pointer to the svg's number of bytes, set by the
+ * function.
+ * @param html_bytes a pointer to the HTML's number of bytes, set by the
+ * function.
+ * @return returns true if the svg could be written down.
+ */
+bool measure_bench_exports(svg_t *svg, size_t *svg_bytes, size_t *html_bytes);
+
+/**
+ * Times the operations on the svg file described by the given config, the
+ * fastest of the runs being kept.
+ * Note that this function allocates and frees memory.
+ * @param config  the benchmark config.
+ * @param source  the file's content.
+ * @param length  the content's length.
+ * @param results the results to set, one per operation.
+ * @param shapes  a pointer to the svg's number of shapes, set by the function.
+ * @return returns true if the file could be parsed and written down.
+ * @see bench_result_t.
+ */
+bool run_bench_operations(bench_config_t *config, char *source, size_t length,
+                          bench_result_t *results, unsigned int *shapes);
+
+/**
+ * Creates a random walk, a line moving by a few units at each point, from
+ * the given seed.
+ * The same seed always creates the same walk.
+ * Note that this function allocates memory.
+ * @param seed  the seed of the random numbers.
+ * @param count the number of points.
+ * @return the new array of count points.
+ * @see next_generate_random.
+ */
+vector_t *new_bench_walk(uint64_t seed, unsigned int count);
+
+/**
+ * Times the simplification of a random walk with both algorithms at the
+ * tolerances 1, 10 and 100, the fastest of the runs being kept.
+ * Note that this function allocates and frees memory.
+ * @param config the benchmark config, whose walk must not be empty.
+ * @param cases  the cases to set.
+ * @see simplify_vectors.
+ */
+void run_bench_simplify(bench_config_t *config, bench_simplify_case_t *cases);
+
+/**
+ * Reads the peak resident memory of the process.
+ * @return the peak memory, in kilobytes.
+ */
+long get_bench_peak_memory();
+
+/**
+ * Writes down a JSON string, without the characters it cannot hold as is.
+ * @param file  an opened file in writing mode.
+ * @param value the string's characters.
+ */
+void write_bench_string(FILE *file, char *value);
+
+/**
+ * Writes down the benchmark's results as JSON.
+ * @param file    an opened file in writing mode.
+ * @param config  the benchmark config.
+ * @param length  the svg file's length.
+ * @param shapes  the svg's number of shapes.
+ * @param results the operations' results.
+ * @param cases   the simplification cases, unused if the walk is empty.
+ * @param memory  the peak resident memory, in kilobytes.
+ * @see bench_result_t.
+ */
+void write_bench_json(FILE *file, bench_config_t *config, size_t length,
+                      unsigned int shapes, bench_result_t *results,
+                      bench_simplify_case_t *cases, long memory);
+
+/**
+ * Displays the benchmark's results as a table.
+ * @param length  the svg file's length.
+ * @param shapes  the svg's number of shapes.
+ * @param results the operations' results.
+ * @param memory  the peak resident memory, in kilobytes.
+ * @see bench_result_t.
+ */
+void print_bench_results(size_t length, unsigned int shapes,
+                         bench_result_t *results, long memory);
+
+/**
+ * Displays the timings of the simplification cases as a table.
+ * @param walk  the number of points of the random walk.
+ * @param cases the simplification cases.
+ * @see bench_simplify_case_t.
+ */
+void print_bench_simplify(unsigned int walk, bench_simplify_case_t *cases);
+
+/**
+ * Runs the benchmark with the given command line arguments: generates a
+ * synthetic svg, then times its parse, its exports as an svg and in HTML
+ * format, its clone, its copy and its destruction, and the simplification
+ * of a random walk.
+ * Note that this function allocates and frees memory.
+ * @param argc the number of arguments.
+ * @param argv the arguments.
+ * @return the process's exit status.
+ * @see bench_parse_options.
+ */
+int bench_main(int argc, char **argv);
+
+#endif
@@ -0,0 +1,8 @@
+#include "bench.h"
+#include "../instrument/instrument.h"
+#include <stdlib.h>
+
+int main(int argc, char **argv) {
+  INSTRUMENT_AT_EXIT();
+  return bench_main(argc - 1, argv + 1);
+}
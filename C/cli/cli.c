@@ -1,15 +1,22 @@
 #include "cli.h"
+#include "../geometry/metrics.h"
+#include "../geometry/rtree.h"
+#include "../hash/dedupe.h"
+#include "../history/history.h"
 #include "../html/html.h"
 #include "../models/shapes/svg.h"
+#include "../script/script.h"
 #include "../serde/deserialize/parser.h"
 #include "../serde/serialize/export.h"
 #include "../utils/utils.h"
 #include "cli_path.h"
 #include "cli_shape.h"
+#include "cli_view.h"
 #include <ctype.h>
 #include <limits.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #define BLACK "\033[1;30m"
@@ -28,6 +35,40 @@
 #define SAVE_FILE_PATH_BUFFER_SIZE 500
 #define EXPORT_HTML_FILE_PATH_BUFFER_SIZE 500
 #define ASK_FOR_INDEX_BUFFER_SIZE 200
+#define CULLED_SHAPES_BUFFER_SIZE 200
+#define SIMPLIFIED_POINTS_BUFFER_SIZE 200
+#define LOD_LEVEL_COUNT 10
+#define METRICS_BUFFER_SIZE 300
+#define HISTORY_CAPACITY (64 * 1024 * 1024)
+#define DEDUPE_BUFFER_SIZE 300
+#define DEDUPE_REPORT_SET_COUNT 20
+#define SCRIPT_FILE_PATH_BUFFER_SIZE 500
+
+cli_editor_t *new_cli_editor() {
+  cli_editor_t *editor = malloc(sizeof(cli_editor_t));
+  editor->history = new_history(HISTORY_CAPACITY);
+  editor->view = new_cli_view();
+  editor->lod_pyramid = NULL;
+  editor->spatial_index = NULL;
+  editor->shape_nodes = NULL;
+  editor->ancestor_transforms = NULL;
+  editor->ancestor_depth = 0;
+  editor->ancestor_capacity = 0;
+  return editor;
+}
+
+void free_cli_editor(cli_editor_t *editor) {
+  if (editor == NULL)
+    return;
+  cli_discard_lod_pyramid(editor);
+  free_history(editor->history);
+  free_cli_view(editor->view);
+  if (editor->spatial_index != NULL)
+    free_rtree(editor->spatial_index);
+  free_node_index(editor->shape_nodes);
+  free(editor->ancestor_transforms);
+  free(editor);
+}
 
 void cli_clear_screen() { fprintf(stdout, "\e[1;1H\e[2J"); }
 
@@ -100,25 +141,22 @@ void cli_print_path_elements(path_element_node_t *elements) {
   cli_print_content("]\n");
 }
 
-void cli_print_shapes(shape_node_t *shapes) {
-  int i = 0;
+void cli_print_shapes(cli_view_t *view, node_index_t *nodes) {
+  int length = get_node_index_length(nodes), i = 0;
   cli_print_content("Shapes [ ");
-  if (shapes == NULL) {
+  if (length == 0) {
     cli_print_content("]\n");
     return;
   } else
     cli_print_content("\n");
 
-  shape_node_t *node = shapes;
-  while (node->next != NULL) {
-    fprintf(stdout, "(%d) ", i);
-    cli_print_shape(node->shape, 0);
-    node = node->next;
-    i++;
+  // Only the first page is formatted, the other indexes stay selectable.
+  for (; i < length && i < CLI_VIEW_PAGE_SIZE; i++) {
+    shape_node_t *node = get_indexed_shape_node(nodes, i);
+    fprintf(stdout, "(%d) %s\n", i, get_cli_view_line(view, node->shape));
   }
-
-  fprintf(stdout, "(%d) ", i);
-  cli_print_shape(node->shape, 0);
+  if (i < length)
+    fprintf(stdout, "... %d more shape(s)\n", length - i);
   cli_print_content("]\n");
 }
 
@@ -258,12 +296,12 @@ cli_output_t cli_ask_for_path_element_index(char *prompt,
   }
 }
 
-cli_output_t cli_ask_for_shape_index(char *prompt, shape_node_t *shapes,
-                                     int *index, bool include_lower,
-                                     bool include_upper) {
+cli_output_t cli_ask_for_shape_index(char *prompt, cli_view_t *view,
+                                     node_index_t *nodes, int *index,
+                                     bool include_lower, bool include_upper) {
   cli_output_t output;
   bool error = false;
-  int length = get_shape_node_length(shapes);
+  int length = get_node_index_length(nodes);
   char buffer[ASK_FOR_INDEX_BUFFER_SIZE];
   char lower = include_lower ? '[' : ']';
   char upper = include_upper ? ']' : '[';
@@ -271,7 +309,7 @@ cli_output_t cli_ask_for_shape_index(char *prompt, shape_node_t *shapes,
   int i;
   while (true) {
     cli_clear_screen();
-    cli_print_shapes(shapes);
+    cli_print_shapes(view, nodes);
     cli_print_content(prompt);
     if (error)
       cli_print_error("Select a valid index.\n");
@@ -499,24 +537,44 @@ svg_t *cli_open_svg() {
   return svg;
 }
 
-void cli_edit_svg(svg_t *svg) {
+void cli_edit_svg(cli_editor_t *editor, svg_t *svg) {
   bool error = false;
   int d;
   cli_output_t output;
+  history_t *history = editor->history;
+  history_entry_t *entry;
+  editor->spatial_index = build_rtree(svg->shapes);
+  cli_index_svg(editor, svg);
+  cli_discard_lod_pyramid(editor);
   while (true) {
     cli_clear_screen();
-    cli_print_svg(svg);
+    cli_print_view(editor->view, svg);
     cli_print_content("Select action to perform :\n");
     cli_print_content("- Edit viewport (1)\n");
     cli_print_content("- Add new shape (2)\n");
     cli_print_content("- Edit shape (3)\n");
     cli_print_content("- Remove shape (4)\n");
+    cli_print_content("- Search shapes in area (5)\n");
+    cli_print_content("- Find nearest shape (6)\n");
+    cli_print_content("- Simplify shapes (7)\n");
+    cli_print_content("- Show metrics (8)\n");
+    cli_print_content("- Undo (9)\n");
+    cli_print_content("- Redo (10)\n");
+    cli_print_content("- Find duplicate shapes (11)\n");
+    cli_print_content("- Run script (12)\n");
+    cli_print_content("- Edit shape by query (13)\n");
+    cli_print_content("- Browse shapes (14)\n");
     if (error)
       cli_print_error("Enter a valid option.\n");
 
     output = cli_ask_for_int(&d);
-    if (output == CLI_EMPTY)
+    if (output == CLI_EMPTY) {
+      free_rtree(editor->spatial_index);
+      editor->spatial_index = NULL;
+      free_node_index(editor->shape_nodes);
+      editor->shape_nodes = NULL;
       return;
+    }
     if (output == CLI_INVALID) {
       error = true;
       continue;
@@ -524,16 +582,72 @@ void cli_edit_svg(svg_t *svg) {
 
     switch (d) {
     case 1:
+      record_history(history, svg);
       cli_edit_viewport(svg->viewport);
+      cli_commit_edit(editor, svg);
       break;
     case 2:
-      cli_add_shape(&svg->shapes, new_default_style());
+      record_history(history, svg);
+      cli_add_shape(editor, &svg->shapes, editor->shape_nodes,
+                    new_default_style());
+      cli_commit_edit(editor, svg);
       break;
     case 3:
-      cli_edit_shapes(svg->shapes);
+      record_history(history, svg);
+      cli_edit_shapes(editor, editor->shape_nodes);
+      cli_commit_edit(editor, svg);
       break;
     case 4:
-      cli_remove_shape(&svg->shapes);
+      record_history(history, svg);
+      cli_remove_shape(editor, &svg->shapes, editor->shape_nodes);
+      cli_commit_edit(editor, svg);
+      break;
+    case 5:
+      cli_search_shapes(editor);
+      break;
+    case 6:
+      cli_find_nearest_shape(editor);
+      break;
+    case 7:
+      record_history(history, svg);
+      cli_simplify_svg(svg);
+      // The shapes which lost points were replaced by simplified copies.
+      if (cli_commit_edit(editor, svg))
+        cli_update_spatial_index(editor, history->undo);
+      break;
+    case 8:
+      cli_print_svg_metrics(svg);
+      break;
+    case 9:
+    case 10:
+      entry = (d == 9) ? undo_history(history, svg, editor->shape_nodes)
+                       : redo_history(history, svg, editor->shape_nodes);
+      if (entry == NULL)
+        break;
+      cli_update_spatial_index(editor, entry);
+      // The view's expanded groups may have been replaced.
+      collapse_cli_view_groups(editor->view);
+      break;
+    case 11:
+      cli_find_duplicates(svg);
+      break;
+    case 12:
+      record_history(history, svg);
+      cli_run_script(svg);
+      if (!cli_commit_edit(editor, svg))
+        break;
+      // The edited shapes were replaced by copies and the deleted shapes'
+      // nodes were unlinked.
+      cli_index_svg(editor, svg);
+      cli_update_spatial_index(editor, history->undo);
+      break;
+    case 13:
+      record_history(history, svg);
+      cli_query_shapes(editor, svg->shapes);
+      cli_commit_edit(editor, svg);
+      break;
+    case 14:
+      cli_browse_svg(editor, svg);
       break;
     default:
       error = true;
@@ -543,18 +657,266 @@ void cli_edit_svg(svg_t *svg) {
   return;
 }
 
+void cli_browse_svg(cli_editor_t *editor, svg_t *svg) {
+  bool error = false;
+  cli_output_t output;
+  int d, row;
+  cli_view_t *view = editor->view;
+  while (true) {
+    cli_clear_screen();
+    cli_print_view(view, svg);
+    cli_print_content("Select action to perform :\n");
+    cli_print_content("- Next page (1)\n");
+    cli_print_content("- Previous page (2)\n");
+    cli_print_content("- Expand or collapse a group (3)\n");
+    if (error)
+      cli_print_error("Enter a valid option.\n");
+    error = false;
+
+    output = cli_ask_for_int(&d);
+    if (output == CLI_EMPTY)
+      return;
+    if (output == CLI_INVALID) {
+      error = true;
+      continue;
+    }
+
+    switch (d) {
+    case 1:
+      move_cli_view(view, 1);
+      break;
+    case 2:
+      move_cli_view(view, -1);
+      break;
+    case 3:
+      cli_print_content("Select the group's row.\n");
+      if (view->visible_count > 0 &&
+          cli_ask_for_index(0, view->visible_count - 1, &row) == CLI_VALID)
+        toggle_cli_view_group(view, view->visible[row]);
+      else
+        error = true;
+      break;
+    default:
+      error = true;
+      break;
+    }
+  }
+}
+
+bool cli_commit_edit(cli_editor_t *editor, svg_t *svg) {
+  if (!commit_history(editor->history, svg))
+    return false;
+  // The view's expanded groups may have been replaced by copies.
+  collapse_cli_view_groups(editor->view);
+  return true;
+}
+
+void cli_update_spatial_index(cli_editor_t *editor, history_entry_t *entry) {
+  history_change_t *change;
+  // The replaced shapes are all removed before the new ones are inserted,
+  // since the new groups may share shapes with the replaced ones.
+  for (change = entry->changes; change != NULL; change = change->next)
+    for (int i = 0; i < change->shape_count; i++)
+      rtree_remove_shape(editor->spatial_index, change->shapes[i]);
+  for (change = entry->changes; change != NULL; change = change->next)
+    for (int i = 0; i < change->count; i++)
+      rtree_insert_shape(
+          editor->spatial_index,
+          get_indexed_shape_node(editor->shape_nodes, change->position + i)
+              ->shape,
+          NULL);
+}
+
+void cli_index_svg(cli_editor_t *editor, svg_t *svg) {
+  free_node_index(editor->shape_nodes);
+  editor->shape_nodes = index_shape_nodes(svg->shapes);
+  // The view's expanded groups may be freed by the edit.
+  collapse_cli_view_groups(editor->view);
+}
+
+cli_output_t cli_ask_for_simplify_method(simplify_method_t *method) {
+  bool error = false;
+  int d;
+  cli_output_t output;
+  while (true) {
+    cli_clear_screen();
+    cli_print_content("Select simplification algorithm :\n");
+    cli_print_content("- Douglas-Peucker (1)\n");
+    cli_print_content("- Visvalingam-Whyatt (2)\n");
+    if (error)
+      cli_print_error("Enter a valid option.\n");
+
+    output = cli_ask_for_int(&d);
+    if (output == CLI_EMPTY)
+      return output;
+    if (output == CLI_VALID && (d == 1 || d == 2)) {
+      *method = (d == 1) ? SIMPLIFY_DOUGLAS_PEUCKER : SIMPLIFY_VISVALINGAM;
+      return output;
+    }
+    error = true;
+  }
+}
+
+bool cli_simplify_svg(svg_t *svg) {
+  bool error = false;
+  int tolerance;
+  simplify_method_t method;
+  char buffer[SIMPLIFIED_POINTS_BUFFER_SIZE];
+  cli_output_t output;
+  while (true) {
+    cli_clear_screen();
+    cli_print_content("Select simplification tolerance.\n");
+    if (error)
+      cli_print_error("Enter a positive integer.\n");
+
+    output = cli_ask_for_int(&tolerance);
+    if (output == CLI_EMPTY)
+      return false;
+    if (output == CLI_VALID && tolerance > 0)
+      break;
+    error = true;
+  }
+  if (cli_ask_for_simplify_method(&method) == CLI_EMPTY)
+    return false;
+
+  int removed = simplify_svg(svg, tolerance, method);
+  sprintf(buffer, "%d point(s) were removed.\n", removed);
+  cli_print_success(buffer);
+  cli_press_any_key();
+  return true;
+}
+
+void cli_print_svg_metrics(svg_t *svg) {
+  char buffer[METRICS_BUFFER_SIZE];
+  vector_t centroid;
+  metrics_t metrics = measure_svg(svg);
+  cli_clear_screen();
+  sprintf(buffer, "Area = %.2f\nLength = %.2f\nPoints = %u\n", metrics.area,
+          metrics.length, metrics.point_count);
+  cli_print_content(buffer);
+  if (get_metrics_centroid(&metrics, &centroid))
+    sprintf(buffer, "Centroid = %.2f %.2f\n", centroid.x, centroid.y);
+  else
+    sprintf(buffer, "Centroid = none\n");
+  cli_print_content(buffer);
+  cli_press_any_key();
+}
+
+void cli_find_duplicates(svg_t *svg) {
+  char buffer[DEDUPE_BUFFER_SIZE];
+  dedupe_report_t *report = dedupe_svg(svg);
+  shape_table_entry_t *duplicates = list_duplicates(report);
+  cli_clear_screen();
+  sprintf(buffer,
+          "Shapes = %u\nDuplicates = %u in %u sets\nShareable = %zu bytes\n",
+          report->shapes, report->duplicates, report->sets, report->saved);
+  cli_print_content(buffer);
+  for (unsigned int i = 0; i < report->sets && i < DEDUPE_REPORT_SET_COUNT;
+       i++) {
+    sprintf(buffer, "- %u copies of a %s\n", duplicates[i].copies,
+            get_shape_name(duplicates[i].shape));
+    cli_print_content(buffer);
+  }
+  free(duplicates);
+  free_dedupe_report(report);
+  cli_press_any_key();
+}
+
+bool cli_run_script(svg_t *svg) {
+  char buffer[SCRIPT_FILE_PATH_BUFFER_SIZE];
+  size_t size, max_length = 500;
+  bool error = false;
+  FILE *file = NULL;
+  cli_output_t output;
+  while (file == NULL) {
+    cli_clear_screen();
+    cli_print_content("Select the script file's path to run.\n");
+    if (error)
+      cli_print_error("Enter a valid file path\n");
+
+    output = cli_ask_for_string(buffer, &size, max_length);
+    if (output == CLI_EMPTY)
+      return false;
+    if (output == CLI_VALID)
+      file = fopen(buffer, "r");
+    error = true;
+  }
+
+  script_report_t report;
+  serdelizer_t *serdelizer = new_serdelizer(file);
+  bool success = run_script(svg, serdelizer, &report);
+  free_serdelizer(serdelizer);
+  sprintf(buffer, "%u statement(s), %u shape(s) edited, %u deleted.\n",
+          report.statements, report.edited, report.deleted);
+  if (success)
+    cli_print_success(buffer);
+  else
+    cli_print_error(buffer);
+  cli_press_any_key();
+  // An invalid statement keeps the edits made before it.
+  return report.edited > 0 || report.deleted > 0;
+}
+
+lod_pyramid_t *cli_get_lod_pyramid(cli_editor_t *editor) {
+  if (editor->lod_pyramid == NULL)
+    editor->lod_pyramid =
+        new_lod_pyramid(LOD_LEVEL_COUNT, SIMPLIFY_DOUGLAS_PEUCKER);
+  return editor->lod_pyramid;
+}
+
+void cli_discard_lod_pyramid(cli_editor_t *editor) {
+  free_lod_pyramid(editor->lod_pyramid);
+  editor->lod_pyramid = NULL;
+}
+
+cli_output_t cli_ask_for_scale(double *scale) {
+  bool error = false;
+  int percent;
+  cli_output_t output;
+  while (true) {
+    cli_clear_screen();
+    cli_print_content(
+        "Select output scale in percent (100 for full detail).\n");
+    if (error)
+      cli_print_error("Enter an integer between 1 and 100.\n");
+
+    output = cli_ask_for_int(&percent);
+    if (output == CLI_EMPTY)
+      return output;
+    if (output == CLI_VALID && percent > 0 && percent <= 100) {
+      *scale = percent / 100.0;
+      return output;
+    }
+    error = true;
+  }
+}
+
 export_config_t *cli_new_export_config() {
-  int tab_size, d;
+  int tab_size, tolerance, d;
   bool error = false;
-  export_config_t *config = new_export_config(2, false);
+  export_config_t *config = new_export_config(2, false, false, false, 0,
+                                              SIMPLIFY_DOUGLAS_PEUCKER);
   cli_output_t output;
   while (true) {
     cli_clear_screen();
-    fprintf(stdout, "Export configs { Tab size = %d, Line break = %s }\n\n",
-            config->tab_size, (config->line_break) ? "true" : "false");
+    fprintf(stdout,
+            "Export configs { Tab size = %d, Line break = %s, Viewport "
+            "culling = %s, Bake transforms = %s, Simplify tolerance = %g, "
+            "Simplify algorithm = %s, Output scale = %g%% }\n\n",
+            config->tab_size, (config->line_break) ? "true" : "false",
+            (config->cull) ? "true" : "false",
+            (config->bake) ? "true" : "false", config->simplify,
+            (config->method == SIMPLIFY_VISVALINGAM) ? "Visvalingam-Whyatt"
+                                                     : "Douglas-Peucker",
+            config->scale * 100);
     cli_print_content("Select action to perform :\n");
     cli_print_content("- Change tab size (1)\n");
     cli_print_content("- Change line break (2)\n");
+    cli_print_content("- Change viewport culling (3)\n");
+    cli_print_content("- Change transform baking (4)\n");
+    cli_print_content("- Change simplify tolerance (5)\n");
+    cli_print_content("- Change simplify algorithm (6)\n");
+    cli_print_content("- Change output scale (7)\n");
     if (error)
       cli_print_error("Enter a valid option.\n");
 
@@ -577,6 +939,25 @@ export_config_t *cli_new_export_config() {
     case 2:
       config->line_break = !config->line_break;
       break;
+    case 3:
+      config->cull = !config->cull;
+      break;
+    case 4:
+      config->bake = !config->bake;
+      break;
+    case 5:
+      output = cli_ask_for_int(&tolerance);
+      if (output == CLI_VALID && tolerance >= 0)
+        config->simplify = tolerance;
+      else if (output != CLI_EMPTY)
+        error = true;
+      break;
+    case 6:
+      cli_ask_for_simplify_method(&config->method);
+      break;
+    case 7:
+      cli_ask_for_scale(&config->scale);
+      break;
     default:
       error = true;
       continue;
@@ -587,7 +968,7 @@ export_config_t *cli_new_export_config() {
   return NULL;
 }
 
-void cli_export_svg(svg_t *svg) {
+void cli_export_svg(cli_editor_t *editor, svg_t *svg) {
   bool running = true, error = false;
   size_t size, max_length = 500;
   char buffer[SAVE_FILE_PATH_BUFFER_SIZE];
@@ -620,6 +1001,8 @@ void cli_export_svg(svg_t *svg) {
       free_serdelizer(serdelizer);
       return;
     }
+    if (config->scale < 1)
+      config->lod = cli_get_lod_pyramid(editor);
     if (!export_svg(svg, serdelizer, config)) {
       cli_press_any_key();
       free_export_config(config);
@@ -627,6 +1010,8 @@ void cli_export_svg(svg_t *svg) {
       return;
     } else
       running = false;
+    if (config->cull)
+      cli_print_culled_shapes(config->culled);
   }
   if (serdelizer != NULL)
     free_serdelizer(serdelizer);
@@ -635,7 +1020,7 @@ void cli_export_svg(svg_t *svg) {
   return;
 }
 
-void cli_export_svg_to_html(svg_t *svg) {
+void cli_export_svg_to_html(cli_editor_t *editor, svg_t *svg) {
   bool error = false;
   size_t size, max_length = 500;
   char buffer[EXPORT_HTML_FILE_PATH_BUFFER_SIZE];
@@ -654,19 +1039,57 @@ void cli_export_svg_to_html(svg_t *svg) {
     error = true;
   }
 
-  export_to_html(svg, buffer);
+  bool cull = false, bake = false;
+  cli_clear_screen();
+  cli_print_content("Skip the shapes outside the viewport ? (true/false)\n");
+  if (cli_ask_for_bool(&cull) == CLI_EMPTY)
+    return;
+  cli_clear_screen();
+  cli_print_content(
+      "Bake the transforms into the coordinates ? (true/false)\n");
+  if (cli_ask_for_bool(&bake) == CLI_EMPTY)
+    return;
+  int tolerance = -1;
+  simplify_method_t method = SIMPLIFY_DOUGLAS_PEUCKER;
+  while (tolerance < 0) {
+    cli_clear_screen();
+    cli_print_content(
+        "Simplify the lines with which tolerance ? (0 to keep them)\n");
+    if (cli_ask_for_int(&tolerance) == CLI_EMPTY)
+      return;
+  }
+  if (tolerance > 0 && cli_ask_for_simplify_method(&method) == CLI_EMPTY)
+    return;
+  double scale = 1;
+  if (cli_ask_for_scale(&scale) == CLI_EMPTY)
+    return;
+  html_config_t *config = new_html_config(cull, bake, tolerance, method);
+  config->scale = scale;
+  if (scale < 1)
+    config->lod = cli_get_lod_pyramid(editor);
+  if (export_to_html(svg, buffer, config) && config->cull)
+    cli_print_culled_shapes(config->culled);
+  free_html_config(config);
+}
+
+void cli_print_culled_shapes(unsigned int culled) {
+  char buffer[CULLED_SHAPES_BUFFER_SIZE];
+  sprintf(buffer, "%u shape(s) outside the viewport were skipped.\n", culled);
+  cli_print_success(buffer);
+  cli_press_any_key();
 }
 
 void cli_main_menu() {
   bool running = true, error = false;
   int d;
   svg_t *svg = NULL;
+  cli_editor_t *editor = NULL;
   cli_output_t output;
 
   while (running) {
     cli_clear_screen();
     if (svg != NULL)
-      cli_print_svg(svg);
+      cli_print_view(editor->view, svg);
     fprintf(stdout, "Choose action to perform :\n");
     if (svg == NULL)
       fprintf(stdout, "- (1) Create\n");
@@ -699,17 +1122,22 @@ void cli_main_menu() {
     else if (svg == NULL && d == 2)
       svg = cli_open_svg();
     else if (d == 3 && svg != NULL)
-      cli_edit_svg(svg);
+      cli_edit_svg(editor, svg);
     else if (d == 4 && svg != NULL)
-      cli_export_svg(svg);
+      cli_export_svg(editor, svg);
     else if (d == 5 && svg != NULL)
-      cli_export_svg_to_html(svg);
+      cli_export_svg_to_html(editor, svg);
     else if (d == 6 && svg != NULL) {
+      free_cli_editor(editor);
+      editor = NULL;
       free_svg(svg);
       svg = NULL;
     } else
       error = true;
+    if (svg != NULL && editor == NULL)
+      editor = new_cli_editor();
   }
+  free_cli_editor(editor);
   if (svg != NULL)
     free_svg(svg);
 }
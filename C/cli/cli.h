@@ -1,8 +1,15 @@
 #ifndef CODA_CLI
 #define CODA_CLI
 
+#include "../geometry/lod.h"
+#include "../geometry/rtree.h"
+#include "../geometry/simplify.h"
+#include "../history/history.h"
 #include "../models/shapes/svg.h"
+#include "../models/utils/affine.h"
+#include "../models/utils/node_index.h"
 #include "../serde/serialize/export.h"
+#include "cli_view.h"
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -15,6 +22,55 @@
  */
 typedef enum cli_output_e { CLI_VALID, CLI_INVALID, CLI_EMPTY } cli_output_t;
 
+/**
+ * Defines the cli editor type, the state kept while an svg is opened.
+ * @param history             the undo and redo history of the svg.
+ * @param view                the paged tree view of the svg.
+ * @param lod_pyramid         the level of detail pyramid of the svg, NULL if
+ * it was not built since the svg was last edited.
+ * @param spatial_index       the spatial index of the svg's shapes, NULL
+ * when the svg is not being edited.
+ * @param shape_nodes         the index of the svg's shape nodes, NULL when
+ * the svg is not being edited.
+ * @param ancestor_transforms the world transformations of the groups
+ * containing the edited shapes, from the outermost to the innermost, used to
+ * locate the shapes in the spatial index.
+ * @param ancestor_depth      the number of groups containing the edited
+ * shapes.
+ * @param ancestor_capacity   the ancestor transformations' capacity.
+ * @see history_t.
+ * @see cli_view_t.
+ * @see rtree_t.
+ * @see node_index_t.
+ */
+typedef struct cli_editor_s {
+  history_t *history;
+  cli_view_t *view;
+  lod_pyramid_t *lod_pyramid;
+  rtree_t *spatial_index;
+  node_index_t *shape_nodes;
+  affine_t *ancestor_transforms;
+  int ancestor_depth;
+  int ancestor_capacity;
+} cli_editor_t;
+
+/**
+ * Creates a new editor for a newly opened svg, with an empty history and a
+ * view of the first page.
+ * Note that this function allocates memory.
+ * @return the new editor's pointer.
+ * @see cli_editor_t.
+ */
+cli_editor_t *new_cli_editor();
+
+/**
+ * Destroys the given editor, its history and its view.
+ * Note that this function frees memory.
+ * @param editor the editor to destroy.
+ * @see cli_editor_t.
+ */
+void free_cli_editor(cli_editor_t *editor);
+
 /**
  * Clears out the terminal.
  */
@@ -66,11 +122,15 @@ void cli_print_points(point_node_t *points);
 void cli_print_path_elements(path_element_node_t *elements);
 
 /**
- * Displays a formatted version of the given shape linked list.
- * @param shapes the shape linked list.
+ * Displays a formatted version of the given shape linked list, one line per
+ * shape. Only the first page of shapes is displayed, followed by the number of
+ * the other shapes.
+ * @param view  the view caching the formatted lines.
+ * @param nodes the index of the shape linked list.
  * @see shape_node_t.
+ * @see node_index_t.
  */
-void cli_print_shapes(shape_node_t *shapes);
+void cli_print_shapes(cli_view_t *view, node_index_t *nodes);
 
 /**
  * Asks the user for an integer.
@@ -171,18 +231,19 @@ cli_output_t cli_ask_for_path_element_index(char *prompt,
  * prompt. The function displays the allowed range using the length of the
  * linked list, the `include_lower` and `include_upper` parameters.
  * @param prompt        the prompt to display.
- * @param shapes        the shape linked list.
+ * @param view          the view caching the formatted lines.
+ * @param nodes         the index of the shape linked list.
  * @param index         a pointer to an integer to set the valid integer
  * submitted by the user.
  * @param include_lower indicates if the user can submit the `0` value.
- * @param include_upper indicates if the user can submit the `length(shapes)`
+ * @param include_upper indicates if the user can submit the `length(nodes)`
  * value.
  * @return the user cli output state.
  * @see cli_output_t.
  */
-cli_output_t cli_ask_for_shape_index(char *prompt, shape_node_t *shapes,
-                                     int *index, bool include_lower,
-                                     bool include_upper);
+cli_output_t cli_ask_for_shape_index(char *prompt, cli_view_t *view,
+                                     node_index_t *nodes, int *index,
+                                     bool include_lower, bool include_upper);
 
 /**
  * Asks the user to select an integer.
@@ -239,10 +300,135 @@ svg_t *cli_open_svg();
 
 /**
  * Asks the user to update the given svg.
- * @param svg the svg to update.
+ * Each edit is recorded in the history so that it can be undone, the svg is
+ * then restored in place.
+ * @param editor the svg's editor.
+ * @param svg    the svg to update.
+ * @see cli_editor_t.
+ * @see svg_t.
+ */
+void cli_edit_svg(cli_editor_t *editor, svg_t *svg);
+
+/**
+ * Ends the recording of an edit of the given svg in its editor's history,
+ * then collapses the groups of its view if the edit changed the svg.
+ * Note that this function allocates and frees memory.
+ * @param editor the svg's editor.
+ * @param svg    the edited svg.
+ * @return returns true if the svg was changed.
+ * @see commit_history.
+ */
+bool cli_commit_edit(cli_editor_t *editor, svg_t *svg);
+
+/**
+ * Updates the spatial index of the given editor after the given history
+ * entry was committed, undone or redone: the shapes held by the entry's
+ * changes are removed and the ones which replaced them are inserted. The
+ * editor's shape node index must be up to date.
+ * Note that this function allocates and frees memory.
+ * @param editor the svg's editor.
+ * @param entry  the history entry.
+ * @see rtree_remove_shape.
+ * @see rtree_insert_shape.
+ */
+void cli_update_spatial_index(cli_editor_t *editor, history_entry_t *entry);
+
+/**
+ * Indexes the shape nodes of the given svg in its editor, replacing the
+ * previous index, and collapses the groups of its view. Called whenever the
+ * svg's shape linked list is replaced.
+ * Note that this function allocates memory.
+ * @param editor the svg's editor.
+ * @param svg    the edited svg.
+ * @see index_shape_nodes.
+ */
+void cli_index_svg(cli_editor_t *editor, svg_t *svg);
+
+/**
+ * Asks the user to select a simplification algorithm.
+ * @param method a pointer to the algorithm to set.
+ * @return the user's input status.
+ * @see simplify_method_t.
+ */
+cli_output_t cli_ask_for_simplify_method(simplify_method_t *method);
+
+/**
+ * Asks the user for a tolerance and an algorithm, then simplifies the given
+ * svg's multilines, polygons and paths in place.
+ * @param svg the svg to simplify.
+ * @return returns true if the svg was simplified.
+ * @see simplify_svg.
+ * @see svg_t.
+ */
+bool cli_simplify_svg(svg_t *svg);
+
+/**
+ * Displays the area, length and centroid of the given svg's shapes.
+ * @param svg the svg to measure.
+ * @see measure_svg.
+ * @see svg_t.
+ */
+void cli_print_svg_metrics(svg_t *svg);
+
+/**
+ * Displays the copies of shapes and groups found in the given svg.
+ * The copies are not shared, since the spatial index and the history tell
+ * the edited shapes apart by address.
+ * Note that this function allocates and frees memory.
+ * @param svg the svg to search.
+ * @see dedupe_svg.
  * @see svg_t.
  */
-void cli_edit_svg(svg_t *svg);
+void cli_find_duplicates(svg_t *svg);
+
+/**
+ * Asks the user for a script file's path then runs the script against the
+ * given svg and displays the number of edited shapes.
+ * Note that this function allocates and frees memory.
+ * @param svg the svg to edit.
+ * @return returns true if a shape was edited or deleted.
+ * @see run_script.
+ * @see script_report_t.
+ * @see svg_t.
+ */
+bool cli_run_script(svg_t *svg);
+
+/**
+ * Asks the user to browse the pages of the given svg's tree view, and to
+ * expand or collapse its groups.
+ * @param editor the svg's editor.
+ * @param svg    the svg.
+ * @see cli_view_t.
+ */
+void cli_browse_svg(cli_editor_t *editor, svg_t *svg);
+
+/**
+ * Retrieves the level of detail pyramid of the edited svg.
+ * The pyramid is created on the first call, its levels being built by the
+ * exports which need them, then kept by the editor until
+ * cli_discard_lod_pyramid is called.
+ * Note that the returned pointer belongs to the editor and must not be freed.
+ * @param editor the svg's editor.
+ * @return the pyramid's pointer.
+ * @see lod_pyramid_t.
+ */
+lod_pyramid_t *cli_get_lod_pyramid(cli_editor_t *editor);
+
+/**
+ * Discards the level of detail pyramid kept by the given editor.
+ * This function must be called each time the svg is edited or closed.
+ * Note that this function frees memory.
+ * @param editor the svg's editor.
+ * @see cli_get_lod_pyramid.
+ */
+void cli_discard_lod_pyramid(cli_editor_t *editor);
+
+/**
+ * Asks the user for an output scale in percent.
+ * @param scale a pointer to the scale to set, between 0 and 1.
+ * @return the user's input status.
+ */
+cli_output_t cli_ask_for_scale(double *scale);
 
 /**
  * Asks the user to create new export configs.
@@ -253,19 +439,27 @@ export_config_t *cli_new_export_config();
 
 /**
  * Asks the user to select a file path to save the given svg.
- * @param svg the svg to save.
+ * @param editor the svg's editor.
+ * @param svg    the svg to save.
  * @see export_config_t.
  * @see serdelizer_t.
  * @see svg_t.
  */
-void cli_export_svg(svg_t *svg);
+void cli_export_svg(cli_editor_t *editor, svg_t *svg);
 
 /**
  * Asks the user to select a file path to export the given svg to html.
- * @param svg the svg to export.
+ * @param editor the svg's editor.
+ * @param svg    the svg to export.
  * @see svg_t.
  */
-void cli_export_svg_to_html(svg_t *svg);
+void cli_export_svg_to_html(cli_editor_t *editor, svg_t *svg);
+
+/**
+ * Displays the number of shapes skipped by an export with viewport culling.
+ * @param culled the number of skipped shapes.
+ */
+void cli_print_culled_shapes(unsigned int culled);
 
 /**
  * Displays the cli main menu and asks the user for actions to perform.
@@ -1,4 +1,9 @@
 #include "cli_shape.h"
+#include "../geometry/bounds.h"
+#include "../geometry/rtree.h"
+#include "../geometry/transform.h"
+#include "../hash/hash.h"
+#include "../history/history.h"
 #include "../models/shapes/ellipse.h"
 #include "../models/shapes/group.h"
 #include "../models/shapes/line.h"
@@ -7,6 +12,8 @@
 #include "../models/shapes/polygon.h"
 #include "../models/shapes/rectangle.h"
 #include "../models/shapes/shape.h"
+#include "../models/shapes/symbol.h"
+#include "../script/query.h"
 #include "../utils/utils.h"
 #include "cli.h"
 #include "cli_path.h"
@@ -15,6 +22,54 @@
 #include <stdlib.h>
 
 #define POINT_BUFFER_SIZE 150
+#define SEARCH_BUFFER_SIZE 200
+#define QUERY_BUFFER_SIZE 300
+#define QUERY_PATH_BUFFER_SIZE 150
+
+void cli_push_ancestor_styles(cli_editor_t *editor, style_t *styles) {
+  if (editor->ancestor_depth == editor->ancestor_capacity) {
+    editor->ancestor_capacity =
+        (editor->ancestor_capacity == 0) ? 8 : editor->ancestor_capacity * 2;
+    editor->ancestor_transforms =
+        realloc(editor->ancestor_transforms,
+                sizeof(affine_t) * editor->ancestor_capacity);
+  }
+  affine_t local = get_style_affine(styles);
+  int depth = editor->ancestor_depth;
+  editor->ancestor_transforms[depth] =
+      (depth == 0) ? local
+                   : multiply_affine(&editor->ancestor_transforms[depth - 1],
+                                     &local);
+  editor->ancestor_depth++;
+}
+
+void cli_pop_ancestor_styles(cli_editor_t *editor) {
+  if (editor->ancestor_depth > 0)
+    editor->ancestor_depth--;
+  if (editor->ancestor_depth == 0) {
+    free(editor->ancestor_transforms);
+    editor->ancestor_transforms = NULL;
+    editor->ancestor_capacity = 0;
+  }
+}
+
+affine_t *cli_get_parent_transform(cli_editor_t *editor) {
+  if (editor->ancestor_depth == 0)
+    return NULL;
+  return &editor->ancestor_transforms[editor->ancestor_depth - 1];
+}
+
+shape_t *cli_unshare_shape(cli_editor_t *editor, shape_t **shape) {
+  // A shape shared with the history or an export is copied before the edit,
+  // the spatial index must then refer to the copy.
+  shape_t *shared = *shape;
+  if (unshare_shape(shape) != shared && editor->spatial_index != NULL) {
+    rtree_remove_shape(editor->spatial_index, shared);
+    rtree_insert_shape(editor->spatial_index, *shape,
+                       cli_get_parent_transform(editor));
+  }
+  return *shape;
+}
 
 void cli_print_ellipse(ellipse_t *ellipse, style_t *styles, int depth) {
   cli_print_spaces(depth);
@@ -120,6 +175,13 @@ void cli_print_group(group_t *group, style_t *styles, int depth) {
   cli_print_content("</group>\n");
 }
 
+void cli_print_instance(symbol_t *symbol, style_t *styles, int depth) {
+  cli_print_spaces(depth);
+  fprintf(stdout, "<use symbol=\"%s\" ", symbol->id);
+  cli_display_style(styles);
+  cli_print_content("/>\n");
+}
+
 void cli_print_shape(shape_t *shape, int depth) {
   switch (shape->shape_variant) {
   case ELLIPSE:
@@ -141,7 +203,10 @@ void cli_print_shape(shape_t *shape, int depth) {
     cli_print_path(shape->shape->path, shape->styles, depth);
     break;
   case GROUP:
-    cli_print_group(shape->shape->group, shape->styles, depth);
+    if (is_instance(shape))
+      cli_print_instance(shape->symbol, shape->styles, depth);
+    else
+      cli_print_group(shape->shape->group, shape->styles, depth);
     break;
   }
 }
@@ -258,8 +323,8 @@ void cli_edit_point(point_t *point) {
     point->y = n;
 }
 
-void cli_add_point(point_node_t **points) {
-  int length = get_point_node_length(*points), index;
+void cli_add_point(point_node_t **points, node_index_t *nodes) {
+  int length = get_node_index_length(nodes), index;
   if (cli_ask_for_point_index("Select the index for the new point.\n", *points,
                               &index, true, true) != CLI_VALID)
     return;
@@ -268,34 +333,25 @@ void cli_add_point(point_node_t **points) {
   if (index < 0 || index > length) {
     free_point(point);
     return;
-  } else if (index == length)
-    *points = push_point_node(*points, point);
-  else
-    *points = insert_point_node_at(*points, index, point);
+  }
+  *points = insert_indexed_point_node(*points, nodes, index, point);
 }
 
-void cli_remove_point(point_node_t **points) {
+void cli_remove_point(point_node_t **points, node_index_t *nodes) {
   int index;
   if (cli_ask_for_point_index("Select the point's index to remove.\n", *points,
                               &index, true, false) != CLI_VALID)
     return;
-  *points = remove_point_node_at(*points, index);
+  *points = remove_indexed_point_node(*points, nodes, index);
 }
 
-void cli_edit_points(point_node_t *points) {
+void cli_edit_points(point_node_t *points, node_index_t *nodes) {
   int index;
   if (cli_ask_for_point_index("Select the point's index to edit.\n", points,
                               &index, true, false) != CLI_VALID)
     return;
-  int i = 0;
-  point_node_t *point = points;
-  while (point != NULL) {
-    if (i == index)
-      break;
-    point = point->next;
-    i++;
-  }
-  if (i != index || point == NULL)
+  point_node_t *point = get_indexed_point_node(nodes, index);
+  if (point == NULL)
     return;
   cli_edit_point(point->point);
 }
@@ -304,6 +360,8 @@ void cli_edit_multiline(multiline_t **multiline, style_t *styles) {
   bool error = false;
   int opt;
   cli_output_t output;
+  // The index follows the points' edits until the multiline is left.
+  node_index_t *nodes = index_point_nodes(*multiline);
   while (true) {
     cli_clear_screen();
     cli_print_multiline(*multiline, styles, 0);
@@ -314,23 +372,25 @@ void cli_edit_multiline(multiline_t **multiline, style_t *styles) {
     if (error)
       cli_print_error("Enter a valid option.\n");
     output = cli_ask_for_int(&opt);
-    if (output == CLI_EMPTY)
+    if (output == CLI_EMPTY) {
+      free_node_index(nodes);
       return;
+    }
     if (output == CLI_INVALID) {
       error = true;
       continue;
     }
     switch (opt) {
     case 1:
-      cli_add_point(multiline);
+      cli_add_point(multiline, nodes);
       error = false;
       break;
     case 2:
-      cli_edit_points(*multiline);
+      cli_edit_points(*multiline, nodes);
       error = false;
       break;
     case 3:
-      cli_remove_point(multiline);
+      cli_remove_point(multiline, nodes);
       error = false;
       break;
     default:
@@ -344,6 +404,7 @@ void cli_edit_polygon(polygon_t **polygon, style_t *styles) {
   bool error = false;
   int opt;
   cli_output_t output;
+  node_index_t *nodes = index_point_nodes(*polygon);
   while (true) {
     cli_clear_screen();
     cli_print_polygon(*polygon, styles, 0);
@@ -354,21 +415,23 @@ void cli_edit_polygon(polygon_t **polygon, style_t *styles) {
     if (error)
       cli_print_error("Enter a valid option.\n");
     output = cli_ask_for_int(&opt);
-    if (output == CLI_EMPTY)
+    if (output == CLI_EMPTY) {
+      free_node_index(nodes);
       return;
+    }
     if (output == CLI_INVALID) {
       error = true;
       continue;
     }
     switch (opt) {
     case 1:
-      cli_add_point(polygon);
+      cli_add_point(polygon, nodes);
       break;
     case 2:
-      cli_edit_points(*polygon);
+      cli_edit_points(*polygon, nodes);
       break;
     case 3:
-      cli_remove_point(polygon);
+      cli_remove_point(polygon, nodes);
       break;
     default:
       error = true;
@@ -377,8 +440,9 @@ void cli_edit_polygon(polygon_t **polygon, style_t *styles) {
   }
 }
 
-void cli_add_path_element(path_element_node_t **elements) {
-  int length = get_path_element_node_length(*elements), index;
+void cli_add_path_element(path_element_node_t **elements,
+                          node_index_t *nodes) {
+  int length = get_node_index_length(nodes), index;
   if (cli_ask_for_path_element_index(
           "Select the index for the new path element.\n", *elements, &index,
           true, true) != CLI_VALID)
@@ -390,35 +454,31 @@ void cli_add_path_element(path_element_node_t **elements) {
   if (index < 0 || index > length) {
     free_path_element(element);
     return;
-  } else if (index == length)
-    *elements = push_path_element_node(*elements, element);
-  else {
-    *elements = insert_path_element_node_at(*elements, index, element);
   }
+  *elements =
+      insert_indexed_path_element_node(*elements, nodes, index, element);
 }
 
-void cli_remove_path_element(path_element_node_t **elements) {
+void cli_remove_path_element(path_element_node_t **elements,
+                             node_index_t *nodes) {
   cli_clear_screen();
   int index;
   if (cli_ask_for_path_element_index(
           "Select the path element's index to delete.\n", *elements, &index,
           true, false) != CLI_VALID)
     return;
-  *elements = remove_path_element_node_at(*elements, index);
+  *elements = remove_indexed_path_element_node(*elements, nodes, index);
 }
 
-void cli_edit_path_elements(path_element_node_t *elements) {
-  int index, i = 0;
+void cli_edit_path_elements(path_element_node_t *elements,
+                            node_index_t *nodes) {
+  int index;
   if (cli_ask_for_path_element_index(
           "Select the path element's index to edit.\n", elements, &index, true,
           false) != CLI_VALID)
     return;
-  path_element_node_t *element = elements;
-  while (element != NULL && i < index) {
-    element = element->next;
-    i++;
-  }
-  if (i != index || element == NULL)
+  path_element_node_t *element = get_indexed_path_element_node(nodes, index);
+  if (element == NULL)
     return;
   cli_edit_path_element(element->element);
 }
@@ -427,6 +487,7 @@ void cli_edit_path(path_t **path, style_t *styles) {
   bool error = false;
   int d;
   cli_output_t output;
+  node_index_t *nodes = index_path_element_nodes(*path);
   while (true) {
     cli_clear_screen();
     cli_print_path(*path, styles, 0);
@@ -437,8 +498,10 @@ void cli_edit_path(path_t **path, style_t *styles) {
     if (error)
       cli_print_error("Enter a valid option.\n");
     output = cli_ask_for_int(&d);
-    if (output == CLI_EMPTY)
+    if (output == CLI_EMPTY) {
+      free_node_index(nodes);
       return;
+    }
     if (output == CLI_INVALID) {
       error = true;
       continue;
@@ -446,13 +509,13 @@ void cli_edit_path(path_t **path, style_t *styles) {
 
     switch (d) {
     case 1:
-      cli_add_path_element(path);
+      cli_add_path_element(path, nodes);
       break;
     case 2:
-      cli_edit_path_elements(*path);
+      cli_edit_path_elements(*path, nodes);
       break;
     case 3:
-      cli_remove_path_element(path);
+      cli_remove_path_element(path, nodes);
       break;
     default:
       error = true;
@@ -461,53 +524,63 @@ void cli_edit_path(path_t **path, style_t *styles) {
   }
 }
 
-void cli_add_shape(shape_node_t **shapes, style_t *inherited_styles) {
-  int length = get_shape_node_length(*shapes), index;
-  if (cli_ask_for_shape_index("Select the index for the new shape.\n", *shapes,
-                              &index, true, true) != CLI_VALID)
+void cli_add_shape(cli_editor_t *editor, shape_node_t **shapes,
+                   node_index_t *nodes, style_t *inherited_styles) {
+  int length = get_node_index_length(nodes), index;
+  if (cli_ask_for_shape_index("Select the index for the new shape.\n",
+                              editor->view, nodes, &index, true,
+                              true) != CLI_VALID)
     return;
 
-  shape_t *shape = cli_new_shape(inherited_styles);
+  shape_t *shape = cli_new_shape(editor, inherited_styles);
   if (shape == NULL)
     return;
 
   if (index < 0 || index > length) {
     free_shape(shape);
     return;
-  } else if (index == length)
-    *shapes = push_shape_node(*shapes, shape);
-  else
-    *shapes = insert_shape_node_at(*shapes, index, shape);
+  }
+  *shapes = insert_indexed_shape_node(*shapes, nodes, index, shape);
+
+  if (editor->spatial_index != NULL)
+    rtree_insert_shape(editor->spatial_index, shape,
+                       cli_get_parent_transform(editor));
 }
 
-void cli_remove_shape(shape_node_t **shapes) {
+void cli_remove_shape(cli_editor_t *editor, shape_node_t **shapes,
+                      node_index_t *nodes) {
   int index;
-  if (cli_ask_for_shape_index("Select the shapes's index to delete.\n", *shapes,
-                              &index, true, false) != CLI_VALID)
+  if (cli_ask_for_shape_index("Select the shapes's index to delete.\n",
+                              editor->view, nodes, &index, true,
+                              false) != CLI_VALID)
     return;
-  *shapes = remove_shape_node_at(*shapes, index);
+
+  shape_node_t *node = get_indexed_shape_node(nodes, index);
+  if (node != NULL && editor->spatial_index != NULL)
+    rtree_remove_shape(editor->spatial_index, node->shape);
+  *shapes = remove_indexed_shape_node(*shapes, nodes, index);
 }
 
-void cli_edit_shapes(shape_node_t *shapes) {
+void cli_edit_shapes(cli_editor_t *editor, node_index_t *nodes) {
   int index;
-  if (cli_ask_for_shape_index("Select the shape's index to edit.\n", shapes,
-                              &index, true, false) != CLI_VALID)
+  if (cli_ask_for_shape_index("Select the shape's index to edit.\n",
+                              editor->view, nodes, &index, true,
+                              false) != CLI_VALID)
     return;
-  int i = 0;
-  shape_node_t *shape = shapes;
-  while (shape != NULL && i < index) {
-    shape = shape->next;
-    i++;
-  }
-  if (i != index || shape == NULL)
+  shape_node_t *shape = get_indexed_shape_node(nodes, index);
+  if (shape == NULL)
     return;
-  cli_edit_shape(shape->shape);
+
+  cli_edit_shape(editor, cli_unshare_shape(editor, &shape->shape));
 }
 
-void cli_edit_group(group_t **group, style_t *inherited_styles) {
+void cli_edit_group(cli_editor_t *editor, group_t **group,
+                    style_t *inherited_styles) {
   bool error = false;
   cli_output_t output;
   int d;
+  node_index_t *nodes = index_shape_nodes(*group);
+  cli_push_ancestor_styles(editor, inherited_styles);
   while (true) {
     cli_clear_screen();
     cli_print_group(*group, inherited_styles, 0);
@@ -519,8 +592,11 @@ void cli_edit_group(group_t **group, style_t *inherited_styles) {
       cli_print_error("Enter a valid option.\n");
 
     output = cli_ask_for_int(&d);
-    if (output == CLI_EMPTY)
+    if (output == CLI_EMPTY) {
+      cli_pop_ancestor_styles(editor);
+      free_node_index(nodes);
       return;
+    }
     if (output == CLI_INVALID) {
       error = true;
       continue;
@@ -528,13 +604,13 @@ void cli_edit_group(group_t **group, style_t *inherited_styles) {
 
     switch (d) {
     case 1:
-      cli_add_shape(group, inherited_styles);
+      cli_add_shape(editor, group, nodes, inherited_styles);
       break;
     case 2:
-      cli_edit_shapes(*group);
+      cli_edit_shapes(editor, nodes);
       break;
     case 3:
-      cli_remove_shape(group);
+      cli_remove_shape(editor, group, nodes);
       break;
     default:
       error = true;
@@ -543,7 +619,7 @@ void cli_edit_group(group_t **group, style_t *inherited_styles) {
   }
 }
 
-void cli_edit_shape(shape_t *shape) {
+void cli_edit_shape(cli_editor_t *editor, shape_t *shape) {
   bool error = false;
   cli_output_t output;
   int d;
@@ -552,7 +628,9 @@ void cli_edit_shape(shape_t *shape) {
     cli_print_shape(shape, 0);
     cli_print_content("Select action to perform :\n");
     cli_print_content("- Edit styles (1)\n");
-    cli_print_content("- Edit shape (2)\n");
+    // The content of an instance belongs to its symbol.
+    if (!is_instance(shape))
+      cli_print_content("- Edit shape (2)\n");
     if (error)
       cli_print_error("Enter a valid option.\n");
 
@@ -566,7 +644,7 @@ void cli_edit_shape(shape_t *shape) {
 
     switch (d) {
     case 1:
-      cli_edit_style(shape->styles);
+      cli_edit_style(unshare_style(&shape->styles));
       break;
     case 2:
       switch (shape->shape_variant) {
@@ -589,7 +667,11 @@ void cli_edit_shape(shape_t *shape) {
         cli_edit_path(&shape->shape->path, shape->styles);
         break;
       case GROUP:
-        cli_edit_group(&shape->shape->group, shape->styles);
+        if (is_instance(shape)) {
+          error = true;
+          break;
+        }
+        cli_edit_group(editor, &shape->shape->group, shape->styles);
         break;
       default:
         error = true;
@@ -600,10 +682,173 @@ void cli_edit_shape(shape_t *shape) {
       error = true;
       break;
     }
+    // The shape's geometry or styles may have changed.
+    if (editor->spatial_index != NULL)
+      rtree_remove_shape(editor->spatial_index, shape);
+    invalidate_shape_bbox(shape);
+    invalidate_shape_transform(shape);
+    invalidate_shape_hash(shape);
+    if (editor->spatial_index != NULL)
+      rtree_insert_shape(editor->spatial_index, shape,
+                         cli_get_parent_transform(editor));
+  }
+}
+
+void cli_search_shapes(cli_editor_t *editor) {
+  int coordinates[4];
+  char *prompts[4] = {"Select the area's minimum X coordinate.\n",
+                      "Select the area's minimum Y coordinate.\n",
+                      "Select the area's maximum X coordinate.\n",
+                      "Select the area's maximum Y coordinate.\n"};
+  if (editor->spatial_index == NULL)
+    return;
+  for (int i = 0; i < 4; i++)
+    if (cli_ask_for_int_parameter("Search shapes in area", prompts[i],
+                                  "Enter a valid interger\n", NULL, true,
+                                  &coordinates[i]) != CLI_VALID)
+      return;
+
+  bbox_t *range = new_bbox(coordinates[0], coordinates[1], coordinates[2],
+                           coordinates[3]);
+  rtree_results_t *results = rtree_search(editor->spatial_index, range);
+  char buffer[SEARCH_BUFFER_SIZE];
+  cli_clear_screen();
+  sprintf(buffer, "%d shape(s) found in area (%d, %d) (%d, %d).\n\n",
+          results->count, coordinates[0], coordinates[1], coordinates[2],
+          coordinates[3]);
+  cli_print_content(buffer);
+  for (int i = 0; i < results->count; i++)
+    cli_print_shape(results->shapes[i], 0);
+  cli_print_content("\n");
+  free_rtree_results(results);
+  free_bbox(range);
+  cli_press_any_key();
+}
+
+void cli_edit_shape_at(cli_editor_t *editor, node_index_t *nodes, int *path,
+                       int depth) {
+  // Only the levels walked are read, zeroed for the optimised builds.
+  shape_t **ancestors = calloc(depth, sizeof(shape_t *));
+  shape_node_t *node, *shapes = NULL;
+  int level = 0;
+  for (; level < depth; level++) {
+    // The groups' children are not indexed, they are walked.
+    if (level == 0)
+      node = get_indexed_shape_node(nodes, path[0]);
+    else {
+      node = shapes;
+      for (int i = 0; node != NULL && i < path[level]; i++)
+        node = node->next;
+    }
+    if (node == NULL ||
+        (level < depth - 1 && node->shape->shape_variant != GROUP))
+      break;
+
+    // As when drilling down, each shape on the way is copied if it is shared.
+    ancestors[level] = cli_unshare_shape(editor, &node->shape);
+    if (level < depth - 1) {
+      cli_push_ancestor_styles(editor, node->shape->styles);
+      shapes = node->shape->shape->group;
+    }
+  }
+  if (level == depth)
+    cli_edit_shape(editor, ancestors[depth - 1]);
+
+  // The groups holding the edited shape may have other bounds and content.
+  for (int i = ((level < depth) ? level : depth - 1) - 1; i >= 0; i--) {
+    invalidate_shape_bbox(ancestors[i]);
+    invalidate_shape_hash(ancestors[i]);
+    cli_pop_ancestor_styles(editor);
+  }
+  free(ancestors);
+}
+
+void cli_query_shapes(cli_editor_t *editor, shape_node_t *shapes) {
+  char buffer[QUERY_BUFFER_SIZE], path[QUERY_PATH_BUFFER_SIZE];
+  size_t size;
+  bool error = false;
+  query_t query;
+  cli_output_t output;
+  while (true) {
+    cli_clear_screen();
+    cli_print_content("Select the query, e.g. type=ellipse and fill=#ff0000ff "
+                      "and bbox within (0,0,100,100).\n");
+    if (error)
+      cli_print_error("Enter a valid query.\n");
+    output = cli_ask_for_string(buffer, &size, QUERY_BUFFER_SIZE - 1);
+    if (output == CLI_EMPTY)
+      return;
+    if (output == CLI_VALID && parse_query(buffer, &query))
+      break;
+    error = true;
+  }
+
+  query_results_t *results =
+      query_shapes(shapes, &query, editor->spatial_index);
+  int index;
+  error = false;
+  while (true) {
+    cli_clear_screen();
+    sprintf(buffer, "%d shape(s) found, %u tested.\n\n", results->count,
+            results->tested);
+    cli_print_content(buffer);
+    for (int i = 0; i < results->count; i++) {
+      format_query_path(&results->matches[i], path, QUERY_PATH_BUFFER_SIZE);
+      sprintf(buffer, "(%d) %s %s\n", i, path,
+              get_shape_name(results->matches[i].shape));
+      cli_print_content(buffer);
+    }
+    if (results->count == 0) {
+      free_query_results(results);
+      cli_press_any_key();
+      return;
+    }
+    cli_print_content("\nSelect the shape's index to edit.\n");
+    if (error)
+      cli_print_error("Select a valid index.\n");
+    output = cli_ask_for_index(0, results->count - 1, &index);
+    if (output == CLI_EMPTY) {
+      free_query_results(results);
+      return;
+    }
+    if (output == CLI_VALID)
+      break;
+    error = true;
+  }
+  cli_edit_shape_at(editor, editor->shape_nodes, results->matches[index].path,
+                    results->matches[index].depth);
+  free_query_results(results);
+}
+
+void cli_find_nearest_shape(cli_editor_t *editor) {
+  int x, y;
+  if (editor->spatial_index == NULL)
+    return;
+  if (cli_ask_for_int_parameter("Find nearest shape",
+                                "Select the point's X coordinate.\n",
+                                "Enter a valid interger\n", NULL, true,
+                                &x) != CLI_VALID ||
+      cli_ask_for_int_parameter("Find nearest shape",
+                                "Select the point's Y coordinate.\n",
+                                "Enter a valid interger\n", NULL, true,
+                                &y) != CLI_VALID)
+    return;
+
+  shape_t *shape = rtree_nearest(editor->spatial_index, x, y);
+  char buffer[SEARCH_BUFFER_SIZE];
+  cli_clear_screen();
+  if (shape == NULL) {
+    cli_print_error("No shape found.\n");
+  } else {
+    sprintf(buffer, "Nearest shape to (%d, %d) :\n\n", x, y);
+    cli_print_content(buffer);
+    cli_print_shape(shape, 0);
+    cli_print_content("\n");
   }
+  cli_press_any_key();
 }
 
-shape_t *cli_new_shape(style_t *inherited_styles) {
+shape_t *cli_new_shape(cli_editor_t *editor, style_t *inherited_styles) {
   bool error = false;
   int d;
   shape_t *shape = NULL;
@@ -632,38 +877,38 @@ shape_t *cli_new_shape(style_t *inherited_styles) {
     switch (d) {
     case 1:
       shape = new_ellipse(0, 0, 10, 10, clone_style(inherited_styles));
-      cli_edit_shape(shape);
+      cli_edit_shape(editor, shape);
       return shape;
       break;
     case 2:
       shape = new_rectangle(0, 0, 10, 10, clone_style(inherited_styles));
-      cli_edit_shape(shape);
+      cli_edit_shape(editor, shape);
       return shape;
       break;
     case 3:
       shape = new_line(new_point(0, 0), new_point(10, 10),
                        clone_style(inherited_styles));
-      cli_edit_shape(shape);
+      cli_edit_shape(editor, shape);
       return shape;
       break;
     case 4:
       shape = new_multiline(NULL, clone_style(inherited_styles));
-      cli_edit_shape(shape);
+      cli_edit_shape(editor, shape);
       return shape;
       break;
     case 5:
       shape = new_polygon(NULL, clone_style(inherited_styles));
-      cli_edit_shape(shape);
+      cli_edit_shape(editor, shape);
       return shape;
       break;
     case 6:
       shape = new_path(NULL, clone_style(inherited_styles));
-      cli_edit_shape(shape);
+      cli_edit_shape(editor, shape);
       return shape;
       break;
     case 7:
       shape = new_group(NULL, clone_style(inherited_styles));
-      cli_edit_shape(shape);
+      cli_edit_shape(editor, shape);
       return shape;
       break;
     default:
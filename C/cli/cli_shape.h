@@ -2,6 +2,8 @@
 #define CODA_CLI_SHAPE
 
 #include "../models/shapes/shape.h"
+#include "../models/utils/affine.h"
+#include "cli.h"
 #include "cli_path.h"
 
 /**
@@ -88,6 +90,18 @@ void cli_print_path(path_t *path, style_t *styles, int depth);
  */
 void cli_print_group(group_t *group, style_t *styles, int depth);
 
+/**
+ * Displays a formatted version of the given instance's symbol and styles.
+ * This function displays in xml format.
+ * @param symbol the instantiated symbol.
+ * @param styles the styles to display.
+ * @param depth the number of tabs to print before displaying the other
+ * elements.
+ * @see symbol_t.
+ * @see style_t.
+ */
+void cli_print_instance(symbol_t *symbol, style_t *styles, int depth);
+
 /**
  * Displays a formatted version of the given shape and the given styles.
  * This function displays in xml format.
@@ -134,24 +148,30 @@ void cli_edit_point(point_t *point);
  * Asks the user to add a point to the given point linked list.
  * Note that this function allocates memory.
  * @param points the point linked list.
+ * @param nodes  the index of the point linked list, updated.
  * @see point_node_t.
+ * @see node_index_t.
  */
-void cli_add_point(point_node_t **points);
+void cli_add_point(point_node_t **points, node_index_t *nodes);
 
 /**
  * Asks the user to remove a point to the given point linked list.
  * Note that this function frees memory.
  * @param points the point linked list.
+ * @param nodes  the index of the point linked list, updated.
  * @see point_node_t.
+ * @see node_index_t.
  */
-void cli_remove_point(point_node_t **points);
+void cli_remove_point(point_node_t **points, node_index_t *nodes);
 
 /**
  * Asks the user to edit a point to the given point linked list.
  * @param points the point linked list.
+ * @param nodes  the index of the point linked list.
  * @see point_node_t.
+ * @see node_index_t.
  */
-void cli_edit_points(point_node_t *points);
+void cli_edit_points(point_node_t *points, node_index_t *nodes);
 
 /**
  * Asks the user to update the given multiline.
@@ -175,25 +195,31 @@ void cli_edit_polygon(polygon_t **polygon, style_t *styles);
  * Asks the user to add a path element in given path element linked list.
  * Note that this function allocates memory.
  * @param elements the path element linked list.
+ * @param nodes    the index of the path element linked list, updated.
  * @see path_element_t.
  * @see path_element_node_t.
  */
-void cli_add_path_element(path_element_node_t **elements);
+void cli_add_path_element(path_element_node_t **elements,
+                          node_index_t *nodes);
 
 /**
  * Asks the user to remove a path element in given path element linked list.
  * Note that this function frees memory.
  * @param elements the path element linked list.
+ * @param nodes    the index of the path element linked list, updated.
  */
-void cli_remove_path_element(path_element_node_t **elements);
+void cli_remove_path_element(path_element_node_t **elements,
+                             node_index_t *nodes);
 
 /**
  * Asks the user to edit a path element in given path element linked list.
  * @param elements the path element linked list.
+ * @param nodes    the index of the path element linked list.
  * @see path_element_t.
  * @see path_element_node_t.
  */
-void cli_edit_path_elements(path_element_node_t *elements);
+void cli_edit_path_elements(path_element_node_t *elements,
+                            node_index_t *nodes);
 
 /**
  * Asks the user to update the given path.
@@ -207,55 +233,146 @@ void cli_edit_path(path_t **path, style_t *styles);
 /**
  * Asks the user to add a new shape in the given shape linked list.
  * Note that this function allocates memory.
+ * @param editor the editor.
  * @param shapes the shape linked list.
+ * @param nodes  the index of the shape linked list, updated.
  * @param inherited_styles the new shape inherited styles.
  * @see style_t.
  * @see shape_t.
  * @see shape_node_t.
  */
-void cli_add_shape(shape_node_t **shapes, style_t *inherited_styles);
+void cli_add_shape(cli_editor_t *editor, shape_node_t **shapes,
+                   node_index_t *nodes, style_t *inherited_styles);
 
 /**
  * Asks the user to update a shape in the given shape linked list.
- * @param shapes the shape linked list.
+ * @param editor the editor.
+ * @param nodes  the index of the shape linked list.
  * @see shape_node_t.
+ * @see node_index_t.
  */
-void cli_edit_shapes(shape_node_t *shapes);
+void cli_edit_shapes(cli_editor_t *editor, node_index_t *nodes);
 
 /**
  * Asks the user to remove a new shape in the given shape linked list.
  * Note that this function frees memory.
+ * @param editor the editor.
  * @param shapes the shape linked list.
+ * @param nodes  the index of the shape linked list, updated.
  * @see shape_t.
  * @see shape_node_t.
  */
-void cli_remove_shape(shape_node_t **shapes);
+void cli_remove_shape(cli_editor_t *editor, shape_node_t **shapes,
+                      node_index_t *nodes);
 
 /**
  * Asks the user to update the given group.
+ * @param editor the editor.
  * @param group the group to update.
  * @param inherited_styles the group's styles.
  * @see style_t.
  * @see group_t.
  */
-void cli_edit_group(group_t **group, style_t *inherited_styles);
+void cli_edit_group(cli_editor_t *editor, group_t **group,
+                    style_t *inherited_styles);
 
 /**
  * Asks the user to update the given shape.
+ * @param editor the editor.
  * @param shape the shape to update.
  * @see shape_t.
  */
-void cli_edit_shape(shape_t *shape);
+void cli_edit_shape(cli_editor_t *editor, shape_t *shape);
 
 /**
  * Asks the user to create a new shape.
  * If the user submit an empty answer this function returns NULL.
  * Note that this function allocates memory.
+ * @param editor the editor.
  * @param inherited_styles the new shape's inheroted styles.
  * @return the new shape's pointer.
  * @see style_t.
  * @see shape_t.
  */
-shape_t *cli_new_shape(style_t *inherited_styles);
+shape_t *cli_new_shape(cli_editor_t *editor, style_t *inherited_styles);
+
+/**
+ * Records the world transformation of the group being edited, so that its
+ * shapes can be located in the spatial index.
+ * Note that this function may allocate memory.
+ * @param editor the editor.
+ * @param styles the group's styles.
+ * @see cli_editor_t.
+ */
+void cli_push_ancestor_styles(cli_editor_t *editor, style_t *styles);
+
+/**
+ * Forgets the world transformation of the group which is no longer edited.
+ * Note that this function may free memory.
+ * @param editor the editor.
+ * @see cli_editor_t.
+ */
+void cli_pop_ancestor_styles(cli_editor_t *editor);
+
+/**
+ * Retrieves the world transformation of the group being edited.
+ * @param editor the editor.
+ * @return the transformation's pointer, NULL for the svg's shapes.
+ * @see cli_push_ancestor_styles.
+ */
+affine_t *cli_get_parent_transform(cli_editor_t *editor);
+
+/**
+ * Copies the given shape if it is shared, e.g. with the history, replacing
+ * the shared shape by the copy in the spatial index.
+ * Note that this function may allocate memory.
+ * @param editor the editor.
+ * @param shape  a pointer to the shape, replaced by its copy.
+ * @return the unshared shape's pointer.
+ * @see unshare_shape.
+ */
+shape_t *cli_unshare_shape(cli_editor_t *editor, shape_t **shape);
+
+/**
+ * Asks the user for an area then displays the shapes whose bounding box
+ * intersects it, using the spatial index.
+ * @param editor the editor.
+ * @see cli_editor_t.
+ */
+void cli_search_shapes(cli_editor_t *editor);
+
+/**
+ * Asks the user to update the shape at the given path, the groups on the way
+ * being unshared and their bounding boxes invalidated as when the user drills
+ * down to the shape.
+ * Note that this function may allocate and free memory.
+ * @param editor the editor.
+ * @param nodes  the index of the svg's shape nodes.
+ * @param path   the shape's indexes from the svg down to the shape.
+ * @param depth  the path's length.
+ * @see cli_edit_shape.
+ * @see query_match_t.
+ */
+void cli_edit_shape_at(cli_editor_t *editor, node_index_t *nodes, int *path,
+                       int depth);
+
+/**
+ * Asks the user for a query then displays the matching shapes and asks the
+ * user to update one of them, using the spatial index.
+ * Note that this function allocates and frees memory.
+ * @param editor the editor.
+ * @param shapes the svg's shapes.
+ * @see parse_query.
+ * @see cli_edit_shape_at.
+ */
+void cli_query_shapes(cli_editor_t *editor, shape_node_t *shapes);
+
+/**
+ * Asks the user for a point then displays the shape whose bounding box is the
+ * nearest to it, using the spatial index.
+ * @param editor the editor.
+ * @see cli_editor_t.
+ */
+void cli_find_nearest_shape(cli_editor_t *editor);
 
 #endif
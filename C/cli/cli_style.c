@@ -10,12 +10,12 @@
 
 void cli_display_style(style_t *styles) {
   fprintf(stdout, "fill=\"");
-  fprintf(stdout, "#%02x%02x%02x%02x\" ", styles->fill->blue,
-          styles->fill->green, styles->fill->red, styles->fill->transparent);
+  fprintf(stdout, "#%02x%02x%02x%02x\" ", styles->fill->red,
+          styles->fill->green, styles->fill->blue, styles->fill->transparent);
 
   fprintf(stdout, "outline=\"");
-  fprintf(stdout, "#%02x%02x%02x%02x\" ", styles->outline->blue,
-          styles->outline->green, styles->outline->red,
+  fprintf(stdout, "#%02x%02x%02x%02x\" ", styles->outline->red,
+          styles->outline->green, styles->outline->blue,
           styles->outline->transparent);
 
   fprintf(stdout, "translate=\"%d %d\" ", styles->translate->x,
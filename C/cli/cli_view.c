@@ -0,0 +1,223 @@
+#include "cli_view.h"
+#include "../hash/hash.h"
+#include "../models/shapes/path/path.h"
+#include "../models/shapes/symbol.h"
+#include "cli.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CLI_VIEW_EXPANDED_CAPACITY 8
+#define CLI_VIEW_ELLIPSIS "..."
+
+cli_view_t *new_cli_view() {
+  cli_view_t *view = malloc(sizeof(cli_view_t));
+  view->first = 0;
+  view->rows = 0;
+  view->visible_count = 0;
+  view->expanded = NULL;
+  view->expanded_count = 0;
+  view->expanded_capacity = 0;
+  for (int i = 0; i < CLI_VIEW_CACHE_SIZE; i++)
+    view->lines[i].shape = NULL;
+  return view;
+}
+
+void free_cli_view(cli_view_t *view) {
+  if (view == NULL)
+    return;
+  free(view->expanded);
+  free(view);
+}
+
+size_t append_cli_view_text(char *buffer, size_t size, size_t length,
+                            const char *format, ...) {
+  if (length >= size - 1)
+    return size - 1;
+  va_list arguments;
+  va_start(arguments, format);
+  int written = vsnprintf(buffer + length, size - length, format, arguments);
+  va_end(arguments);
+  if (written < 0)
+    return length;
+  return (length + written < size - 1) ? length + written : size - 1;
+}
+
+size_t append_cli_view_style(char *buffer, size_t size, size_t length,
+                             style_t *styles) {
+  color_t *fill = styles->fill, *outline = styles->outline;
+  length = append_cli_view_text(
+      buffer, size, length,
+      "fill=\"#%02x%02x%02x%02x\" outline=\"#%02x%02x%02x%02x\" "
+      "translate=\"%d %d\" ",
+      fill->red, fill->green, fill->blue, fill->transparent, outline->red,
+      outline->green, outline->blue, outline->transparent,
+      styles->translate->x, styles->translate->y);
+  switch (styles->rotate->variant) {
+  case FLIP_X:
+    return append_cli_view_text(buffer, size, length, "rotate=\"X\" ");
+  case FLIP_Y:
+    return append_cli_view_text(buffer, size, length, "rotate=\"Y\" ");
+  case CIRCULAR:
+    return append_cli_view_text(buffer, size, length, "rotate=\"%d\" ",
+                                styles->rotate->rotation.circular);
+  }
+  return length;
+}
+
+void format_cli_view_line(shape_t *shape, char *buffer, size_t size) {
+  size_t length = 0;
+  point_node_t *point = NULL;
+  shape_union_t *content = shape->shape;
+  switch (shape->shape_variant) {
+  case ELLIPSE:
+    length = append_cli_view_text(
+        buffer, size, length,
+        "<ellipse x=\"%d\" y=\"%d\" width=\"%d\" height=\"%d\" ",
+        content->ellipse->center_x, content->ellipse->center_y,
+        content->ellipse->radius_x, content->ellipse->radius_y);
+    break;
+  case RECTANGLE:
+    length = append_cli_view_text(
+        buffer, size, length,
+        "<rectangle x=\"%d\" y=\"%d\" width=\"%d\" height=\"%d\" ",
+        content->rectangle->x, content->rectangle->y,
+        content->rectangle->width, content->rectangle->height);
+    break;
+  case LINE:
+    length = append_cli_view_text(
+        buffer, size, length, "<line start=\"%d %d\" end=\"%d %d\" ",
+        content->line->start->x, content->line->start->y,
+        content->line->end->x, content->line->end->y);
+    break;
+  case MULTILINE:
+  case POLYGON:
+    point = (shape->shape_variant == MULTILINE) ? content->multiline
+                                                : content->polygon;
+    length = append_cli_view_text(buffer, size, length, "<%s points=\"",
+                                  get_shape_name(shape));
+    // The points are only formatted until the line is full.
+    for (; point != NULL && length < size - 1; point = point->next)
+      length = append_cli_view_text(buffer, size, length,
+                                    (point->next != NULL) ? "(%d %d) "
+                                                          : "(%d %d)",
+                                    point->point->x, point->point->y);
+    length = append_cli_view_text(buffer, size, length, "\" ");
+    break;
+  case PATH:
+    length = append_cli_view_text(buffer, size, length,
+                                  "<%s data=\"%d element(s)\" ",
+                                  get_shape_name(shape),
+                                  get_path_element_node_length(content->path));
+    break;
+  case GROUP:
+    if (is_instance(shape))
+      length = append_cli_view_text(buffer, size, length,
+                                    "<use symbol=\"%s\" ", shape->symbol->id);
+    else
+      length = append_cli_view_text(buffer, size, length, "<group ");
+    break;
+  }
+  length = append_cli_view_style(buffer, size, length, shape->styles);
+  if (shape->shape_variant == GROUP && !is_instance(shape))
+    length = append_cli_view_text(buffer, size, length, "> %d shape(s)",
+                                  get_shape_node_length(content->group));
+  else
+    length = append_cli_view_text(buffer, size, length, "/>");
+
+  if (length == size - 1 && size > sizeof(CLI_VIEW_ELLIPSIS))
+    strcpy(buffer + size - sizeof(CLI_VIEW_ELLIPSIS), CLI_VIEW_ELLIPSIS);
+}
+
+char *get_cli_view_line(cli_view_t *view, shape_t *shape) {
+  uint64_t hash = get_shape_hash(shape);
+  cli_view_line_t *line =
+      &view->lines[((uintptr_t)shape / sizeof(shape_t)) % CLI_VIEW_CACHE_SIZE];
+  if (line->shape != shape || line->hash != hash) {
+    format_cli_view_line(shape, line->text, CLI_VIEW_LINE_SIZE);
+    line->shape = shape;
+    line->hash = hash;
+  }
+  return line->text;
+}
+
+bool is_cli_view_expanded(cli_view_t *view, shape_t *shape) {
+  for (int i = 0; i < view->expanded_count; i++)
+    if (view->expanded[i] == shape)
+      return true;
+  return false;
+}
+
+void collapse_cli_view_groups(cli_view_t *view) { view->expanded_count = 0; }
+
+void toggle_cli_view_group(cli_view_t *view, shape_t *shape) {
+  if (shape->shape_variant != GROUP || is_instance(shape))
+    return;
+  for (int i = 0; i < view->expanded_count; i++)
+    if (view->expanded[i] == shape) {
+      view->expanded[i] = view->expanded[--view->expanded_count];
+      return;
+    }
+
+  if (view->expanded_count == view->expanded_capacity) {
+    view->expanded_capacity = (view->expanded_capacity == 0)
+                                  ? CLI_VIEW_EXPANDED_CAPACITY
+                                  : view->expanded_capacity * 2;
+    view->expanded = realloc(view->expanded,
+                             sizeof(shape_t *) * view->expanded_capacity);
+  }
+  view->expanded[view->expanded_count++] = shape;
+}
+
+void print_cli_view_rows(cli_view_t *view, shape_node_t *shapes, int depth,
+                         int *row) {
+  bool is_group, is_expanded;
+  shape_t *shape;
+  for (shape_node_t *node = shapes; node != NULL; node = node->next) {
+    shape = node->shape;
+    is_group = shape->shape_variant == GROUP && !is_instance(shape);
+    is_expanded = is_group && is_cli_view_expanded(view, shape);
+    if (*row >= view->first && *row < view->first + CLI_VIEW_PAGE_SIZE) {
+      fprintf(stdout, "(%d) ", view->visible_count);
+      cli_print_spaces(depth);
+      if (is_group)
+        cli_print_content(is_expanded ? "[-] " : "[+] ");
+      cli_print_content(get_cli_view_line(view, shape));
+      cli_print_content("\n");
+      view->visible[view->visible_count++] = shape;
+    }
+    (*row)++;
+    if (is_expanded)
+      print_cli_view_rows(view, shape->shape->group, depth + 1, row);
+  }
+}
+
+void cli_print_view(cli_view_t *view, svg_t *svg) {
+  int row = 0;
+  fprintf(stdout, "<svg viewport=\"%d %d %d %d\">\n", svg->viewport->start->x,
+          svg->viewport->start->y, svg->viewport->end->x,
+          svg->viewport->end->y);
+  view->visible_count = 0;
+  print_cli_view_rows(view, svg->shapes, 1, &row);
+  view->rows = row;
+  if (view->visible_count == 0 && view->first > 0 && row > 0) {
+    // The shapes of the page were removed, the last page is shown instead.
+    view->first = (row - 1) / CLI_VIEW_PAGE_SIZE * CLI_VIEW_PAGE_SIZE;
+    row = 0;
+    print_cli_view_rows(view, svg->shapes, 1, &row);
+  }
+  cli_print_content("<svg \\>\n");
+  if (view->visible_count > 0)
+    fprintf(stdout, "Rows %d to %d of %d.\n\n", view->first + 1,
+            view->first + view->visible_count, view->rows);
+  else
+    cli_print_content("\n");
+}
+
+void move_cli_view(cli_view_t *view, int pages) {
+  int first = view->first + pages * CLI_VIEW_PAGE_SIZE;
+  if (first >= view->rows)
+    first = (view->rows - 1) / CLI_VIEW_PAGE_SIZE * CLI_VIEW_PAGE_SIZE;
+  view->first = (first < 0) ? 0 : first;
+}
@@ -0,0 +1,176 @@
+#ifndef CODA_CLI_VIEW
+#define CODA_CLI_VIEW
+
+#include "../models/shapes/shape.h"
+#include "../models/shapes/svg.h"
+#include "../models/styles/style.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define CLI_VIEW_PAGE_SIZE 20
+#define CLI_VIEW_LINE_SIZE 160
+#define CLI_VIEW_CACHE_SIZE 256
+
+/**
+ * Defines the cli view line type, the formatted line of a shape kept between
+ * redraws.
+ * @param shape the shape, NULL if the line is unused.
+ * @param hash  the shape's content hash when the line was formatted.
+ * @param text  the formatted line, truncated to fit a terminal's line.
+ * @see get_shape_hash.
+ */
+typedef struct cli_view_line_s {
+  shape_t *shape;
+  uint64_t hash;
+  char text[CLI_VIEW_LINE_SIZE];
+} cli_view_line_t;
+
+/**
+ * Defines the cli view type, a paged tree view of an svg's shapes.
+ * Each shape takes a row, the content of a group only taking rows once the
+ * group is expanded, so a page only formats its own rows whatever the size of
+ * the document. The formatted lines are cached by shape address and checked
+ * against the shapes' content hashes, which every edit invalidates.
+ * The expanded groups are collapsed again after each edit, undo or redo,
+ * which may free them.
+ * @param first              the index of the first displayed row.
+ * @param rows               the number of rows at the last redraw.
+ * @param visible            the shapes of the displayed rows.
+ * @param visible_count      the number of displayed rows.
+ * @param expanded           the expanded groups.
+ * @param expanded_count     the number of expanded groups.
+ * @param expanded_capacity  the expanded groups array's capacity.
+ * @param lines              the formatted lines' direct-mapped cache.
+ * @see cli_view_line_t.
+ */
+typedef struct cli_view_s {
+  int first;
+  int rows;
+  shape_t *visible[CLI_VIEW_PAGE_SIZE];
+  int visible_count;
+  shape_t **expanded;
+  int expanded_count;
+  int expanded_capacity;
+  cli_view_line_t lines[CLI_VIEW_CACHE_SIZE];
+} cli_view_t;
+
+/**
+ * Creates a new cli view showing the first page with all groups collapsed.
+ * Note that this function allocates memory.
+ * @return the new view's pointer.
+ * @see cli_view_t.
+ */
+cli_view_t *new_cli_view();
+
+/**
+ * Destroys the given cli view.
+ * Note that this function frees memory.
+ * Note that the shapes are not freed.
+ * @param view the view to destroy.
+ * @see cli_view_t.
+ */
+void free_cli_view(cli_view_t *view);
+
+/**
+ * Appends formatted text to the given buffer, truncating it to the buffer's
+ * size.
+ * @param buffer the buffer.
+ * @param size   the buffer's size.
+ * @param length the buffer's current length.
+ * @param format the printf-like format.
+ * @return the buffer's new length, at most size - 1.
+ */
+size_t append_cli_view_text(char *buffer, size_t size, size_t length,
+                            const char *format, ...);
+
+/**
+ * Appends the given styles to the given buffer, as in the svg files.
+ * @param buffer the buffer.
+ * @param size   the buffer's size.
+ * @param length the buffer's current length.
+ * @param styles the styles.
+ * @return the buffer's new length.
+ * @see style_t.
+ */
+size_t append_cli_view_style(char *buffer, size_t size, size_t length,
+                             style_t *styles);
+
+/**
+ * Formats the given shape on a single line, as in the svg files. Groups are
+ * formatted with their number of shapes instead of their content, and long
+ * point lists are cut with an ellipsis.
+ * @param shape  the shape.
+ * @param buffer the buffer.
+ * @param size   the buffer's size.
+ * @see shape_t.
+ */
+void format_cli_view_line(shape_t *shape, char *buffer, size_t size);
+
+/**
+ * Retrieves the formatted line of the given shape from the given view's
+ * cache, formatting it only if the shape is not cached or was edited since.
+ * @param view  the view.
+ * @param shape the shape.
+ * @return the formatted line, valid until the shape's cache line is reused.
+ * @see format_cli_view_line.
+ */
+char *get_cli_view_line(cli_view_t *view, shape_t *shape);
+
+/**
+ * Tests if the given group is expanded in the given view.
+ * @param view  the view.
+ * @param shape the group.
+ * @return returns true if the group's shapes are displayed.
+ * @see cli_view_t.
+ */
+bool is_cli_view_expanded(cli_view_t *view, shape_t *shape);
+
+/**
+ * Collapses all the groups of the given view.
+ * @param view the view.
+ * @see cli_view_t.
+ */
+void collapse_cli_view_groups(cli_view_t *view);
+
+/**
+ * Expands the given collapsed group or collapses the given expanded group.
+ * Note that this function may allocate memory.
+ * @param view  the view.
+ * @param shape the group, instances excepted.
+ * @see cli_view_t.
+ */
+void toggle_cli_view_group(cli_view_t *view, shape_t *shape);
+
+/**
+ * Displays the rows of the given linked list and of the expanded groups which
+ * are on the view's page, and counts all the rows.
+ * @param view   the view.
+ * @param shapes the linked list.
+ * @param depth  the linked list's depth in the tree.
+ * @param row    a pointer to the index of the list's first row, moved past
+ * its last row.
+ * @see cli_view_t.
+ */
+void print_cli_view_rows(cli_view_t *view, shape_node_t *shapes, int depth,
+                         int *row);
+
+/**
+ * Displays the given view's page of the given svg's shapes, the page being
+ * moved back if the document shrank under it.
+ * @param view the view.
+ * @param svg  the svg.
+ * @see cli_view_t.
+ */
+void cli_print_view(cli_view_t *view, svg_t *svg);
+
+/**
+ * Moves the given view by the given number of pages, within the rows counted
+ * at the last redraw.
+ * @param view  the view.
+ * @param pages the number of pages, negative to move back.
+ * @see cli_view_t.
+ */
+void move_cli_view(cli_view_t *view, int pages);
+
+#endif
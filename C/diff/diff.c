@@ -0,0 +1,521 @@
+#include "diff.h"
+#include "../hash/hash.h"
+#include "../models/shapes/group.h"
+#include "../models/shapes/multiline.h"
+#include "../models/shapes/path/path.h"
+#include "../models/shapes/polygon.h"
+#include "../models/shapes/shape.h"
+#include "../models/shapes/svg.h"
+#include "../models/shapes/symbol.h"
+#include "../models/styles/style.h"
+#include "../models/utils/point.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DIFF_MAX_EDITS 1000
+
+void mark_sequence_edits(uint64_t *a, int a_count, uint64_t *b, int b_count,
+                         bool *removed, bool *inserted) {
+  int max = a_count + b_count;
+  if (max == 0)
+    return;
+
+  // v[offset + k] is the furthest x reached on the diagonal k = x - y, and
+  // trace[d] keeps v[-d..d] after d edits for the backtracking.
+  int offset = max;
+  int *v = calloc(2 * max + 1, sizeof(int));
+  int limit = (max < DIFF_MAX_EDITS) ? max : DIFF_MAX_EDITS;
+  int **trace = malloc(sizeof(int *) * (limit + 1));
+  int edits = -1;
+  v[offset + 1] = 0;
+  for (int d = 0; d <= limit && edits < 0; d++) {
+    for (int k = -d; k <= d; k += 2) {
+      int x = (k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1]))
+                  ? v[offset + k + 1]
+                  : v[offset + k - 1] + 1;
+      int y = x - k;
+      while (x < a_count && y < b_count && a[x] == b[y]) {
+        x++;
+        y++;
+      }
+      v[offset + k] = x;
+      if (x >= a_count && y >= b_count) {
+        edits = d;
+        break;
+      }
+    }
+    trace[d] = malloc(sizeof(int) * (2 * d + 1));
+    memcpy(trace[d], &v[offset - d], sizeof(int) * (2 * d + 1));
+  }
+
+  if (edits < 0) {
+    // Too many edits, the whole sequence is replaced.
+    for (int i = 0; i < a_count; i++)
+      removed[i] = true;
+    for (int j = 0; j < b_count; j++)
+      inserted[j] = true;
+    edits = limit;
+  } else {
+    int x = a_count, y = b_count;
+    for (int d = edits; d > 0; d--) {
+      int *previous = trace[d - 1];
+      int k = x - y;
+      int previous_k =
+          (k == -d || (k != d && previous[k - 1 + d - 1] <
+                                     previous[k + 1 + d - 1]))
+              ? k + 1
+              : k - 1;
+      int previous_x = previous[previous_k + d - 1];
+      int previous_y = previous_x - previous_k;
+      if (previous_k == k + 1)
+        inserted[previous_y] = true;
+      else
+        removed[previous_x] = true;
+      x = previous_x;
+      y = previous_y;
+    }
+  }
+
+  for (int d = 0; d <= edits; d++)
+    free(trace[d]);
+  free(trace);
+  free(v);
+}
+
+int diff_sequences(uint64_t *a, int a_count, uint64_t *b, int b_count,
+                   diff_hunk_t **hunks) {
+  int start = 0, a_end = a_count, b_end = b_count;
+  while (start < a_count && start < b_count && a[start] == b[start])
+    start++;
+  while (a_end > start && b_end > start && a[a_end - 1] == b[b_end - 1]) {
+    a_end--;
+    b_end--;
+  }
+
+  int n = a_end - start, m = b_end - start;
+  bool *removed = calloc(n + 1, sizeof(bool));
+  bool *inserted = calloc(m + 1, sizeof(bool));
+  mark_sequence_edits(a + start, n, b + start, m, removed, inserted);
+
+  // Each hunk is followed by a common item, or ends the sequences.
+  *hunks = malloc(sizeof(diff_hunk_t) * (((n < m) ? n : m) + 1));
+  int count = 0, i = 0, j = 0;
+  while (i < n || j < m) {
+    if (i < n && j < m && !removed[i] && !inserted[j]) {
+      i++;
+      j++;
+      continue;
+    }
+    diff_hunk_t *hunk = &(*hunks)[count++];
+    hunk->a_index = start + i;
+    hunk->b_index = start + j;
+    hunk->removed = 0;
+    hunk->inserted = 0;
+    for (; i < n && removed[i]; i++)
+      hunk->removed++;
+    for (; j < m && inserted[j]; j++)
+      hunk->inserted++;
+  }
+
+  free(removed);
+  free(inserted);
+  return count;
+}
+
+point_patch_t *diff_points(point_node_t *a, point_node_t *b) {
+  int a_count = get_point_node_length(a), b_count = get_point_node_length(b);
+  uint64_t *a_hashes = malloc(sizeof(uint64_t) * (a_count + 1));
+  uint64_t *b_hashes = malloc(sizeof(uint64_t) * (b_count + 1));
+  point_t **b_points = malloc(sizeof(point_t *) * (b_count + 1));
+  // The coordinates fit in 64 bits, so the points are compared exactly.
+  int i = 0;
+  for (point_node_t *node = a; node != NULL; node = node->next)
+    a_hashes[i++] = (uint64_t)(unsigned int)node->point->x << 32 |
+                    (unsigned int)node->point->y;
+  i = 0;
+  for (point_node_t *node = b; node != NULL; node = node->next) {
+    b_points[i] = node->point;
+    b_hashes[i++] = (uint64_t)(unsigned int)node->point->x << 32 |
+                    (unsigned int)node->point->y;
+  }
+
+  diff_hunk_t *hunks;
+  int count = diff_sequences(a_hashes, a_count, b_hashes, b_count, &hunks);
+  point_patch_t *patch = NULL, *last = NULL;
+  for (i = 0; i < count; i++) {
+    point_patch_t *node = malloc(sizeof(point_patch_t));
+    node->index = hunks[i].b_index;
+    node->removed = hunks[i].removed;
+    node->points = NULL;
+    point_node_t *points_last = NULL;
+    for (int j = 0; j < hunks[i].inserted; j++)
+      append_point_node(&node->points, &points_last,
+                           clone_point(b_points[hunks[i].b_index + j]));
+    node->previous = last;
+    node->next = NULL;
+    if (last == NULL)
+      patch = node;
+    else
+      last->next = node;
+    last = node;
+  }
+
+  free(hunks);
+  free(a_hashes);
+  free(b_hashes);
+  free(b_points);
+  return patch;
+}
+
+bool is_shape_patchable(shape_t *a, shape_t *b) {
+  if (a->shape_variant != b->shape_variant)
+    return false;
+  // The content of instances is not patched, it belongs to their symbol.
+  if (a->shape_variant == GROUP && !is_instance(a) && !is_instance(b))
+    return true;
+  return a->shape_variant == MULTILINE || a->shape_variant == POLYGON ||
+         hash_geometry(a) == hash_geometry(b);
+}
+
+patch_t *diff_shape(shape_t *a, shape_t *b, int index) {
+  patch_t *operation = new_patch(PATCH_MODIFY, index);
+  if (hash_style(a->styles) != hash_style(b->styles))
+    operation->styles = clone_style(b->styles);
+  switch (a->shape_variant) {
+  case MULTILINE:
+  case POLYGON:
+    operation->points = diff_points(a->shape->multiline, b->shape->multiline);
+    break;
+  case GROUP:
+    if (!is_instance(a))
+      operation->children = diff_shapes(a->shape->group, b->shape->group);
+    break;
+  default:
+    break;
+  }
+  return operation;
+}
+
+patch_t *diff_shapes(shape_node_t *a, shape_node_t *b) {
+  int a_count = get_shape_node_length(a), b_count = get_shape_node_length(b);
+  uint64_t *a_hashes = malloc(sizeof(uint64_t) * (a_count + 1));
+  uint64_t *b_hashes = malloc(sizeof(uint64_t) * (b_count + 1));
+  shape_t **a_shapes = malloc(sizeof(shape_t *) * (a_count + 1));
+  shape_t **b_shapes = malloc(sizeof(shape_t *) * (b_count + 1));
+  int i = 0;
+  for (shape_node_t *node = a; node != NULL; node = node->next) {
+    a_shapes[i] = node->shape;
+    a_hashes[i++] = get_shape_hash(node->shape);
+  }
+  i = 0;
+  for (shape_node_t *node = b; node != NULL; node = node->next) {
+    b_shapes[i] = node->shape;
+    b_hashes[i++] = get_shape_hash(node->shape);
+  }
+
+  diff_hunk_t *hunks;
+  int count = diff_sequences(a_hashes, a_count, b_hashes, b_count, &hunks);
+  patch_t *patch = NULL, *last = NULL;
+  for (i = 0; i < count; i++) {
+    diff_hunk_t *hunk = &hunks[i];
+    // The leading shapes of the hunk are modified in place when possible.
+    int k = 0;
+    while (k < hunk->removed && k < hunk->inserted &&
+           is_shape_patchable(a_shapes[hunk->a_index + k],
+                              b_shapes[hunk->b_index + k])) {
+      append_patch(&patch, &last,
+                   diff_shape(a_shapes[hunk->a_index + k],
+                              b_shapes[hunk->b_index + k], hunk->b_index + k));
+      k++;
+    }
+
+    if (hunk->removed > k) {
+      patch_t *operation = new_patch(PATCH_REMOVE, hunk->b_index + k);
+      operation->count = hunk->removed - k;
+      append_patch(&patch, &last, operation);
+    }
+    if (hunk->inserted > k) {
+      patch_t *operation = new_patch(PATCH_INSERT, hunk->b_index + k);
+      shape_node_t *shapes_last = NULL;
+      for (int j = k; j < hunk->inserted; j++)
+        append_shape_node(&operation->shapes, &shapes_last,
+                             clone_shape(b_shapes[hunk->b_index + j]));
+      append_patch(&patch, &last, operation);
+    }
+  }
+
+  free(hunks);
+  free(a_hashes);
+  free(b_hashes);
+  free(a_shapes);
+  free(b_shapes);
+  return patch;
+}
+
+svg_patch_t *diff_svg(svg_t *a, svg_t *b) {
+  svg_patch_t *patch = malloc(sizeof(svg_patch_t));
+  patch->viewport = NULL;
+  if (b->viewport != NULL &&
+      (a->viewport == NULL ||
+       a->viewport->start->x != b->viewport->start->x ||
+       a->viewport->start->y != b->viewport->start->y ||
+       a->viewport->end->x != b->viewport->end->x ||
+       a->viewport->end->y != b->viewport->end->y))
+    patch->viewport = new_viewport(clone_point(b->viewport->start),
+                                   clone_point(b->viewport->end));
+  patch->symbols = NULL;
+  patch->clear_symbols = false;
+  if (b->symbols == NULL)
+    patch->clear_symbols = a->symbols != NULL;
+  else if (!are_symbols_equal(a->symbols, b->symbols))
+    patch->symbols = clone_symbol_list(b->symbols);
+  patch->shapes = diff_shapes(a->shapes, b->shapes);
+  return patch;
+}
+
+bool patch_points(point_node_t *points, point_patch_t *patch,
+                  point_node_t **result) {
+  point_node_t *source = points, *patched = NULL, *last = NULL;
+  int length = 0;
+  bool valid = true;
+  for (point_patch_t *hunk = patch; hunk != NULL && valid;
+       hunk = hunk->next) {
+    // Keeps the points before the hunk, then replaces the removed ones.
+    while (source != NULL && length < hunk->index) {
+      append_point_node(&patched, &last, clone_point(source->point));
+      source = source->next;
+      length++;
+    }
+    valid = length == hunk->index;
+    for (int i = 0; i < hunk->removed && valid; i++) {
+      valid = source != NULL;
+      if (valid)
+        source = source->next;
+    }
+    for (point_node_t *node = hunk->points; node != NULL && valid;
+         node = node->next) {
+      append_point_node(&patched, &last, clone_point(node->point));
+      length++;
+    }
+  }
+
+  if (!valid) {
+    free_point_nodes(patched);
+    return false;
+  }
+  for (; source != NULL; source = source->next)
+    append_point_node(&patched, &last, clone_point(source->point));
+  *result = patched;
+  return true;
+}
+
+shape_t *patch_shape(shape_t *shape, patch_t *operation) {
+  if ((operation->points != NULL && shape->shape_variant != MULTILINE &&
+       shape->shape_variant != POLYGON) ||
+      (operation->children != NULL &&
+       (shape->shape_variant != GROUP || is_instance(shape))))
+    return NULL;
+
+  style_t *styles = clone_style(
+      (operation->styles != NULL) ? operation->styles : shape->styles);
+  point_node_t *points;
+  shape_node_t *shapes;
+  switch (shape->shape_variant) {
+  case MULTILINE:
+  case POLYGON:
+    if (!patch_points(shape->shape->multiline, operation->points, &points)) {
+      free_style(styles);
+      return NULL;
+    }
+    return (shape->shape_variant == MULTILINE) ? new_multiline(points, styles)
+                                               : new_polygon(points, styles);
+  case GROUP:
+    if (is_instance(shape))
+      break;
+    if (!patch_shapes(shape->shape->group, operation->children, &shapes)) {
+      free_style(styles);
+      return NULL;
+    }
+    return new_group(shapes, styles);
+  default:
+    break;
+  }
+
+  shape_t *patched = copy_shape(shape);
+  free_style(patched->styles);
+  patched->styles = styles;
+  return patched;
+}
+
+bool patch_shapes(shape_node_t *shapes, patch_t *patch,
+                  shape_node_t **result) {
+  shape_node_t *source = shapes, *patched = NULL, *last = NULL;
+  int length = 0;
+  bool valid = true;
+  for (patch_t *operation = patch; operation != NULL && valid;
+       operation = operation->next) {
+    // Shares the shapes before the operation.
+    while (source != NULL && length < operation->index) {
+      append_shape_node(&patched, &last, clone_shape(source->shape));
+      source = source->next;
+      length++;
+    }
+    if (length != operation->index) {
+      valid = false;
+      break;
+    }
+
+    shape_t *shape;
+    switch (operation->variant) {
+    case PATCH_REMOVE:
+      for (int i = 0; i < operation->count && valid; i++) {
+        valid = source != NULL;
+        if (valid)
+          source = source->next;
+      }
+      break;
+    case PATCH_INSERT:
+      for (shape_node_t *node = operation->shapes; node != NULL;
+           node = node->next) {
+        append_shape_node(&patched, &last, clone_shape(node->shape));
+        length++;
+      }
+      break;
+    case PATCH_MODIFY:
+      shape = (source != NULL) ? patch_shape(source->shape, operation) : NULL;
+      valid = shape != NULL;
+      if (!valid)
+        break;
+      append_shape_node(&patched, &last, shape);
+      source = source->next;
+      length++;
+      break;
+    }
+  }
+
+  if (!valid) {
+    free_shape_node(patched);
+    return false;
+  }
+  for (; source != NULL; source = source->next)
+    append_shape_node(&patched, &last, clone_shape(source->shape));
+  *result = patched;
+  return true;
+}
+
+svg_t *patch_svg(svg_t *svg, svg_patch_t *patch) {
+  shape_node_t *shapes;
+  if (!patch_shapes(svg->shapes, patch->shapes, &shapes))
+    return NULL;
+  viewport_t *viewport = (patch->viewport != NULL) ? patch->viewport
+                                                   : svg->viewport;
+  if (viewport != NULL)
+    viewport = new_viewport(clone_point(viewport->start),
+                            clone_point(viewport->end));
+  svg_t *patched = new_svg(viewport, shapes);
+  if (!patch->clear_symbols)
+    patched->symbols = clone_symbol_list(
+        (patch->symbols != NULL) ? patch->symbols : svg->symbols);
+  // The kept and modified instances still point at the given svg's symbols,
+  // and the inserted ones at the symbols of the svg the patch was made from.
+  if (!resolve_instances(patched->shapes, patched->symbols)) {
+    free_svg(patched);
+    return NULL;
+  }
+  return patched;
+}
+
+bool resolve_instances(shape_node_t *shapes, symbol_node_t *symbols) {
+  for (shape_node_t *node = shapes; node != NULL; node = node->next) {
+    shape_t *shape = node->shape;
+    if (shape->shape_variant != GROUP)
+      continue;
+    if (is_instance(shape)) {
+      symbol_t *symbol = find_symbol(symbols, shape->symbol->id);
+      if (symbol == NULL)
+        return false;
+      if (symbol == shape->symbol)
+        continue;
+      node->shape =
+          new_instance(clone_symbol(symbol), clone_style(shape->styles));
+      free_shape(shape);
+      continue;
+    }
+    if (has_stale_instances(shape->shape->group, symbols) &&
+        !resolve_instances(unshare_shape(&node->shape)->shape->group,
+                           symbols))
+      return false;
+  }
+  return true;
+}
+
+bool has_stale_instances(shape_node_t *shapes, symbol_node_t *symbols) {
+  for (shape_node_t *node = shapes; node != NULL; node = node->next) {
+    shape_t *shape = node->shape;
+    if (shape->shape_variant != GROUP)
+      continue;
+    if (is_instance(shape)) {
+      if (find_symbol(symbols, shape->symbol->id) != shape->symbol)
+        return true;
+    } else if (has_stale_instances(shape->shape->group, symbols))
+      return true;
+  }
+  return false;
+}
+
+void append_patch(patch_t **patch, patch_t **last, patch_t *operation) {
+  operation->previous = *last;
+  if (*last == NULL)
+    *patch = operation;
+  else
+    (*last)->next = operation;
+  *last = operation;
+}
+
+patch_t *new_patch(patch_variant_t variant, int index) {
+  patch_t *operation = malloc(sizeof(patch_t));
+  operation->previous = NULL;
+  operation->variant = variant;
+  operation->index = index;
+  operation->count = 0;
+  operation->shapes = NULL;
+  operation->styles = NULL;
+  operation->points = NULL;
+  operation->children = NULL;
+  operation->next = NULL;
+  return operation;
+}
+
+void free_point_patch(point_patch_t *patch) {
+  point_patch_t *hunk = patch;
+  while (hunk != NULL) {
+    point_patch_t *next = hunk->next;
+    free_point_nodes(hunk->points);
+    free(hunk);
+    hunk = next;
+  }
+}
+
+void free_patch(patch_t *patch) {
+  patch_t *operation = patch;
+  while (operation != NULL) {
+    patch_t *next = operation->next;
+    free_shape_node(operation->shapes);
+    if (operation->styles != NULL)
+      free_style(operation->styles);
+    free_point_patch(operation->points);
+    free_patch(operation->children);
+    free(operation);
+    operation = next;
+  }
+}
+
+void free_svg_patch(svg_patch_t *patch) {
+  if (patch->viewport != NULL)
+    free_viewport(patch->viewport);
+  free_symbol_node(patch->symbols);
+  free_patch(patch->shapes);
+  free(patch);
+}
@@ -0,0 +1,314 @@
+#ifndef CODA_DIFF
+#define CODA_DIFF
+
+#include "../models/shapes/shape.h"
+#include "../models/shapes/svg.h"
+#include "../models/styles/style.h"
+#include "../models/utils/point.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Defines a difference between two sequences: a run of removed items of the
+ * first sequence replaced by a run of inserted items of the second one.
+ * @param a_index  the index of the first removed item in the first sequence.
+ * @param removed  the number of removed items.
+ * @param b_index  the index of the first inserted item in the second
+ * sequence.
+ * @param inserted the number of inserted items.
+ */
+typedef struct diff_hunk_s {
+  int a_index;
+  int removed;
+  int b_index;
+  int inserted;
+} diff_hunk_t;
+
+/**
+ * Defines the point patch linked list node type.
+ * A point patch replaces a run of points of a multiline or a polygon.
+ * @param previous the previous node.
+ * @param index    the index of the first replaced point in the patched list.
+ * @param removed  the number of removed points.
+ * @param points   the inserted points, NULL if there are none.
+ * @param next     the next node.
+ * @see point_node_t.
+ */
+typedef struct point_patch_s point_patch_t;
+
+struct point_patch_s {
+  point_patch_t *previous;
+  int index;
+  int removed;
+  point_node_t *points;
+  point_patch_t *next;
+};
+
+/**
+ * Lists the shape patch operations.
+ */
+typedef enum patch_variant_e {
+  PATCH_REMOVE,
+  PATCH_INSERT,
+  PATCH_MODIFY,
+} patch_variant_t;
+
+/**
+ * Defines the shape patch linked list node type.
+ * The operations are applied in order, their index being the position in the
+ * patched list, so that the shapes before it are already patched.
+ * A modification replaces the styles, patches the points of a multiline or a
+ * polygon or patches the shapes of a group, the other shapes being replaced
+ * by a removal followed by an insertion.
+ * @param previous the previous node.
+ * @param variant  the operation.
+ * @param index    the index of the operation in the patched list.
+ * @param count    the number of removed shapes.
+ * @param shapes   the inserted shapes.
+ * @param styles   the modified shape's new styles, NULL if they did not
+ * change.
+ * @param points   the modified multiline or polygon's point patches.
+ * @param children the modified group's shape patches.
+ * @param next     the next node.
+ * @see patch_variant_t.
+ * @see point_patch_t.
+ */
+typedef struct patch_s patch_t;
+
+struct patch_s {
+  patch_t *previous;
+  patch_variant_t variant;
+  int index;
+  int count;
+  shape_node_t *shapes;
+  style_t *styles;
+  point_patch_t *points;
+  patch_t *children;
+  patch_t *next;
+};
+
+/**
+ * Defines the patch turning an svg into another one.
+ * @param viewport      the new viewport, NULL if it did not change.
+ * @param symbols       the new symbols, NULL if they did not change or if
+ * they were all removed.
+ * @param clear_symbols true if the symbols were all removed, since a NULL
+ * symbols list keeps them.
+ * @param shapes        the shape patches, NULL if the shapes did not change.
+ * @see patch_t.
+ * @see symbol_node_t.
+ */
+typedef struct svg_patch_s {
+  viewport_t *viewport;
+  symbol_node_t *symbols;
+  bool clear_symbols;
+  patch_t *shapes;
+} svg_patch_t;
+
+/**
+ * Marks the items to remove from the first sequence and to insert from the
+ * second one so that the other items form a longest common subsequence.
+ * The edits are found with Myers' algorithm, whose cost grows with the number
+ * of edits rather than with the sequences lengths. Past DIFF_MAX_EDITS edits
+ * all the items are marked, i.e. the first sequence is replaced entirely.
+ * Note that this function allocates memory.
+ * @param a        the first sequence's hashes.
+ * @param a_count  the first sequence's length.
+ * @param b        the second sequence's hashes.
+ * @param b_count  the second sequence's length.
+ * @param removed  an array of a_count booleans to set.
+ * @param inserted an array of b_count booleans to set.
+ */
+void mark_sequence_edits(uint64_t *a, int a_count, uint64_t *b, int b_count,
+                         bool *removed, bool *inserted);
+
+/**
+ * Computes the differences between two sequences of hashes.
+ * The common prefix and suffix are skipped before looking for the edits.
+ * Note that this function allocates memory.
+ * @param a       the first sequence's hashes.
+ * @param a_count the first sequence's length.
+ * @param b       the second sequence's hashes.
+ * @param b_count the second sequence's length.
+ * @param hunks   a pointer to the array of differences to set, to be freed by
+ * the caller.
+ * @return the number of differences.
+ * @see mark_sequence_edits.
+ * @see diff_hunk_t.
+ */
+int diff_sequences(uint64_t *a, int a_count, uint64_t *b, int b_count,
+                   diff_hunk_t **hunks);
+
+/**
+ * Computes the patch turning the given point linked list into another one.
+ * Note that this function allocates memory.
+ * @param a the original points.
+ * @param b the new points.
+ * @return the point patch linked list, NULL if the points are equal.
+ * @see point_patch_t.
+ */
+point_patch_t *diff_points(point_node_t *a, point_node_t *b);
+
+/**
+ * Tests if the given shape can be patched into the other one, i.e. if they
+ * have the same variant and either the same geometry or a geometry with
+ * patchable parts. The content of instances is never patchable.
+ * @param a the original shape.
+ * @param b the new shape.
+ * @return true if a modification can turn a into b, false otherwise.
+ * @see patch_t.
+ */
+bool is_shape_patchable(shape_t *a, shape_t *b);
+
+/**
+ * Computes the modification turning the given shape into another one.
+ * Note that this function allocates memory.
+ * @param a     the original shape.
+ * @param b     the new shape.
+ * @param index the modification's index.
+ * @return the new modification's pointer.
+ * @see is_shape_patchable.
+ * @see patch_t.
+ */
+patch_t *diff_shape(shape_t *a, shape_t *b, int index);
+
+/**
+ * Computes the patch turning the given shape linked list into another one.
+ * The shapes are matched by hash, the unmatched shapes are modified when
+ * possible, removed or inserted otherwise. The inserted shapes are shared
+ * with the new list.
+ * Note that this function allocates memory.
+ * @param a the original shapes.
+ * @param b the new shapes.
+ * @return the shape patch linked list, NULL if the shapes are equal.
+ * @see diff_sequences.
+ * @see patch_t.
+ */
+patch_t *diff_shapes(shape_node_t *a, shape_node_t *b);
+
+/**
+ * Computes the patch turning the given svg into another one.
+ * Note that this function allocates memory.
+ * @param a the original svg.
+ * @param b the new svg.
+ * @return the new patch's pointer.
+ * @see svg_patch_t.
+ */
+svg_patch_t *diff_svg(svg_t *a, svg_t *b);
+
+/**
+ * Applies the given point patch to the given point linked list.
+ * Note that this function allocates memory.
+ * @param points the points.
+ * @param patch  the point patch linked list.
+ * @param result a pointer to the new point linked list to set.
+ * @return true if the patch applies to the points, false otherwise.
+ * @see point_patch_t.
+ */
+bool patch_points(point_node_t *points, point_patch_t *patch,
+                  point_node_t **result);
+
+/**
+ * Applies the given modification to the given shape.
+ * Note that this function allocates memory.
+ * @param shape     the shape.
+ * @param operation the modification.
+ * @return the new shape's pointer, NULL if the modification does not apply.
+ * @see patch_t.
+ */
+shape_t *patch_shape(shape_t *shape, patch_t *operation);
+
+/**
+ * Applies the given patch to the given shape linked list.
+ * The shapes left untouched by the patch are shared with the new list.
+ * Note that this function allocates memory.
+ * @param shapes the shapes.
+ * @param patch  the shape patch linked list.
+ * @param result a pointer to the new shape linked list to set.
+ * @return true if the patch applies to the shapes, false otherwise.
+ * @see patch_t.
+ */
+bool patch_shapes(shape_node_t *shapes, patch_t *patch,
+                  shape_node_t **result);
+
+/**
+ * Points the instances of the given shape linked list at the symbols of the
+ * given symbol linked list with the same identifiers.
+ * The shared groups holding a stale instance are copied before their shapes
+ * are replaced.
+ * Note that this function allocates memory.
+ * @param shapes  the shapes.
+ * @param symbols the symbols.
+ * @return true if every instance has a symbol, false otherwise.
+ * @see has_stale_instances.
+ */
+bool resolve_instances(shape_node_t *shapes, symbol_node_t *symbols);
+
+/**
+ * Tests if the given shape linked list holds an instance of a symbol which
+ * is not in the given symbol linked list.
+ * @param shapes  the shapes.
+ * @param symbols the symbols.
+ * @return true if an instance is stale, false otherwise.
+ * @see find_symbol.
+ */
+bool has_stale_instances(shape_node_t *shapes, symbol_node_t *symbols);
+
+/**
+ * Applies the given patch to the given svg.
+ * The given svg is left untouched and shares its unchanged shapes and its
+ * symbols, unless the patch redefines them, with the new one. The instances
+ * are then resolved against the new svg's symbols, so that none of them
+ * keeps a symbol which was redefined or which belongs to another svg.
+ * Note that this function allocates memory.
+ * @param svg   the svg.
+ * @param patch the patch.
+ * @return the new svg's pointer, NULL if the patch does not apply.
+ * @see svg_patch_t.
+ */
+svg_t *patch_svg(svg_t *svg, svg_patch_t *patch);
+
+/**
+ * Creates a new shape patch operation.
+ * Note that this function allocates memory.
+ * @param variant the operation.
+ * @param index   the operation's index.
+ * @return the new operation's pointer.
+ * @see patch_t.
+ */
+patch_t *new_patch(patch_variant_t variant, int index);
+
+/**
+ * Appends the given operation to the given shape patch linked list.
+ * @param patch     a pointer to the linked list's first operation.
+ * @param last      a pointer to the linked list's last operation.
+ * @param operation the operation to append.
+ * @see patch_t.
+ */
+void append_patch(patch_t **patch, patch_t **last, patch_t *operation);
+
+/**
+ * Destroys the given point patch linked list.
+ * Note that this function frees memory.
+ * @param patch the point patch linked list.
+ * @see point_patch_t.
+ */
+void free_point_patch(point_patch_t *patch);
+
+/**
+ * Destroys the given shape patch linked list.
+ * Note that this function frees memory.
+ * @param patch the shape patch linked list.
+ * @see patch_t.
+ */
+void free_patch(patch_t *patch);
+
+/**
+ * Destroys the given svg patch.
+ * Note that this function frees memory.
+ * @param patch the svg patch.
+ * @see svg_patch_t.
+ */
+void free_svg_patch(svg_patch_t *patch);
+
+#endif
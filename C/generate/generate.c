@@ -0,0 +1,362 @@
+#include "generate.h"
+#include "../models/shapes/shape.h"
+#include <ctype.h>
+#include <string.h>
+
+#define GENERATE_SHAPES 10000
+#define GENERATE_GROUP_SIZE 8
+#define GENERATE_DEPTH 2
+#define GENERATE_POINTS 8
+#define GENERATE_ELEMENTS 8
+#define GENERATE_STYLE_RATE 25
+#define GENERATE_VIEWPORT 1000
+#define GENERATE_SEED 42
+#define GENERATE_SIZE 100
+#define GENERATE_TRANSLATE 10
+#define GOLDEN_GAMMA 0x9e3779b97f4a7c15ULL
+
+static const char *GENERATE_VARIANT_NAMES[GENERATE_VARIANT_COUNT] = {
+    "ellipse", "rectangle", "line", "multiline", "polygon", "draw", "group"};
+
+static const char *GENERATE_PATH_ELEMENTS[GENERATE_PATH_ELEMENT_COUNT] = {
+    "M", "L", "H", "V", "C", "S", "Q", "T", "Z"};
+
+static const unsigned long
+    GENERATE_PATH_WEIGHTS[GENERATE_PATH_ELEMENT_COUNT] = {1, 4, 1, 1, 2,
+                                                          1, 1, 1, 1};
+
+void generate_print_usage() {
+  fprintf(stderr,
+          "Generate options:\n"
+          "  --shapes <count>          number of shapes, group children "
+          "included\n"
+          "  --mix <name=weight,...>   relative frequency of the shapes, "
+          "e.g. rectangle=2,draw=1\n"
+          "  --counts <name=count,...> number of shapes of each kind\n"
+          "  --group-size <count>      number of shapes of each group\n"
+          "  --depth <count>           maximum nesting of the groups\n"
+          "  --points <count>          number of points of the multilines "
+          "and polygons\n"
+          "  --elements <count>        number of elements of the paths\n"
+          "  --path-mix <C=weight,...> relative frequency of the path "
+          "elements\n"
+          "  --style-rate <percent>    percentage of the styles written "
+          "down\n"
+          "  --palette <count>         number of colors, 0 for random "
+          "colors\n"
+          "  --viewport <size>         width and height of the viewport\n"
+          "  --seed <number>           seed of the random numbers\n");
+}
+
+bool generate_parse_values(char *list, const char **names, int count,
+                           unsigned long *values) {
+  unsigned long parsed[GENERATE_VARIANT_COUNT + GENERATE_PATH_ELEMENT_COUNT] =
+      {0};
+  bool has_value = false;
+  char *cursor = list;
+  while (*cursor != '\0') {
+    size_t length = strcspn(cursor, "=");
+    int index = -1, consumed;
+    unsigned long value;
+    for (int i = 0; i < count; i++)
+      if (strlen(names[i]) == length &&
+          strncmp(cursor, names[i], length) == 0)
+        index = i;
+    if (index < 0 || cursor[length] != '=' ||
+        !isdigit((unsigned char)cursor[length + 1]) ||
+        sscanf(cursor + length + 1, "%lu%n", &value, &consumed) != 1)
+      return false;
+    parsed[index] = value;
+    has_value = has_value || value > 0;
+    cursor += length + 1 + consumed;
+    if (*cursor == ',')
+      cursor++;
+    else if (*cursor != '\0')
+      return false;
+  }
+  if (!has_value)
+    return false;
+  memcpy(values, parsed, sizeof(unsigned long) * count);
+  return true;
+}
+
+int generate_parse_options(int argc, char **argv, generate_config_t *config) {
+  unsigned long shapes = GENERATE_SHAPES, mix[GENERATE_VARIANT_COUNT];
+  for (int i = 0; i < GENERATE_VARIANT_COUNT; i++)
+    mix[i] = 1;
+  bool has_counts = false;
+  config->group_size = GENERATE_GROUP_SIZE;
+  config->depth = GENERATE_DEPTH;
+  config->points = GENERATE_POINTS;
+  config->elements = GENERATE_ELEMENTS;
+  memcpy(config->path_weights, GENERATE_PATH_WEIGHTS,
+         sizeof(GENERATE_PATH_WEIGHTS));
+  config->style_rate = GENERATE_STYLE_RATE;
+  config->palette = 0;
+  config->viewport = GENERATE_VIEWPORT;
+  config->seed = GENERATE_SEED;
+
+  int others = 0;
+  unsigned long n;
+  for (int i = 0; i < argc; i++) {
+    if (strncmp(argv[i], "--", 2) != 0)
+      argv[others++] = argv[i];
+    else if (i + 1 < argc && strcmp(argv[i], "--mix") == 0) {
+      if (!generate_parse_values(argv[++i], GENERATE_VARIANT_NAMES,
+                                 GENERATE_VARIANT_COUNT, mix)) {
+        fprintf(stderr, "Invalid option: --mix %s\n", argv[i]);
+        return -1;
+      }
+    } else if (i + 1 < argc && strcmp(argv[i], "--counts") == 0) {
+      if (!generate_parse_values(argv[++i], GENERATE_VARIANT_NAMES,
+                                 GENERATE_VARIANT_COUNT, config->counts)) {
+        fprintf(stderr, "Invalid option: --counts %s\n", argv[i]);
+        return -1;
+      }
+      has_counts = true;
+    } else if (i + 1 < argc && strcmp(argv[i], "--path-mix") == 0) {
+      if (!generate_parse_values(argv[++i], GENERATE_PATH_ELEMENTS,
+                                 GENERATE_PATH_ELEMENT_COUNT,
+                                 config->path_weights)) {
+        fprintf(stderr, "Invalid option: --path-mix %s\n", argv[i]);
+        return -1;
+      }
+    } else if (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0]) &&
+               sscanf(argv[i + 1], "%lu", &n) == 1) {
+      // Options with a value.
+      if (strcmp(argv[i], "--shapes") == 0 && n > 0)
+        shapes = n;
+      else if (strcmp(argv[i], "--group-size") == 0 && n > 0)
+        config->group_size = n;
+      else if (strcmp(argv[i], "--depth") == 0)
+        config->depth = n;
+      else if (strcmp(argv[i], "--points") == 0 && n > 1)
+        config->points = n;
+      else if (strcmp(argv[i], "--elements") == 0)
+        config->elements = n;
+      else if (strcmp(argv[i], "--style-rate") == 0 && n <= 100)
+        config->style_rate = n;
+      else if (strcmp(argv[i], "--palette") == 0)
+        config->palette = n;
+      else if (strcmp(argv[i], "--viewport") == 0 && n > 0)
+        config->viewport = n;
+      else if (strcmp(argv[i], "--seed") == 0)
+        config->seed = n;
+      else {
+        fprintf(stderr, "Invalid option: %s %s\n", argv[i], argv[i + 1]);
+        return -1;
+      }
+      i++;
+    } else {
+      fprintf(stderr, "Invalid option: %s\n", argv[i]);
+      return -1;
+    }
+  }
+  if (has_counts)
+    return others;
+
+  // The shapes are split along the mix, the rest going to the first variants.
+  unsigned long weights = 0, split = 0;
+  for (int i = 0; i < GENERATE_VARIANT_COUNT; i++)
+    weights += mix[i];
+  for (int i = 0; i < GENERATE_VARIANT_COUNT; i++) {
+    config->counts[i] = shapes / weights * mix[i] +
+                        shapes % weights * mix[i] / weights;
+    split += config->counts[i];
+  }
+  for (int i = 0; split < shapes; i = (i + 1) % GENERATE_VARIANT_COUNT)
+    if (mix[i] > 0) {
+      config->counts[i]++;
+      split++;
+    }
+  return others;
+}
+
+uint64_t next_generate_random(uint64_t *random) {
+  uint64_t z = (*random += GOLDEN_GAMMA);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+int draw_generate_random(uint64_t *random, int bound) {
+  return (int)(next_generate_random(random) % (uint64_t)bound);
+}
+
+int draw_generate_variant(generate_state_t *state, unsigned int depth) {
+  // The groups nested deeper than the config's depth are left out.
+  bool has_groups = depth == 0 || depth < state->config->depth;
+  unsigned long total = state->total;
+  if (!has_groups)
+    total -= state->remaining[GROUP];
+  if (total == 0)
+    return -1;
+  unsigned long drawn = next_generate_random(&state->random) % total;
+  for (int i = 0; i < GENERATE_VARIANT_COUNT; i++) {
+    if (i == GROUP && !has_groups)
+      continue;
+    if (drawn < state->remaining[i]) {
+      state->remaining[i]--;
+      state->total--;
+      return i;
+    }
+    drawn -= state->remaining[i];
+  }
+  return -1;
+}
+
+void write_generate_color(FILE *file, generate_state_t *state) {
+  uint64_t color = next_generate_random(&state->random);
+  if (state->config->palette > 0) {
+    // The palette's colors are derived from the seed and their index.
+    uint64_t index =
+        draw_generate_random(&state->random, state->config->palette);
+    color = state->config->seed ^ (index * GOLDEN_GAMMA);
+    color = next_generate_random(&color);
+  }
+  fprintf(file, "#%08x", (unsigned int)color);
+}
+
+void write_generate_styles(FILE *file, generate_state_t *state) {
+  int rate = state->config->style_rate;
+  if (draw_generate_random(&state->random, 100) < rate) {
+    fprintf(file, " fill=\"");
+    write_generate_color(file, state);
+    fprintf(file, "\"");
+  }
+  if (draw_generate_random(&state->random, 100) < rate) {
+    fprintf(file, " outline=\"");
+    write_generate_color(file, state);
+    fprintf(file, "\"");
+  }
+  if (draw_generate_random(&state->random, 100) < rate)
+    fprintf(file, " translate=\"%d %d\"",
+            draw_generate_random(&state->random, 2 * GENERATE_TRANSLATE + 1) -
+                GENERATE_TRANSLATE,
+            draw_generate_random(&state->random, 2 * GENERATE_TRANSLATE + 1) -
+                GENERATE_TRANSLATE);
+  if (draw_generate_random(&state->random, 100) < rate) {
+    // The flips are drawn as often as ten angles each.
+    int rotate = draw_generate_random(&state->random, 380);
+    if (rotate < 360)
+      fprintf(file, " rotate=\"%d\"", rotate);
+    else
+      fprintf(file, " rotate=\"%s\"", (rotate < 370) ? "X" : "Y");
+  }
+}
+
+void write_generate_points(FILE *file, generate_state_t *state,
+                           unsigned int count) {
+  int viewport = state->config->viewport;
+  for (unsigned int i = 0; i < count; i++)
+    fprintf(file, "%s%d %d", (i > 0) ? " " : "",
+            draw_generate_random(&state->random, viewport),
+            draw_generate_random(&state->random, viewport));
+}
+
+void write_generate_path(FILE *file, generate_state_t *state) {
+  generate_config_t *config = state->config;
+  unsigned long weights = 0;
+  for (int i = 0; i < GENERATE_PATH_ELEMENT_COUNT; i++)
+    weights += config->path_weights[i];
+
+  fprintf(file, "M ");
+  write_generate_points(file, state, 1);
+  for (unsigned int i = 0; i < config->elements; i++) {
+    unsigned long drawn = next_generate_random(&state->random) % weights;
+    int element = 0;
+    while (drawn >= config->path_weights[element])
+      drawn -= config->path_weights[element++];
+    fprintf(file, " %s", GENERATE_PATH_ELEMENTS[element]);
+    switch (GENERATE_PATH_ELEMENTS[element][0]) {
+    case 'H':
+    case 'V':
+      fprintf(file, " %d",
+              draw_generate_random(&state->random, config->viewport));
+      break;
+    case 'C':
+      fprintf(file, " ");
+      write_generate_points(file, state, 3);
+      break;
+    case 'S':
+    case 'Q':
+      fprintf(file, " ");
+      write_generate_points(file, state, 2);
+      break;
+    case 'Z':
+      break;
+    default:
+      fprintf(file, " ");
+      write_generate_points(file, state, 1);
+      break;
+    }
+  }
+  // The parser expects the data to end with a close, as in the examples.
+  fprintf(file, " Z");
+}
+
+void write_generate_shape(FILE *file, generate_state_t *state, int variant,
+                          unsigned int depth) {
+  generate_config_t *config = state->config;
+  fprintf(file, "%*s<%s", (depth + 1) * 2, "",
+          GENERATE_VARIANT_NAMES[variant]);
+  write_generate_styles(file, state);
+  switch (variant) {
+  case ELLIPSE:
+  case RECTANGLE:
+    fprintf(file, " x=\"%d\" y=\"%d\" width=\"%d\" height=\"%d\"",
+            draw_generate_random(&state->random, config->viewport),
+            draw_generate_random(&state->random, config->viewport),
+            draw_generate_random(&state->random, GENERATE_SIZE) + 1,
+            draw_generate_random(&state->random, GENERATE_SIZE) + 1);
+    break;
+  case LINE:
+    fprintf(file, " start=\"");
+    write_generate_points(file, state, 1);
+    fprintf(file, "\" end=\"");
+    write_generate_points(file, state, 1);
+    fprintf(file, "\"");
+    break;
+  case MULTILINE:
+  case POLYGON:
+    fprintf(file, " points=\"");
+    write_generate_points(file, state, config->points);
+    fprintf(file, "\"");
+    break;
+  case PATH:
+    fprintf(file, " data=\"");
+    write_generate_path(file, state);
+    fprintf(file, "\"");
+    break;
+  case GROUP:
+    fprintf(file, ">\n");
+    for (unsigned int i = 0; depth < config->depth && i < config->group_size;
+         i++) {
+      int child = draw_generate_variant(state, depth + 1);
+      if (child < 0)
+        break;
+      write_generate_shape(file, state, child, depth + 1);
+    }
+    fprintf(file, "%*s</group>\n", (depth + 1) * 2, "");
+    return;
+  }
+  fprintf(file, "/>\n");
+}
+
+bool generate_svg(FILE *file, generate_config_t *config) {
+  generate_state_t state = {.config = config, .random = config->seed};
+  state.total = 0;
+  for (int i = 0; i < GENERATE_VARIANT_COUNT; i++) {
+    state.remaining[i] = config->counts[i];
+    state.total += config->counts[i];
+  }
+
+  fprintf(file, "<svg viewport=\"0 0 %u %u\">\n", config->viewport,
+          config->viewport);
+  // The groups are always allowed at the top, so every shape gets written.
+  int variant;
+  while ((variant = draw_generate_variant(&state, 0)) >= 0)
+    write_generate_shape(file, &state, variant, 0);
+  fprintf(file, "</svg>\n");
+  return !ferror(file);
+}
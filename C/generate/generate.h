@@ -0,0 +1,181 @@
+#ifndef CODA_GENERATE
+#define CODA_GENERATE
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define GENERATE_VARIANT_COUNT 7
+#define GENERATE_PATH_ELEMENT_COUNT 9
+
+/**
+ * Defines the generator config type, describing a synthetic svg file.
+ * @param counts        the number of shapes of each variant, groups and their
+ * children included, indexed by shape_variants_t.
+ * @param group_size    the number of shapes of each group.
+ * @param depth         the maximum nesting of the groups, 0 for empty groups.
+ * @param points        the number of points of the multilines and polygons.
+ * @param elements      the number of elements of the paths.
+ * @param path_weights  the relative frequency of each path element, in the
+ * order of GENERATE_PATH_ELEMENTS.
+ * @param style_rate    the percentage of the style attributes written down.
+ * @param palette       the number of distinct colors, 0 for random colors.
+ * @param viewport      the width and height of the svg's viewport.
+ * @param seed          the seed of the random numbers.
+ */
+typedef struct generate_config_s {
+  unsigned long counts[GENERATE_VARIANT_COUNT];
+  unsigned int group_size;
+  unsigned int depth;
+  unsigned int points;
+  unsigned int elements;
+  unsigned long path_weights[GENERATE_PATH_ELEMENT_COUNT];
+  unsigned int style_rate;
+  unsigned int palette;
+  unsigned int viewport;
+  uint64_t seed;
+} generate_config_t;
+
+/**
+ * Defines the generator state type, the progress of a generated file.
+ * @param config    the generator config.
+ * @param random    the state of the random numbers.
+ * @param remaining the number of shapes of each variant left to write down.
+ * @param total     the number of shapes left to write down.
+ * @see generate_config_t.
+ */
+typedef struct generate_state_s {
+  generate_config_t *config;
+  uint64_t random;
+  unsigned long remaining[GENERATE_VARIANT_COUNT];
+  unsigned long total;
+} generate_state_t;
+
+/**
+ * Displays the generator options.
+ */
+void generate_print_usage();
+
+/**
+ * Reads a `name=value,...` list of values, the names left out having a value
+ * of 0.
+ * @param list   the list.
+ * @param names  the names of the values.
+ * @param count  the number of names.
+ * @param values the values to set, in the order of the names.
+ * @return returns true if the list is valid and has a value other than 0.
+ */
+bool generate_parse_values(char *list, const char **names, int count,
+                           unsigned long *values);
+
+/**
+ * Reads the options of the generator and moves its other arguments to the
+ * front of the given arguments.
+ * The options are:
+ * - --shapes <count> : the number of shapes, groups and their children
+ * included.
+ * - --mix <name=weight,...> : the relative frequency of the shape variants,
+ * named as in the svg files.
+ * - --counts <name=count,...> : the number of shapes of each variant,
+ * replacing --shapes and --mix.
+ * - --group-size <count> : the number of shapes of each group.
+ * - --depth <count> : the maximum nesting of the groups.
+ * - --points <count> : the number of points of the multilines and polygons.
+ * - --elements <count> : the number of elements of the paths.
+ * - --path-mix <letter=weight,...> : the relative frequency of the path
+ * elements.
+ * - --style-rate <percent> : the percentage of the style attributes written
+ * down.
+ * - --palette <count> : the number of distinct colors, 0 for random colors.
+ * - --viewport <size> : the width and height of the viewport.
+ * - --seed <number> : the seed of the random numbers.
+ * @param argc   the number of arguments.
+ * @param argv   the arguments.
+ * @param config the config to set.
+ * @return the number of other arguments, -1 if an option is invalid.
+ * @see generate_config_t.
+ */
+int generate_parse_options(int argc, char **argv, generate_config_t *config);
+
+/**
+ * Draws the next number of the given generator, a splitmix generator.
+ * @param random a pointer to the generator's state.
+ * @return the drawn number.
+ */
+uint64_t next_generate_random(uint64_t *random);
+
+/**
+ * Draws a number between 0 and the given bound excluded.
+ * @param random a pointer to the generator's state.
+ * @param bound  the bound, greater than 0.
+ * @return the drawn number.
+ * @see next_generate_random.
+ */
+int draw_generate_random(uint64_t *random, int bound);
+
+/**
+ * Draws the variant of the next shape among the shapes left, the variants
+ * being drawn as often as they remain.
+ * @param state the generator state.
+ * @param depth the number of groups around the shape.
+ * @return the shape's variant, -1 if no shape can be written down at this
+ * depth.
+ * @see generate_state_t.
+ */
+int draw_generate_variant(generate_state_t *state, unsigned int depth);
+
+/**
+ * Writes down a color, drawn from the config's palette if it has one.
+ * @param file  an opened file in writing mode.
+ * @param state the generator state.
+ */
+void write_generate_color(FILE *file, generate_state_t *state);
+
+/**
+ * Writes down random styles, each style being written down at the config's
+ * rate.
+ * @param file  an opened file in writing mode.
+ * @param state the generator state.
+ */
+void write_generate_styles(FILE *file, generate_state_t *state);
+
+/**
+ * Writes down the given number of random points.
+ * @param file  an opened file in writing mode.
+ * @param state the generator state.
+ * @param count the number of points.
+ */
+void write_generate_points(FILE *file, generate_state_t *state,
+                           unsigned int count);
+
+/**
+ * Writes down the elements of a random path, starting with a move and
+ * ending with a close.
+ * @param file  an opened file in writing mode.
+ * @param state the generator state.
+ */
+void write_generate_path(FILE *file, generate_state_t *state);
+
+/**
+ * Writes down a random shape of the given variant, with its children if it
+ * is a group.
+ * @param file    an opened file in writing mode.
+ * @param state   the generator state.
+ * @param variant the shape's variant.
+ * @param depth   the number of groups around the shape.
+ * @see draw_generate_variant.
+ */
+void write_generate_shape(FILE *file, generate_state_t *state, int variant,
+                          unsigned int depth);
+
+/**
+ * Writes down the svg file described by the given config.
+ * The same config always writes down the same file.
+ * @param file   an opened file in writing mode.
+ * @param config the generator config.
+ * @return returns true if the file was written.
+ * @see generate_config_t.
+ */
+bool generate_svg(FILE *file, generate_config_t *config);
+
+#endif
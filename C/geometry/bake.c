@@ -0,0 +1,238 @@
+#include "bake.h"
+#include "../models/shapes/ellipse.h"
+#include "../models/shapes/line.h"
+#include "../models/shapes/multiline.h"
+#include "../models/shapes/path/path.h"
+#include "../models/shapes/polygon.h"
+#include "../models/shapes/rectangle.h"
+#include "../models/shapes/shape.h"
+#include "../models/shapes/svg.h"
+#include "../models/styles/color.h"
+#include "../models/styles/rotate.h"
+#include "../models/styles/style.h"
+#include "../models/utils/affine.h"
+#include "../models/utils/point.h"
+#include "transform.h"
+#include "vector.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define PI 3.14159265358979323846
+
+int get_affine_angle(affine_t *affine) {
+  int degrees = (int)lround(atan2(affine->b, affine->a) * 180 / PI);
+  return (degrees + 360) % 360;
+}
+
+point_t *bake_point(affine_t *affine, int x, int y) {
+  vector_t point = apply_affine(affine, (vector_t){.x = x, .y = y});
+  return new_point((int)lround(point.x), (int)lround(point.y));
+}
+
+point_node_t *bake_points(affine_t *affine, point_node_t *points) {
+  point_node_t *baked = NULL, *last = NULL;
+  for (point_node_t *node = points; node != NULL; node = node->next) {
+    point_t *point = bake_point(affine, node->point->x, node->point->y);
+    if (last == NULL) {
+      baked = push_point_node(NULL, point);
+      last = baked;
+    } else {
+      push_point_node(last, point);
+      last = last->next;
+    }
+  }
+  return baked;
+}
+
+path_element_node_t *bake_path(affine_t *affine, path_t *path) {
+  path_element_node_t *baked = NULL, *last = NULL;
+  point_t current = {.x = 0, .y = 0}, start = {.x = 0, .y = 0};
+  for (path_element_node_t *node = path; node != NULL; node = node->next) {
+    path_element_union_t *value = node->element->path_element;
+    path_element_t *element = NULL;
+
+    switch (node->element->path_element_variant) {
+    case MOVE_TO:
+      element = new_move_to(
+          bake_point(affine, value->move_to->x, value->move_to->y));
+      current = *value->move_to;
+      start = current;
+      break;
+    case LINE_TO:
+      element = new_line_to(
+          bake_point(affine, value->line_to->x, value->line_to->y));
+      current = *value->line_to;
+      break;
+    case HORIZONTAL_LINE_TO:
+      current.x = value->horizontal_line_to;
+      element = new_line_to(bake_point(affine, current.x, current.y));
+      break;
+    case VERTICAL_LINE_TO:
+      current.y = value->vertical_line_to;
+      element = new_line_to(bake_point(affine, current.x, current.y));
+      break;
+    case END_PATH:
+      element = new_end_path();
+      current = start;
+      break;
+    case CUBIC_CURVE_TO:
+      element = new_cubic_curve_to(
+          bake_point(affine, value->cubic_curve_to->control_point_1->x,
+                     value->cubic_curve_to->control_point_1->y),
+          bake_point(affine, value->cubic_curve_to->control_point_2->x,
+                     value->cubic_curve_to->control_point_2->y),
+          bake_point(affine, value->cubic_curve_to->end->x,
+                     value->cubic_curve_to->end->y));
+      current = *value->cubic_curve_to->end;
+      break;
+    case CUBIC_CURVE_TO_SHORTHAND:
+      element = new_cubic_curve_to_shorthand(
+          bake_point(affine, value->shorthand_cubic_curve_to->control_point->x,
+                     value->shorthand_cubic_curve_to->control_point->y),
+          bake_point(affine, value->shorthand_cubic_curve_to->end->x,
+                     value->shorthand_cubic_curve_to->end->y));
+      current = *value->shorthand_cubic_curve_to->end;
+      break;
+    case QUADRATIC_CURVE_TO:
+      element = new_quadratic_curve_to(
+          bake_point(affine, value->quadratic_curve_to->control_point->x,
+                     value->quadratic_curve_to->control_point->y),
+          bake_point(affine, value->quadratic_curve_to->end->x,
+                     value->quadratic_curve_to->end->y));
+      current = *value->quadratic_curve_to->end;
+      break;
+    case QUADRATIC_CURVE_TO_SHORTHAND:
+      element = new_quadratic_curve_to_shorthand(
+          bake_point(affine, value->shorthand_quadratic_curve_to->x,
+                     value->shorthand_quadratic_curve_to->y));
+      current = *value->shorthand_quadratic_curve_to;
+      break;
+    }
+
+    // Appends after the last node to avoid walking the whole list each time.
+    if (last == NULL) {
+      baked = push_path_element_node(NULL, element);
+      last = baked;
+    } else {
+      push_path_element_node(last, element);
+      last = last->next;
+    }
+  }
+  return baked;
+}
+
+style_t *bake_styles(style_t *styles) {
+  return new_style(clone_color(styles->fill), clone_color(styles->outline),
+                   new_point(0, 0), new_circular(0));
+}
+
+shape_t *bake_ellipse(ellipse_t *ellipse, style_t *styles, affine_t *world) {
+  int angle = get_affine_angle(world);
+  int radius_x = abs(ellipse->radius_x), radius_y = abs(ellipse->radius_y);
+  point_t *center = bake_point(world, ellipse->center_x, ellipse->center_y);
+  shape_t *shape;
+
+  if (angle % 90 == 0) {
+    shape = (angle % 180 == 0)
+                ? new_ellipse(center->x, center->y, radius_x, radius_y,
+                              bake_styles(styles))
+                : new_ellipse(center->x, center->y, radius_y, radius_x,
+                              bake_styles(styles));
+    free_point(center);
+    return shape;
+  }
+
+  return new_ellipse(0, 0, radius_x, radius_y,
+                     new_style(clone_color(styles->fill),
+                               clone_color(styles->outline), center,
+                               new_circular(angle)));
+}
+
+shape_t *bake_rectangle(rectangle_t *rectangle, style_t *styles,
+                        affine_t *world) {
+  int x = rectangle->x, y = rectangle->y;
+  int width = rectangle->width, height = rectangle->height;
+
+  if (get_affine_angle(world) % 90 != 0) {
+    point_node_t *corners = NULL;
+    corners = push_point_node(corners, bake_point(world, x, y));
+    corners = push_point_node(corners, bake_point(world, x + width, y));
+    corners =
+        push_point_node(corners, bake_point(world, x + width, y + height));
+    corners = push_point_node(corners, bake_point(world, x, y + height));
+    return new_polygon(corners, bake_styles(styles));
+  }
+
+  point_t *start = bake_point(world, x, y);
+  point_t *end = bake_point(world, x + width, y + height);
+  shape_t *shape = new_rectangle(
+      (start->x < end->x) ? start->x : end->x,
+      (start->y < end->y) ? start->y : end->y, abs(end->x - start->x),
+      abs(end->y - start->y), bake_styles(styles));
+  free_point(start);
+  free_point(end);
+  return shape;
+}
+
+shape_t *bake_shape(shape_t *shape, affine_t *world) {
+  line_t *line;
+
+  switch (shape->shape_variant) {
+  case ELLIPSE:
+    return bake_ellipse(shape->shape->ellipse, shape->styles, world);
+  case RECTANGLE:
+    return bake_rectangle(shape->shape->rectangle, shape->styles, world);
+  case LINE:
+    line = shape->shape->line;
+    return new_line(bake_point(world, line->start->x, line->start->y),
+                    bake_point(world, line->end->x, line->end->y),
+                    bake_styles(shape->styles));
+  case MULTILINE:
+    return new_multiline(bake_points(world, shape->shape->multiline),
+                         bake_styles(shape->styles));
+  case POLYGON:
+    return new_polygon(bake_points(world, shape->shape->polygon),
+                       bake_styles(shape->styles));
+  case PATH:
+    return new_path(bake_path(world, shape->shape->path),
+                    bake_styles(shape->styles));
+  case GROUP:
+    break;
+  }
+  return NULL;
+}
+
+void bake_shapes(shape_node_t *shapes, affine_t *parent, shape_node_t **baked,
+                 shape_node_t **last) {
+  for (shape_node_t *node = shapes; node != NULL; node = node->next) {
+    affine_t *world = get_world_transform(node->shape, parent);
+    if (node->shape->shape_variant == GROUP) {
+      bake_shapes(node->shape->shape->group, world, baked, last);
+      continue;
+    }
+
+    shape_t *shape = bake_shape(node->shape, world);
+    if (*last == NULL) {
+      *baked = push_shape_node(NULL, shape);
+      *last = *baked;
+    } else {
+      push_shape_node(*last, shape);
+      *last = (*last)->next;
+    }
+  }
+}
+
+shape_node_t *bake_svg_shapes(svg_t *svg) {
+  shape_node_t *baked = NULL, *last = NULL;
+  bake_shapes(svg->shapes, NULL, &baked, &last);
+  return baked;
+}
+
+void free_baked_shapes(shape_node_t *shapes) {
+  while (shapes != NULL) {
+    shape_node_t *next = shapes->next;
+    free_shape(shapes->shape);
+    free(shapes);
+    shapes = next;
+  }
+}
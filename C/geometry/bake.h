@@ -0,0 +1,146 @@
+#ifndef CODA_BAKE
+#define CODA_BAKE
+
+#include "../models/shapes/path/path.h"
+#include "../models/shapes/shape.h"
+#include "../models/shapes/svg.h"
+#include "../models/styles/style.h"
+#include "../models/utils/affine.h"
+#include "../models/utils/point.h"
+
+/**
+ * Computes the rotation angle of the given transformation in degrees.
+ * Mirrored transformations return the angle of their first axis, which is
+ * enough for the shapes symmetric along their own axes.
+ * @param affine the transformation.
+ * @return the angle in degrees, between 0 and 359.
+ * @see affine_t.
+ */
+int get_affine_angle(affine_t *affine);
+
+/**
+ * Creates a new point by transforming the given coordinates.
+ * The transformed coordinates are rounded to the nearest integers.
+ * Note that this function allocates memory.
+ * @param affine the transformation.
+ * @param x      the point's X coordinate.
+ * @param y      the point's Y coordinate.
+ * @return the new point's pointer.
+ * @see affine_t.
+ * @see point_t.
+ */
+point_t *bake_point(affine_t *affine, int x, int y);
+
+/**
+ * Creates a new point linked list by transforming the given points.
+ * Note that this function allocates memory.
+ * @param affine the transformation.
+ * @param points the point linked list.
+ * @return the new point linked list.
+ * @see bake_point.
+ * @see point_node_t.
+ */
+point_node_t *bake_points(affine_t *affine, point_node_t *points);
+
+/**
+ * Creates a new path by transforming the given path's points.
+ * The horizontal and vertical lines are turned into lines since they may no
+ * longer be axis-aligned. The shorthand curves are kept as is since the
+ * reflection of their control point is preserved by affine transformations.
+ * Note that this function allocates memory.
+ * @param affine the transformation.
+ * @param path   the path.
+ * @return the new path elements linked list.
+ * @see path_t.
+ */
+path_element_node_t *bake_path(affine_t *affine, path_t *path);
+
+/**
+ * Creates a copy of the given styles without their translate and rotate
+ * transformations.
+ * Note that this function allocates memory.
+ * @param styles the styles.
+ * @return the new styles' pointer.
+ * @see style_t.
+ */
+style_t *bake_styles(style_t *styles);
+
+/**
+ * Creates a new ellipse holding the given ellipse once transformed.
+ * Note that this function allocates memory.
+ * @param ellipse the ellipse.
+ * @param styles  the ellipse's styles.
+ * @param world   the ellipse's world transformation.
+ * @return the new shape's pointer.
+ * @see bake_shape.
+ * @see ellipse_t.
+ */
+shape_t *bake_ellipse(ellipse_t *ellipse, style_t *styles, affine_t *world);
+
+/**
+ * Creates a new rectangle, or a polygon when the rectangle is no longer
+ * axis-aligned, holding the given rectangle once transformed.
+ * Note that this function allocates memory.
+ * @param rectangle the rectangle.
+ * @param styles    the rectangle's styles.
+ * @param world     the rectangle's world transformation.
+ * @return the new shape's pointer.
+ * @see bake_shape.
+ * @see rectangle_t.
+ */
+shape_t *bake_rectangle(rectangle_t *rectangle, style_t *styles,
+                        affine_t *world);
+
+/**
+ * Creates a new shape holding the given shape's geometry once transformed by
+ * the given transformation, with no transformation of its own.
+ * Rectangles rotated by an angle which is not a multiple of 90 degrees become
+ * polygons. Such ellipses are centered on their translation and keep the
+ * rotation since the format has no other way to describe them.
+ * Note that this function allocates memory.
+ * @param shape the shape, which must not be a group.
+ * @param world the shape's world transformation.
+ * @return the new shape's pointer, NULL for groups.
+ * @see get_world_transform.
+ * @see shape_t.
+ */
+shape_t *bake_shape(shape_t *shape, affine_t *world);
+
+/**
+ * Appends the baked copies of the given shapes to the given linked list,
+ * collapsing the groups into their shapes.
+ * The groups only contribute their transformation since every shape holds its
+ * own fill and outline colors.
+ * Note that this function allocates memory.
+ * @param shapes the shape linked list.
+ * @param parent the world transformation of the group containing the shapes,
+ * or NULL for the svg's shapes.
+ * @param baked  a pointer to the baked shape linked list, set when it is
+ * created.
+ * @param last   a pointer to the baked shape linked list's last node.
+ * @see bake_shape.
+ * @see shape_node_t.
+ */
+void bake_shapes(shape_node_t *shapes, affine_t *parent, shape_node_t **baked,
+                 shape_node_t **last);
+
+/**
+ * Creates a flat copy of the given svg's shapes, with their world
+ * transformations baked into their coordinates.
+ * Note that this function allocates memory.
+ * @param svg the svg.
+ * @return the baked shape linked list.
+ * @see bake_shapes.
+ * @see svg_t.
+ */
+shape_node_t *bake_svg_shapes(svg_t *svg);
+
+/**
+ * Destroys the given baked shape linked list and its shapes.
+ * Note that this function frees memory.
+ * @param shapes the baked shape linked list.
+ * @see bake_svg_shapes.
+ */
+void free_baked_shapes(shape_node_t *shapes);
+
+#endif
@@ -0,0 +1,138 @@
+#include "bounds.h"
+#include "../models/shapes/shape.h"
+#include "../models/shapes/svg.h"
+#include "../models/styles/style.h"
+#include "../models/utils/affine.h"
+#include "../models/utils/bbox.h"
+#include "segment.h"
+#include "transform.h"
+#include "vector.h"
+#include <math.h>
+#include <stdlib.h>
+
+bbox_t *compute_ellipse_bbox(ellipse_t *ellipse, affine_t *affine) {
+  vector_t center = apply_affine(
+      affine, (vector_t){.x = ellipse->center_x, .y = ellipse->center_y});
+  double radius_x = abs(ellipse->radius_x);
+  double radius_y = abs(ellipse->radius_y);
+  double half_width =
+      sqrt(pow(affine->a * radius_x, 2) + pow(affine->c * radius_y, 2));
+  double half_height =
+      sqrt(pow(affine->b * radius_x, 2) + pow(affine->d * radius_y, 2));
+  return new_bbox(center.x - half_width, center.y - half_height,
+                  center.x + half_width, center.y + half_height);
+}
+
+bbox_t *compute_points_bbox(point_node_t *points, affine_t *affine) {
+  bbox_t *bbox = new_empty_bbox();
+  for (point_node_t *node = points; node != NULL; node = node->next)
+    extend_bbox_transformed(bbox, affine, node->point->x, node->point->y);
+  return bbox;
+}
+
+void visit_path_bbox_segment(segment_t *segment, void *context) {
+  path_bbox_context_t *state = context;
+  segment_t transformed = *segment;
+  transformed.start = apply_affine(state->affine, segment->start);
+  transformed.control_1 = apply_affine(state->affine, segment->control_1);
+  transformed.control_2 = apply_affine(state->affine, segment->control_2);
+  transformed.end = apply_affine(state->affine, segment->end);
+
+  extend_bbox(state->bbox, transformed.start.x, transformed.start.y);
+  extend_bbox(state->bbox, transformed.end.x, transformed.end.y);
+
+  double parameters[4];
+  int count = get_segment_extrema(&transformed, parameters);
+  for (int i = 0; i < count; i++) {
+    vector_t point = get_segment_point(&transformed, parameters[i]);
+    extend_bbox(state->bbox, point.x, point.y);
+  }
+}
+
+bbox_t *compute_path_bbox(path_t *path, affine_t *affine) {
+  path_bbox_context_t context = {.affine = affine, .bbox = new_empty_bbox()};
+  walk_path_segments(path, visit_path_bbox_segment, &context);
+  return context.bbox;
+}
+
+bbox_t *compute_group_bbox(group_t *group, affine_t *affine) {
+  bbox_t *bbox = new_empty_bbox();
+  for (shape_node_t *node = group; node != NULL; node = node->next)
+    merge_bbox(bbox, get_shape_bbox(node->shape));
+  bbox_t *result = transform_bbox(affine, bbox);
+  free_bbox(bbox);
+  return result;
+}
+
+bbox_t *compute_transformed_bbox(shape_t *shape, affine_t *affine) {
+  bbox_t *bbox = NULL;
+  rectangle_t *rectangle;
+  line_t *line;
+
+  switch (shape->shape_variant) {
+  case ELLIPSE:
+    bbox = compute_ellipse_bbox(shape->shape->ellipse, affine);
+    break;
+  case RECTANGLE:
+    rectangle = shape->shape->rectangle;
+    bbox = new_empty_bbox();
+    extend_bbox_transformed(bbox, affine, rectangle->x, rectangle->y);
+    extend_bbox_transformed(bbox, affine, rectangle->x + rectangle->width,
+                            rectangle->y);
+    extend_bbox_transformed(bbox, affine, rectangle->x,
+                            rectangle->y + rectangle->height);
+    extend_bbox_transformed(bbox, affine, rectangle->x + rectangle->width,
+                            rectangle->y + rectangle->height);
+    break;
+  case LINE:
+    line = shape->shape->line;
+    bbox = new_empty_bbox();
+    extend_bbox_transformed(bbox, affine, line->start->x, line->start->y);
+    extend_bbox_transformed(bbox, affine, line->end->x, line->end->y);
+    break;
+  case MULTILINE:
+    bbox = compute_points_bbox(shape->shape->multiline, affine);
+    break;
+  case POLYGON:
+    bbox = compute_points_bbox(shape->shape->polygon, affine);
+    break;
+  case PATH:
+    bbox = compute_path_bbox(shape->shape->path, affine);
+    break;
+  case GROUP:
+    bbox = compute_group_bbox(shape->shape->group, affine);
+    break;
+  }
+
+  return bbox;
+}
+
+bbox_t *compute_shape_bbox(shape_t *shape) {
+  return compute_transformed_bbox(shape, get_local_transform(shape));
+}
+
+bbox_t *get_shape_bbox(shape_t *shape) {
+  if (shape->bbox == NULL)
+    shape->bbox = compute_shape_bbox(shape);
+  return shape->bbox;
+}
+
+void invalidate_shape_bbox(shape_t *shape) {
+  free_bbox(shape->bbox);
+  shape->bbox = NULL;
+}
+
+bbox_t *compute_world_bbox(shape_t *shape, affine_t *parent) {
+  if (shape->shape_variant != GROUP)
+    return compute_transformed_bbox(shape, get_world_transform(shape, parent));
+  if (parent == NULL)
+    return clone_bbox(get_shape_bbox(shape));
+  return transform_bbox(parent, get_shape_bbox(shape));
+}
+
+bbox_t *compute_svg_bbox(svg_t *svg) {
+  bbox_t *bbox = new_empty_bbox();
+  for (shape_node_t *node = svg->shapes; node != NULL; node = node->next)
+    merge_bbox(bbox, get_shape_bbox(node->shape));
+  return bbox;
+}
@@ -0,0 +1,159 @@
+#ifndef CODA_BOUNDS
+#define CODA_BOUNDS
+
+#include "../models/shapes/shape.h"
+#include "../models/shapes/svg.h"
+#include "../models/styles/style.h"
+#include "../models/utils/affine.h"
+#include "../models/utils/bbox.h"
+#include "segment.h"
+#include "vector.h"
+
+/**
+ * Holds the state of a path bounding box computation.
+ * @param affine the transformation applied to the path.
+ * @param bbox   the bounding box being computed.
+ * @see affine_t.
+ * @see bbox_t.
+ */
+typedef struct path_bbox_context_s {
+  affine_t *affine;
+  bbox_t *bbox;
+} path_bbox_context_t;
+
+/**
+ * Computes the bounding box of the given ellipse once transformed.
+ * Note that this function allocates memory.
+ * The transformed ellipse's extents are computed exactly.
+ * @param ellipse the ellipse.
+ * @param affine  the transformation applied to the ellipse.
+ * @return the new bounding box's pointer.
+ * @see ellipse_t.
+ * @see affine_t.
+ */
+bbox_t *compute_ellipse_bbox(ellipse_t *ellipse, affine_t *affine);
+
+/**
+ * Computes the bounding box of the given point linked list once transformed.
+ * Note that this function allocates memory.
+ * @param points the point linked list.
+ * @param affine the transformation applied to the points.
+ * @return the new bounding box's pointer.
+ * @see point_node_t.
+ * @see affine_t.
+ */
+bbox_t *compute_points_bbox(point_node_t *points, affine_t *affine);
+
+/**
+ * Extends the path bounding box with the given segment.
+ * The segment is transformed before its extrema are computed since curves are
+ * invariant under affine transformations.
+ * @param segment the segment.
+ * @param context the path bounding box computation's state.
+ * @see path_bbox_context_t.
+ * @see segment_t.
+ */
+void visit_path_bbox_segment(segment_t *segment, void *context);
+
+/**
+ * Computes the bounding box of the given path once transformed.
+ * Note that this function allocates memory.
+ * @param path   the path.
+ * @param affine the transformation applied to the path.
+ * @return the new bounding box's pointer.
+ * @see path_t.
+ * @see affine_t.
+ */
+bbox_t *compute_path_bbox(path_t *path, affine_t *affine);
+
+/**
+ * Computes the bounding box of the given group once transformed.
+ * Note that this function allocates memory.
+ * The group's shapes bounding boxes are retrieved from their cache.
+ * @param group  the group.
+ * @param affine the transformation applied to the group.
+ * @return the new bounding box's pointer.
+ * @see group_t.
+ * @see affine_t.
+ */
+bbox_t *compute_group_bbox(group_t *group, affine_t *affine);
+
+/**
+ * Computes the bounding box of the given shape's geometry once transformed by
+ * the given transformation, ignoring the shape's own styles.
+ * Note that this function allocates memory.
+ * The result is exact for all the shapes but groups, which contain the
+ * transformed union of their shapes bounding boxes.
+ * @param shape  the shape.
+ * @param affine the transformation applied to the shape's geometry.
+ * @return the new bounding box's pointer.
+ * @see shape_t.
+ * @see affine_t.
+ * @see bbox_t.
+ */
+bbox_t *compute_transformed_bbox(shape_t *shape, affine_t *affine);
+
+/**
+ * Computes the bounding box of the given shape.
+ * Note that this function allocates memory.
+ * The bounding box is expressed in the shape's parent coordinates system:
+ * the shape's cached local transformation is applied. Paths use the exact
+ * extrema of their curves. Groups are the union of their shapes.
+ * This function ignores the cached bounding boxes of the given shape but
+ * uses the cached bounding boxes of a group's shapes.
+ * @param shape the shape.
+ * @return the new bounding box's pointer.
+ * @see shape_t.
+ * @see bbox_t.
+ */
+bbox_t *compute_shape_bbox(shape_t *shape);
+
+/**
+ * Retrieves the bounding box of the given shape.
+ * The bounding box is computed on the first call then cached on the shape
+ * until invalidate_shape_bbox is called.
+ * Note that the returned pointer belongs to the shape and must not be freed.
+ * @param shape the shape.
+ * @return the shape's bounding box's pointer.
+ * @see compute_shape_bbox.
+ * @see shape_t.
+ * @see bbox_t.
+ */
+bbox_t *get_shape_bbox(shape_t *shape);
+
+/**
+ * Discards the cached bounding box of the given shape.
+ * This function must be called each time the shape's geometry, its styles or
+ * (for groups) its shapes are updated. Note that the groups containing the
+ * shape must be invalidated too.
+ * Note that this function frees memory.
+ * @param shape the shape.
+ * @see shape_t.
+ */
+void invalidate_shape_bbox(shape_t *shape);
+
+/**
+ * Computes the bounding box of the given shape in the svg's coordinates
+ * system, using the shape's cached world transformation.
+ * Note that this function allocates memory.
+ * @param shape  the shape.
+ * @param parent the world transformation of the group containing the shape, or
+ * NULL for the svg's shapes.
+ * @return the new bounding box's pointer.
+ * @see get_world_transform.
+ * @see shape_t.
+ * @see bbox_t.
+ */
+bbox_t *compute_world_bbox(shape_t *shape, affine_t *parent);
+
+/**
+ * Computes the bounding box of all the given svg's shapes.
+ * Note that this function allocates memory.
+ * @param svg the svg.
+ * @return the new bounding box's pointer.
+ * @see svg_t.
+ * @see bbox_t.
+ */
+bbox_t *compute_svg_bbox(svg_t *svg);
+
+#endif
@@ -0,0 +1,51 @@
+#include "cull.h"
+#include "../models/shapes/shape.h"
+#include "../models/shapes/svg.h"
+#include "../models/utils/affine.h"
+#include "../models/utils/bbox.h"
+#include "bounds.h"
+#include "transform.h"
+#include "vector.h"
+#include <stdbool.h>
+#include <stdlib.h>
+
+bbox_t *get_viewport_bbox(viewport_t *viewport) {
+  bbox_t *bbox = new_empty_bbox();
+  extend_bbox(bbox, viewport->start->x, viewport->start->y);
+  extend_bbox(bbox, viewport->end->x, viewport->end->y);
+  return bbox;
+}
+
+bbox_t *get_group_visible_area(affine_t *affine, bbox_t *area) {
+  affine_t inverse;
+  if (area == NULL)
+    return NULL;
+  if (!invert_affine(affine, &inverse))
+    return new_empty_bbox();
+  vector_t corners[4] = {{.x = area->min_x, .y = area->min_y},
+                         {.x = area->max_x, .y = area->min_y},
+                         {.x = area->min_x, .y = area->max_y},
+                         {.x = area->max_x, .y = area->max_y}};
+  bbox_t *local = new_empty_bbox();
+  for (int i = 0; i < 4; i++) {
+    vector_t corner = apply_affine(&inverse, corners[i]);
+    extend_bbox(local, corner.x, corner.y);
+  }
+  return local;
+}
+
+bool is_shape_culled(shape_t *shape, bbox_t *area) {
+  if (area == NULL)
+    return false;
+  bbox_t *bbox = get_shape_bbox(shape);
+  return is_bbox_empty(bbox) || !bbox_intersects(bbox, area);
+}
+
+unsigned int count_shapes(shape_t *shape) {
+  unsigned int count = 1;
+  if (shape->shape_variant == GROUP)
+    for (shape_node_t *node = shape->shape->group; node != NULL;
+         node = node->next)
+      count += count_shapes(node->shape);
+  return count;
+}
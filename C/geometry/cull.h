@@ -0,0 +1,53 @@
+#ifndef CODA_CULL
+#define CODA_CULL
+
+#include "../models/shapes/shape.h"
+#include "../models/shapes/svg.h"
+#include "../models/utils/affine.h"
+#include "../models/utils/bbox.h"
+#include <stdbool.h>
+
+/**
+ * Computes the bounding box of the given viewport.
+ * Note that this function allocates memory.
+ * @param viewport the viewport.
+ * @return the new bounding box's pointer.
+ * @see viewport_t.
+ * @see bbox_t.
+ */
+bbox_t *get_viewport_bbox(viewport_t *viewport);
+
+/**
+ * Expresses the given visible area in the coordinates system of the shapes of
+ * a group with the given local transformation.
+ * The result contains the exact area when the group is rotated.
+ * Note that this function allocates memory.
+ * @param affine the group's local transformation.
+ * @param area   the visible area in the group's parent coordinates system, or
+ * NULL when culling is disabled.
+ * @return the new bounding box's pointer, NULL if the area is NULL.
+ * @see get_local_transform.
+ * @see bbox_t.
+ */
+bbox_t *get_group_visible_area(affine_t *affine, bbox_t *area);
+
+/**
+ * Tests if the given shape lies completely outside the given visible area.
+ * @param shape the shape.
+ * @param area  the visible area in the shape's parent coordinates system, or
+ * NULL when culling is disabled.
+ * @return true if the shape can be skipped, false otherwise.
+ * @see shape_t.
+ * @see bbox_t.
+ */
+bool is_shape_culled(shape_t *shape, bbox_t *area);
+
+/**
+ * Counts the given shape and, for groups, all the shapes it contains.
+ * @param shape the shape.
+ * @return the number of shapes.
+ * @see shape_t.
+ */
+unsigned int count_shapes(shape_t *shape);
+
+#endif
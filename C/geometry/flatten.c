@@ -0,0 +1,121 @@
+#include "flatten.h"
+#include "../models/shapes/path/path.h"
+#include "../models/utils/point.h"
+#include "segment.h"
+#include "vector.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define POLYLINE_INITIAL_CAPACITY 8
+#define MAX_SUBDIVISIONS 1024
+
+void push_polyline_point(polyline_t *polyline, vector_t point) {
+  if (polyline->count == polyline->capacity) {
+    polyline->capacity = (polyline->capacity == 0) ? POLYLINE_INITIAL_CAPACITY
+                                                   : polyline->capacity * 2;
+    polyline->points =
+        realloc(polyline->points, sizeof(vector_t) * polyline->capacity);
+  }
+  polyline->points[polyline->count++] = point;
+}
+
+void push_polyline_points(polyline_t *polyline, point_node_t *points) {
+  for (point_node_t *node = points; node != NULL; node = node->next)
+    push_polyline_point(polyline,
+                        (vector_t){.x = node->point->x, .y = node->point->y});
+}
+
+polyline_list_t *new_polyline_list() {
+  polyline_list_t *list = malloc(sizeof(polyline_list_t));
+  list->polylines = NULL;
+  list->count = 0;
+  list->capacity = 0;
+  return list;
+}
+
+polyline_t *push_polyline(polyline_list_t *list) {
+  if (list->count == list->capacity) {
+    list->capacity = (list->capacity == 0) ? POLYLINE_INITIAL_CAPACITY
+                                           : list->capacity * 2;
+    list->polylines =
+        realloc(list->polylines, sizeof(polyline_t) * list->capacity);
+  }
+  polyline_t *polyline = &list->polylines[list->count++];
+  polyline->points = NULL;
+  polyline->count = 0;
+  polyline->capacity = 0;
+  polyline->closed = false;
+  return polyline;
+}
+
+void free_polyline_list(polyline_list_t *list) {
+  for (int i = 0; i < list->count; i++)
+    free(list->polylines[i].points);
+  free(list->polylines);
+  free(list);
+}
+
+int get_segment_subdivisions(segment_t *segment, double tolerance) {
+  double second_difference, factor;
+  switch (segment->variant) {
+  case SEGMENT_QUADRATIC:
+    second_difference =
+        hypot(segment->start.x - 2 * segment->control_1.x + segment->end.x,
+              segment->start.y - 2 * segment->control_1.y + segment->end.y);
+    factor = 0.25;
+    break;
+  case SEGMENT_CUBIC:
+    second_difference = fmax(
+        hypot(segment->start.x - 2 * segment->control_1.x +
+                  segment->control_2.x,
+              segment->start.y - 2 * segment->control_1.y +
+                  segment->control_2.y),
+        hypot(segment->control_1.x - 2 * segment->control_2.x + segment->end.x,
+              segment->control_1.y - 2 * segment->control_2.y +
+                  segment->end.y));
+    factor = 0.75;
+    break;
+  case SEGMENT_LINE:
+  default:
+    return 1;
+  }
+
+  if (tolerance <= 0)
+    tolerance = 1e-3;
+  int subdivisions = (int)ceil(sqrt(factor * second_difference / tolerance));
+  if (subdivisions > MAX_SUBDIVISIONS)
+    return MAX_SUBDIVISIONS;
+  return (subdivisions < 1) ? 1 : subdivisions;
+}
+
+void flatten_segment(segment_t *segment, double tolerance,
+                     polyline_t *polyline) {
+  int subdivisions = get_segment_subdivisions(segment, tolerance);
+  for (int i = 1; i < subdivisions; i++)
+    push_polyline_point(polyline,
+                        get_segment_point(segment, (double)i / subdivisions));
+  push_polyline_point(polyline, segment->end);
+}
+
+void visit_flatten_segment(segment_t *segment, void *context) {
+  flatten_context_t *state = context;
+  polyline_list_t *list = state->list;
+  if (segment->starts_subpath || list->count == 0) {
+    polyline_t *polyline = push_polyline(list);
+    push_polyline_point(polyline, segment->start);
+  }
+
+  polyline_t *polyline = &list->polylines[list->count - 1];
+  if (segment->closes_subpath) {
+    polyline->closed = true;
+    return;
+  }
+  flatten_segment(segment, state->tolerance, polyline);
+}
+
+polyline_list_t *flatten_path(path_t *path, double tolerance) {
+  flatten_context_t context = {.list = new_polyline_list(),
+                               .tolerance = tolerance};
+  walk_path_segments(path, visit_flatten_segment, &context);
+  return context.list;
+}
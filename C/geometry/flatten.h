@@ -0,0 +1,139 @@
+#ifndef CODA_FLATTEN
+#define CODA_FLATTEN
+
+#include "../models/shapes/path/path.h"
+#include "../models/utils/point.h"
+#include "segment.h"
+#include "vector.h"
+#include <stdbool.h>
+
+/**
+ * Represents a polyline, i.e. a sequence of points joined by straight lines.
+ * @param points   the polyline's points.
+ * @param count    the number of points.
+ * @param capacity the points array's capacity.
+ * @param closed   indicates if the last point is joined back to the first.
+ * @see vector_t.
+ */
+typedef struct polyline_s {
+  vector_t *points;
+  int count;
+  int capacity;
+  bool closed;
+} polyline_t;
+
+/**
+ * Represents a list of polylines, e.g. the subpaths of a flattened path.
+ * @param polylines the polylines.
+ * @param count     the number of polylines.
+ * @param capacity  the polylines array's capacity.
+ * @see polyline_t.
+ */
+typedef struct polyline_list_s {
+  polyline_t *polylines;
+  int count;
+  int capacity;
+} polyline_list_t;
+
+/**
+ * Holds the state of a path flattening.
+ * @param list      the polylines being built.
+ * @param tolerance the flattening tolerance.
+ * @see polyline_list_t.
+ */
+typedef struct flatten_context_s {
+  polyline_list_t *list;
+  double tolerance;
+} flatten_context_t;
+
+/**
+ * Appends the given point to the given polyline.
+ * Note that this function may allocate memory.
+ * @param polyline the polyline.
+ * @param point    the point to append.
+ * @see polyline_t.
+ */
+void push_polyline_point(polyline_t *polyline, vector_t point);
+
+/**
+ * Appends the points of the given point linked list to the given polyline.
+ * Note that this function may allocate memory.
+ * @param polyline the polyline.
+ * @param points   the point linked list.
+ * @see polyline_t.
+ * @see point_node_t.
+ */
+void push_polyline_points(polyline_t *polyline, point_node_t *points);
+
+/**
+ * Creates a new empty polyline list.
+ * Note that this function allocates memory.
+ * @return the new polyline list's pointer.
+ * @see polyline_list_t.
+ */
+polyline_list_t *new_polyline_list();
+
+/**
+ * Appends a new empty polyline to the given polyline list.
+ * Note that this function may allocate memory.
+ * Note that the returned pointer is invalidated by the next append.
+ * @param list the polyline list.
+ * @return the new polyline's pointer.
+ * @see polyline_list_t.
+ */
+polyline_t *push_polyline(polyline_list_t *list);
+
+/**
+ * Destroys the given polyline list and its polylines.
+ * Note that this function frees memory.
+ * @param list the polyline list to be destroyed.
+ * @see polyline_list_t.
+ */
+void free_polyline_list(polyline_list_t *list);
+
+/**
+ * Computes the number of lines needed to approximate the given segment
+ * within the given tolerance, using Wang's formula.
+ * @param segment   the segment.
+ * @param tolerance the maximum distance between the curve and the lines.
+ * @return the number of lines, at least 1 and at most 1024.
+ * @see segment_t.
+ */
+int get_segment_subdivisions(segment_t *segment, double tolerance);
+
+/**
+ * Appends the points approximating the given segment to the given polyline.
+ * The segment's start point is not appended.
+ * Note that this function may allocate memory.
+ * @param segment   the segment.
+ * @param tolerance the maximum distance between the curve and the lines.
+ * @param polyline  the polyline.
+ * @see segment_t.
+ * @see polyline_t.
+ */
+void flatten_segment(segment_t *segment, double tolerance,
+                     polyline_t *polyline);
+
+/**
+ * Appends the given segment to the last polyline of the flattening, or to a
+ * new polyline if the segment starts a subpath.
+ * Note that this function may allocate memory.
+ * @param segment the segment.
+ * @param context the path flattening's state.
+ * @see flatten_context_t.
+ * @see segment_t.
+ */
+void visit_flatten_segment(segment_t *segment, void *context);
+
+/**
+ * Approximates the given path with polylines, one per subpath.
+ * Note that this function allocates memory.
+ * @param path      the path.
+ * @param tolerance the maximum distance between the curves and the lines.
+ * @return the new polyline list's pointer.
+ * @see path_t.
+ * @see polyline_list_t.
+ */
+polyline_list_t *flatten_path(path_t *path, double tolerance);
+
+#endif
@@ -0,0 +1,208 @@
+#include "hit_test.h"
+#include "../models/shapes/shape.h"
+#include "../models/shapes/svg.h"
+#include "../models/utils/affine.h"
+#include "../models/utils/bbox.h"
+#include "bounds.h"
+#include "flatten.h"
+#include "rtree.h"
+#include "transform.h"
+#include "vector.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#define DEFAULT_TOLERANCE 1.0
+#define DEFAULT_FLATTEN_TOLERANCE 0.25
+
+hit_test_config_t *new_hit_test_config(double tolerance,
+                                       fill_rule_t fill_rule) {
+  hit_test_config_t *config = malloc(sizeof(hit_test_config_t));
+  config->tolerance = tolerance;
+  config->fill_rule = fill_rule;
+  config->flatten_tolerance = DEFAULT_FLATTEN_TOLERANCE;
+  return config;
+}
+
+void free_hit_test_config(hit_test_config_t *config) { free(config); }
+
+double get_line_distance(vector_t point, vector_t start, vector_t end) {
+  double dx = end.x - start.x, dy = end.y - start.y;
+  double length = dx * dx + dy * dy;
+  double t = 0;
+  if (length > 0) {
+    t = ((point.x - start.x) * dx + (point.y - start.y) * dy) / length;
+    t = fmax(0, fmin(1, t));
+  }
+  double x = start.x + t * dx - point.x, y = start.y + t * dy - point.y;
+  return x * x + y * y;
+}
+
+int add_polyline_winding(polyline_t *polyline, vector_t point, int winding) {
+  for (int i = 0; i < polyline->count; i++) {
+    vector_t a = polyline->points[i];
+    vector_t b = polyline->points[(i + 1) % polyline->count];
+    // Sign of the point's side relative to the edge a -> b.
+    double side = (b.x - a.x) * (point.y - a.y) - (point.x - a.x) * (b.y - a.y);
+    if (a.y <= point.y) {
+      if (b.y > point.y && side > 0)
+        winding++;
+    } else if (b.y <= point.y && side < 0)
+      winding--;
+  }
+  return winding;
+}
+
+bool is_winding_inside(int winding, fill_rule_t fill_rule) {
+  if (fill_rule == FILL_RULE_EVEN_ODD)
+    return winding % 2 != 0;
+  return winding != 0;
+}
+
+bool hit_test_polyline(polyline_t *polyline, vector_t point, double tolerance) {
+  double limit = tolerance * tolerance;
+  if (polyline->count == 1)
+    return get_line_distance(point, polyline->points[0], polyline->points[0]) <=
+           limit;
+  for (int i = 0; i + 1 < polyline->count; i++)
+    if (get_line_distance(point, polyline->points[i],
+                          polyline->points[i + 1]) <= limit)
+      return true;
+  return polyline->closed && polyline->count > 2 &&
+         get_line_distance(point, polyline->points[polyline->count - 1],
+                           polyline->points[0]) <= limit;
+}
+
+bool hit_test_polylines(polyline_list_t *list, vector_t point,
+                        hit_test_config_t *config) {
+  int winding = 0;
+  for (int i = 0; i < list->count; i++) {
+    if (hit_test_polyline(&list->polylines[i], point, config->tolerance))
+      return true;
+    winding = add_polyline_winding(&list->polylines[i], point, winding);
+  }
+  return is_winding_inside(winding, config->fill_rule);
+}
+
+bool hit_test_geometry(shape_t *shape, vector_t point,
+                       hit_test_config_t *config) {
+  ellipse_t *ellipse;
+  rectangle_t *rectangle;
+  line_t *line;
+  polyline_list_t *list;
+  polyline_t *polyline;
+  double dx, dy;
+  bool hit = false;
+
+  switch (shape->shape_variant) {
+  case ELLIPSE:
+    ellipse = shape->shape->ellipse;
+    dx = abs(ellipse->radius_x) + config->tolerance;
+    dy = abs(ellipse->radius_y) + config->tolerance;
+    if (dx <= 0 || dy <= 0)
+      return false;
+    dx = (point.x - ellipse->center_x) / dx;
+    dy = (point.y - ellipse->center_y) / dy;
+    return dx * dx + dy * dy <= 1;
+  case RECTANGLE:
+    rectangle = shape->shape->rectangle;
+    return point.x >= fmin(rectangle->x, rectangle->x + rectangle->width) -
+                          config->tolerance &&
+           point.x <= fmax(rectangle->x, rectangle->x + rectangle->width) +
+                          config->tolerance &&
+           point.y >= fmin(rectangle->y, rectangle->y + rectangle->height) -
+                          config->tolerance &&
+           point.y <= fmax(rectangle->y, rectangle->y + rectangle->height) +
+                          config->tolerance;
+  case LINE:
+    line = shape->shape->line;
+    return get_line_distance(
+               point, (vector_t){.x = line->start->x, .y = line->start->y},
+               (vector_t){.x = line->end->x, .y = line->end->y}) <=
+           config->tolerance * config->tolerance;
+  case MULTILINE:
+  case POLYGON:
+    list = new_polyline_list();
+    polyline = push_polyline(list);
+    push_polyline_points(polyline, shape->shape->multiline);
+    if (shape->shape_variant == MULTILINE)
+      hit = polyline->count > 0 &&
+            hit_test_polyline(polyline, point, config->tolerance);
+    else {
+      polyline->closed = true;
+      hit = polyline->count > 0 && hit_test_polylines(list, point, config);
+    }
+    free_polyline_list(list);
+    return hit;
+  case PATH:
+    list = flatten_path(shape->shape->path, config->flatten_tolerance);
+    hit = hit_test_polylines(list, point, config);
+    free_polyline_list(list);
+    return hit;
+  case GROUP:
+    break;
+  }
+  return false;
+}
+
+shape_t *hit_test_shape(shape_t *shape, vector_t point,
+                        hit_test_config_t *config, rtree_results_t *results) {
+  bbox_t *bbox = get_shape_bbox(shape);
+  if (is_bbox_empty(bbox) || point.x < bbox->min_x - config->tolerance ||
+      point.x > bbox->max_x + config->tolerance ||
+      point.y < bbox->min_y - config->tolerance ||
+      point.y > bbox->max_y + config->tolerance)
+    return NULL;
+
+  affine_t inverse;
+  if (!invert_affine(get_local_transform(shape), &inverse))
+    return NULL;
+  vector_t local = apply_affine(&inverse, point);
+  if (shape->shape_variant == GROUP)
+    return hit_test_shapes(shape->shape->group, local, config, results);
+  if (!hit_test_geometry(shape, local, config))
+    return NULL;
+  if (results != NULL)
+    push_rtree_result(results, shape);
+  return shape;
+}
+
+shape_t *hit_test_shapes(shape_node_t *shapes, vector_t point,
+                         hit_test_config_t *config, rtree_results_t *results) {
+  if (shapes == NULL)
+    return NULL;
+  shape_node_t *node = shapes;
+  while (node->next != NULL)
+    node = node->next;
+
+  shape_t *topmost = NULL;
+  for (; node != NULL; node = node->previous) {
+    shape_t *hit = hit_test_shape(node->shape, point, config, results);
+    if (hit != NULL && topmost == NULL) {
+      topmost = hit;
+      if (results == NULL)
+        break;
+    }
+  }
+  return topmost;
+}
+
+shape_t *svg_hit_test(svg_t *svg, double x, double y,
+                      hit_test_config_t *config) {
+  hit_test_config_t defaults = {.tolerance = DEFAULT_TOLERANCE,
+                                .fill_rule = FILL_RULE_NONZERO,
+                                .flatten_tolerance = DEFAULT_FLATTEN_TOLERANCE};
+  return hit_test_shapes(svg->shapes, (vector_t){.x = x, .y = y},
+                         (config == NULL) ? &defaults : config, NULL);
+}
+
+rtree_results_t *svg_hit_test_all(svg_t *svg, double x, double y,
+                                  hit_test_config_t *config) {
+  hit_test_config_t defaults = {.tolerance = DEFAULT_TOLERANCE,
+                                .fill_rule = FILL_RULE_NONZERO,
+                                .flatten_tolerance = DEFAULT_FLATTEN_TOLERANCE};
+  rtree_results_t *results = new_rtree_results();
+  hit_test_shapes(svg->shapes, (vector_t){.x = x, .y = y},
+                  (config == NULL) ? &defaults : config, results);
+  return results;
+}
@@ -0,0 +1,176 @@
+#ifndef CODA_HIT_TEST
+#define CODA_HIT_TEST
+
+#include "../models/shapes/shape.h"
+#include "../models/shapes/svg.h"
+#include "flatten.h"
+#include "rtree.h"
+#include "vector.h"
+#include <stdbool.h>
+
+/**
+ * Lists the rules deciding which points are inside a shape's fill.
+ */
+typedef enum fill_rule_e {
+  FILL_RULE_NONZERO,
+  FILL_RULE_EVEN_ODD,
+} fill_rule_t;
+
+/**
+ * Represents the hit testing configuration.
+ * @param tolerance         the maximum distance between a point and a shape's
+ * outline to hit it.
+ * @param fill_rule         the rule used to fill polygons and paths.
+ * @param flatten_tolerance the maximum distance between the path curves and
+ * the lines approximating them.
+ * @see fill_rule_t.
+ */
+typedef struct hit_test_config_s {
+  double tolerance;
+  fill_rule_t fill_rule;
+  double flatten_tolerance;
+} hit_test_config_t;
+
+/**
+ * Creates a new hit testing configuration.
+ * Note that this function allocates memory.
+ * @param tolerance the maximum distance between a point and a shape's outline
+ * to hit it.
+ * @param fill_rule the rule used to fill polygons and paths.
+ * @return the new configuration's pointer.
+ * @see hit_test_config_t.
+ */
+hit_test_config_t *new_hit_test_config(double tolerance, fill_rule_t fill_rule);
+
+/**
+ * Destroys the given hit testing configuration.
+ * Note that this function frees memory.
+ * @param config the configuration to be destroyed.
+ * @see hit_test_config_t.
+ */
+void free_hit_test_config(hit_test_config_t *config);
+
+/**
+ * Computes the squared distance between the given point and the given line
+ * segment.
+ * @param point the point.
+ * @param start the line segment's start.
+ * @param end   the line segment's end.
+ * @return the squared distance.
+ * @see vector_t.
+ */
+double get_line_distance(vector_t point, vector_t start, vector_t end);
+
+/**
+ * Adds the winding number of the given polyline around the given point to the
+ * given winding number. The polyline is implicitly closed.
+ * @param polyline the polyline.
+ * @param point    the point.
+ * @param winding  the winding number accumulated so far.
+ * @return the updated winding number.
+ * @see polyline_t.
+ */
+int add_polyline_winding(polyline_t *polyline, vector_t point, int winding);
+
+/**
+ * Tests if the given winding number is inside a fill.
+ * @param winding   the winding number.
+ * @param fill_rule the fill rule.
+ * @return true if the winding number is inside the fill, false otherwise.
+ * @see fill_rule_t.
+ */
+bool is_winding_inside(int winding, fill_rule_t fill_rule);
+
+/**
+ * Tests if the given point is within the given tolerance of the given
+ * polyline.
+ * @param polyline  the polyline.
+ * @param point     the point.
+ * @param tolerance the tolerance.
+ * @return true if the point hits the polyline, false otherwise.
+ * @see polyline_t.
+ */
+bool hit_test_polyline(polyline_t *polyline, vector_t point, double tolerance);
+
+/**
+ * Tests if the given point hits the given polylines, either inside their fill
+ * or within the tolerance of their outline.
+ * @param list   the polylines.
+ * @param point  the point.
+ * @param config the hit testing configuration.
+ * @return true if the point hits the polylines, false otherwise.
+ * @see polyline_list_t.
+ */
+bool hit_test_polylines(polyline_list_t *list, vector_t point,
+                        hit_test_config_t *config);
+
+/**
+ * Tests if the given point hits the given non group shape's geometry.
+ * Filled shapes are hit inside their fill or within the tolerance of their
+ * outline, lines and multilines within the tolerance of their strokes.
+ * @param shape  the shape.
+ * @param point  the point, in the shape's coordinates system.
+ * @param config the hit testing configuration.
+ * @return true if the point hits the shape, false otherwise.
+ * @see shape_t.
+ */
+bool hit_test_geometry(shape_t *shape, vector_t point,
+                       hit_test_config_t *config);
+
+/**
+ * Hit tests the given shape, descending into groups.
+ * Shapes whose bounding box does not contain the point are rejected first.
+ * @param shape   the shape.
+ * @param point   the point, in the shape's parent coordinates system.
+ * @param config  the hit testing configuration.
+ * @param results the result to append all the hit shapes to, topmost first,
+ * or NULL to stop at the first hit.
+ * @return the topmost hit shape's pointer, NULL if none.
+ * @see shape_t.
+ */
+shape_t *hit_test_shape(shape_t *shape, vector_t point,
+                        hit_test_config_t *config, rtree_results_t *results);
+
+/**
+ * Hit tests the given shape linked list from the last shape, which is drawn
+ * on top, to the first one.
+ * @param shapes  the shape linked list.
+ * @param point   the point, in the shapes' parent coordinates system.
+ * @param config  the hit testing configuration.
+ * @param results the result to append all the hit shapes to, topmost first,
+ * or NULL to stop at the first hit.
+ * @return the topmost hit shape's pointer, NULL if none.
+ * @see shape_node_t.
+ */
+shape_t *hit_test_shapes(shape_node_t *shapes, vector_t point,
+                         hit_test_config_t *config, rtree_results_t *results);
+
+/**
+ * Searches the topmost shape under the given point.
+ * Groups are never returned: the hit shape inside them is.
+ * @param svg    the svg.
+ * @param x      the point's X coordinate.
+ * @param y      the point's Y coordinate.
+ * @param config the hit testing configuration, NULL for the default one.
+ * @return the topmost hit shape's pointer, NULL if none.
+ * @see svg_t.
+ * @see hit_test_config_t.
+ */
+shape_t *svg_hit_test(svg_t *svg, double x, double y,
+                      hit_test_config_t *config);
+
+/**
+ * Searches all the shapes under the given point.
+ * Note that this function allocates memory.
+ * @param svg    the svg.
+ * @param x      the point's X coordinate.
+ * @param y      the point's Y coordinate.
+ * @param config the hit testing configuration, NULL for the default one.
+ * @return the hit shapes, topmost first.
+ * @see svg_t.
+ * @see rtree_results_t.
+ */
+rtree_results_t *svg_hit_test_all(svg_t *svg, double x, double y,
+                                  hit_test_config_t *config);
+
+#endif
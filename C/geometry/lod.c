@@ -0,0 +1,149 @@
+#include "lod.h"
+#include "../models/shapes/group.h"
+#include "../models/shapes/shape.h"
+#include "../models/shapes/svg.h"
+#include "../models/shapes/symbol.h"
+#include "../models/styles/style.h"
+#include "../models/utils/bbox.h"
+#include "bake.h"
+#include "bounds.h"
+#include "cull.h"
+#include "simplify.h"
+#include <stdbool.h>
+#include <stdlib.h>
+
+bool is_shape_negligible(shape_t *shape, double size) {
+  bbox_t *bbox = get_shape_bbox(shape);
+  if (is_bbox_empty(bbox))
+    return true;
+  return bbox->max_x - bbox->min_x < size && bbox->max_y - bbox->min_y < size;
+}
+
+shape_t *reduce_shape(shape_t *shape, double size, double tolerance,
+                      simplify_method_t method, unsigned int *dropped) {
+  shape_t *reduced;
+  if (is_shape_negligible(shape, size)) {
+    *dropped += count_shapes(shape);
+    return NULL;
+  }
+
+  // Instances keep their symbol's content, which is stored once.
+  if (is_instance(shape))
+    return clone_shape(shape);
+
+  switch (shape->shape_variant) {
+  case ELLIPSE:
+  case RECTANGLE:
+  case LINE:
+    return clone_shape(shape);
+  case MULTILINE:
+  case POLYGON:
+  case PATH:
+    reduced = simplify_shape_copy(shape, tolerance, method, NULL);
+    return (reduced != NULL) ? reduced : clone_shape(shape);
+  case GROUP:
+    break;
+  }
+
+  shape_node_t *shapes =
+      reduce_shapes(shape->shape->group, size, tolerance, method, dropped);
+  if (shapes == NULL) {
+    (*dropped)++;
+    return NULL;
+  }
+
+  // A group whose shapes are all shared keeps its cached bounding box.
+  shape_node_t *node = shape->shape->group, *copy = shapes;
+  while (node != NULL && copy != NULL && node->shape == copy->shape) {
+    node = node->next;
+    copy = copy->next;
+  }
+  if (node == NULL && copy == NULL) {
+    free_baked_shapes(shapes);
+    return clone_shape(shape);
+  }
+  return new_group(shapes, clone_style(shape->styles));
+}
+
+shape_node_t *reduce_shapes(shape_node_t *shapes, double size,
+                            double tolerance, simplify_method_t method,
+                            unsigned int *dropped) {
+  shape_node_t *reduced = NULL, *last = NULL;
+  for (shape_node_t *node = shapes; node != NULL; node = node->next) {
+    shape_t *shape =
+        reduce_shape(node->shape, size, tolerance, method, dropped);
+    if (shape == NULL)
+      continue;
+    if (last == NULL) {
+      reduced = push_shape_node(NULL, shape);
+      last = reduced;
+    } else {
+      push_shape_node(last, shape);
+      last = last->next;
+    }
+  }
+  return reduced;
+}
+
+lod_pyramid_t *new_lod_pyramid(int count, simplify_method_t method) {
+  lod_pyramid_t *pyramid = malloc(sizeof(lod_pyramid_t));
+  pyramid->levels = malloc(sizeof(lod_level_t) * count);
+  pyramid->count = count;
+  pyramid->method = method;
+  double scale = 1;
+  for (int i = 0; i < count; i++) {
+    scale /= 2;
+    pyramid->levels[i].scale = scale;
+    pyramid->levels[i].is_built = false;
+    pyramid->levels[i].shapes = NULL;
+    pyramid->levels[i].shape_count = 0;
+    pyramid->levels[i].dropped = 0;
+  }
+  return pyramid;
+}
+
+lod_level_t *build_lod_level(lod_pyramid_t *pyramid, svg_t *svg, int index) {
+  lod_level_t *level = &pyramid->levels[index];
+  if (level->is_built)
+    return level;
+  shape_node_t *shapes = svg->shapes;
+  for (int i = index - 1; i >= 0; i--) {
+    if (pyramid->levels[i].is_built) {
+      shapes = pyramid->levels[i].shapes;
+      break;
+    }
+  }
+
+  double size = 1 / level->scale;
+  level->shapes =
+      reduce_shapes(shapes, size, size / 2, pyramid->method, &level->dropped);
+  for (shape_node_t *node = level->shapes; node != NULL; node = node->next)
+    level->shape_count += count_shapes(node->shape);
+  level->is_built = true;
+  return level;
+}
+
+lod_level_t *select_lod_level(lod_pyramid_t *pyramid, double scale) {
+  lod_level_t *selected = NULL;
+  if (pyramid == NULL)
+    return NULL;
+  for (int i = 0; i < pyramid->count && pyramid->levels[i].scale >= scale; i++)
+    selected = &pyramid->levels[i];
+  return selected;
+}
+
+lod_level_t *get_lod_level(lod_pyramid_t *pyramid, svg_t *svg, double scale) {
+  lod_level_t *level = select_lod_level(pyramid, scale);
+  if (level == NULL)
+    return NULL;
+  return build_lod_level(pyramid, svg, level - pyramid->levels);
+}
+
+void free_lod_pyramid(lod_pyramid_t *pyramid) {
+  if (pyramid == NULL)
+    return;
+  for (int i = 0; i < pyramid->count; i++)
+    free_baked_shapes(pyramid->levels[i].shapes);
+  free(pyramid->levels);
+  free(pyramid);
+}
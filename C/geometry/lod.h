@@ -0,0 +1,149 @@
+#ifndef CODA_LOD
+#define CODA_LOD
+
+#include "../models/shapes/shape.h"
+#include "../models/shapes/svg.h"
+#include "simplify.h"
+#include <stdbool.h>
+
+/**
+ * Defines a level of detail of an svg.
+ * One unit of the output is worth 1 / scale units of the svg, and is called
+ * the level's pixel size.
+ * @param scale       the output scale the level is made for, between 0 and 1.
+ * @param is_built    indicates if the level's shapes were built.
+ * @param shapes      the level's shape linked list.
+ * @param shape_count the number of shapes of the level, groups included.
+ * @param dropped     the number of shapes of the level's source dropped by
+ * this level, groups included.
+ */
+typedef struct lod_level_s {
+  double scale;
+  bool is_built;
+  shape_node_t *shapes;
+  unsigned int shape_count;
+  unsigned int dropped;
+} lod_level_t;
+
+/**
+ * Defines a level of detail pyramid.
+ * The levels go from the finest to the coarsest, each level halving the scale
+ * of the previous one. The full detail level is the svg itself and is not
+ * stored. The levels are only built when an output scale needs them, so that
+ * an export only pays for the level it writes down.
+ * @param levels the levels.
+ * @param count  the number of levels.
+ * @param method the simplification algorithm.
+ */
+typedef struct lod_pyramid_s {
+  lod_level_t *levels;
+  int count;
+  simplify_method_t method;
+} lod_pyramid_t;
+
+/**
+ * Tests if the given shape is smaller than the given size along both axes,
+ * so that it covers less than a pixel once scaled.
+ * The styles' transformations do not scale the shapes, so the size can be
+ * compared with the shape's bounding box in its parent coordinates system.
+ * @param shape the shape.
+ * @param size  the pixel size.
+ * @return true if the shape can be dropped, false otherwise.
+ * @see get_shape_bbox.
+ * @see shape_t.
+ */
+bool is_shape_negligible(shape_t *shape, double size);
+
+/**
+ * Creates a reduced copy of the given shape.
+ * The shapes smaller than the pixel size are dropped, the lines and paths are
+ * simplified and the groups whose shapes were all dropped are dropped. The
+ * other shapes, and the groups whose shapes are all kept as they are, are
+ * shared with the given shape.
+ * Note that this function allocates memory.
+ * @param shape     the shape.
+ * @param size      the pixel size.
+ * @param tolerance the simplification tolerance.
+ * @param method    the simplification algorithm.
+ * @param dropped   a pointer to add the number of dropped shapes to.
+ * @return the new shape's pointer, NULL if the shape is dropped.
+ * @see is_shape_negligible.
+ * @see simplify_shape.
+ */
+shape_t *reduce_shape(shape_t *shape, double size, double tolerance,
+                      simplify_method_t method, unsigned int *dropped);
+
+/**
+ * Creates a reduced copy of the given shape linked list.
+ * Note that this function allocates memory.
+ * @param shapes    the shape linked list.
+ * @param size      the pixel size.
+ * @param tolerance the simplification tolerance.
+ * @param method    the simplification algorithm.
+ * @param dropped   a pointer to add the number of dropped shapes to.
+ * @return the new shape linked list.
+ * @see reduce_shape.
+ * @see shape_node_t.
+ */
+shape_node_t *reduce_shapes(shape_node_t *shapes, double size,
+                            double tolerance, simplify_method_t method,
+                            unsigned int *dropped);
+
+/**
+ * Creates a level of detail pyramid whose levels are not built yet.
+ * Note that this function allocates memory.
+ * @param count  the number of levels.
+ * @param method the simplification algorithm.
+ * @return the new pyramid's pointer.
+ * @see lod_pyramid_t.
+ */
+lod_pyramid_t *new_lod_pyramid(int count, simplify_method_t method);
+
+/**
+ * Builds the given level of the given pyramid from the coarsest built level
+ * finer than it, or from the svg if there is none, so that a coarse level
+ * only visits the shapes kept by the finer ones. The level is simplified with
+ * half its pixel size as tolerance, so the errors of the successive
+ * simplifications stay below the pixel size. The shapes and groups left as
+ * they are are shared with the source, so a level is never larger than it.
+ * Note that this function allocates memory.
+ * @param pyramid the pyramid.
+ * @param svg     the svg the pyramid was made for.
+ * @param index   the level's index.
+ * @return the level's pointer.
+ * @see reduce_shapes.
+ */
+lod_level_t *build_lod_level(lod_pyramid_t *pyramid, svg_t *svg, int index);
+
+/**
+ * Selects the coarsest level of the given pyramid detailed enough for the
+ * given output scale, which may not be built yet.
+ * @param pyramid the pyramid, can be NULL.
+ * @param scale   the output scale.
+ * @return the level's pointer, NULL if the svg itself must be used.
+ * @see lod_pyramid_t.
+ */
+lod_level_t *select_lod_level(lod_pyramid_t *pyramid, double scale);
+
+/**
+ * Selects the coarsest level of the given pyramid detailed enough for the
+ * given output scale, building it if needed.
+ * Note that this function allocates memory.
+ * @param pyramid the pyramid, can be NULL.
+ * @param svg     the svg the pyramid was made for.
+ * @param scale   the output scale.
+ * @return the level's pointer, NULL if the svg itself must be used.
+ * @see select_lod_level.
+ * @see build_lod_level.
+ */
+lod_level_t *get_lod_level(lod_pyramid_t *pyramid, svg_t *svg, double scale);
+
+/**
+ * Destroys the given pyramid and its levels' shapes.
+ * Note that this function frees memory.
+ * @param pyramid the pyramid.
+ * @see lod_pyramid_t.
+ */
+void free_lod_pyramid(lod_pyramid_t *pyramid);
+
+#endif
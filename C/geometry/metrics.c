@@ -0,0 +1,361 @@
+#include "metrics.h"
+#include "../models/shapes/ellipse.h"
+#include "../models/shapes/line.h"
+#include "../models/shapes/path/path.h"
+#include "../models/shapes/rectangle.h"
+#include "../models/shapes/shape.h"
+#include "../models/shapes/svg.h"
+#include "../models/utils/affine.h"
+#include "../models/utils/point.h"
+#include "segment.h"
+#include "transform.h"
+#include "vector.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define PI 3.14159265358979323846
+#define EPSILON 1e-12
+#define ARC_LENGTH_TOLERANCE 1e-6
+#define ARC_LENGTH_MAX_DEPTH 20
+
+metrics_t get_empty_metrics() {
+  return (metrics_t){.area = 0,
+                     .length = 0,
+                     .area_moment = {.x = 0, .y = 0},
+                     .length_moment = {.x = 0, .y = 0},
+                     .point_count = 0};
+}
+
+void add_metrics(metrics_t *total, metrics_t *metrics) {
+  total->area += metrics->area;
+  total->length += metrics->length;
+  total->area_moment.x += metrics->area_moment.x;
+  total->area_moment.y += metrics->area_moment.y;
+  total->length_moment.x += metrics->length_moment.x;
+  total->length_moment.y += metrics->length_moment.y;
+  total->point_count += metrics->point_count;
+}
+
+metrics_t transform_metrics(metrics_t *metrics, affine_t *affine) {
+  metrics_t result = *metrics;
+  // The moments are transformed like points weighted by the area or length.
+  result.area_moment = (vector_t){
+      .x = affine->a * metrics->area_moment.x +
+           affine->c * metrics->area_moment.y + affine->e * metrics->area,
+      .y = affine->b * metrics->area_moment.x +
+           affine->d * metrics->area_moment.y + affine->f * metrics->area};
+  result.length_moment = (vector_t){
+      .x = affine->a * metrics->length_moment.x +
+           affine->c * metrics->length_moment.y + affine->e * metrics->length,
+      .y = affine->b * metrics->length_moment.x +
+           affine->d * metrics->length_moment.y + affine->f * metrics->length};
+  return result;
+}
+
+bool get_metrics_centroid(metrics_t *metrics, vector_t *centroid) {
+  if (metrics->area > EPSILON) {
+    centroid->x = metrics->area_moment.x / metrics->area;
+    centroid->y = metrics->area_moment.y / metrics->area;
+    return true;
+  }
+  if (metrics->length > EPSILON) {
+    centroid->x = metrics->length_moment.x / metrics->length;
+    centroid->y = metrics->length_moment.y / metrics->length;
+    return true;
+  }
+  return false;
+}
+
+double get_ellipse_perimeter(double radius_x, double radius_y) {
+  double a = fabs(radius_x), b = fabs(radius_y);
+  return PI * (3 * (a + b) - sqrt((3 * a + b) * (a + 3 * b)));
+}
+
+int get_point_coordinates(point_node_t *points, double **x, double **y) {
+  int count = get_point_node_length(points);
+  // One more slot holds the first point again, so that closed polylines can
+  // be walked without wrapping around.
+  *x = malloc(sizeof(double) * (count + 1));
+  *y = malloc(sizeof(double) * (count + 1));
+  int i = 0;
+  for (point_node_t *node = points; node != NULL; node = node->next, i++) {
+    (*x)[i] = node->point->x;
+    (*y)[i] = node->point->y;
+  }
+  if (count > 0) {
+    (*x)[count] = (*x)[0];
+    (*y)[count] = (*y)[0];
+  }
+  return count;
+}
+
+metrics_t measure_polyline(double *x, double *y, int count, bool closed) {
+  metrics_t metrics = get_empty_metrics();
+  metrics.point_count = count;
+  if (count < 2)
+    return metrics;
+
+  // The arrays hold the first point again after the last one.
+  int edges = closed ? count : count - 1;
+  double area = 0, area_x = 0, area_y = 0;
+  double length = 0, length_x = 0, length_y = 0;
+  for (int i = 0; i < edges; i++) {
+    double cross = x[i] * y[i + 1] - x[i + 1] * y[i];
+    double edge = hypot(x[i + 1] - x[i], y[i + 1] - y[i]);
+    area += cross;
+    area_x += (x[i] + x[i + 1]) * cross;
+    area_y += (y[i] + y[i + 1]) * cross;
+    length += edge;
+    length_x += (x[i] + x[i + 1]) * edge;
+    length_y += (y[i] + y[i + 1]) * edge;
+  }
+
+  if (closed) {
+    metrics.area = area / 2;
+    metrics.area_moment = (vector_t){.x = area_x / 6, .y = area_y / 6};
+  }
+  metrics.length = length;
+  metrics.length_moment = (vector_t){.x = length_x / 2, .y = length_y / 2};
+  return metrics;
+}
+
+vector_t get_segment_derivative(segment_t *segment, double t) {
+  double u = 1 - t;
+  switch (segment->variant) {
+  case SEGMENT_QUADRATIC:
+    return (vector_t){.x = 2 * u * (segment->control_1.x - segment->start.x) +
+                           2 * t * (segment->end.x - segment->control_1.x),
+                      .y = 2 * u * (segment->control_1.y - segment->start.y) +
+                           2 * t * (segment->end.y - segment->control_1.y)};
+  case SEGMENT_CUBIC:
+    return (vector_t){
+        .x = 3 * u * u * (segment->control_1.x - segment->start.x) +
+             6 * u * t * (segment->control_2.x - segment->control_1.x) +
+             3 * t * t * (segment->end.x - segment->control_2.x),
+        .y = 3 * u * u * (segment->control_1.y - segment->start.y) +
+             6 * u * t * (segment->control_2.y - segment->control_1.y) +
+             3 * t * t * (segment->end.y - segment->control_2.y)};
+  case SEGMENT_LINE:
+  default:
+    return (vector_t){.x = segment->end.x - segment->start.x,
+                      .y = segment->end.y - segment->start.y};
+  }
+}
+
+void add_segment_area(metrics_t *metrics, segment_t *segment) {
+  // Five points Gauss-Legendre quadrature on [0, 1], exact up to degree 9.
+  double nodes[5] = {0.5, 0.2307653449471585, 0.7692346550528415,
+                     0.0469100770306680, 0.9530899229693320};
+  double weights[5] = {0.2844444444444444, 0.2393143352496832,
+                       0.2393143352496832, 0.1184634425280945,
+                       0.1184634425280945};
+  for (int i = 0; i < 5; i++) {
+    vector_t point = get_segment_point(segment, nodes[i]);
+    vector_t derivative = get_segment_derivative(segment, nodes[i]);
+    double weight = weights[i] / 2;
+    metrics->area += weight * (point.x * derivative.y - point.y * derivative.x);
+    metrics->area_moment.x += weight * point.x * point.x * derivative.y;
+    metrics->area_moment.y -= weight * point.y * point.y * derivative.x;
+  }
+}
+
+void add_segment_length(metrics_t *metrics, segment_t *segment) {
+  if (segment->variant == SEGMENT_LINE) {
+    double length = hypot(segment->end.x - segment->start.x,
+                          segment->end.y - segment->start.y);
+    metrics->length += length;
+    metrics->length_moment.x +=
+        length * (segment->start.x + segment->end.x) / 2;
+    metrics->length_moment.y +=
+        length * (segment->start.y + segment->end.y) / 2;
+    return;
+  }
+
+  // Each interval is split into two halves, so the stack never holds more
+  // than one pending interval per depth.
+  double starts[ARC_LENGTH_MAX_DEPTH + 2], ends[ARC_LENGTH_MAX_DEPTH + 2];
+  int depths[ARC_LENGTH_MAX_DEPTH + 2];
+  int top = 0;
+  starts[top] = 0;
+  ends[top] = 1;
+  depths[top++] = 0;
+
+  while (top > 0) {
+    top--;
+    double start = starts[top], end = ends[top];
+    int depth = depths[top];
+
+    // Samples the speed and the speed weighted by the coordinates at the
+    // interval's start, quarter, middle, three quarters and end.
+    double speeds[5], xs[5], ys[5];
+    for (int i = 0; i < 5; i++) {
+      double t = start + (end - start) * i / 4;
+      vector_t point = get_segment_point(segment, t);
+      vector_t derivative = get_segment_derivative(segment, t);
+      speeds[i] = hypot(derivative.x, derivative.y);
+      xs[i] = speeds[i] * point.x;
+      ys[i] = speeds[i] * point.y;
+    }
+
+    double width = end - start;
+    double whole = width / 6 * (speeds[0] + 4 * speeds[2] + speeds[4]);
+    double halves = width / 12 *
+                    (speeds[0] + 4 * speeds[1] + 2 * speeds[2] +
+                     4 * speeds[3] + speeds[4]);
+    if (depth < ARC_LENGTH_MAX_DEPTH &&
+        fabs(halves - whole) > 15 * ARC_LENGTH_TOLERANCE * width) {
+      double middle = (start + end) / 2;
+      starts[top] = start;
+      ends[top] = middle;
+      depths[top++] = depth + 1;
+      starts[top] = middle;
+      ends[top] = end;
+      depths[top++] = depth + 1;
+      continue;
+    }
+
+    metrics->length += halves + (halves - whole) / 15;
+    metrics->length_moment.x +=
+        width / 12 * (xs[0] + 4 * xs[1] + 2 * xs[2] + 4 * xs[3] + xs[4]);
+    metrics->length_moment.y +=
+        width / 12 * (ys[0] + 4 * ys[1] + 2 * ys[2] + 4 * ys[3] + ys[4]);
+  }
+}
+
+void close_metrics_subpath(path_metrics_context_t *context) {
+  if (!context->open)
+    return;
+  segment_t closing = {.variant = SEGMENT_LINE,
+                       .start = context->current,
+                       .end = context->subpath_start};
+  add_segment_area(&context->metrics, &closing);
+  context->open = false;
+}
+
+void visit_metrics_segment(segment_t *segment, void *context) {
+  path_metrics_context_t *state = context;
+  if (segment->starts_subpath) {
+    close_metrics_subpath(state);
+    state->subpath_start = segment->start;
+    state->open = true;
+    state->metrics.point_count++;
+  }
+
+  add_segment_area(&state->metrics, segment);
+  add_segment_length(&state->metrics, segment);
+  state->current = segment->end;
+  if (segment->closes_subpath)
+    state->open = false;
+  else
+    state->metrics.point_count++;
+}
+
+metrics_t measure_path(path_t *path) {
+  path_metrics_context_t context = {.metrics = get_empty_metrics(),
+                                    .subpath_start = {.x = 0, .y = 0},
+                                    .current = {.x = 0, .y = 0},
+                                    .open = false};
+  walk_path_segments(path, visit_metrics_segment, &context);
+  close_metrics_subpath(&context);
+  return context.metrics;
+}
+
+metrics_t measure_geometry(shape_t *shape) {
+  metrics_t metrics = get_empty_metrics(), child;
+  ellipse_t *ellipse;
+  rectangle_t *rectangle;
+  line_t *line;
+  double *x, *y;
+  int count;
+  // Only read by the variants setting it, zeroed for the optimised builds.
+  vector_t center = {.x = 0, .y = 0};
+
+  switch (shape->shape_variant) {
+  case ELLIPSE:
+    ellipse = shape->shape->ellipse;
+    center = (vector_t){.x = ellipse->center_x, .y = ellipse->center_y};
+    metrics.area = PI * fabs((double)ellipse->radius_x * ellipse->radius_y);
+    metrics.length =
+        get_ellipse_perimeter(ellipse->radius_x, ellipse->radius_y);
+    break;
+  case RECTANGLE:
+    rectangle = shape->shape->rectangle;
+    center = (vector_t){.x = rectangle->x + rectangle->width / 2.0,
+                        .y = rectangle->y + rectangle->height / 2.0};
+    metrics.area = fabs((double)rectangle->width * rectangle->height);
+    metrics.length = 2.0 * (abs(rectangle->width) + abs(rectangle->height));
+    break;
+  case LINE:
+    line = shape->shape->line;
+    center = (vector_t){.x = (line->start->x + line->end->x) / 2.0,
+                        .y = (line->start->y + line->end->y) / 2.0};
+    metrics.length =
+        hypot(line->end->x - line->start->x, line->end->y - line->start->y);
+    metrics.point_count = 2;
+    break;
+  case MULTILINE:
+  case POLYGON:
+    count = get_point_coordinates(shape->shape->multiline, &x, &y);
+    metrics = measure_polyline(x, y, count, shape->shape_variant == POLYGON);
+    free(x);
+    free(y);
+    break;
+  case PATH:
+    metrics = measure_path(shape->shape->path);
+    break;
+  case GROUP:
+    for (shape_node_t *node = shape->shape->group; node != NULL;
+         node = node->next) {
+      child = measure_shape(node->shape);
+      add_metrics(&metrics, &child);
+    }
+    return metrics;
+  }
+
+  switch (shape->shape_variant) {
+  case ELLIPSE:
+  case RECTANGLE:
+  case LINE:
+    metrics.area_moment =
+        (vector_t){.x = metrics.area * center.x, .y = metrics.area * center.y};
+    metrics.length_moment = (vector_t){.x = metrics.length * center.x,
+                                       .y = metrics.length * center.y};
+    break;
+  default:
+    // Clockwise outlines have a negative signed area.
+    if (metrics.area < 0) {
+      metrics.area = -metrics.area;
+      metrics.area_moment.x = -metrics.area_moment.x;
+      metrics.area_moment.y = -metrics.area_moment.y;
+    }
+    break;
+  }
+  return metrics;
+}
+
+metrics_t measure_shape(shape_t *shape) {
+  metrics_t metrics = measure_geometry(shape);
+  return transform_metrics(&metrics, get_local_transform(shape));
+}
+
+metrics_t measure_svg(svg_t *svg) {
+  metrics_t metrics = get_empty_metrics(), shape;
+  for (shape_node_t *node = svg->shapes; node != NULL; node = node->next) {
+    shape = measure_shape(node->shape);
+    add_metrics(&metrics, &shape);
+  }
+  return metrics;
+}
+
+void print_metrics(metrics_t *metrics) {
+  vector_t centroid;
+  printf("Metrics { Area = %.2f, Length = %.2f, ", metrics->area,
+         metrics->length);
+  if (get_metrics_centroid(metrics, &centroid))
+    printf("Centroid = %.2f %.2f, ", centroid.x, centroid.y);
+  else
+    printf("Centroid = none, ");
+  printf("Points = %u }", metrics->point_count);
+}
@@ -0,0 +1,213 @@
+#ifndef CODA_METRICS
+#define CODA_METRICS
+
+#include "../models/shapes/path/path.h"
+#include "../models/shapes/shape.h"
+#include "../models/shapes/svg.h"
+#include "../models/utils/affine.h"
+#include "../models/utils/point.h"
+#include "segment.h"
+#include "vector.h"
+#include <stdbool.h>
+
+/**
+ * Represents the measures of a shape or of a set of shapes.
+ * The moments are the integrals of the coordinates over the surface and over
+ * the outline, they are summed when aggregating shapes and divided by the
+ * area or the length to get the centroid.
+ * @param area            the filled area.
+ * @param length          the outline's length, i.e. the perimeter of closed
+ * shapes.
+ * @param area_moment     the integral of the coordinates over the area.
+ * @param length_moment   the integral of the coordinates along the outline.
+ * @param point_count     the number of points of the lines and paths.
+ * @see vector_t.
+ */
+typedef struct metrics_s {
+  double area;
+  double length;
+  vector_t area_moment;
+  vector_t length_moment;
+  unsigned int point_count;
+} metrics_t;
+
+/**
+ * Holds the state of a path measure.
+ * Open subpaths are closed by a straight line for the area, as when they are
+ * filled, but the line does not count in the length.
+ * @param metrics       the path's signed metrics.
+ * @param subpath_start the current subpath's start point.
+ * @param current       the current point.
+ * @param open          indicates if the current subpath was not closed yet.
+ * @see metrics_t.
+ */
+typedef struct path_metrics_context_s {
+  metrics_t metrics;
+  vector_t subpath_start;
+  vector_t current;
+  bool open;
+} path_metrics_context_t;
+
+/**
+ * Creates empty metrics.
+ * @return the metrics.
+ * @see metrics_t.
+ */
+metrics_t get_empty_metrics();
+
+/**
+ * Adds the given metrics to the given total.
+ * @param total   the metrics to update.
+ * @param metrics the metrics to add.
+ * @see metrics_t.
+ */
+void add_metrics(metrics_t *total, metrics_t *metrics);
+
+/**
+ * Expresses the given metrics in another coordinates system.
+ * The transformation must preserve the distances, which is the case of the
+ * styles' translations, rotations and flips.
+ * @param metrics the metrics.
+ * @param affine  the transformation.
+ * @return the transformed metrics.
+ * @see get_style_affine.
+ * @see metrics_t.
+ */
+metrics_t transform_metrics(metrics_t *metrics, affine_t *affine);
+
+/**
+ * Computes the centroid of the given metrics.
+ * The centroid of the area is used when there is one, the centroid of the
+ * outline otherwise.
+ * @param metrics  the metrics.
+ * @param centroid a pointer to the centroid to set.
+ * @return true if the centroid exists, false for empty metrics.
+ * @see metrics_t.
+ */
+bool get_metrics_centroid(metrics_t *metrics, vector_t *centroid);
+
+/**
+ * Computes the perimeter of an ellipse with Ramanujan's second
+ * approximation.
+ * @param radius_x the ellipse's X radius.
+ * @param radius_y the ellipse's Y radius.
+ * @return the perimeter.
+ */
+double get_ellipse_perimeter(double radius_x, double radius_y);
+
+/**
+ * Copies the given point linked list into coordinates arrays.
+ * Note that this function allocates memory.
+ * @param points the point linked list.
+ * @param x      a pointer to the X coordinates array to set.
+ * @param y      a pointer to the Y coordinates array to set.
+ * @return the number of points.
+ * @see point_node_t.
+ */
+int get_point_coordinates(point_node_t *points, double **x, double **y);
+
+/**
+ * Measures the polyline going through the given points.
+ * The points are given as separate coordinates arrays so that the loops only
+ * read contiguous memory. Closed polylines also get their signed area.
+ * @param x      the X coordinates.
+ * @param y      the Y coordinates.
+ * @param count  the number of points.
+ * @param closed indicates if the last point is joined back to the first.
+ * @return the metrics, with a negative area for clockwise polylines.
+ * @see metrics_t.
+ */
+metrics_t measure_polyline(double *x, double *y, int count, bool closed);
+
+/**
+ * Computes the derivative of the given segment at the given parameter.
+ * @param segment the segment.
+ * @param t       the curve parameter in the [0, 1] range.
+ * @return the derivative.
+ * @see segment_t.
+ */
+vector_t get_segment_derivative(segment_t *segment, double t);
+
+/**
+ * Adds the contribution of the given segment to the signed area and area
+ * moment of the given metrics, following Green's theorem.
+ * The integrals are exact for lines, quadratic and cubic curves.
+ * @param metrics the metrics to update.
+ * @param segment the segment.
+ * @see segment_t.
+ */
+void add_segment_area(metrics_t *metrics, segment_t *segment);
+
+/**
+ * Adds the length and length moment of the given segment to the given
+ * metrics.
+ * The curves are measured with an adaptive Simpson integration, iterating
+ * over an explicit stack of intervals.
+ * @param metrics the metrics to update.
+ * @param segment the segment.
+ * @see segment_t.
+ */
+void add_segment_length(metrics_t *metrics, segment_t *segment);
+
+/**
+ * Closes the current subpath of the given path measure for the area.
+ * @param context the path measure's state.
+ * @see path_metrics_context_t.
+ */
+void close_metrics_subpath(path_metrics_context_t *context);
+
+/**
+ * Adds the given segment to the path measure.
+ * @param segment the segment.
+ * @param context a pointer to the path measure's state.
+ * @see walk_path_segments.
+ * @see path_metrics_context_t.
+ */
+void visit_metrics_segment(segment_t *segment, void *context);
+
+/**
+ * Measures the given path.
+ * @param path the path.
+ * @return the metrics, with a negative area for clockwise paths.
+ * @see path_t.
+ */
+metrics_t measure_path(path_t *path);
+
+/**
+ * Measures the given shape in its own coordinates system.
+ * Lines and multilines have no area, the area of overlapping parts of a
+ * path's subpaths is counted with their orientation. Groups sum their
+ * shapes' metrics.
+ * @param shape the shape.
+ * @return the metrics.
+ * @see shape_t.
+ */
+metrics_t measure_geometry(shape_t *shape);
+
+/**
+ * Measures the given shape in its parent coordinates system: the shape's
+ * cached local transformation is applied.
+ * @param shape the shape.
+ * @return the metrics.
+ * @see measure_geometry.
+ * @see get_local_transform.
+ */
+metrics_t measure_shape(shape_t *shape);
+
+/**
+ * Measures all the given svg's shapes.
+ * @param svg the svg.
+ * @return the metrics.
+ * @see measure_shape.
+ * @see svg_t.
+ */
+metrics_t measure_svg(svg_t *svg);
+
+/**
+ * Prints out the given metrics with their centroid.
+ * @param metrics the metrics.
+ * @see metrics_t.
+ */
+void print_metrics(metrics_t *metrics);
+
+#endif
@@ -0,0 +1,572 @@
+#include "rtree.h"
+#include "../models/shapes/shape.h"
+#include "../models/shapes/symbol.h"
+#include "../models/styles/style.h"
+#include "../models/utils/affine.h"
+#include "../models/utils/bbox.h"
+#include "bounds.h"
+#include "transform.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define RTREE_INITIAL_CAPACITY 16
+
+rtree_t *new_rtree() {
+  rtree_t *tree = malloc(sizeof(rtree_t));
+  tree->root = new_rtree_node(true);
+  tree->size = 0;
+  tree->capacity = RTREE_INITIAL_CAPACITY;
+  tree->occupied = 0;
+  tree->keys = calloc(tree->capacity, sizeof(shape_t *));
+  tree->leaves = calloc(tree->capacity, sizeof(rtree_node_t *));
+  return tree;
+}
+
+rtree_t *build_rtree(shape_node_t *shapes) {
+  rtree_t *tree = new_rtree();
+  rtree_entry_list_t list = {.entries = NULL, .count = 0, .capacity = 0};
+  for (shape_node_t *node = shapes; node != NULL; node = node->next)
+    collect_rtree_entries(&list, node->shape, NULL);
+  if (list.count == 0) {
+    free(list.entries);
+    return tree;
+  }
+
+  tree->size = list.count;
+  bool is_leaf = true;
+  // Packs each level into the next one until a single node remains.
+  while (is_leaf || list.count > 1) {
+    rtree_entry_list_t packed = {.entries = NULL, .count = 0, .capacity = 0};
+    pack_rtree_entries(tree, list.entries, list.count, is_leaf, &packed);
+    free(list.entries);
+    list = packed;
+    is_leaf = false;
+  }
+
+  free_rtree_node(tree->root);
+  tree->root = list.entries[0].child;
+  tree->root->parent = NULL;
+  free(list.entries);
+  return tree;
+}
+
+void free_rtree(rtree_t *tree) {
+  free_rtree_node(tree->root);
+  free(tree->keys);
+  free(tree->leaves);
+  free(tree);
+}
+
+rtree_node_t *new_rtree_node(bool is_leaf) {
+  rtree_node_t *node = malloc(sizeof(rtree_node_t));
+  node->is_leaf = is_leaf;
+  node->count = 0;
+  node->parent = NULL;
+  return node;
+}
+
+void free_rtree_node(rtree_node_t *node) {
+  if (!node->is_leaf)
+    for (int i = 0; i < node->count; i++)
+      free_rtree_node(node->entries[i].child);
+  free(node);
+}
+
+bbox_t get_rtree_node_bbox(rtree_node_t *node) {
+  bbox_t bbox = {.min_x = INFINITY,
+                 .min_y = INFINITY,
+                 .max_x = -INFINITY,
+                 .max_y = -INFINITY};
+  for (int i = 0; i < node->count; i++)
+    merge_bbox(&bbox, &node->entries[i].bbox);
+  return bbox;
+}
+
+/**
+ * Computes the leaves table's slot of the given shape's pointer.
+ */
+#define RTREE_HASH(shape, capacity)                                            \
+  ((int)((((uintptr_t)(shape)) >> 4) * 2654435761u) & ((capacity) - 1))
+
+rtree_node_t *get_rtree_leaf(rtree_t *tree, shape_t *shape) {
+  int slot = RTREE_HASH(shape, tree->capacity);
+  while (tree->keys[slot] != NULL) {
+    if (tree->keys[slot] == shape)
+      return tree->leaves[slot];
+    slot = (slot + 1) & (tree->capacity - 1);
+  }
+  return NULL;
+}
+
+void set_rtree_leaf(rtree_t *tree, shape_t *shape, rtree_node_t *leaf) {
+  int slot = RTREE_HASH(shape, tree->capacity);
+  while (tree->keys[slot] != NULL) {
+    if (tree->keys[slot] == shape) {
+      tree->leaves[slot] = leaf;
+      return;
+    }
+    slot = (slot + 1) & (tree->capacity - 1);
+  }
+  tree->keys[slot] = shape;
+  tree->leaves[slot] = leaf;
+
+  // Keeps the table at most half full.
+  if (++tree->occupied * 2 <= tree->capacity)
+    return;
+
+  int capacity = tree->capacity;
+  shape_t **keys = tree->keys;
+  rtree_node_t **leaves = tree->leaves;
+  tree->capacity = capacity * 2;
+  tree->occupied = 0;
+  tree->keys = calloc(tree->capacity, sizeof(shape_t *));
+  tree->leaves = calloc(tree->capacity, sizeof(rtree_node_t *));
+  for (int i = 0; i < capacity; i++)
+    if (keys[i] != NULL)
+      set_rtree_leaf(tree, keys[i], leaves[i]);
+  free(keys);
+  free(leaves);
+}
+
+void unset_rtree_leaf(rtree_t *tree, shape_t *shape) {
+  int mask = tree->capacity - 1;
+  int slot = RTREE_HASH(shape, tree->capacity);
+  while (tree->keys[slot] != shape) {
+    if (tree->keys[slot] == NULL)
+      return;
+    slot = (slot + 1) & mask;
+  }
+
+  // Shifts back the following keys of the probe sequence to fill the hole.
+  int hole = slot;
+  slot = (slot + 1) & mask;
+  while (tree->keys[slot] != NULL) {
+    int home = RTREE_HASH(tree->keys[slot], tree->capacity);
+    if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+      tree->keys[hole] = tree->keys[slot];
+      tree->leaves[hole] = tree->leaves[slot];
+      hole = slot;
+    }
+    slot = (slot + 1) & mask;
+  }
+  tree->keys[hole] = NULL;
+  tree->leaves[hole] = NULL;
+  tree->occupied--;
+}
+
+void add_rtree_entry(rtree_t *tree, rtree_node_t *node, rtree_entry_t entry) {
+  node->entries[node->count++] = entry;
+  if (node->is_leaf)
+    set_rtree_leaf(tree, entry.shape, node);
+  else
+    entry.child->parent = node;
+}
+
+/**
+ * Computes the area of the given bounding box.
+ */
+#define BBOX_AREA(bbox)                                                        \
+  (((bbox).max_x - (bbox).min_x) * ((bbox).max_y - (bbox).min_y))
+
+/**
+ * Computes the area of the union of the given bounding boxes.
+ */
+#define BBOX_UNION_AREA(a, b)                                                  \
+  ((fmax((a).max_x, (b).max_x) - fmin((a).min_x, (b).min_x)) *                 \
+   (fmax((a).max_y, (b).max_y) - fmin((a).min_y, (b).min_y)))
+
+rtree_node_t *split_rtree_node(rtree_t *tree, rtree_node_t *node) {
+  rtree_entry_t entries[RTREE_MAX_ENTRIES + 1];
+  bool assigned[RTREE_MAX_ENTRIES + 1] = {false};
+  int count = node->count;
+  for (int i = 0; i < count; i++)
+    entries[i] = node->entries[i];
+
+  // Picks the two entries wasting the most area when grouped together.
+  int seed_1 = 0, seed_2 = 1;
+  double worst = -INFINITY;
+  for (int i = 0; i < count; i++)
+    for (int j = i + 1; j < count; j++) {
+      double waste = BBOX_UNION_AREA(entries[i].bbox, entries[j].bbox) -
+                     BBOX_AREA(entries[i].bbox) - BBOX_AREA(entries[j].bbox);
+      if (waste > worst) {
+        worst = waste;
+        seed_1 = i;
+        seed_2 = j;
+      }
+    }
+
+  rtree_node_t *sibling = new_rtree_node(node->is_leaf);
+  node->count = 0;
+  add_rtree_entry(tree, node, entries[seed_1]);
+  add_rtree_entry(tree, sibling, entries[seed_2]);
+  assigned[seed_1] = assigned[seed_2] = true;
+  bbox_t bbox_1 = entries[seed_1].bbox, bbox_2 = entries[seed_2].bbox;
+  int remaining = count - 2;
+
+  while (remaining > 0) {
+    // Gives all the remaining entries to a group that needs them to reach the
+    // minimum number of entries.
+    rtree_node_t *forced = NULL;
+    if (node->count + remaining <= RTREE_MIN_ENTRIES)
+      forced = node;
+    else if (sibling->count + remaining <= RTREE_MIN_ENTRIES)
+      forced = sibling;
+    if (forced != NULL) {
+      for (int i = 0; i < count; i++)
+        if (!assigned[i]) {
+          add_rtree_entry(tree, forced, entries[i]);
+          assigned[i] = true;
+        }
+      break;
+    }
+
+    // Picks the entry with the strongest preference for a group.
+    int next = -1;
+    double cost_1 = 0, cost_2 = 0, preference = -INFINITY;
+    for (int i = 0; i < count; i++) {
+      if (assigned[i])
+        continue;
+      double d_1 = BBOX_UNION_AREA(bbox_1, entries[i].bbox) - BBOX_AREA(bbox_1);
+      double d_2 = BBOX_UNION_AREA(bbox_2, entries[i].bbox) - BBOX_AREA(bbox_2);
+      if (fabs(d_1 - d_2) > preference) {
+        preference = fabs(d_1 - d_2);
+        next = i;
+        cost_1 = d_1;
+        cost_2 = d_2;
+      }
+    }
+
+    bool first = cost_1 < cost_2 ||
+                 (cost_1 == cost_2 &&
+                  (BBOX_AREA(bbox_1) < BBOX_AREA(bbox_2) ||
+                   (BBOX_AREA(bbox_1) == BBOX_AREA(bbox_2) &&
+                    node->count <= sibling->count)));
+    if (first) {
+      add_rtree_entry(tree, node, entries[next]);
+      merge_bbox(&bbox_1, &entries[next].bbox);
+    } else {
+      add_rtree_entry(tree, sibling, entries[next]);
+      merge_bbox(&bbox_2, &entries[next].bbox);
+    }
+    assigned[next] = true;
+    remaining--;
+  }
+
+  return sibling;
+}
+
+void adjust_rtree(rtree_t *tree, rtree_node_t *node, rtree_node_t *sibling) {
+  while (node != tree->root) {
+    rtree_node_t *parent = node->parent;
+    for (int i = 0; i < parent->count; i++)
+      if (parent->entries[i].child == node) {
+        parent->entries[i].bbox = get_rtree_node_bbox(node);
+        break;
+      }
+
+    if (sibling != NULL) {
+      rtree_entry_t entry = {
+          .bbox = get_rtree_node_bbox(sibling), .child = sibling, .shape = NULL};
+      add_rtree_entry(tree, parent, entry);
+      sibling = (parent->count > RTREE_MAX_ENTRIES)
+                    ? split_rtree_node(tree, parent)
+                    : NULL;
+    }
+    node = parent;
+  }
+
+  // Grows the tree when the root was split.
+  if (sibling != NULL) {
+    rtree_node_t *root = new_rtree_node(false);
+    rtree_entry_t entry = {
+        .bbox = get_rtree_node_bbox(node), .child = node, .shape = NULL};
+    add_rtree_entry(tree, root, entry);
+    entry.bbox = get_rtree_node_bbox(sibling);
+    entry.child = sibling;
+    add_rtree_entry(tree, root, entry);
+    tree->root = root;
+  }
+}
+
+void insert_rtree_entry(rtree_t *tree, rtree_entry_t entry) {
+  // Descends towards the child needing the least enlargement.
+  rtree_node_t *node = tree->root;
+  while (!node->is_leaf) {
+    int best = 0;
+    double best_enlargement = INFINITY, best_area = INFINITY;
+    for (int i = 0; i < node->count; i++) {
+      double area = BBOX_AREA(node->entries[i].bbox);
+      double enlargement =
+          BBOX_UNION_AREA(node->entries[i].bbox, entry.bbox) - area;
+      if (enlargement < best_enlargement ||
+          (enlargement == best_enlargement && area < best_area)) {
+        best = i;
+        best_enlargement = enlargement;
+        best_area = area;
+      }
+    }
+    node = node->entries[best].child;
+  }
+
+  add_rtree_entry(tree, node, entry);
+  rtree_node_t *sibling =
+      (node->count > RTREE_MAX_ENTRIES) ? split_rtree_node(tree, node) : NULL;
+  adjust_rtree(tree, node, sibling);
+}
+
+void rtree_insert(rtree_t *tree, shape_t *shape, bbox_t *bbox) {
+  if (get_rtree_leaf(tree, shape) != NULL)
+    rtree_remove(tree, shape);
+  if (is_bbox_empty(bbox))
+    return;
+  rtree_entry_t entry = {.bbox = *bbox, .child = NULL, .shape = shape};
+  insert_rtree_entry(tree, entry);
+  tree->size++;
+}
+
+void dissolve_rtree_node(rtree_node_t *node, rtree_entry_list_t *orphans) {
+  for (int i = 0; i < node->count; i++) {
+    if (node->is_leaf)
+      push_rtree_entry(orphans, node->entries[i]);
+    else
+      dissolve_rtree_node(node->entries[i].child, orphans);
+  }
+  free(node);
+}
+
+bool rtree_remove(rtree_t *tree, shape_t *shape) {
+  rtree_node_t *leaf = get_rtree_leaf(tree, shape);
+  if (leaf == NULL)
+    return false;
+
+  for (int i = 0; i < leaf->count; i++)
+    if (leaf->entries[i].shape == shape) {
+      leaf->entries[i] = leaf->entries[--leaf->count];
+      break;
+    }
+  unset_rtree_leaf(tree, shape);
+  tree->size--;
+
+  // Condenses the tree: underfull nodes are dissolved and their shapes are
+  // inserted again.
+  rtree_entry_list_t orphans = {.entries = NULL, .count = 0, .capacity = 0};
+  rtree_node_t *node = leaf;
+  while (node != tree->root) {
+    rtree_node_t *parent = node->parent;
+    int index = 0;
+    while (parent->entries[index].child != node)
+      index++;
+    if (node->count < RTREE_MIN_ENTRIES) {
+      parent->entries[index] = parent->entries[--parent->count];
+      dissolve_rtree_node(node, &orphans);
+    } else
+      parent->entries[index].bbox = get_rtree_node_bbox(node);
+    node = parent;
+  }
+
+  while (!tree->root->is_leaf && tree->root->count == 1) {
+    rtree_node_t *root = tree->root;
+    tree->root = root->entries[0].child;
+    tree->root->parent = NULL;
+    free(root);
+  }
+  if (!tree->root->is_leaf && tree->root->count == 0) {
+    free(tree->root);
+    tree->root = new_rtree_node(true);
+  }
+
+  for (int i = 0; i < orphans.count; i++)
+    insert_rtree_entry(tree, orphans.entries[i]);
+  free(orphans.entries);
+  return true;
+}
+
+void rtree_insert_shape(rtree_t *tree, shape_t *shape, affine_t *parent) {
+  rtree_entry_list_t list = {.entries = NULL, .count = 0, .capacity = 0};
+  collect_rtree_entries(&list, shape, parent);
+  for (int i = 0; i < list.count; i++)
+    rtree_insert(tree, list.entries[i].shape, &list.entries[i].bbox);
+  free(list.entries);
+}
+
+void rtree_remove_shape(rtree_t *tree, shape_t *shape) {
+  if (shape->shape_variant != GROUP || is_instance(shape)) {
+    rtree_remove(tree, shape);
+    return;
+  }
+  for (shape_node_t *node = shape->shape->group; node != NULL;
+       node = node->next)
+    rtree_remove_shape(tree, node->shape);
+}
+
+void collect_rtree_entries(rtree_entry_list_t *list, shape_t *shape,
+                           affine_t *parent) {
+  // Instances are indexed as a whole since their content is shared by all of
+  // them.
+  if (shape->shape_variant != GROUP || is_instance(shape)) {
+    bbox_t *bbox = compute_world_bbox(shape, parent);
+    rtree_entry_t entry = {.bbox = *bbox, .child = NULL, .shape = shape};
+    if (!is_bbox_empty(bbox))
+      push_rtree_entry(list, entry);
+    free_bbox(bbox);
+    return;
+  }
+
+  affine_t *world = get_world_transform(shape, parent);
+  for (shape_node_t *node = shape->shape->group; node != NULL;
+       node = node->next)
+    collect_rtree_entries(list, node->shape, world);
+}
+
+void pack_rtree_entries(rtree_t *tree, rtree_entry_t *entries, int count,
+                        bool is_leaf, rtree_entry_list_t *packed) {
+  int node_count = (count + RTREE_MAX_ENTRIES - 1) / RTREE_MAX_ENTRIES;
+  int slice_count = (int)ceil(sqrt(node_count));
+  int slice_size = slice_count * RTREE_MAX_ENTRIES;
+
+  qsort(entries, count, sizeof(rtree_entry_t), compare_rtree_entries_x);
+  for (int start = 0; start < count; start += slice_size) {
+    int end = (start + slice_size < count) ? start + slice_size : count;
+    qsort(entries + start, end - start, sizeof(rtree_entry_t),
+          compare_rtree_entries_y);
+
+    for (int i = start; i < end; i += RTREE_MAX_ENTRIES) {
+      rtree_node_t *node = new_rtree_node(is_leaf);
+      for (int j = i; j < end && j < i + RTREE_MAX_ENTRIES; j++)
+        add_rtree_entry(tree, node, entries[j]);
+      rtree_entry_t entry = {
+          .bbox = get_rtree_node_bbox(node), .child = node, .shape = NULL};
+      push_rtree_entry(packed, entry);
+    }
+  }
+}
+
+int compare_rtree_entries_x(const void *a, const void *b) {
+  const bbox_t *bbox_a = &((const rtree_entry_t *)a)->bbox;
+  const bbox_t *bbox_b = &((const rtree_entry_t *)b)->bbox;
+  double center_a = bbox_a->min_x + bbox_a->max_x;
+  double center_b = bbox_b->min_x + bbox_b->max_x;
+  return (center_a > center_b) - (center_a < center_b);
+}
+
+int compare_rtree_entries_y(const void *a, const void *b) {
+  const bbox_t *bbox_a = &((const rtree_entry_t *)a)->bbox;
+  const bbox_t *bbox_b = &((const rtree_entry_t *)b)->bbox;
+  double center_a = bbox_a->min_y + bbox_a->max_y;
+  double center_b = bbox_b->min_y + bbox_b->max_y;
+  return (center_a > center_b) - (center_a < center_b);
+}
+
+void push_rtree_entry(rtree_entry_list_t *list, rtree_entry_t entry) {
+  if (list->count == list->capacity) {
+    list->capacity =
+        (list->capacity == 0) ? RTREE_INITIAL_CAPACITY : list->capacity * 2;
+    list->entries =
+        realloc(list->entries, sizeof(rtree_entry_t) * list->capacity);
+  }
+  list->entries[list->count++] = entry;
+}
+
+rtree_results_t *new_rtree_results() {
+  rtree_results_t *results = malloc(sizeof(rtree_results_t));
+  results->shapes = NULL;
+  results->count = 0;
+  results->capacity = 0;
+  return results;
+}
+
+void push_rtree_result(rtree_results_t *results, shape_t *shape) {
+  if (results->count == results->capacity) {
+    results->capacity = (results->capacity == 0) ? RTREE_INITIAL_CAPACITY
+                                                 : results->capacity * 2;
+    results->shapes =
+        realloc(results->shapes, sizeof(shape_t *) * results->capacity);
+  }
+  results->shapes[results->count++] = shape;
+}
+
+void free_rtree_results(rtree_results_t *results) {
+  free(results->shapes);
+  free(results);
+}
+
+rtree_results_t *rtree_search(rtree_t *tree, bbox_t *range) {
+  rtree_results_t *results = new_rtree_results();
+  search_rtree_node(tree->root, range, results);
+  return results;
+}
+
+void search_rtree_node(rtree_node_t *node, bbox_t *range,
+                       rtree_results_t *results) {
+  for (int i = 0; i < node->count; i++) {
+    if (!bbox_intersects(&node->entries[i].bbox, range))
+      continue;
+    if (node->is_leaf)
+      push_rtree_result(results, node->entries[i].shape);
+    else
+      search_rtree_node(node->entries[i].child, range, results);
+  }
+}
+
+double get_bbox_distance(bbox_t *bbox, double x, double y) {
+  double dx = fmax(fmax(bbox->min_x - x, 0), x - bbox->max_x);
+  double dy = fmax(fmax(bbox->min_y - y, 0), y - bbox->max_y);
+  return dx * dx + dy * dy;
+}
+
+shape_t *rtree_nearest(rtree_t *tree, double x, double y) {
+  if (tree->size == 0)
+    return NULL;
+
+  // Binary min heap of entries ordered by distance.
+  int capacity = RTREE_INITIAL_CAPACITY, count = 0;
+  rtree_queue_item_t *queue = malloc(sizeof(rtree_queue_item_t) * capacity);
+  rtree_entry_t root = {
+      .bbox = get_rtree_node_bbox(tree->root), .child = tree->root};
+  queue[count++] = (rtree_queue_item_t){.distance = 0, .entry = &root};
+  shape_t *nearest = NULL;
+
+  while (count > 0) {
+    rtree_queue_item_t item = queue[0];
+    queue[0] = queue[--count];
+    for (int i = 0; 2 * i + 1 < count;) {
+      int child = 2 * i + 1;
+      if (child + 1 < count && queue[child + 1].distance < queue[child].distance)
+        child++;
+      if (queue[i].distance <= queue[child].distance)
+        break;
+      rtree_queue_item_t swap = queue[i];
+      queue[i] = queue[child];
+      queue[child] = swap;
+      i = child;
+    }
+
+    if (item.entry->child == NULL) {
+      nearest = item.entry->shape;
+      break;
+    }
+
+    rtree_node_t *node = item.entry->child;
+    for (int i = 0; i < node->count; i++) {
+      if (count == capacity) {
+        capacity *= 2;
+        queue = realloc(queue, sizeof(rtree_queue_item_t) * capacity);
+      }
+      int j = count++;
+      queue[j].distance = get_bbox_distance(&node->entries[i].bbox, x, y);
+      queue[j].entry = &node->entries[i];
+      while (j > 0 && queue[(j - 1) / 2].distance > queue[j].distance) {
+        rtree_queue_item_t swap = queue[j];
+        queue[j] = queue[(j - 1) / 2];
+        queue[(j - 1) / 2] = swap;
+        j = (j - 1) / 2;
+      }
+    }
+  }
+
+  free(queue);
+  return nearest;
+}
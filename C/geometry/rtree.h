@@ -0,0 +1,416 @@
+#ifndef CODA_RTREE
+#define CODA_RTREE
+
+#include "../models/shapes/shape.h"
+#include "../models/styles/style.h"
+#include "../models/utils/affine.h"
+#include "../models/utils/bbox.h"
+#include <stdbool.h>
+
+#define RTREE_MAX_ENTRIES 8
+#define RTREE_MIN_ENTRIES 3
+
+/**
+ * Predefines the R-tree node type.
+ */
+typedef struct rtree_node_s rtree_node_t;
+
+/**
+ * Represents an R-tree node entry.
+ * Leaf entries hold a shape, the other entries hold a child node.
+ * @param bbox  the entry's bounding box, in the svg's coordinates system.
+ * @param child the child node (NULL for leaf entries).
+ * @param shape the indexed shape (NULL for inner entries).
+ * @see bbox_t.
+ * @see rtree_node_t.
+ */
+typedef struct rtree_entry_s {
+  bbox_t bbox;
+  rtree_node_t *child;
+  shape_t *shape;
+} rtree_entry_t;
+
+/**
+ * Defines the R-tree node type.
+ * The entries array has an extra slot to hold an overflowing entry until the
+ * node is split.
+ * @param is_leaf indicates if the node's entries hold shapes.
+ * @param count   the number of entries.
+ * @param parent  the parent node (NULL for the root).
+ * @param entries the node's entries.
+ * @see rtree_entry_t.
+ */
+struct rtree_node_s {
+  bool is_leaf;
+  int count;
+  rtree_node_t *parent;
+  rtree_entry_t entries[RTREE_MAX_ENTRIES + 1];
+};
+
+/**
+ * Represents a spatial index over shapes.
+ * Groups are not indexed: their shapes are, with their bounding boxes
+ * expressed in the svg's coordinates system. Shapes without geometry (e.g. an
+ * empty multiline) are not indexed either.
+ * The leaves table maps each indexed shape to the leaf holding it so that
+ * shapes can be removed without searching the tree.
+ * @param root     the tree's root node.
+ * @param size     the number of indexed shapes.
+ * @param keys     the leaves table's shapes (open addressing).
+ * @param leaves   the leaves table's leaf nodes.
+ * @param capacity the leaves table's capacity (a power of 2).
+ * @param occupied the number of shapes in the leaves table.
+ * @see rtree_node_t.
+ */
+typedef struct rtree_s {
+  rtree_node_t *root;
+  int size;
+  shape_t **keys;
+  rtree_node_t **leaves;
+  int capacity;
+  int occupied;
+} rtree_t;
+
+/**
+ * Represents the result of an R-tree query.
+ * @param shapes   the matching shapes.
+ * @param count    the number of matching shapes.
+ * @param capacity the shapes array's capacity.
+ */
+typedef struct rtree_results_s {
+  shape_t **shapes;
+  int count;
+  int capacity;
+} rtree_results_t;
+
+/**
+ * Represents a growable array of R-tree entries.
+ * @param entries  the entries.
+ * @param count    the number of entries.
+ * @param capacity the entries array's capacity.
+ * @see rtree_entry_t.
+ */
+typedef struct rtree_entry_list_s {
+  rtree_entry_t *entries;
+  int count;
+  int capacity;
+} rtree_entry_list_t;
+
+/**
+ * Represents an item of the nearest shape search's priority queue.
+ * @param distance the squared distance between the query point and the
+ * entry's bounding box.
+ * @param entry    the queued entry.
+ * @see rtree_entry_t.
+ */
+typedef struct rtree_queue_item_s {
+  double distance;
+  rtree_entry_t *entry;
+} rtree_queue_item_t;
+
+/**
+ * Creates a new empty R-tree.
+ * Note that this function allocates memory.
+ * @return the new R-tree's pointer.
+ * @see rtree_t.
+ */
+rtree_t *new_rtree();
+
+/**
+ * Creates a new R-tree indexing the given shapes and all their group's
+ * shapes, using the Sort-Tile-Recursive bulk loading algorithm.
+ * Note that this function allocates memory.
+ * @param shapes the shape linked list to index.
+ * @return the new R-tree's pointer.
+ * @see rtree_t.
+ * @see shape_node_t.
+ */
+rtree_t *build_rtree(shape_node_t *shapes);
+
+/**
+ * Destroys the given R-tree.
+ * Note that this function frees memory.
+ * Note that the indexed shapes are not freed.
+ * @param tree the R-tree to be destroyed.
+ * @see rtree_t.
+ */
+void free_rtree(rtree_t *tree);
+
+/**
+ * Creates a new R-tree node.
+ * Note that this function allocates memory.
+ * @param is_leaf indicates if the node is a leaf.
+ * @return the new node's pointer.
+ * @see rtree_node_t.
+ */
+rtree_node_t *new_rtree_node(bool is_leaf);
+
+/**
+ * Destroys the given R-tree node and all its descendants.
+ * Note that this function frees memory.
+ * @param node the node to be destroyed.
+ * @see rtree_node_t.
+ */
+void free_rtree_node(rtree_node_t *node);
+
+/**
+ * Computes the bounding box of all the given node's entries.
+ * @param node the node.
+ * @return the node's bounding box.
+ * @see rtree_node_t.
+ */
+bbox_t get_rtree_node_bbox(rtree_node_t *node);
+
+/**
+ * Retrieves the leaf holding the given shape.
+ * @param tree  the R-tree.
+ * @param shape the shape.
+ * @return the leaf's pointer, NULL if the shape is not indexed.
+ * @see rtree_t.
+ */
+rtree_node_t *get_rtree_leaf(rtree_t *tree, shape_t *shape);
+
+/**
+ * Records the leaf holding the given shape.
+ * Note that this function may allocate memory.
+ * @param tree  the R-tree.
+ * @param shape the shape.
+ * @param leaf  the leaf holding the shape.
+ * @see rtree_t.
+ */
+void set_rtree_leaf(rtree_t *tree, shape_t *shape, rtree_node_t *leaf);
+
+/**
+ * Forgets the leaf holding the given shape.
+ * @param tree  the R-tree.
+ * @param shape the shape.
+ * @see rtree_t.
+ */
+void unset_rtree_leaf(rtree_t *tree, shape_t *shape);
+
+/**
+ * Appends the given entry to the given node and updates the entry's parent
+ * pointers.
+ * Note that the node may overflow and must then be split.
+ * @param tree  the R-tree.
+ * @param node  the node.
+ * @param entry the entry to append.
+ * @see rtree_node_t.
+ * @see rtree_entry_t.
+ */
+void add_rtree_entry(rtree_t *tree, rtree_node_t *node, rtree_entry_t entry);
+
+/**
+ * Splits the given overflowing node using Guttman's quadratic split.
+ * Note that this function allocates memory.
+ * @param tree the R-tree.
+ * @param node the node to split.
+ * @return the new sibling node's pointer.
+ * @see rtree_node_t.
+ */
+rtree_node_t *split_rtree_node(rtree_t *tree, rtree_node_t *node);
+
+/**
+ * Propagates the bounding box changes and the splits from the given node up to
+ * the root.
+ * Note that this function may allocate memory.
+ * @param tree    the R-tree.
+ * @param node    the updated node.
+ * @param sibling the node's new sibling created by a split, NULL if none.
+ * @see rtree_node_t.
+ */
+void adjust_rtree(rtree_t *tree, rtree_node_t *node, rtree_node_t *sibling);
+
+/**
+ * Inserts the given leaf entry into the given R-tree without updating its
+ * size.
+ * Note that this function may allocate memory.
+ * @param tree  the R-tree.
+ * @param entry the leaf entry.
+ * @see rtree_t.
+ * @see rtree_entry_t.
+ */
+void insert_rtree_entry(rtree_t *tree, rtree_entry_t entry);
+
+/**
+ * Indexes the given shape with the given bounding box.
+ * Note that this function allocates memory.
+ * Note that shapes with an empty bounding box are not indexed.
+ * @param tree  the R-tree.
+ * @param shape the shape to index.
+ * @param bbox  the shape's bounding box in the svg's coordinates system.
+ * @see rtree_t.
+ * @see bbox_t.
+ */
+void rtree_insert(rtree_t *tree, shape_t *shape, bbox_t *bbox);
+
+/**
+ * Removes the given shape from the given R-tree.
+ * Underfull nodes are dissolved and their shapes are inserted again.
+ * Note that this function frees memory.
+ * @param tree  the R-tree.
+ * @param shape the shape to remove.
+ * @return true if the shape was indexed, false otherwise.
+ * @see rtree_t.
+ */
+bool rtree_remove(rtree_t *tree, shape_t *shape);
+
+/**
+ * Appends all the leaf entries of the given node to the given entry list then
+ * destroys the node and its descendants.
+ * Note that this function frees memory.
+ * @param node    the node to dissolve.
+ * @param orphans the entry list.
+ * @see rtree_node_t.
+ * @see rtree_entry_list_t.
+ */
+void dissolve_rtree_node(rtree_node_t *node, rtree_entry_list_t *orphans);
+
+/**
+ * Indexes the given shape, or all the shapes of the given group. Instances
+ * are indexed as a single shape.
+ * Note that this function allocates memory.
+ * @param tree   the R-tree.
+ * @param shape  the shape to index.
+ * @param parent the world transformation of the group containing the shape, or
+ * NULL for the svg's shapes.
+ * @see rtree_t.
+ * @see shape_t.
+ */
+void rtree_insert_shape(rtree_t *tree, shape_t *shape, affine_t *parent);
+
+/**
+ * Removes the given shape, or all the shapes of the given group, from the
+ * given R-tree. Instances are removed as a single shape.
+ * Note that this function frees memory.
+ * @param tree  the R-tree.
+ * @param shape the shape to remove.
+ * @see rtree_t.
+ * @see shape_t.
+ */
+void rtree_remove_shape(rtree_t *tree, shape_t *shape);
+
+/**
+ * Appends the leaf entries of the given shape, or of all the shapes of the
+ * given group, to the given entry list.
+ * Note that this function allocates memory.
+ * The shapes world transformations are cached along the way.
+ * @param list   the entry list.
+ * @param shape  the shape.
+ * @param parent the world transformation of the group containing the shape, or
+ * NULL for the svg's shapes.
+ * @see rtree_entry_list_t.
+ * @see get_world_transform.
+ */
+void collect_rtree_entries(rtree_entry_list_t *list, shape_t *shape,
+                           affine_t *parent);
+
+/**
+ * Packs the given entries into nodes using the Sort-Tile-Recursive algorithm.
+ * The given entries are sorted in place.
+ * Note that this function allocates memory.
+ * @param tree    the R-tree.
+ * @param entries the entries to pack.
+ * @param count   the number of entries.
+ * @param is_leaf indicates if the entries are leaf entries.
+ * @param packed  the entry list to append the new nodes' entries to.
+ * @see rtree_entry_t.
+ */
+void pack_rtree_entries(rtree_t *tree, rtree_entry_t *entries, int count,
+                        bool is_leaf, rtree_entry_list_t *packed);
+
+/**
+ * Compares two R-tree entries by their bounding box's center X coordinate.
+ * @param a the first entry's pointer.
+ * @param b the second entry's pointer.
+ * @return a negative value, 0 or a positive value as for qsort.
+ */
+int compare_rtree_entries_x(const void *a, const void *b);
+
+/**
+ * Compares two R-tree entries by their bounding box's center Y coordinate.
+ * @param a the first entry's pointer.
+ * @param b the second entry's pointer.
+ * @return a negative value, 0 or a positive value as for qsort.
+ */
+int compare_rtree_entries_y(const void *a, const void *b);
+
+/**
+ * Appends the given entry to the given entry list.
+ * Note that this function may allocate memory.
+ * @param list  the entry list.
+ * @param entry the entry to append.
+ * @see rtree_entry_list_t.
+ */
+void push_rtree_entry(rtree_entry_list_t *list, rtree_entry_t entry);
+
+/**
+ * Creates a new empty query result.
+ * Note that this function allocates memory.
+ * @return the new query result's pointer.
+ * @see rtree_results_t.
+ */
+rtree_results_t *new_rtree_results();
+
+/**
+ * Appends the given shape to the given query result.
+ * Note that this function may allocate memory.
+ * @param results the query result.
+ * @param shape   the shape to append.
+ * @see rtree_results_t.
+ */
+void push_rtree_result(rtree_results_t *results, shape_t *shape);
+
+/**
+ * Destroys the given query result.
+ * Note that this function frees memory.
+ * Note that the shapes are not freed.
+ * @param results the query result to be destroyed.
+ * @see rtree_results_t.
+ */
+void free_rtree_results(rtree_results_t *results);
+
+/**
+ * Searches the shapes whose bounding box intersects the given range.
+ * Note that this function allocates memory.
+ * @param tree  the R-tree.
+ * @param range the range, in the svg's coordinates system.
+ * @return the query result's pointer.
+ * @see rtree_results_t.
+ */
+rtree_results_t *rtree_search(rtree_t *tree, bbox_t *range);
+
+/**
+ * Appends the shapes of the given node whose bounding box intersects the
+ * given range to the given query result.
+ * Note that this function may allocate memory.
+ * @param node    the node to search.
+ * @param range   the range.
+ * @param results the query result.
+ * @see rtree_node_t.
+ */
+void search_rtree_node(rtree_node_t *node, bbox_t *range,
+                       rtree_results_t *results);
+
+/**
+ * Computes the squared distance between the given point and bounding box.
+ * @param bbox the bounding box.
+ * @param x    the point's X coordinate.
+ * @param y    the point's Y coordinate.
+ * @return the squared distance, 0 if the point is inside the bounding box.
+ * @see bbox_t.
+ */
+double get_bbox_distance(bbox_t *bbox, double x, double y);
+
+/**
+ * Searches the shape whose bounding box is the nearest to the given point.
+ * The tree is explored best first, ordered by bounding box distance.
+ * @param tree the R-tree.
+ * @param x    the point's X coordinate.
+ * @param y    the point's Y coordinate.
+ * @return the nearest shape's pointer, NULL if the tree is empty.
+ * @see rtree_t.
+ */
+shape_t *rtree_nearest(rtree_t *tree, double x, double y);
+
+#endif
@@ -0,0 +1,215 @@
+#include "segment.h"
+#include "../models/shapes/path/path.h"
+#include "vector.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#define EPSILON 1e-12
+
+void walk_path_segments(path_t *path,
+                        void (*visit)(segment_t *segment, void *context),
+                        void *context) {
+  vector_t current = {.x = 0, .y = 0};
+  vector_t subpath_start = current;
+  // Last curve control point, used to resolve the shorthand curves.
+  vector_t last_control = current;
+  path_element_variant_t last_variant = MOVE_TO;
+  bool starts_subpath = true;
+  segment_t segment;
+
+  path_element_node_t *node = path;
+  while (node != NULL) {
+    path_element_t *element = node->element;
+    path_element_union_t *value = element->path_element;
+    segment.start = current;
+    segment.starts_subpath = starts_subpath;
+    segment.closes_subpath = false;
+
+    switch (element->path_element_variant) {
+    case MOVE_TO:
+      current = (vector_t){.x = value->move_to->x, .y = value->move_to->y};
+      subpath_start = current;
+      last_variant = MOVE_TO;
+      starts_subpath = true;
+      node = node->next;
+      continue;
+
+    case LINE_TO:
+      segment.variant = SEGMENT_LINE;
+      segment.end = (vector_t){.x = value->line_to->x, .y = value->line_to->y};
+      break;
+
+    case HORIZONTAL_LINE_TO:
+      segment.variant = SEGMENT_LINE;
+      segment.end = (vector_t){.x = value->horizontal_line_to, .y = current.y};
+      break;
+
+    case VERTICAL_LINE_TO:
+      segment.variant = SEGMENT_LINE;
+      segment.end = (vector_t){.x = current.x, .y = value->vertical_line_to};
+      break;
+
+    case END_PATH:
+      segment.variant = SEGMENT_LINE;
+      segment.end = subpath_start;
+      segment.closes_subpath = true;
+      break;
+
+    case CUBIC_CURVE_TO:
+      segment.variant = SEGMENT_CUBIC;
+      segment.control_1 =
+          (vector_t){.x = value->cubic_curve_to->control_point_1->x,
+                     .y = value->cubic_curve_to->control_point_1->y};
+      segment.control_2 =
+          (vector_t){.x = value->cubic_curve_to->control_point_2->x,
+                     .y = value->cubic_curve_to->control_point_2->y};
+      segment.end = (vector_t){.x = value->cubic_curve_to->end->x,
+                               .y = value->cubic_curve_to->end->y};
+      break;
+
+    case CUBIC_CURVE_TO_SHORTHAND:
+      segment.variant = SEGMENT_CUBIC;
+      // The first control point is the reflection of the previous cubic
+      // curve's second control point.
+      if (last_variant == CUBIC_CURVE_TO ||
+          last_variant == CUBIC_CURVE_TO_SHORTHAND)
+        segment.control_1 = (vector_t){.x = 2 * current.x - last_control.x,
+                                       .y = 2 * current.y - last_control.y};
+      else
+        segment.control_1 = current;
+      segment.control_2 =
+          (vector_t){.x = value->shorthand_cubic_curve_to->control_point->x,
+                     .y = value->shorthand_cubic_curve_to->control_point->y};
+      segment.end = (vector_t){.x = value->shorthand_cubic_curve_to->end->x,
+                               .y = value->shorthand_cubic_curve_to->end->y};
+      break;
+
+    case QUADRATIC_CURVE_TO:
+      segment.variant = SEGMENT_QUADRATIC;
+      segment.control_1 =
+          (vector_t){.x = value->quadratic_curve_to->control_point->x,
+                     .y = value->quadratic_curve_to->control_point->y};
+      segment.end = (vector_t){.x = value->quadratic_curve_to->end->x,
+                               .y = value->quadratic_curve_to->end->y};
+      break;
+
+    case QUADRATIC_CURVE_TO_SHORTHAND:
+      segment.variant = SEGMENT_QUADRATIC;
+      // The control point is the reflection of the previous quadratic curve's
+      // control point.
+      if (last_variant == QUADRATIC_CURVE_TO ||
+          last_variant == QUADRATIC_CURVE_TO_SHORTHAND)
+        segment.control_1 = (vector_t){.x = 2 * current.x - last_control.x,
+                                       .y = 2 * current.y - last_control.y};
+      else
+        segment.control_1 = current;
+      segment.end = (vector_t){.x = value->shorthand_quadratic_curve_to->x,
+                               .y = value->shorthand_quadratic_curve_to->y};
+      break;
+    }
+
+    switch (segment.variant) {
+    case SEGMENT_CUBIC:
+      last_control = segment.control_2;
+      break;
+    case SEGMENT_QUADRATIC:
+      last_control = segment.control_1;
+      break;
+    case SEGMENT_LINE:
+      last_control = segment.end;
+      break;
+    }
+
+    visit(&segment, context);
+    current = segment.end;
+    last_variant = element->path_element_variant;
+    starts_subpath = segment.closes_subpath;
+    node = node->next;
+  }
+}
+
+vector_t get_segment_point(segment_t *segment, double t) {
+  double u = 1 - t;
+  switch (segment->variant) {
+  case SEGMENT_QUADRATIC:
+    return (vector_t){
+        .x = u * u * segment->start.x + 2 * u * t * segment->control_1.x +
+             t * t * segment->end.x,
+        .y = u * u * segment->start.y + 2 * u * t * segment->control_1.y +
+             t * t * segment->end.y};
+  case SEGMENT_CUBIC:
+    return (vector_t){.x = u * u * u * segment->start.x +
+                           3 * u * u * t * segment->control_1.x +
+                           3 * u * t * t * segment->control_2.x +
+                           t * t * t * segment->end.x,
+                      .y = u * u * u * segment->start.y +
+                           3 * u * u * t * segment->control_1.y +
+                           3 * u * t * t * segment->control_2.y +
+                           t * t * t * segment->end.y};
+  case SEGMENT_LINE:
+  default:
+    return (vector_t){.x = u * segment->start.x + t * segment->end.x,
+                      .y = u * segment->start.y + t * segment->end.y};
+  }
+}
+
+int append_unit_roots(double a, double b, double c, double *parameters,
+                      int count) {
+  double roots[2];
+  int n = 0;
+  if (fabs(a) < EPSILON) {
+    if (fabs(b) >= EPSILON)
+      roots[n++] = -c / b;
+  } else {
+    double discriminant = b * b - 4 * a * c;
+    if (discriminant >= 0) {
+      double root = sqrt(discriminant);
+      roots[n++] = (-b + root) / (2 * a);
+      roots[n++] = (-b - root) / (2 * a);
+    }
+  }
+  for (int i = 0; i < n; i++)
+    if (roots[i] > 0 && roots[i] < 1)
+      parameters[count++] = roots[i];
+  return count;
+}
+
+int get_segment_extrema(segment_t *segment, double *parameters) {
+  int count = 0;
+  double denominator;
+  switch (segment->variant) {
+  case SEGMENT_QUADRATIC:
+    denominator =
+        segment->start.x - 2 * segment->control_1.x + segment->end.x;
+    if (fabs(denominator) >= EPSILON)
+      count = append_unit_roots(
+          0, 1, -(segment->start.x - segment->control_1.x) / denominator,
+          parameters, count);
+    denominator =
+        segment->start.y - 2 * segment->control_1.y + segment->end.y;
+    if (fabs(denominator) >= EPSILON)
+      count = append_unit_roots(
+          0, 1, -(segment->start.y - segment->control_1.y) / denominator,
+          parameters, count);
+    break;
+  case SEGMENT_CUBIC:
+    // The derivative divided by 3 is a * t^2 + b * t + c.
+    count = append_unit_roots(
+        -segment->start.x + 3 * segment->control_1.x -
+            3 * segment->control_2.x + segment->end.x,
+        2 * (segment->start.x - 2 * segment->control_1.x +
+             segment->control_2.x),
+        segment->control_1.x - segment->start.x, parameters, count);
+    count = append_unit_roots(
+        -segment->start.y + 3 * segment->control_1.y -
+            3 * segment->control_2.y + segment->end.y,
+        2 * (segment->start.y - 2 * segment->control_1.y +
+             segment->control_2.y),
+        segment->control_1.y - segment->start.y, parameters, count);
+    break;
+  case SEGMENT_LINE:
+    break;
+  }
+  return count;
+}
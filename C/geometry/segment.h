@@ -0,0 +1,90 @@
+#ifndef CODA_SEGMENT
+#define CODA_SEGMENT
+
+#include "../models/shapes/path/path.h"
+#include "vector.h"
+#include <stdbool.h>
+
+/**
+ * Lists all the segment variants.
+ */
+typedef enum segment_variants_e {
+  SEGMENT_LINE,
+  SEGMENT_QUADRATIC,
+  SEGMENT_CUBIC,
+} segment_variants_t;
+
+/**
+ * Represents a path segment with absolute coordinates.
+ * Shorthand curves, horizontal and vertical lines and end of paths are
+ * resolved into plain lines and curves.
+ * @param variant         indicates the active segment variant.
+ * @param start           the segment's start point.
+ * @param control_1       the curve's first control point (unused for lines).
+ * @param control_2       the cubic curve's second control point.
+ * @param end             the segment's end point.
+ * @param starts_subpath  indicates if the segment follows a move to element.
+ * @param closes_subpath  indicates if the segment comes from an end of path
+ * element.
+ * @see vector_t.
+ */
+typedef struct segment_s {
+  segment_variants_t variant;
+  vector_t start;
+  vector_t control_1;
+  vector_t control_2;
+  vector_t end;
+  bool starts_subpath;
+  bool closes_subpath;
+} segment_t;
+
+/**
+ * Walks through the given path and calls the given function on each of its
+ * resolved segments, in order.
+ * The path elements are absolute. The path starts at (0, 0) if it does not
+ * start with a move to element.
+ * @param path    the path to walk through.
+ * @param visit   a function pointer called on each segment.
+ * @param context a pointer given back to the visit function.
+ * @see segment_t.
+ * @see path_t.
+ */
+void walk_path_segments(path_t *path,
+                        void (*visit)(segment_t *segment, void *context),
+                        void *context);
+
+/**
+ * Computes the point of the given segment at the given parameter.
+ * @param segment the segment.
+ * @param t       the curve parameter in the [0, 1] range.
+ * @return the point's coordinates.
+ * @see segment_t.
+ * @see vector_t.
+ */
+vector_t get_segment_point(segment_t *segment, double t);
+
+/**
+ * Appends the roots of a * t^2 + b * t + c = 0 in the ]0, 1[ range to the
+ * given array.
+ * @param a          the quadratic coefficient.
+ * @param b          the linear coefficient.
+ * @param c          the constant coefficient.
+ * @param parameters the array to append the roots to.
+ * @param count      the number of values already set in the array.
+ * @return the updated number of values set in the array.
+ */
+int append_unit_roots(double a, double b, double c, double *parameters,
+                      int count);
+
+/**
+ * Computes the curve parameters where the given segment reaches an extremum
+ * along the X or Y axis.
+ * Only the parameters in the ]0, 1[ range are returned.
+ * @param segment    the segment.
+ * @param parameters an array of at least 4 values to set the parameters.
+ * @return the number of parameters set.
+ * @see segment_t.
+ */
+int get_segment_extrema(segment_t *segment, double *parameters);
+
+#endif
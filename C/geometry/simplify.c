@@ -0,0 +1,538 @@
+#include "simplify.h"
+#include "../hash/hash.h"
+#include "../models/shapes/multiline.h"
+#include "../models/shapes/path/path.h"
+#include "../models/shapes/polygon.h"
+#include "../models/shapes/shape.h"
+#include "../models/shapes/svg.h"
+#include "../models/shapes/symbol.h"
+#include "../models/utils/point.h"
+#include "bounds.h"
+#include "flatten.h"
+#include "hit_test.h"
+#include "vector.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+int simplify_douglas_peucker(vector_t *points, int count, double tolerance,
+                             bool *keep) {
+  for (int i = 0; i < count; i++)
+    keep[i] = count <= 2;
+  if (count <= 2)
+    return count;
+
+  keep[0] = true;
+  keep[count - 1] = true;
+  int kept = 2;
+  double limit = tolerance * tolerance;
+  // Each range is split into two smaller ones, so the stack never holds more
+  // than count ranges.
+  int *stack = malloc(sizeof(int) * 2 * count);
+  int top = 0;
+  stack[top++] = 0;
+  stack[top++] = count - 1;
+
+  while (top > 0) {
+    int last = stack[--top];
+    int first = stack[--top];
+    int farthest = -1;
+    double distance = limit;
+    for (int i = first + 1; i < last; i++) {
+      double d = get_line_distance(points[i], points[first], points[last]);
+      if (d > distance) {
+        distance = d;
+        farthest = i;
+      }
+    }
+    if (farthest < 0)
+      continue;
+
+    keep[farthest] = true;
+    kept++;
+    stack[top++] = first;
+    stack[top++] = farthest;
+    stack[top++] = farthest;
+    stack[top++] = last;
+  }
+
+  free(stack);
+  return kept;
+}
+
+double get_triangle_area(vector_t a, vector_t b, vector_t c) {
+  return fabs((b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y)) / 2;
+}
+
+void swap_visvalingam_entries(visvalingam_state_t *state, int i, int j) {
+  int index = state->heap[i];
+  state->heap[i] = state->heap[j];
+  state->heap[j] = index;
+  state->positions[state->heap[i]] = i;
+  state->positions[state->heap[j]] = j;
+}
+
+void sift_visvalingam_entry(visvalingam_state_t *state, int position) {
+  while (position > 0) {
+    int parent = (position - 1) / 2;
+    if (state->areas[state->heap[parent]] <=
+        state->areas[state->heap[position]])
+      break;
+    swap_visvalingam_entries(state, parent, position);
+    position = parent;
+  }
+
+  while (true) {
+    int smallest = position;
+    int left = 2 * position + 1, right = left + 1;
+    if (left < state->size &&
+        state->areas[state->heap[left]] < state->areas[state->heap[smallest]])
+      smallest = left;
+    if (right < state->size &&
+        state->areas[state->heap[right]] < state->areas[state->heap[smallest]])
+      smallest = right;
+    if (smallest == position)
+      return;
+    swap_visvalingam_entries(state, smallest, position);
+    position = smallest;
+  }
+}
+
+void remove_visvalingam_entry(visvalingam_state_t *state, int index) {
+  int position = state->positions[index];
+  state->size--;
+  if (position != state->size) {
+    swap_visvalingam_entries(state, position, state->size);
+    sift_visvalingam_entry(state, position);
+  }
+  state->positions[index] = -1;
+}
+
+int simplify_visvalingam(vector_t *points, int count, double tolerance,
+                         bool *keep) {
+  for (int i = 0; i < count; i++)
+    keep[i] = true;
+  if (count <= 2)
+    return count;
+
+  visvalingam_state_t state = {.points = points,
+                               .previous = malloc(sizeof(int) * count),
+                               .next = malloc(sizeof(int) * count),
+                               .areas = malloc(sizeof(double) * count),
+                               .heap = malloc(sizeof(int) * count),
+                               .positions = malloc(sizeof(int) * count),
+                               .size = 0};
+  for (int i = 0; i < count; i++) {
+    state.previous[i] = i - 1;
+    state.next[i] = i + 1;
+    state.positions[i] = -1;
+    if (i == 0 || i == count - 1)
+      continue;
+    state.areas[i] = get_triangle_area(points[i - 1], points[i], points[i + 1]);
+    state.heap[state.size] = i;
+    state.positions[i] = state.size++;
+  }
+  for (int i = state.size / 2 - 1; i >= 0; i--)
+    sift_visvalingam_entry(&state, i);
+
+  int kept = count;
+  double limit = tolerance * tolerance;
+  while (state.size > 0 && state.areas[state.heap[0]] < limit) {
+    int index = state.heap[0];
+    remove_visvalingam_entry(&state, index);
+    keep[index] = false;
+    kept--;
+
+    int previous = state.previous[index], next = state.next[index];
+    state.next[previous] = next;
+    state.previous[next] = previous;
+    int neighbours[2] = {previous, next};
+    for (int i = 0; i < 2; i++) {
+      int neighbour = neighbours[i];
+      if (state.positions[neighbour] < 0)
+        continue;
+      double area = get_triangle_area(points[state.previous[neighbour]],
+                                      points[neighbour],
+                                      points[state.next[neighbour]]);
+      // Keeps the areas increasing so that a point is never removed before
+      // the points which were removed to reach it.
+      state.areas[neighbour] = fmax(area, state.areas[index]);
+      sift_visvalingam_entry(&state, state.positions[neighbour]);
+    }
+  }
+
+  free(state.previous);
+  free(state.next);
+  free(state.areas);
+  free(state.heap);
+  free(state.positions);
+  return kept;
+}
+
+int simplify_vectors(vector_t *points, int count, double tolerance,
+                     simplify_method_t method, bool closed, bool *keep) {
+  if (!closed)
+    return (method == SIMPLIFY_VISVALINGAM)
+               ? simplify_visvalingam(points, count, tolerance, keep)
+               : simplify_douglas_peucker(points, count, tolerance, keep);
+
+  // Closed lines go back to their first point, which is appended to the line.
+  vector_t *ring = malloc(sizeof(vector_t) * (count + 1));
+  bool *ring_keep = malloc(sizeof(bool) * (count + 1));
+  for (int i = 0; i < count; i++)
+    ring[i] = points[i];
+  ring[count] = points[0];
+  int kept = (method == SIMPLIFY_VISVALINGAM)
+                 ? simplify_visvalingam(ring, count + 1, tolerance, ring_keep)
+                 : simplify_douglas_peucker(ring, count + 1, tolerance,
+                                            ring_keep);
+  kept--;
+  for (int i = 0; i < count; i++)
+    keep[i] = ring_keep[i] || kept < 3;
+  free(ring);
+  free(ring_keep);
+  return (kept < 3) ? count : kept;
+}
+
+int simplify_polyline(polyline_t *polyline, double tolerance,
+                      simplify_method_t method) {
+  bool *keep = malloc(sizeof(bool) * polyline->count);
+  simplify_vectors(polyline->points, polyline->count, tolerance, method,
+                   polyline->closed, keep);
+  int kept = 0;
+  for (int i = 0; i < polyline->count; i++)
+    if (keep[i])
+      polyline->points[kept++] = polyline->points[i];
+  int removed = polyline->count - kept;
+  polyline->count = kept;
+  free(keep);
+  return removed;
+}
+
+point_node_t *simplify_point_list(point_node_t *points, double tolerance,
+                                  simplify_method_t method, bool closed) {
+  int count = get_point_node_length(points);
+  vector_t *vectors = malloc(sizeof(vector_t) * count);
+  bool *keep = malloc(sizeof(bool) * count);
+  int i = 0;
+  for (point_node_t *node = points; node != NULL; node = node->next, i++)
+    vectors[i] = (vector_t){.x = node->point->x, .y = node->point->y};
+  int kept = simplify_vectors(vectors, count, tolerance, method, closed, keep);
+  free(vectors);
+  if (kept == count) {
+    free(keep);
+    return NULL;
+  }
+
+  point_node_t *simplified = NULL, *last = NULL;
+  i = 0;
+  for (point_node_t *node = points; node != NULL; node = node->next, i++) {
+    if (!keep[i])
+      continue;
+    if (last == NULL) {
+      simplified = push_point_node(NULL, clone_point(node->point));
+      last = simplified;
+    } else {
+      push_point_node(last, clone_point(node->point));
+      last = last->next;
+    }
+  }
+  free(keep);
+  return simplified;
+}
+
+void push_simplify_path_point(simplify_path_context_t *state, vector_t point,
+                              int owner) {
+  if (state->count == state->capacity) {
+    state->capacity = (state->capacity == 0) ? 16 : state->capacity * 2;
+    state->points = realloc(state->points, sizeof(vector_t) * state->capacity);
+    state->owners = realloc(state->owners, sizeof(int) * state->capacity);
+  }
+  state->points[state->count] = point;
+  state->owners[state->count++] = owner;
+}
+
+void visit_simplify_segment(segment_t *segment, void *context) {
+  simplify_path_context_t *state = context;
+  polyline_list_t *list = state->flatten.list;
+  int polylines = list->count;
+  int first = (polylines > 0) ? list->polylines[polylines - 1].count : 0;
+  visit_flatten_segment(segment, &state->flatten);
+
+  // The first point of a subpath belongs to no element.
+  polyline_t *polyline = &list->polylines[list->count - 1];
+  if (list->count > polylines) {
+    push_simplify_path_point(state, polyline->points[0], -1);
+    first = 1;
+  }
+  for (int i = first; i < polyline->count; i++)
+    push_simplify_path_point(state, polyline->points[i],
+                             state->segment_count);
+
+  if (state->segment_count == state->segment_capacity) {
+    state->segment_capacity =
+        (state->segment_capacity == 0) ? 16 : state->segment_capacity * 2;
+    state->segments = realloc(state->segments,
+                              sizeof(segment_t) * state->segment_capacity);
+  }
+  state->segments[state->segment_count++] = *segment;
+}
+
+point_t *new_rounded_point(vector_t vector) {
+  return new_point((int)lround(vector.x), (int)lround(vector.y));
+}
+
+path_element_t *new_segment_path_element(segment_t *segment) {
+  switch (segment->variant) {
+  case SEGMENT_CUBIC:
+    return new_cubic_curve_to(new_rounded_point(segment->control_1),
+                              new_rounded_point(segment->control_2),
+                              new_rounded_point(segment->end));
+  case SEGMENT_QUADRATIC:
+    return new_quadratic_curve_to(new_rounded_point(segment->control_1),
+                                  new_rounded_point(segment->end));
+  case SEGMENT_LINE:
+  default:
+    return new_line_to(new_rounded_point(segment->end));
+  }
+}
+
+path_element_node_t *append_path_element(path_element_node_t *last,
+                                         path_element_t *element) {
+  if (last == NULL)
+    return push_path_element_node(NULL, element);
+  push_path_element_node(last, element);
+  return last->next;
+}
+
+bool is_path_element_relative(path_element_variant_t variant) {
+  return variant == HORIZONTAL_LINE_TO || variant == VERTICAL_LINE_TO ||
+         variant == CUBIC_CURVE_TO_SHORTHAND ||
+         variant == QUADRATIC_CURVE_TO_SHORTHAND;
+}
+
+bool is_path_element_shorthand(path_element_variant_t variant) {
+  return variant == CUBIC_CURVE_TO_SHORTHAND ||
+         variant == QUADRATIC_CURVE_TO_SHORTHAND;
+}
+
+int get_path_element_point_count(path_element_variant_t variant) {
+  switch (variant) {
+  case END_PATH:
+    return 0;
+  case CUBIC_CURVE_TO:
+    return 3;
+  case CUBIC_CURVE_TO_SHORTHAND:
+  case QUADRATIC_CURVE_TO:
+    return 2;
+  default:
+    return 1;
+  }
+}
+
+path_element_node_t *simplify_path(path_t *path, double tolerance,
+                                   simplify_method_t method, int *removed) {
+  simplify_path_context_t state = {
+      .flatten = {.list = new_polyline_list(), .tolerance = tolerance / 2}};
+  walk_path_segments(path, visit_simplify_segment, &state);
+  polyline_list_t *list = state.flatten.list;
+  bool *keep = malloc(sizeof(bool) * (state.count + 1));
+  int count = 0, offset = 0;
+  for (int i = 0; i < list->count; i++) {
+    polyline_t *polyline = &list->polylines[i];
+    count += polyline->count -
+             simplify_vectors(state.points + offset, polyline->count,
+                              tolerance / 2, method, polyline->closed,
+                              keep + offset);
+    offset += polyline->count;
+  }
+  free_polyline_list(list);
+
+  // An element is only replaced by lines through its kept points when they
+  // are fewer than its own points, so that the path never grows. A kept
+  // shorthand curve drawn after a replaced element is written in full, which
+  // costs a point. The other elements are kept as they are.
+  path_element_node_t *simplified = NULL, *last = NULL;
+  bool replaced = false;
+  int point = 0, segment = 0, saved = 0;
+  for (path_element_node_t *node = path; count > 0 && node != NULL;
+       node = node->next) {
+    path_element_t *element = node->element;
+    path_element_variant_t variant = element->path_element_variant;
+    int first = point, points = get_path_element_point_count(variant);
+    int kept = 0;
+    if (variant != MOVE_TO) {
+      while (point < state.count && state.owners[point] == -1)
+        point++;
+      for (first = point;
+           point < state.count && state.owners[point] == segment; point++)
+        kept += keep[point];
+    }
+    bool is_relative = replaced && is_path_element_relative(variant);
+    if (is_relative && is_path_element_shorthand(variant))
+      points++;
+    int cost = kept;
+    if (node->next != NULL &&
+        is_path_element_shorthand(node->next->element->path_element_variant))
+      cost++;
+
+    replaced = variant != MOVE_TO && variant != END_PATH && cost < points;
+    if (replaced) {
+      saved += get_path_element_point_count(variant) - kept;
+      for (int i = first; i < point; i++)
+        if (keep[i])
+          last = append_path_element(
+              last, new_line_to(new_rounded_point(state.points[i])));
+    } else if (is_relative) {
+      saved += get_path_element_point_count(variant) - points;
+      last = append_path_element(
+          last, new_segment_path_element(&state.segments[segment]));
+    } else
+      last = append_path_element(last, clone_path_element(element));
+    if (simplified == NULL)
+      simplified = last;
+    if (variant != MOVE_TO)
+      segment++;
+  }
+  free(keep);
+  free(state.points);
+  free(state.owners);
+  free(state.segments);
+  if (saved <= 0) {
+    free_path_element_nodes(simplified);
+    return NULL;
+  }
+  if (removed != NULL)
+    *removed += saved;
+  return simplified;
+}
+
+shape_t *simplify_shape_copy(shape_t *shape, double tolerance,
+                             simplify_method_t method, int *removed) {
+  point_node_t *points;
+  path_element_node_t *path;
+  int count = 0;
+
+  if (tolerance <= 0 || is_instance(shape))
+    return NULL;
+  switch (shape->shape_variant) {
+  case ELLIPSE:
+  case RECTANGLE:
+  case LINE:
+    return NULL;
+  case MULTILINE:
+  case POLYGON:
+    points = simplify_point_list(shape->shape->multiline, tolerance, method,
+                                 shape->shape_variant == POLYGON);
+    if (points == NULL)
+      return NULL;
+    if (removed != NULL)
+      *removed += get_point_node_length(shape->shape->multiline) -
+                  get_point_node_length(points);
+    if (shape->shape_variant == POLYGON)
+      return new_polygon(points, clone_style(shape->styles));
+    return new_multiline(points, clone_style(shape->styles));
+  case PATH:
+    path = simplify_path(shape->shape->path, tolerance, method, &count);
+    if (path == NULL)
+      return NULL;
+    if (removed != NULL)
+      *removed += count;
+    return new_path(path, clone_style(shape->styles));
+  case GROUP:
+    break;
+  }
+
+  // The group is copied at its first simplified shape, its copy's shapes
+  // being replaced from there on.
+  shape_t *copy = NULL;
+  shape_node_t *copied = NULL;
+  int index = 0;
+  for (shape_node_t *node = shape->shape->group; node != NULL;
+       node = node->next, index++) {
+    shape_t *simplified =
+        simplify_shape_copy(node->shape, tolerance, method, removed);
+    if (copy != NULL)
+      copied = copied->next;
+    if (simplified == NULL)
+      continue;
+    if (copy == NULL) {
+      copy = copy_shape(shape);
+      copied = copy->shape->group;
+      for (int i = 0; i < index; i++)
+        copied = copied->next;
+    }
+    free_shape(copied->shape);
+    copied->shape = simplified;
+  }
+  return copy;
+}
+
+int simplify_shape(shape_t *shape, double tolerance, simplify_method_t method) {
+  int removed = 0;
+  point_node_t *points;
+  path_element_node_t *path;
+
+  if (tolerance <= 0)
+    return 0;
+  switch (shape->shape_variant) {
+  case ELLIPSE:
+  case RECTANGLE:
+  case LINE:
+    return 0;
+  case MULTILINE:
+  case POLYGON:
+    points = simplify_point_list(shape->shape->multiline, tolerance, method,
+                                 shape->shape_variant == POLYGON);
+    if (points == NULL)
+      return 0;
+    removed = get_point_node_length(shape->shape->multiline) -
+              get_point_node_length(points);
+    free_point_nodes(shape->shape->multiline);
+    shape->shape->multiline = points;
+    break;
+  case PATH:
+    path = simplify_path(shape->shape->path, tolerance, method, &removed);
+    if (path == NULL)
+      return 0;
+    free_path(shape->shape->path);
+    shape->shape->path = path;
+    break;
+  case GROUP:
+    removed = simplify_shapes(shape->shape->group, tolerance, method);
+    if (removed == 0)
+      return 0;
+    break;
+  }
+
+  invalidate_shape_bbox(shape);
+  invalidate_shape_hash(shape);
+  return removed;
+}
+
+int simplify_shapes(shape_node_t *shapes, double tolerance,
+                    simplify_method_t method) {
+  int removed = 0;
+  if (tolerance <= 0)
+    return 0;
+  for (shape_node_t *node = shapes; node != NULL; node = node->next) {
+    // The shared shapes are only copied when they lose points.
+    if (is_instance(node->shape))
+      continue;
+    if (node->shape->references == 1) {
+      removed += simplify_shape(node->shape, tolerance, method);
+      continue;
+    }
+    shape_t *simplified =
+        simplify_shape_copy(node->shape, tolerance, method, &removed);
+    if (simplified == NULL)
+      continue;
+    free_shape(node->shape);
+    node->shape = simplified;
+  }
+  return removed;
+}
+
+int simplify_svg(svg_t *svg, double tolerance, simplify_method_t method) {
+  return simplify_shapes(svg->shapes, tolerance, method);
+}
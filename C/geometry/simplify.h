@@ -0,0 +1,340 @@
+#ifndef CODA_SIMPLIFY
+#define CODA_SIMPLIFY
+
+#include "../models/shapes/path/path.h"
+#include "../models/shapes/shape.h"
+#include "../models/shapes/svg.h"
+#include "../models/utils/point.h"
+#include "flatten.h"
+#include "segment.h"
+#include "vector.h"
+#include <stdbool.h>
+
+/**
+ * Defines the simplification algorithms.
+ * The Douglas-Peucker algorithm keeps the points farther than the tolerance
+ * from the simplified line. The Visvalingam-Whyatt algorithm removes the points
+ * forming the smallest triangles with their neighbours until all the triangles
+ * areas exceed the squared tolerance.
+ */
+typedef enum simplify_method_e {
+  SIMPLIFY_DOUGLAS_PEUCKER,
+  SIMPLIFY_VISVALINGAM,
+} simplify_method_t;
+
+/**
+ * Holds the state of a Visvalingam-Whyatt simplification.
+ * The points are kept in a doubly linked list by index and their triangles
+ * areas in a binary min-heap.
+ * @param points    the points.
+ * @param previous  the index of each point's previous remaining point.
+ * @param next      the index of each point's next remaining point.
+ * @param areas     the area of the triangle formed by each point and its
+ * neighbours.
+ * @param heap      the heap of point indexes, ordered by area.
+ * @param positions the position of each point in the heap, -1 if it is not in
+ * the heap.
+ * @param size      the number of points in the heap.
+ */
+typedef struct visvalingam_state_s {
+  vector_t *points;
+  int *previous;
+  int *next;
+  double *areas;
+  int *heap;
+  int *positions;
+  int size;
+} visvalingam_state_t;
+
+/**
+ * Marks the points kept by the Douglas-Peucker algorithm.
+ * The algorithm uses an explicit stack of ranges instead of recursion so that
+ * long lines cannot overflow the call stack. The first and last points are
+ * always kept.
+ * @param points    the points.
+ * @param count     the number of points.
+ * @param tolerance the maximum distance between a removed point and the
+ * simplified line.
+ * @param keep      an array of count booleans to set.
+ * @return the number of kept points.
+ * @see vector_t.
+ */
+int simplify_douglas_peucker(vector_t *points, int count, double tolerance,
+                             bool *keep);
+
+/**
+ * Computes the area of the triangle formed by the given points.
+ * @param a the first point.
+ * @param b the second point.
+ * @param c the third point.
+ * @return the triangle's area.
+ * @see vector_t.
+ */
+double get_triangle_area(vector_t a, vector_t b, vector_t c);
+
+/**
+ * Swaps the given heap entries and updates their positions.
+ * @param state the simplification state.
+ * @param i     the first heap position.
+ * @param j     the second heap position.
+ * @see visvalingam_state_t.
+ */
+void swap_visvalingam_entries(visvalingam_state_t *state, int i, int j);
+
+/**
+ * Moves the given heap entry to its place after its area changed.
+ * @param state    the simplification state.
+ * @param position the entry's heap position.
+ * @see visvalingam_state_t.
+ */
+void sift_visvalingam_entry(visvalingam_state_t *state, int position);
+
+/**
+ * Removes the given point from the heap.
+ * @param state the simplification state.
+ * @param index the point's index.
+ * @see visvalingam_state_t.
+ */
+void remove_visvalingam_entry(visvalingam_state_t *state, int index);
+
+/**
+ * Marks the points kept by the Visvalingam-Whyatt algorithm.
+ * The first and last points are always kept.
+ * @param points    the points.
+ * @param count     the number of points.
+ * @param tolerance the square root of the minimum area of the triangles
+ * formed by the kept points.
+ * @param keep      an array of count booleans to set.
+ * @return the number of kept points.
+ * @see vector_t.
+ */
+int simplify_visvalingam(vector_t *points, int count, double tolerance,
+                         bool *keep);
+
+/**
+ * Marks the points kept by the given simplification algorithm.
+ * Closed lines are simplified as lines going back to their first point, and
+ * are left untouched if less than 3 points would be kept.
+ * Note that this function allocates memory.
+ * @param points    the points.
+ * @param count     the number of points.
+ * @param tolerance the simplification tolerance.
+ * @param method    the simplification algorithm.
+ * @param closed    indicates if the last point is linked to the first one.
+ * @param keep      an array of count booleans to set.
+ * @return the number of kept points.
+ * @see simplify_method_t.
+ */
+int simplify_vectors(vector_t *points, int count, double tolerance,
+                     simplify_method_t method, bool closed, bool *keep);
+
+/**
+ * Simplifies the given polyline in place.
+ * Note that this function allocates memory.
+ * @param polyline  the polyline.
+ * @param tolerance the simplification tolerance.
+ * @param method    the simplification algorithm.
+ * @return the number of removed points.
+ * @see polyline_t.
+ */
+int simplify_polyline(polyline_t *polyline, double tolerance,
+                      simplify_method_t method);
+
+/**
+ * Holds the state of a path simplification, the path's flattened points and
+ * the elements they come from.
+ * @param flatten          the flattening state.
+ * @param points           the flattened points, in the order of the
+ * polylines.
+ * @param owners           the index of the segment each point comes from, -1
+ * for the first points of the subpaths.
+ * @param count            the number of points.
+ * @param capacity         the points and owners arrays' capacity.
+ * @param segments         the path's segments, one per element other than
+ * the moves.
+ * @param segment_count    the number of segments.
+ * @param segment_capacity the segments array's capacity.
+ * @see flatten_context_t.
+ * @see segment_t.
+ */
+typedef struct simplify_path_context_s {
+  flatten_context_t flatten;
+  vector_t *points;
+  int *owners;
+  int count;
+  int capacity;
+  segment_t *segments;
+  int segment_count;
+  int segment_capacity;
+} simplify_path_context_t;
+
+/**
+ * Creates a simplified copy of the given point linked list, unless no point
+ * can be removed.
+ * Note that this function allocates memory.
+ * @param points    the point linked list.
+ * @param tolerance the simplification tolerance.
+ * @param method    the simplification algorithm.
+ * @param closed    indicates if the last point is linked to the first one.
+ * @return the new point linked list, NULL if no point was removed.
+ * @see point_node_t.
+ */
+point_node_t *simplify_point_list(point_node_t *points, double tolerance,
+                                  simplify_method_t method, bool closed);
+
+/**
+ * Appends the given flattened point to the given path simplification.
+ * Note that this function may allocate memory.
+ * @param state the path simplification state.
+ * @param point the point.
+ * @param owner the index of the segment the point comes from, -1 if none.
+ * @see simplify_path_context_t.
+ */
+void push_simplify_path_point(simplify_path_context_t *state, vector_t point,
+                              int owner);
+
+/**
+ * Flattens the given segment, recording the segment and the points it adds.
+ * Meant to be given to walk_path_segments.
+ * Note that this function may allocate memory.
+ * @param segment the segment.
+ * @param context a pointer to the path simplification state.
+ * @see simplify_path_context_t.
+ */
+void visit_simplify_segment(segment_t *segment, void *context);
+
+/**
+ * Creates a new point at the given vector, rounded to the nearest integers.
+ * Note that this function allocates memory.
+ * @param vector the vector.
+ * @return the new point's pointer.
+ */
+point_t *new_rounded_point(vector_t vector);
+
+/**
+ * Creates the path element drawing the given segment, without shorthands.
+ * Note that this function allocates memory.
+ * @param segment the segment.
+ * @return the new path element's pointer.
+ * @see segment_t.
+ */
+path_element_t *new_segment_path_element(segment_t *segment);
+
+/**
+ * Appends the given path element after the given last node.
+ * Note that this function allocates memory.
+ * @param last    the last node, NULL for a new linked list.
+ * @param element the path element.
+ * @return the new last node's pointer.
+ * @see path_element_node_t.
+ */
+path_element_node_t *append_path_element(path_element_node_t *last,
+                                         path_element_t *element);
+
+/**
+ * Indicates if the given path element is drawn relatively to the previous
+ * one, i.e. it is a horizontal or vertical line or a shorthand curve.
+ * @param variant the path element's variant.
+ * @return returns true if the path element depends on the previous one.
+ */
+bool is_path_element_relative(path_element_variant_t variant);
+
+/**
+ * Indicates if the given path element is a shorthand curve, whose first
+ * control point is the reflection of the previous one's last.
+ * @param variant the path element's variant.
+ * @return returns true if the path element is a shorthand curve.
+ */
+bool is_path_element_shorthand(path_element_variant_t variant);
+
+/**
+ * Gets the number of points written down for a path element, its control
+ * points included.
+ * @param variant the path element's variant.
+ * @return the number of points.
+ */
+int get_path_element_point_count(path_element_variant_t variant);
+
+/**
+ * Creates a simplified copy of the given path, unless no point can be
+ * removed.
+ * The path is flattened into lines with half the tolerance, then the lines
+ * are simplified with the other half, so that the result stays within the
+ * tolerance of the original curves. An element is turned into lines through
+ * its kept flattened points only when they are fewer than its own points,
+ * the others are kept as they are, so that the copy never has more points
+ * than the path.
+ * Note that this function allocates memory.
+ * @param path      the path.
+ * @param tolerance the simplification tolerance.
+ * @param method    the simplification algorithm.
+ * @param removed   a pointer to add the number of removed points to, can be
+ * NULL.
+ * @return the new path elements linked list, NULL if no point was removed.
+ * @see path_t.
+ */
+path_element_node_t *simplify_path(path_t *path, double tolerance,
+                                   simplify_method_t method, int *removed);
+
+/**
+ * Creates a simplified copy of the given shape, unless no point can be
+ * removed. The shape is left untouched, as are the shapes of a group which
+ * lose no point, the copy sharing them.
+ * Note that this function allocates memory.
+ * @param shape     the shape.
+ * @param tolerance the simplification tolerance.
+ * @param method    the simplification algorithm.
+ * @param removed   a pointer to add the number of removed points to, can be
+ * NULL.
+ * @return the new shape's pointer, NULL if no point was removed.
+ * @see shape_t.
+ */
+shape_t *simplify_shape_copy(shape_t *shape, double tolerance,
+                             simplify_method_t method, int *removed);
+
+/**
+ * Simplifies the given shape in place.
+ * Multilines, polygons and paths are simplified, and groups simplify their
+ * shapes. The other shapes are left untouched.
+ * The shape's cached bounding box is discarded if it lost points, the groups
+ * containing it must be invalidated by the caller. The shape must not be
+ * shared, the shared shapes of groups are replaced by copies only when they
+ * lose points.
+ * Note that this function frees memory.
+ * @param shape     the shape.
+ * @param tolerance the simplification tolerance.
+ * @param method    the simplification algorithm.
+ * @return the number of removed points, 0 if the tolerance is not positive.
+ * @see shape_t.
+ */
+int simplify_shape(shape_t *shape, double tolerance, simplify_method_t method);
+
+/**
+ * Simplifies all the given shapes in place.
+ * The shared shapes losing points are replaced by simplified copies, leaving
+ * the other owners' shapes untouched. The instances are left untouched too, since
+ * their content belongs to their symbol.
+ * Note that this function frees memory.
+ * @param shapes    the shape linked list.
+ * @param tolerance the simplification tolerance.
+ * @param method    the simplification algorithm.
+ * @return the number of removed points.
+ * @see simplify_shape.
+ * @see shape_node_t.
+ */
+int simplify_shapes(shape_node_t *shapes, double tolerance,
+                    simplify_method_t method);
+
+/**
+ * Simplifies all the given svg's shapes in place.
+ * Note that this function frees memory.
+ * @param svg       the svg.
+ * @param tolerance the simplification tolerance.
+ * @param method    the simplification algorithm.
+ * @return the number of removed points.
+ * @see simplify_shape.
+ * @see svg_t.
+ */
+int simplify_svg(svg_t *svg, double tolerance, simplify_method_t method);
+
+#endif
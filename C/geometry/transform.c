@@ -0,0 +1,125 @@
+#include "transform.h"
+#include "../models/shapes/shape.h"
+#include "../models/shapes/svg.h"
+#include "../models/styles/style.h"
+#include "../models/utils/affine.h"
+#include "../models/utils/bbox.h"
+#include "vector.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define PI 3.14159265358979323846
+
+void get_rotation(int degrees, double *cosine, double *sine) {
+  degrees %= 360;
+  if (degrees < 0)
+    degrees += 360;
+  switch (degrees) {
+  case 0:
+    *cosine = 1;
+    *sine = 0;
+    return;
+  case 90:
+    *cosine = 0;
+    *sine = 1;
+    return;
+  case 180:
+    *cosine = -1;
+    *sine = 0;
+    return;
+  case 270:
+    *cosine = 0;
+    *sine = -1;
+    return;
+  }
+  *cosine = cos(degrees * PI / 180);
+  *sine = sin(degrees * PI / 180);
+}
+
+affine_t get_style_affine(style_t *style) {
+  affine_t affine = get_identity_affine();
+  if (style == NULL)
+    return affine;
+
+  if (style->rotate != NULL) {
+    switch (style->rotate->variant) {
+    case FLIP_X:
+      affine.d = -1;
+      break;
+    case FLIP_Y:
+      affine.a = -1;
+      break;
+    case CIRCULAR:
+      get_rotation(style->rotate->rotation.circular, &affine.a, &affine.b);
+      affine.c = -affine.b;
+      affine.d = affine.a;
+      break;
+    }
+  }
+  if (style->translate != NULL) {
+    affine.e = style->translate->x;
+    affine.f = style->translate->y;
+  }
+  return affine;
+}
+
+vector_t apply_affine(affine_t *affine, vector_t point) {
+  return (vector_t){.x = affine->a * point.x + affine->c * point.y + affine->e,
+                    .y = affine->b * point.x + affine->d * point.y + affine->f};
+}
+
+void extend_bbox_transformed(bbox_t *bbox, affine_t *affine, double x,
+                             double y) {
+  vector_t point = apply_affine(affine, (vector_t){.x = x, .y = y});
+  extend_bbox(bbox, point.x, point.y);
+}
+
+bbox_t *transform_bbox(affine_t *affine, bbox_t *bbox) {
+  bbox_t *result = new_empty_bbox();
+  if (is_bbox_empty(bbox))
+    return result;
+  extend_bbox_transformed(result, affine, bbox->min_x, bbox->min_y);
+  extend_bbox_transformed(result, affine, bbox->max_x, bbox->min_y);
+  extend_bbox_transformed(result, affine, bbox->min_x, bbox->max_y);
+  extend_bbox_transformed(result, affine, bbox->max_x, bbox->max_y);
+  return result;
+}
+
+affine_t *get_local_transform(shape_t *shape) {
+  if (shape->transform == NULL)
+    shape->transform = new_transform(get_style_affine(shape->styles));
+  return &shape->transform->local;
+}
+
+affine_t *get_world_transform(shape_t *shape, affine_t *parent) {
+  affine_t *local = get_local_transform(shape);
+  transform_t *transform = shape->transform;
+  affine_t identity = get_identity_affine();
+  if (parent == NULL)
+    parent = &identity;
+  if (!transform->has_world || !are_affines_equal(&transform->parent, parent)) {
+    transform->parent = *parent;
+    transform->world = multiply_affine(parent, local);
+    transform->has_world = true;
+  }
+  return &transform->world;
+}
+
+void invalidate_shape_transform(shape_t *shape) {
+  free_transform(shape->transform);
+  shape->transform = NULL;
+}
+
+void resolve_shape_transforms(shape_t *shape, affine_t *parent) {
+  affine_t *world = get_world_transform(shape, parent);
+  if (shape->shape_variant != GROUP)
+    return;
+  for (shape_node_t *node = shape->shape->group; node != NULL;
+       node = node->next)
+    resolve_shape_transforms(node->shape, world);
+}
+
+void resolve_svg_transforms(svg_t *svg) {
+  for (shape_node_t *node = svg->shapes; node != NULL; node = node->next)
+    resolve_shape_transforms(node->shape, NULL);
+}
@@ -0,0 +1,130 @@
+#ifndef CODA_TRANSFORM
+#define CODA_TRANSFORM
+
+#include "../models/shapes/shape.h"
+#include "../models/shapes/svg.h"
+#include "../models/styles/style.h"
+#include "../models/utils/affine.h"
+#include "../models/utils/bbox.h"
+#include "vector.h"
+
+/**
+ * Computes the cosine and sine of the given angle in degrees.
+ * The results are exact for the multiples of 90 degrees.
+ * @param degrees the angle in degrees.
+ * @param cosine  a pointer to set the angle's cosine.
+ * @param sine    a pointer to set the angle's sine.
+ */
+void get_rotation(int degrees, double *cosine, double *sine);
+
+/**
+ * Computes the transformation described by the given style.
+ * The style's rotation is applied first, then its translation, matching the
+ * "translate(...) rotate(...)" order used by the HTML export.
+ * The rotate "X" variant mirrors the Y coordinates and the rotate "Y" variant
+ * mirrors the X coordinates, as rotateX(180) and rotateY(180) do.
+ * @param style the style, can be NULL.
+ * @return the style's transformation.
+ * @see style_t.
+ * @see affine_t.
+ */
+affine_t get_style_affine(style_t *style);
+
+/**
+ * Applies the given transformation to the given point.
+ * @param affine the transformation.
+ * @param point  the point to transform.
+ * @return the transformed point.
+ * @see affine_t.
+ * @see vector_t.
+ */
+vector_t apply_affine(affine_t *affine, vector_t point);
+
+/**
+ * Extends the given bounding box with the given point once transformed.
+ * @param bbox   the bounding box.
+ * @param affine the transformation.
+ * @param x      the point's X coordinate.
+ * @param y      the point's Y coordinate.
+ * @see affine_t.
+ * @see bbox_t.
+ */
+void extend_bbox_transformed(bbox_t *bbox, affine_t *affine, double x,
+                             double y);
+
+/**
+ * Computes the bounding box of the given bounding box once transformed.
+ * Note that this function allocates memory.
+ * Note that the result is exact for translations and flips, and contains the
+ * rotated box otherwise.
+ * @param affine the transformation.
+ * @param bbox   the bounding box to transform.
+ * @return the transformed bounding box's pointer.
+ * @see affine_t.
+ * @see bbox_t.
+ */
+bbox_t *transform_bbox(affine_t *affine, bbox_t *bbox);
+
+/**
+ * Retrieves the transformation described by the given shape's styles.
+ * The transformation, and thus the rotation's sine and cosine, are computed on
+ * the first call then cached on the shape until invalidate_shape_transform is
+ * called.
+ * Note that the returned pointer belongs to the shape and must not be freed.
+ * Note that this function may allocate memory.
+ * @param shape the shape.
+ * @return the shape's local transformation's pointer.
+ * @see shape_t.
+ * @see affine_t.
+ */
+affine_t *get_local_transform(shape_t *shape);
+
+/**
+ * Retrieves the transformation from the given shape's coordinates system to the
+ * svg's coordinates system.
+ * The transformation is cached on the shape and only computed again when the
+ * given parent's transformation differs from the one it was computed with.
+ * Note that the returned pointer belongs to the shape and must not be freed.
+ * Note that this function may allocate memory.
+ * @param shape  the shape.
+ * @param parent the world transformation of the group containing the shape, or
+ * NULL for the svg's shapes.
+ * @return the shape's world transformation's pointer.
+ * @see get_local_transform.
+ * @see shape_t.
+ * @see affine_t.
+ */
+affine_t *get_world_transform(shape_t *shape, affine_t *parent);
+
+/**
+ * Discards the cached transformations of the given shape.
+ * This function must be called each time the shape's styles are updated.
+ * Note that this function frees memory.
+ * @param shape the shape.
+ * @see shape_t.
+ */
+void invalidate_shape_transform(shape_t *shape);
+
+/**
+ * Computes the world transformations of the given shape and, for groups, of
+ * all the shapes it contains.
+ * Note that this function may allocate memory.
+ * @param shape  the shape.
+ * @param parent the world transformation of the group containing the shape, or
+ * NULL for the svg's shapes.
+ * @see get_world_transform.
+ * @see shape_t.
+ */
+void resolve_shape_transforms(shape_t *shape, affine_t *parent);
+
+/**
+ * Computes the world transformations of all the given svg's shapes, so that
+ * they can be reused by the bounding boxes, hit-testing and exports.
+ * Note that this function may allocate memory.
+ * @param svg the svg.
+ * @see resolve_shape_transforms.
+ * @see svg_t.
+ */
+void resolve_svg_transforms(svg_t *svg);
+
+#endif
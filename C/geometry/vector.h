@@ -0,0 +1,17 @@
+#ifndef CODA_VECTOR
+#define CODA_VECTOR
+
+/**
+ * Represents a point or a direction in a 2D space with real coordinates.
+ * Unlike point_t, vectors are handled by value and are meant for
+ * intermediate geometry computations.
+ * @param x the X coordinate.
+ * @param y the Y coordinate.
+ * @see point_t.
+ */
+typedef struct vector_s {
+  double x;
+  double y;
+} vector_t;
+
+#endif
@@ -0,0 +1,192 @@
+#include "dedupe.h"
+#include "../geometry/bounds.h"
+#include "../history/history.h"
+#include "../models/shapes/shape.h"
+#include "../models/shapes/svg.h"
+#include "../models/shapes/symbol.h"
+#include "hash.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SHAPE_TABLE_CAPACITY 64
+#define SYMBOL_ID_BUFFER_SIZE 32
+
+shape_table_t *new_shape_table(unsigned int capacity) {
+  shape_table_t *table = malloc(sizeof(shape_table_t));
+  table->entries = calloc(capacity, sizeof(shape_table_entry_t));
+  table->capacity = capacity;
+  table->count = 0;
+  return table;
+}
+
+void grow_shape_table(shape_table_t *table) {
+  shape_table_entry_t *entries = table->entries;
+  unsigned int capacity = table->capacity;
+  table->capacity *= 2;
+  table->entries = calloc(table->capacity, sizeof(shape_table_entry_t));
+  for (unsigned int i = 0; i < capacity; i++) {
+    if (entries[i].shape == NULL)
+      continue;
+    uint64_t hash = get_shape_hash(entries[i].shape);
+    unsigned int slot = (hash ^ hash >> 32) & (table->capacity - 1);
+    while (table->entries[slot].shape != NULL)
+      slot = (slot + 1) & (table->capacity - 1);
+    table->entries[slot] = entries[i];
+  }
+  free(entries);
+}
+
+shape_table_entry_t *lookup_shape_table(shape_table_t *table, shape_t *shape,
+                                        bool *found) {
+  // Keeps at least half of the entries free so that the probes stay short.
+  if (2 * (table->count + 1) > table->capacity)
+    grow_shape_table(table);
+
+  uint64_t hash = get_shape_hash(shape);
+  unsigned int slot = (hash ^ hash >> 32) & (table->capacity - 1);
+  while (table->entries[slot].shape != NULL) {
+    if (are_shapes_equal(table->entries[slot].shape, shape)) {
+      *found = true;
+      return &table->entries[slot];
+    }
+    slot = (slot + 1) & (table->capacity - 1);
+  }
+
+  *found = false;
+  table->entries[slot].shape = clone_shape(shape);
+  table->entries[slot].copies = 0;
+  table->entries[slot].symbol = NULL;
+  table->count++;
+  return &table->entries[slot];
+}
+
+void free_shape_table(shape_table_t *table) {
+  for (unsigned int i = 0; i < table->capacity; i++) {
+    if (table->entries[i].shape != NULL)
+      free_shape(table->entries[i].shape);
+    if (table->entries[i].symbol != NULL)
+      free_symbol(table->entries[i].symbol);
+  }
+  free(table->entries);
+  free(table);
+}
+
+void dedupe_shapes(shape_node_t *shapes, dedupe_report_t *report) {
+  bool found;
+  for (shape_node_t *node = shapes; node != NULL; node = node->next) {
+    report->shapes++;
+    shape_table_entry_t *entry =
+        lookup_shape_table(report->table, node->shape, &found);
+    if (!found) {
+      if (node->shape->shape_variant == GROUP && !is_instance(node->shape))
+        dedupe_shapes(node->shape->shape->group, report);
+      continue;
+    }
+
+    if (entry->copies++ == 0)
+      report->sets++;
+    report->duplicates++;
+    if (node->shape != entry->shape && node->shape->references == 1)
+      report->saved += get_shape_size(node->shape, true);
+  }
+}
+
+dedupe_report_t *dedupe_svg(svg_t *svg) {
+  dedupe_report_t *report = malloc(sizeof(dedupe_report_t));
+  report->table = new_shape_table(SHAPE_TABLE_CAPACITY);
+  report->shapes = 0;
+  report->duplicates = 0;
+  report->sets = 0;
+  report->saved = 0;
+  dedupe_shapes(svg->shapes, report);
+  return report;
+}
+
+bool has_instantiated_groups(shape_node_t *shapes, shape_table_t *table) {
+  bool found;
+  for (shape_node_t *node = shapes; node != NULL; node = node->next) {
+    if (node->shape->shape_variant != GROUP || is_instance(node->shape))
+      continue;
+    if (lookup_shape_table(table, node->shape, &found)->symbol != NULL ||
+        has_instantiated_groups(node->shape->shape->group, table))
+      return true;
+  }
+  return false;
+}
+
+unsigned int instantiate_shapes(shape_node_t *shapes, shape_table_t *table) {
+  unsigned int replaced = 0;
+  bool found;
+  for (shape_node_t *node = shapes; node != NULL; node = node->next) {
+    if (node->shape->shape_variant != GROUP || is_instance(node->shape))
+      continue;
+    // The walk follows dedupe_shapes, so every group is in the table.
+    shape_table_entry_t *entry =
+        lookup_shape_table(table, node->shape, &found);
+    if (entry->symbol != NULL) {
+      free_shape(node->shape);
+      node->shape =
+          new_instance(clone_symbol(entry->symbol), new_default_style());
+      replaced++;
+    } else if (has_instantiated_groups(node->shape->shape->group, table)) {
+      // The table holds a reference to the group, which is copied before its
+      // shapes are replaced.
+      shape_t *group = unshare_shape(&node->shape);
+      replaced += instantiate_shapes(group->shape->group, table);
+      invalidate_shape_bbox(group);
+      invalidate_shape_hash(group);
+    }
+  }
+  return replaced;
+}
+
+char *new_duplicate_symbol_id(symbol_node_t *symbols, unsigned int *next) {
+  char buffer[SYMBOL_ID_BUFFER_SIZE];
+  do
+    sprintf(buffer, "shared-%u", (*next)++);
+  while (find_symbol(symbols, buffer) != NULL);
+  char *id = malloc(strlen(buffer) + 1);
+  strcpy(id, buffer);
+  return id;
+}
+
+unsigned int instantiate_duplicates(svg_t *svg, dedupe_report_t *report) {
+  shape_table_t *table = report->table;
+  unsigned int next = 1;
+  for (unsigned int i = 0; i < table->capacity; i++) {
+    shape_table_entry_t *entry = &table->entries[i];
+    if (entry->shape == NULL || entry->copies == 0 ||
+        entry->shape->shape_variant != GROUP || is_instance(entry->shape))
+      continue;
+    // The svg holds a reference to the symbol, the entry another one.
+    entry->symbol = new_symbol(new_duplicate_symbol_id(svg->symbols, &next),
+                               clone_shape(entry->shape));
+    svg->symbols = push_symbol_node(svg->symbols, clone_symbol(entry->symbol));
+  }
+  return instantiate_shapes(svg->shapes, table);
+}
+
+int compare_duplicates(const void *a, const void *b) {
+  unsigned int copies_a = ((shape_table_entry_t *)a)->copies;
+  unsigned int copies_b = ((shape_table_entry_t *)b)->copies;
+  return (copies_a < copies_b) - (copies_a > copies_b);
+}
+
+shape_table_entry_t *list_duplicates(dedupe_report_t *report) {
+  shape_table_entry_t *duplicates =
+      malloc(sizeof(shape_table_entry_t) * (report->sets + 1));
+  unsigned int count = 0;
+  for (unsigned int i = 0; i < report->table->capacity; i++)
+    if (report->table->entries[i].copies > 0)
+      duplicates[count++] = report->table->entries[i];
+  qsort(duplicates, count, sizeof(shape_table_entry_t), compare_duplicates);
+  return duplicates;
+}
+
+void free_dedupe_report(dedupe_report_t *report) {
+  free_shape_table(report->table);
+  free(report);
+}
@@ -0,0 +1,197 @@
+#ifndef CODA_DEDUPE
+#define CODA_DEDUPE
+
+#include "../models/shapes/shape.h"
+#include "../models/shapes/svg.h"
+#include "../models/shapes/symbol.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Defines an entry of a shape table.
+ * @param shape  the first occurrence of the shape, NULL if the entry is free.
+ * @param copies the number of copies found after the first occurrence.
+ * @param symbol the symbol instantiated in place of the occurrences of a
+ * group, NULL if there is none.
+ * @see shape_t.
+ */
+typedef struct shape_table_entry_s {
+  shape_t *shape;
+  unsigned int copies;
+  symbol_t *symbol;
+} shape_table_entry_t;
+
+/**
+ * Defines a hash table of distinct shapes, keyed by their content hash.
+ * The table uses open addressing, its capacity is a power of two.
+ * @param entries  the entries.
+ * @param capacity the number of entries.
+ * @param count    the number of used entries.
+ * @see shape_table_entry_t.
+ */
+typedef struct shape_table_s {
+  shape_table_entry_t *entries;
+  unsigned int capacity;
+  unsigned int count;
+} shape_table_t;
+
+/**
+ * Defines the report of a deduplication.
+ * @param table      the distinct shapes, with their number of copies.
+ * @param shapes     the number of visited shapes.
+ * @param duplicates the number of copies found.
+ * @param sets       the number of distinct shapes having copies.
+ * @param saved      the estimated memory which sharing the copies would free,
+ * in bytes.
+ * @see shape_table_t.
+ */
+typedef struct dedupe_report_s {
+  shape_table_t *table;
+  unsigned int shapes;
+  unsigned int duplicates;
+  unsigned int sets;
+  size_t saved;
+} dedupe_report_t;
+
+/**
+ * Creates a new empty shape table.
+ * Note that this function allocates memory.
+ * @param capacity the initial number of entries, a power of two.
+ * @return the new shape table's pointer.
+ * @see shape_table_t.
+ */
+shape_table_t *new_shape_table(unsigned int capacity);
+
+/**
+ * Doubles the capacity of the given shape table.
+ * Note that this function allocates and frees memory.
+ * @param table the shape table.
+ * @see shape_table_t.
+ */
+void grow_shape_table(shape_table_t *table);
+
+/**
+ * Looks for a shape equal to the given one in the given table, adding the
+ * given shape to the table if there is none.
+ * Note that this function allocates memory.
+ * @param table the shape table.
+ * @param shape the shape.
+ * @param found a pointer to the boolean to set, true if an equal shape was
+ * already in the table.
+ * @return the entry holding the equal shape or the added one.
+ * @see are_shapes_equal.
+ * @see shape_table_t.
+ */
+shape_table_entry_t *lookup_shape_table(shape_table_t *table, shape_t *shape,
+                                        bool *found);
+
+/**
+ * Destroys the given shape table, releasing its shapes and symbols.
+ * Note that this function frees memory.
+ * @param table the shape table.
+ * @see shape_table_t.
+ */
+void free_shape_table(shape_table_t *table);
+
+/**
+ * Finds the copies of shapes and groups in the given shape linked list and
+ * its groups, the first occurrence of a shape being the original.
+ * The groups which are copies and the instances are not visited.
+ * Note that this function allocates memory.
+ * @param shapes the shape linked list.
+ * @param report the report to update.
+ * @see dedupe_report_t.
+ */
+void dedupe_shapes(shape_node_t *shapes, dedupe_report_t *report);
+
+/**
+ * Finds the copies of shapes and groups in the given svg.
+ * Note that this function allocates memory.
+ * @param svg the svg.
+ * @return the new report's pointer.
+ * @see dedupe_shapes.
+ * @see dedupe_report_t.
+ */
+dedupe_report_t *dedupe_svg(svg_t *svg);
+
+/**
+ * Tests if the given shape linked list or its groups hold a group whose entry
+ * in the given table has a symbol.
+ * @param shapes the shape linked list.
+ * @param table  the shape table.
+ * @return true if a group would be replaced by an instance, false otherwise.
+ * @see instantiate_shapes.
+ */
+bool has_instantiated_groups(shape_node_t *shapes, shape_table_t *table);
+
+/**
+ * Replaces the occurrences of the groups of the given table having copies,
+ * the original included, by instances of their entry's symbol.
+ * The groups holding a replaced shape are copied if they are shared, the
+ * given list must not be.
+ * Note that this function allocates and frees memory.
+ * @param shapes the shape linked list, deduplicated with the table.
+ * @param table  the shape table, whose entries hold the symbols.
+ * @return the number of replaced groups.
+ * @see new_instance.
+ */
+unsigned int instantiate_shapes(shape_node_t *shapes, shape_table_t *table);
+
+/**
+ * Defines each group having copies in the given svg as a new symbol, then
+ * replaces all its occurrences by instances of it, so that its content is
+ * written down once.
+ * The svg must not be shared and must not be indexed, since its shapes are
+ * replaced.
+ * Note that this function allocates and frees memory.
+ * @param svg    the svg.
+ * @param report the svg's deduplication report.
+ * @return the number of replaced groups.
+ * @see dedupe_svg.
+ * @see instantiate_shapes.
+ */
+unsigned int instantiate_duplicates(svg_t *svg, dedupe_report_t *report);
+
+/**
+ * Creates a symbol identifier which is not used in the given symbol linked
+ * list.
+ * Note that this function allocates memory.
+ * @param symbols the symbol linked list.
+ * @param next    a pointer to the number of the next identifier to try,
+ * which is updated.
+ * @return the new identifier.
+ * @see find_symbol.
+ */
+char *new_duplicate_symbol_id(symbol_node_t *symbols, unsigned int *next);
+
+/**
+ * Compares two shape table entries by their number of copies, the most
+ * copied first.
+ * @param a the first entry.
+ * @param b the second entry.
+ * @return a negative value if a has more copies, a positive one if it has
+ * less, 0 otherwise.
+ * @see shape_table_entry_t.
+ */
+int compare_duplicates(const void *a, const void *b);
+
+/**
+ * Lists the distinct shapes having copies in the given report, the most
+ * copied first.
+ * Note that this function allocates memory.
+ * @param report the report.
+ * @return the new array of report->sets entries, to be freed by the caller.
+ * The entries' shapes are owned by the report.
+ * @see dedupe_report_t.
+ */
+shape_table_entry_t *list_duplicates(dedupe_report_t *report);
+
+/**
+ * Destroys the given deduplication report.
+ * Note that this function frees memory.
+ * @param report the report.
+ * @see dedupe_report_t.
+ */
+void free_dedupe_report(dedupe_report_t *report);
+
+#endif
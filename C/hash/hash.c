@@ -0,0 +1,289 @@
+#include "hash.h"
+#include "../models/shapes/path/curve_to.h"
+#include "../models/shapes/path/path.h"
+#include "../models/shapes/shape.h"
+#include "../models/shapes/symbol.h"
+#include "../models/styles/color.h"
+#include "../models/styles/rotate.h"
+#include "../models/styles/style.h"
+#include "../models/utils/point.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+uint64_t hash_int(uint64_t hash, int value) {
+  unsigned int bits = (unsigned int)value;
+  for (int i = 0; i < 4; i++) {
+    hash ^= (bits >> (8 * i)) & 0xff;
+    hash *= FNV_PRIME;
+  }
+  return hash;
+}
+
+uint64_t hash_string(uint64_t hash, char *value) {
+  for (; *value != '\0'; value++) {
+    hash ^= (unsigned char)*value;
+    hash *= FNV_PRIME;
+  }
+  return hash;
+}
+
+uint64_t hash_bytes(char *value, size_t length) {
+  uint64_t hash = FNV_OFFSET_BASIS;
+  for (size_t i = 0; i < length; i++) {
+    hash ^= (unsigned char)value[i];
+    hash *= FNV_PRIME;
+  }
+  return hash;
+}
+
+uint64_t hash_hash(uint64_t hash, uint64_t value) {
+  return hash_int(hash_int(hash, (int)value), (int)(value >> 32));
+}
+
+uint64_t hash_point(uint64_t hash, point_t *point) {
+  return hash_int(hash_int(hash, point->x), point->y);
+}
+
+uint64_t hash_style(style_t *style) {
+  uint64_t hash = FNV_OFFSET_BASIS;
+  hash = hash_int(hash, style->fill->red);
+  hash = hash_int(hash, style->fill->green);
+  hash = hash_int(hash, style->fill->blue);
+  hash = hash_int(hash, style->fill->transparent);
+  hash = hash_int(hash, style->outline->red);
+  hash = hash_int(hash, style->outline->green);
+  hash = hash_int(hash, style->outline->blue);
+  hash = hash_int(hash, style->outline->transparent);
+  hash = hash_point(hash, style->translate);
+  hash = hash_int(hash, style->rotate->variant);
+  if (style->rotate->variant == CIRCULAR)
+    hash = hash_int(hash, style->rotate->rotation.circular);
+  return hash;
+}
+
+uint64_t hash_path_element(uint64_t hash, path_element_t *element) {
+  path_element_union_t *e = element->path_element;
+  hash = hash_int(hash, element->path_element_variant);
+  switch (element->path_element_variant) {
+  case MOVE_TO:
+    return hash_point(hash, e->move_to);
+  case LINE_TO:
+    return hash_point(hash, e->line_to);
+  case VERTICAL_LINE_TO:
+    return hash_int(hash, e->vertical_line_to);
+  case HORIZONTAL_LINE_TO:
+    return hash_int(hash, e->horizontal_line_to);
+  case END_PATH:
+    return hash;
+  case CUBIC_CURVE_TO:
+    hash = hash_point(hash, e->cubic_curve_to->control_point_1);
+    hash = hash_point(hash, e->cubic_curve_to->control_point_2);
+    return hash_point(hash, e->cubic_curve_to->end);
+  case CUBIC_CURVE_TO_SHORTHAND:
+    hash = hash_point(hash, e->shorthand_cubic_curve_to->control_point);
+    return hash_point(hash, e->shorthand_cubic_curve_to->end);
+  case QUADRATIC_CURVE_TO:
+    hash = hash_point(hash, e->quadratic_curve_to->control_point);
+    return hash_point(hash, e->quadratic_curve_to->end);
+  case QUADRATIC_CURVE_TO_SHORTHAND:
+    return hash_point(hash, e->shorthand_quadratic_curve_to);
+  }
+  return hash;
+}
+
+uint64_t hash_geometry(shape_t *shape) {
+  uint64_t hash = hash_int(FNV_OFFSET_BASIS, shape->shape_variant);
+  switch (shape->shape_variant) {
+  case ELLIPSE:
+    hash = hash_int(hash, shape->shape->ellipse->center_x);
+    hash = hash_int(hash, shape->shape->ellipse->center_y);
+    hash = hash_int(hash, shape->shape->ellipse->radius_x);
+    hash = hash_int(hash, shape->shape->ellipse->radius_y);
+    break;
+  case RECTANGLE:
+    hash = hash_int(hash, shape->shape->rectangle->x);
+    hash = hash_int(hash, shape->shape->rectangle->y);
+    hash = hash_int(hash, shape->shape->rectangle->width);
+    hash = hash_int(hash, shape->shape->rectangle->height);
+    break;
+  case LINE:
+    hash = hash_point(hash, shape->shape->line->start);
+    hash = hash_point(hash, shape->shape->line->end);
+    break;
+  case MULTILINE:
+  case POLYGON:
+    for (point_node_t *node = shape->shape->multiline; node != NULL;
+         node = node->next)
+      hash = hash_point(hash, node->point);
+    break;
+  case PATH:
+    for (path_element_node_t *node = shape->shape->path; node != NULL;
+         node = node->next)
+      hash = hash_path_element(hash, node->element);
+    break;
+  case GROUP:
+    // Instances of different symbols are never equal, even with the same
+    // content.
+    if (shape->symbol != NULL)
+      hash = hash_string(hash, shape->symbol->id);
+    for (shape_node_t *node = shape->shape->group; node != NULL;
+         node = node->next)
+      hash = hash_hash(hash, get_shape_hash(node->shape));
+    break;
+  }
+  return hash;
+}
+
+uint64_t compute_shape_hash(shape_t *shape) {
+  return hash_hash(hash_geometry(shape), hash_style(shape->styles));
+}
+
+uint64_t get_shape_hash(shape_t *shape) {
+  if (!shape->is_hash_set) {
+    shape->hash = compute_shape_hash(shape);
+    shape->is_hash_set = true;
+  }
+  return shape->hash;
+}
+
+void invalidate_shape_hash(shape_t *shape) { shape->is_hash_set = false; }
+
+bool are_colors_equal(color_t *a, color_t *b) {
+  return a->red == b->red && a->green == b->green && a->blue == b->blue &&
+         a->transparent == b->transparent;
+}
+
+bool are_styles_equal(style_t *a, style_t *b) {
+  if (a == b)
+    return true;
+  if (!are_colors_equal(a->fill, b->fill) ||
+      !are_colors_equal(a->outline, b->outline) ||
+      a->translate->x != b->translate->x ||
+      a->translate->y != b->translate->y ||
+      a->rotate->variant != b->rotate->variant)
+    return false;
+  return a->rotate->variant != CIRCULAR ||
+         a->rotate->rotation.circular == b->rotate->rotation.circular;
+}
+
+bool are_points_equal(point_node_t *a, point_node_t *b) {
+  while (a != NULL && b != NULL && a->point->x == b->point->x &&
+         a->point->y == b->point->y) {
+    a = a->next;
+    b = b->next;
+  }
+  return a == NULL && b == NULL;
+}
+
+bool is_point_equal(point_t *a, point_t *b) {
+  return a->x == b->x && a->y == b->y;
+}
+
+bool are_path_elements_equal(path_element_t *a, path_element_t *b) {
+  if (a->path_element_variant != b->path_element_variant)
+    return false;
+  path_element_union_t *e1 = a->path_element, *e2 = b->path_element;
+  switch (a->path_element_variant) {
+  case MOVE_TO:
+    return is_point_equal(e1->move_to, e2->move_to);
+  case LINE_TO:
+    return is_point_equal(e1->line_to, e2->line_to);
+  case VERTICAL_LINE_TO:
+    return e1->vertical_line_to == e2->vertical_line_to;
+  case HORIZONTAL_LINE_TO:
+    return e1->horizontal_line_to == e2->horizontal_line_to;
+  case END_PATH:
+    return true;
+  case CUBIC_CURVE_TO:
+    return is_point_equal(e1->cubic_curve_to->control_point_1,
+                          e2->cubic_curve_to->control_point_1) &&
+           is_point_equal(e1->cubic_curve_to->control_point_2,
+                          e2->cubic_curve_to->control_point_2) &&
+           is_point_equal(e1->cubic_curve_to->end, e2->cubic_curve_to->end);
+  case CUBIC_CURVE_TO_SHORTHAND:
+    return is_point_equal(e1->shorthand_cubic_curve_to->control_point,
+                          e2->shorthand_cubic_curve_to->control_point) &&
+           is_point_equal(e1->shorthand_cubic_curve_to->end,
+                          e2->shorthand_cubic_curve_to->end);
+  case QUADRATIC_CURVE_TO:
+    return is_point_equal(e1->quadratic_curve_to->control_point,
+                          e2->quadratic_curve_to->control_point) &&
+           is_point_equal(e1->quadratic_curve_to->end,
+                          e2->quadratic_curve_to->end);
+  case QUADRATIC_CURVE_TO_SHORTHAND:
+    return is_point_equal(e1->shorthand_quadratic_curve_to,
+                          e2->shorthand_quadratic_curve_to);
+  }
+  return false;
+}
+
+bool are_paths_equal(path_element_node_t *a, path_element_node_t *b) {
+  while (a != NULL && b != NULL &&
+         are_path_elements_equal(a->element, b->element)) {
+    a = a->next;
+    b = b->next;
+  }
+  return a == NULL && b == NULL;
+}
+
+bool are_shapes_equal(shape_t *a, shape_t *b) {
+  if (a == b)
+    return true;
+  if (a->shape_variant != b->shape_variant ||
+      get_shape_hash(a) != get_shape_hash(b) ||
+      !are_styles_equal(a->styles, b->styles))
+    return false;
+
+  shape_union_t *s1 = a->shape, *s2 = b->shape;
+  shape_node_t *n1, *n2;
+  switch (a->shape_variant) {
+  case ELLIPSE:
+    return s1->ellipse->center_x == s2->ellipse->center_x &&
+           s1->ellipse->center_y == s2->ellipse->center_y &&
+           s1->ellipse->radius_x == s2->ellipse->radius_x &&
+           s1->ellipse->radius_y == s2->ellipse->radius_y;
+  case RECTANGLE:
+    return s1->rectangle->x == s2->rectangle->x &&
+           s1->rectangle->y == s2->rectangle->y &&
+           s1->rectangle->width == s2->rectangle->width &&
+           s1->rectangle->height == s2->rectangle->height;
+  case LINE:
+    return s1->line->start->x == s2->line->start->x &&
+           s1->line->start->y == s2->line->start->y &&
+           s1->line->end->x == s2->line->end->x &&
+           s1->line->end->y == s2->line->end->y;
+  case MULTILINE:
+  case POLYGON:
+    return are_points_equal(s1->multiline, s2->multiline);
+  case PATH:
+    return are_paths_equal(s1->path, s2->path);
+  case GROUP:
+    if ((a->symbol == NULL) != (b->symbol == NULL) ||
+        (a->symbol != NULL && strcmp(a->symbol->id, b->symbol->id) != 0))
+      return false;
+    n1 = s1->group;
+    n2 = s2->group;
+    while (n1 != NULL && n2 != NULL &&
+           are_shapes_equal(n1->shape, n2->shape)) {
+      n1 = n1->next;
+      n2 = n2->next;
+    }
+    return n1 == NULL && n2 == NULL;
+  }
+  return false;
+}
+
+bool are_symbols_equal(symbol_node_t *a, symbol_node_t *b) {
+  while (a != NULL && b != NULL &&
+         strcmp(a->symbol->id, b->symbol->id) == 0 &&
+         are_shapes_equal(a->symbol->shape, b->symbol->shape)) {
+    a = a->next;
+    b = b->next;
+  }
+  return a == NULL && b == NULL;
+}
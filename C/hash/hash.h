@@ -0,0 +1,180 @@
+#ifndef CODA_HASH
+#define CODA_HASH
+
+#include "../models/shapes/path/path.h"
+#include "../models/shapes/shape.h"
+#include "../models/shapes/symbol.h"
+#include "../models/styles/style.h"
+#include "../models/utils/point.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Mixes the given integer into the given FNV-1a hash.
+ * @param hash  the hash.
+ * @param value the integer.
+ * @return the new hash.
+ */
+uint64_t hash_int(uint64_t hash, int value);
+
+/**
+ * Mixes the given null terminated string into the given FNV-1a hash.
+ * @param hash  the hash.
+ * @param value the string.
+ * @return the new hash.
+ */
+uint64_t hash_string(uint64_t hash, char *value);
+
+/**
+ * Computes the FNV-1a hash of the given characters.
+ * @param value  the characters.
+ * @param length the number of characters.
+ * @return the hash.
+ */
+uint64_t hash_bytes(char *value, size_t length);
+
+/**
+ * Mixes the given 64 bits hash into the given hash.
+ * @param hash  the hash.
+ * @param value the hash to mix.
+ * @return the new hash.
+ */
+uint64_t hash_hash(uint64_t hash, uint64_t value);
+
+/**
+ * Mixes the given point into the given hash.
+ * @param hash  the hash.
+ * @param point the point.
+ * @return the new hash.
+ * @see point_t.
+ */
+uint64_t hash_point(uint64_t hash, point_t *point);
+
+/**
+ * Hashes the given styles.
+ * @param style the styles.
+ * @return the hash.
+ * @see style_t.
+ */
+uint64_t hash_style(style_t *style);
+
+/**
+ * Mixes the given path element into the given hash.
+ * @param hash    the hash.
+ * @param element the path element.
+ * @return the new hash.
+ * @see path_element_t.
+ */
+uint64_t hash_path_element(uint64_t hash, path_element_t *element);
+
+/**
+ * Hashes the given shape's geometry, i.e. its content without its own
+ * styles. The shapes of groups are hashed with their styles, using their
+ * cached hashes, and instances are hashed with their symbol's identifier.
+ * @param shape the shape.
+ * @return the hash.
+ * @see get_shape_hash.
+ * @see shape_t.
+ */
+uint64_t hash_geometry(shape_t *shape);
+
+/**
+ * Computes the given shape's content hash, covering its variant, its
+ * geometry and its styles.
+ * @param shape the shape.
+ * @return the hash.
+ * @see hash_geometry.
+ * @see shape_t.
+ */
+uint64_t compute_shape_hash(shape_t *shape);
+
+/**
+ * Retrieves the content hash of the given shape.
+ * The hash is computed on the first call then cached on the shape until
+ * invalidate_shape_hash is called, so that groups are hashed bottom-up once.
+ * Equal shapes have equal hashes.
+ * @param shape the shape.
+ * @return the hash.
+ * @see compute_shape_hash.
+ * @see shape_t.
+ */
+uint64_t get_shape_hash(shape_t *shape);
+
+/**
+ * Discards the cached hash of the given shape, to be called when its
+ * geometry, its styles or (for groups) its shapes are updated. Note that the
+ * groups containing the shape must be invalidated too.
+ * @param shape the shape.
+ * @see shape_t.
+ */
+void invalidate_shape_hash(shape_t *shape);
+
+/**
+ * Tests if the given styles are equal.
+ * @param a the first styles.
+ * @param b the second styles.
+ * @return true if the styles are equal, false otherwise.
+ * @see style_t.
+ */
+bool are_styles_equal(style_t *a, style_t *b);
+
+/**
+ * Tests if the given point linked lists are equal.
+ * @param a the first point linked list.
+ * @param b the second point linked list.
+ * @return true if the points are equal, false otherwise.
+ * @see point_node_t.
+ */
+bool are_points_equal(point_node_t *a, point_node_t *b);
+
+/**
+ * Tests if the given points are equal.
+ * @param a the first point.
+ * @param b the second point.
+ * @return true if the coordinates are equal, false otherwise.
+ * @see point_t.
+ */
+bool is_point_equal(point_t *a, point_t *b);
+
+/**
+ * Tests if the given path elements are equal, comparing their variants then
+ * their values.
+ * @param a the first path element.
+ * @param b the second path element.
+ * @return true if the path elements are equal, false otherwise.
+ * @see path_element_t.
+ */
+bool are_path_elements_equal(path_element_t *a, path_element_t *b);
+
+/**
+ * Tests if the given path elements linked lists are equal.
+ * @param a the first path elements linked list.
+ * @param b the second path elements linked list.
+ * @return true if the path elements are equal, false otherwise.
+ * @see path_element_node_t.
+ */
+bool are_paths_equal(path_element_node_t *a, path_element_node_t *b);
+
+/**
+ * Tests if the given shapes are equal, comparing their hashes first then
+ * their content, so that a hash collision is never taken for a copy.
+ * @param a the first shape.
+ * @param b the second shape.
+ * @return true if the shapes are equal, false otherwise.
+ * @see get_shape_hash.
+ * @see shape_t.
+ */
+bool are_shapes_equal(shape_t *a, shape_t *b);
+
+/**
+ * Tests if the given symbol linked lists are equal, i.e. if they define the
+ * same identifiers in the same order with equal shapes.
+ * @param a the first symbol linked list.
+ * @param b the second symbol linked list.
+ * @return true if the symbols are equal, false otherwise.
+ * @see symbol_node_t.
+ */
+bool are_symbols_equal(symbol_node_t *a, symbol_node_t *b);
+
+#endif
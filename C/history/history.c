@@ -0,0 +1,416 @@
+#include "history.h"
+#include "../models/shapes/path/path.h"
+#include "../models/shapes/shape.h"
+#include "../models/shapes/svg.h"
+#include "../models/shapes/symbol.h"
+#include "../models/styles/color.h"
+#include "../models/styles/rotate.h"
+#include "../models/styles/style.h"
+#include "../models/utils/point.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+history_t *new_history(size_t capacity) {
+  history_t *history = malloc(sizeof(history_t));
+  history->oldest = NULL;
+  history->undo = NULL;
+  history->count = 0;
+  history->size = 0;
+  history->capacity = capacity;
+  history->shapes = NULL;
+  history->shape_count = 0;
+  return history;
+}
+
+size_t get_point_list_size(point_node_t *points) {
+  size_t size = 0;
+  for (point_node_t *node = points; node != NULL; node = node->next)
+    size += sizeof(point_node_t) + sizeof(point_t);
+  return size;
+}
+
+size_t get_path_size(path_element_node_t *path) {
+  size_t size = 0;
+  for (path_element_node_t *node = path; node != NULL; node = node->next) {
+    size += sizeof(path_element_node_t) + sizeof(path_element_t) +
+            sizeof(path_element_union_t);
+    // The curves hold up to three points.
+    switch (node->element->path_element_variant) {
+    case MOVE_TO:
+    case LINE_TO:
+    case QUADRATIC_CURVE_TO_SHORTHAND:
+      size += sizeof(point_t);
+      break;
+    case CUBIC_CURVE_TO_SHORTHAND:
+    case QUADRATIC_CURVE_TO:
+      size += 2 * sizeof(point_t);
+      break;
+    case CUBIC_CURVE_TO:
+      size += 3 * sizeof(point_t);
+      break;
+    case VERTICAL_LINE_TO:
+    case HORIZONTAL_LINE_TO:
+    case END_PATH:
+      break;
+    }
+  }
+  return size;
+}
+
+size_t get_style_size(style_t *style) {
+  return sizeof(style_t) + 2 * sizeof(color_t) + sizeof(point_t) +
+         sizeof(rotate_t);
+}
+
+size_t get_shape_size(shape_t *shape, bool deep) {
+  size_t size =
+      sizeof(shape_t) + sizeof(shape_union_t) + get_style_size(shape->styles);
+  switch (shape->shape_variant) {
+  case ELLIPSE:
+    size += sizeof(ellipse_t);
+    break;
+  case RECTANGLE:
+    size += sizeof(rectangle_t);
+    break;
+  case LINE:
+    size += sizeof(line_t) + 2 * sizeof(point_t);
+    break;
+  case MULTILINE:
+  case POLYGON:
+    size += get_point_list_size(shape->shape->multiline);
+    break;
+  case PATH:
+    size += get_path_size(shape->shape->path);
+    break;
+  case GROUP:
+    for (shape_node_t *node = shape->shape->group; node != NULL;
+         node = node->next) {
+      size += sizeof(shape_node_t);
+      if (deep && !is_instance(shape))
+        size += get_shape_size(node->shape, true);
+    }
+    break;
+  }
+  return size;
+}
+
+size_t get_svg_size(svg_t *svg) {
+  size_t size = sizeof(svg_t);
+  if (svg->viewport != NULL)
+    size += sizeof(viewport_t) + 2 * sizeof(point_t);
+  for (shape_node_t *node = svg->shapes; node != NULL; node = node->next)
+    size += sizeof(shape_node_t);
+  size += get_symbol_node_length(svg->symbols) * sizeof(symbol_node_t);
+  return size;
+}
+
+size_t get_replaced_shape_size(shape_t *shape, shape_t *copy) {
+  if (shape == copy)
+    return 0;
+  // A copied group shares the shapes which were not replaced.
+  if (copy != NULL && shape->shape_variant == GROUP &&
+      copy->shape_variant == GROUP && !is_instance(shape) &&
+      !is_instance(copy))
+    return get_shape_size(shape, false) +
+           get_replaced_size(shape->shape->group, copy->shape->group);
+  return get_shape_size(shape, true);
+}
+
+size_t get_replaced_size(shape_node_t *snapshot, shape_node_t *shapes) {
+  size_t size = 0;
+  for (; snapshot != NULL; snapshot = snapshot->next) {
+    size += get_replaced_shape_size(snapshot->shape,
+                                    (shapes != NULL) ? shapes->shape : NULL);
+    if (shapes != NULL)
+      shapes = shapes->next;
+  }
+  return size;
+}
+
+void record_history(history_t *history, svg_t *svg) {
+  // Recording a new edit drops the undone ones.
+  history_entry_t *redo =
+      (history->undo == NULL) ? history->oldest : history->undo->next;
+  for (history_entry_t *entry = redo; entry != NULL; entry = entry->next) {
+    history->size -= entry->size;
+    history->count--;
+  }
+  if (redo == history->oldest)
+    history->oldest = NULL;
+  else
+    history->undo->next = NULL;
+  free_history_entries(redo);
+
+  // The shared shapes are copied by the edit instead of being modified.
+  history->shape_count = get_shape_node_length(svg->shapes);
+  history->shapes = malloc(sizeof(shape_t *) * (history->shape_count + 1));
+  int i = 0;
+  for (shape_node_t *node = svg->shapes; node != NULL; node = node->next)
+    history->shapes[i++] = clone_shape(node->shape);
+
+  history_entry_t *entry = malloc(sizeof(history_entry_t));
+  entry->previous = history->undo;
+  entry->viewport = NULL;
+  if (svg->viewport != NULL)
+    entry->viewport = new_viewport(clone_point(svg->viewport->start),
+                                   clone_point(svg->viewport->end));
+  entry->changes = NULL;
+  entry->size = sizeof(history_entry_t);
+  entry->next = NULL;
+  if (history->undo == NULL)
+    history->oldest = entry;
+  else
+    history->undo->next = entry;
+  history->undo = entry;
+  history->count++;
+  history->size += entry->size;
+}
+
+history_change_t *new_history_change(int position, shape_t **shapes,
+                                     int count, shape_t **recorded,
+                                     int shape_count, size_t *size) {
+  history_change_t *change = malloc(sizeof(history_change_t));
+  change->position = position;
+  change->count = count;
+  change->shapes = malloc(sizeof(shape_t *) * (shape_count + 1));
+  change->shape_count = shape_count;
+  change->next = NULL;
+  *size += sizeof(history_change_t) + sizeof(shape_t *) * shape_count;
+  for (int i = 0; i < shape_count; i++) {
+    change->shapes[i] = recorded[i];
+    *size += get_replaced_shape_size(recorded[i],
+                                     (i < count) ? shapes[i] : NULL);
+  }
+  return change;
+}
+
+int compare_history_matches(const void *a, const void *b) {
+  const history_match_t *x = a, *y = b;
+  uintptr_t s = (uintptr_t)x->shape, t = (uintptr_t)y->shape;
+  if (s != t)
+    return (s > t) - (s < t);
+  return (x->position > y->position) - (x->position < y->position);
+}
+
+int find_history_match(history_match_t *matches, int count, shape_t *shape,
+                       int position) {
+  history_match_t key = {.shape = shape, .position = position};
+  int low = 0, high = count;
+  while (low < high) {
+    int middle = low + (high - low) / 2;
+    if (compare_history_matches(&matches[middle], &key) < 0)
+      low = middle + 1;
+    else
+      high = middle;
+  }
+  if (low == count || matches[low].shape != shape)
+    return -1;
+  return matches[low].position;
+}
+
+history_change_t *diff_history_shapes(shape_t **recorded, int start, int end,
+                                      shape_t **shapes, int count,
+                                      size_t *size) {
+  history_change_t *changes = NULL, **last = &changes;
+  history_match_t *matches =
+      malloc(sizeof(history_match_t) * (end - start + 1));
+  for (int i = start; i < end; i++)
+    matches[i - start] = (history_match_t){.shape = recorded[i], .position = i};
+  qsort(matches, end - start, sizeof(history_match_t),
+        compare_history_matches);
+
+  // The run of edited shapes since the last kept one replaces the recorded
+  // shapes skipped to find it.
+  int i = start, run = 0;
+  for (int j = 0; j < count; j++) {
+    int kept = find_history_match(matches, end - start, shapes[j], i);
+    if (kept < 0)
+      continue;
+    if (kept > i || j > run) {
+      *last = new_history_change(start + run, shapes + run, j - run,
+                                 recorded + i, kept - i, size);
+      last = &(*last)->next;
+    }
+    free_shape(recorded[kept]);
+    i = kept + 1;
+    run = j + 1;
+  }
+  if (i < end || count > run)
+    *last = new_history_change(start + run, shapes + run, count - run,
+                               recorded + i, end - i, size);
+  free(matches);
+  return changes;
+}
+
+void charge_history(history_t *history, size_t size) {
+  if (history->undo == NULL)
+    return;
+  history->undo->size += size;
+  history->size += size;
+
+  // Only the entries which can be undone are dropped, the oldest first, the
+  // last recorded one excepted.
+  while (history->size > history->capacity && history->undo != NULL &&
+         history->oldest != history->undo) {
+    history_entry_t *entry = history->oldest;
+    history->oldest = entry->next;
+    if (history->oldest != NULL)
+      history->oldest->previous = NULL;
+    history->size -= entry->size;
+    history->count--;
+    entry->next = NULL;
+    free_history_entries(entry);
+  }
+}
+
+bool commit_history(history_t *history, svg_t *svg) {
+  history_entry_t *entry = history->undo;
+  shape_t **recorded = history->shapes;
+  if (entry == NULL || recorded == NULL)
+    return false;
+  history->shapes = NULL;
+
+  // The shapes kept at both ends of the linked list are released first.
+  int start = 0, end = history->shape_count;
+  shape_node_t *first = svg->shapes;
+  while (first != NULL && start < end && first->shape == recorded[start]) {
+    free_shape(recorded[start++]);
+    first = first->next;
+  }
+  int count = get_shape_node_length(first);
+  shape_t **shapes = malloc(sizeof(shape_t *) * (count + 1));
+  int j = 0;
+  for (shape_node_t *node = first; node != NULL; node = node->next)
+    shapes[j++] = node->shape;
+  while (count > 0 && end > start && shapes[count - 1] == recorded[end - 1]) {
+    free_shape(recorded[--end]);
+    count--;
+  }
+
+  size_t size = 0;
+  entry->changes =
+      diff_history_shapes(recorded, start, end, shapes, count, &size);
+  free(shapes);
+  free(recorded);
+
+  if (entry->viewport != NULL && svg->viewport != NULL &&
+      entry->viewport->start->x == svg->viewport->start->x &&
+      entry->viewport->start->y == svg->viewport->start->y &&
+      entry->viewport->end->x == svg->viewport->end->x &&
+      entry->viewport->end->y == svg->viewport->end->y) {
+    free_viewport(entry->viewport);
+    entry->viewport = NULL;
+  }
+  if (entry->viewport != NULL)
+    size += sizeof(viewport_t) + 2 * sizeof(point_t);
+
+  if (entry->changes == NULL && entry->viewport == NULL) {
+    history->undo = entry->previous;
+    if (history->undo == NULL)
+      history->oldest = NULL;
+    else
+      history->undo->next = NULL;
+    history->size -= entry->size;
+    history->count--;
+    free_history_entries(entry);
+    return false;
+  }
+  charge_history(history, size);
+  return true;
+}
+
+void swap_history_entry(history_entry_t *entry, svg_t *svg,
+                        node_index_t *nodes) {
+  if (entry->viewport != NULL) {
+    viewport_t *viewport = svg->viewport;
+    svg->viewport = entry->viewport;
+    entry->viewport = viewport;
+  }
+
+  // The changes before a run moved it by the number of shapes they added.
+  int offset = 0;
+  for (history_change_t *change = entry->changes; change != NULL;
+       change = change->next) {
+    int position = change->position + offset;
+    int kept = (change->count < change->shape_count) ? change->count
+                                                     : change->shape_count;
+    shape_t **shapes = malloc(sizeof(shape_t *) * (change->count + 1));
+    for (int i = 0; i < kept; i++) {
+      shape_node_t *node = get_indexed_shape_node(nodes, position + i);
+      shapes[i] = node->shape;
+      node->shape = change->shapes[i];
+    }
+    for (int i = kept; i < change->count; i++) {
+      shape_node_t *node = get_indexed_shape_node(nodes, position + kept);
+      shapes[i] = clone_shape(node->shape);
+      svg->shapes = remove_indexed_shape_node(svg->shapes, nodes,
+                                              position + kept);
+    }
+    for (int i = kept; i < change->shape_count; i++)
+      svg->shapes = insert_indexed_shape_node(svg->shapes, nodes,
+                                              position + i, change->shapes[i]);
+
+    offset += change->shape_count - change->count;
+    free(change->shapes);
+    change->shapes = shapes;
+    int count = change->count;
+    change->count = change->shape_count;
+    change->shape_count = count;
+    change->position = position;
+  }
+}
+
+history_entry_t *undo_history(history_t *history, svg_t *svg,
+                              node_index_t *nodes) {
+  history_entry_t *entry = history->undo;
+  if (entry == NULL)
+    return NULL;
+  swap_history_entry(entry, svg, nodes);
+  history->undo = entry->previous;
+  return entry;
+}
+
+history_entry_t *redo_history(history_t *history, svg_t *svg,
+                              node_index_t *nodes) {
+  history_entry_t *entry =
+      (history->undo == NULL) ? history->oldest : history->undo->next;
+  if (entry == NULL)
+    return NULL;
+  swap_history_entry(entry, svg, nodes);
+  history->undo = entry;
+  return entry;
+}
+
+void free_history_changes(history_change_t *changes) {
+  history_change_t *change = changes;
+  while (change != NULL) {
+    history_change_t *next = change->next;
+    for (int i = 0; i < change->shape_count; i++)
+      free_shape(change->shapes[i]);
+    free(change->shapes);
+    free(change);
+    change = next;
+  }
+}
+
+void free_history_entries(history_entry_t *entries) {
+  history_entry_t *entry = entries;
+  while (entry != NULL) {
+    history_entry_t *next = entry->next;
+    if (entry->viewport != NULL)
+      free_viewport(entry->viewport);
+    free_history_changes(entry->changes);
+    free(entry);
+    entry = next;
+  }
+}
+
+void free_history(history_t *history) {
+  // An edit still being recorded holds its svg's shapes.
+  for (int i = 0; history->shapes != NULL && i < history->shape_count; i++)
+    free_shape(history->shapes[i]);
+  free(history->shapes);
+  free_history_entries(history->oldest);
+  free(history);
+}
@@ -0,0 +1,346 @@
+#ifndef CODA_HISTORY
+#define CODA_HISTORY
+
+#include "../models/shapes/path/path.h"
+#include "../models/shapes/shape.h"
+#include "../models/shapes/svg.h"
+#include "../models/styles/style.h"
+#include "../models/utils/node_index.h"
+#include "../models/utils/point.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Defines the history change linked list node type, a run of consecutive
+ * top-level shapes replaced by an edit.
+ * Undoing or redoing the change swaps the svg's run with the change's shapes,
+ * so that the change then holds the run to go back to.
+ * @param position    the run's position in the svg's shape linked list.
+ * @param count       the number of shapes of the svg's run, 0 if the change
+ * inserts its shapes.
+ * @param shapes      the shapes replacing the svg's run, which the change
+ * holds a reference to.
+ * @param shape_count the number of shapes, 0 if the change removes the run.
+ * @param next        the next change, at a greater position.
+ * @see history_entry_t.
+ */
+typedef struct history_change_s {
+  int position;
+  int count;
+  shape_t **shapes;
+  int shape_count;
+  struct history_change_s *next;
+} history_change_t;
+
+/**
+ * Defines the shape matched by the diff of a recorded svg's shapes, sorted by
+ * address then position.
+ * @param shape    the shape.
+ * @param position the shape's position in the recorded svg's shapes.
+ * @see diff_history_shapes.
+ */
+typedef struct history_match_s {
+  shape_t *shape;
+  int position;
+} history_match_t;
+
+/**
+ * Defines the history entry linked list node type.
+ * An entry holds the changes of an edit, i.e. the top-level shapes it
+ * replaced, so that its memory is proportional to the edit rather than to
+ * the svg. The symbols are not recorded since the edits never change them.
+ * @param previous the previous, older, entry.
+ * @param viewport the viewport to swap with the svg's one, NULL if the edit
+ * kept it.
+ * @param changes  the changes, from the lowest to the greatest position.
+ * @param size     the estimated memory kept alive by the entry, i.e. the
+ * size of the shapes replaced or removed by the edit.
+ * @param next     the next, newer, entry.
+ * @see history_change_t.
+ */
+typedef struct history_entry_s history_entry_t;
+
+struct history_entry_s {
+  history_entry_t *previous;
+  viewport_t *viewport;
+  history_change_t *changes;
+  size_t size;
+  history_entry_t *next;
+};
+
+/**
+ * Defines the undo and redo history of an svg.
+ * The entries go from the oldest to the newest. The entries up to the undo
+ * entry can be undone, the ones after it can be redone. Undoing or redoing
+ * swaps the svg's runs of shapes with the entry's changes, so that the entry
+ * then holds the state to go back to.
+ * @param oldest      the oldest entry, NULL if the history is empty.
+ * @param undo        the entry restored by the next undo, NULL if there is
+ * none.
+ * @param count       the number of entries.
+ * @param size        the estimated memory kept alive by all the entries.
+ * @param capacity    the maximum estimated memory, the oldest entries are
+ * dropped beyond it.
+ * @param shapes      the svg's top-level shapes before the edit being
+ * recorded, which the history holds a reference to, NULL if no edit is being
+ * recorded.
+ * @param shape_count the number of shapes before the edit being recorded.
+ * @see history_entry_t.
+ */
+typedef struct history_s {
+  history_entry_t *oldest;
+  history_entry_t *undo;
+  int count;
+  size_t size;
+  size_t capacity;
+  shape_t **shapes;
+  int shape_count;
+} history_t;
+
+/**
+ * Creates a new empty history.
+ * Note that this function allocates memory.
+ * @param capacity the maximum estimated memory of the history, in bytes.
+ * @return the new history's pointer.
+ * @see history_t.
+ */
+history_t *new_history(size_t capacity);
+
+/**
+ * Estimates the memory used by the given point linked list.
+ * @param points the point linked list.
+ * @return the size in bytes.
+ * @see point_node_t.
+ */
+size_t get_point_list_size(point_node_t *points);
+
+/**
+ * Estimates the memory used by the given path elements linked list.
+ * @param path the path elements linked list.
+ * @return the size in bytes.
+ * @see path_element_node_t.
+ */
+size_t get_path_size(path_element_node_t *path);
+
+/**
+ * Estimates the memory used by the given style.
+ * @param style the style.
+ * @return the size in bytes.
+ * @see style_t.
+ */
+size_t get_style_size(style_t *style);
+
+/**
+ * Estimates the memory used by the given shape.
+ * Note that the shapes of groups are only counted when deep is true, since
+ * copying a group shares them, and the content of instances is never counted
+ * since it belongs to their symbol.
+ * @param shape the shape.
+ * @param deep  indicates if the shapes of groups are counted.
+ * @return the size in bytes.
+ * @see copy_shape.
+ * @see shape_t.
+ */
+size_t get_shape_size(shape_t *shape, bool deep);
+
+/**
+ * Estimates the memory copied when unsharing the given svg, i.e. its viewport
+ * and its shape and symbol linked lists.
+ * @param svg the svg.
+ * @return the size in bytes.
+ * @see copy_svg.
+ * @see svg_t.
+ */
+size_t get_svg_size(svg_t *svg);
+
+/**
+ * Estimates the memory kept alive by the given shape once it is replaced by
+ * the given shape, copied from it by an edit keeping its structure, e.g. a
+ * simplification. A copied group only counts the shapes it replaced.
+ * @param shape the replaced shape.
+ * @param copy  the shape replacing it, NULL if it was removed.
+ * @return the size in bytes, 0 if the shape was kept.
+ * @see get_shape_size.
+ */
+size_t get_replaced_shape_size(shape_t *shape, shape_t *copy);
+
+/**
+ * Estimates the memory kept alive by the given snapshot's shapes once they
+ * are replaced by the given shapes, copied from them by an edit keeping their
+ * structure, e.g. a simplification. The shapes still shared by the copies are
+ * not counted, and the copied groups only count the shapes they replaced.
+ * @param snapshot the snapshot's shape linked list.
+ * @param shapes   the edited shape linked list.
+ * @return the size in bytes.
+ * @see get_replaced_shape_size.
+ */
+size_t get_replaced_size(shape_node_t *snapshot, shape_node_t *shapes);
+
+/**
+ * Records the state of the given svg before an edit, which must then be
+ * committed. The svg's top-level shapes are listed and shared with the
+ * history so that the edit copies the ones it changes, and its viewport is
+ * copied. The entries which could be redone are dropped.
+ * Note that this function allocates memory.
+ * @param history the history.
+ * @param svg     the svg to be edited.
+ * @see commit_history.
+ * @see unshare_shape.
+ * @see history_t.
+ */
+void record_history(history_t *history, svg_t *svg);
+
+/**
+ * Creates a change replacing the given run of the edited svg's shapes by the
+ * given recorded shapes.
+ * Note that this function allocates memory.
+ * @param position    the run's position in the edited svg's shapes.
+ * @param shapes      the run's shapes.
+ * @param count       the run's number of shapes.
+ * @param recorded    the recorded shapes replaced by the run, whose
+ * references are given to the change.
+ * @param shape_count the number of recorded shapes.
+ * @param size        a pointer to the estimated size to increase by the
+ * memory kept alive by the change.
+ * @return the new change's pointer.
+ * @see history_change_t.
+ */
+history_change_t *new_history_change(int position, shape_t **shapes,
+                                     int count, shape_t **recorded,
+                                     int shape_count, size_t *size);
+
+/**
+ * Compares two history matches by address then position.
+ * @param a a pointer to the first match.
+ * @param b a pointer to the second match.
+ * @return a negative value, 0 or a positive value as the first match is
+ * lower, equal or greater.
+ * @see history_match_t.
+ */
+int compare_history_matches(const void *a, const void *b);
+
+/**
+ * Searches the first of the given sorted matches holding the given shape at
+ * or after the given position.
+ * @param matches  the matches, sorted by compare_history_matches.
+ * @param count    the number of matches.
+ * @param shape    the shape.
+ * @param position the lowest position.
+ * @return the match's position, -1 if there is none.
+ * @see compare_history_matches.
+ */
+int find_history_match(history_match_t *matches, int count, shape_t *shape,
+                       int position);
+
+/**
+ * Computes the changes turning the given recorded shapes into the given
+ * edited ones. The recorded shapes found in the same order among the edited
+ * ones are kept, the others are gathered in runs. The references held on the
+ * kept recorded shapes are released, the others are given to the changes.
+ * Note that this function allocates and frees memory.
+ * @param recorded the recorded shapes.
+ * @param start    the position of the first recorded shape, which is the
+ * position of the first edited shape as well.
+ * @param end      the position after the last recorded shape.
+ * @param shapes   the edited shapes.
+ * @param count    the number of edited shapes.
+ * @param size     a pointer to the estimated size to increase by the memory
+ * kept alive by the changes.
+ * @return the change linked list, from the lowest to the greatest position.
+ * @see history_change_t.
+ */
+history_change_t *diff_history_shapes(shape_t **recorded, int start, int end,
+                                      shape_t **shapes, int count,
+                                      size_t *size);
+
+/**
+ * Adds the given size to the last recorded entry, for the shapes the current
+ * edit copies or removes, then drops the oldest entries until the history
+ * fits its capacity. The last recorded entry is never dropped, so that the
+ * current edit can always be undone.
+ * Note that this function frees memory.
+ * @param history the history.
+ * @param size    the estimated size of the shapes kept alive by the entry.
+ * @see history_t.
+ */
+void charge_history(history_t *history, size_t size);
+
+/**
+ * Ends the recording of the current edit of the given svg. Only the runs of
+ * top-level shapes the edit replaced are kept, compared from both ends of the
+ * shape linked list so that an edit of a few shapes is quickly recorded. The
+ * entry is dropped if the edit changed nothing, e.g. if it was cancelled.
+ * Note that this function allocates and frees memory.
+ * @param history the history.
+ * @param svg     the edited svg.
+ * @return true if the entry was kept, false otherwise.
+ * @see diff_history_shapes.
+ * @see history_t.
+ */
+bool commit_history(history_t *history, svg_t *svg);
+
+/**
+ * Swaps the given svg's runs of shapes and viewport with the given entry's
+ * changes and viewport.
+ * Note that this function allocates and frees memory.
+ * @param entry the entry.
+ * @param svg   the svg.
+ * @param nodes the index of the svg's shape nodes, which is kept up to date.
+ * @see history_change_t.
+ */
+void swap_history_entry(history_entry_t *entry, svg_t *svg,
+                        node_index_t *nodes);
+
+/**
+ * Restores the state recorded before the last edit.
+ * Note that this function allocates and frees memory.
+ * @param history the history.
+ * @param svg     the edited svg.
+ * @param nodes   the index of the svg's shape nodes, which is kept up to
+ * date.
+ * @return the undone entry, whose changes hold the replaced shapes, NULL if
+ * there was none.
+ * @see swap_history_entry.
+ */
+history_entry_t *undo_history(history_t *history, svg_t *svg,
+                              node_index_t *nodes);
+
+/**
+ * Restores the state undone by the last undo.
+ * Note that this function allocates and frees memory.
+ * @param history the history.
+ * @param svg     the edited svg.
+ * @param nodes   the index of the svg's shape nodes, which is kept up to
+ * date.
+ * @return the redone entry, whose changes hold the replaced shapes, NULL if
+ * there was none.
+ * @see swap_history_entry.
+ */
+history_entry_t *redo_history(history_t *history, svg_t *svg,
+                              node_index_t *nodes);
+
+/**
+ * Destroys the given history change linked list and releases its shapes.
+ * Note that this function frees memory.
+ * @param changes the history change linked list.
+ * @see history_change_t.
+ */
+void free_history_changes(history_change_t *changes);
+
+/**
+ * Destroys the given history entry linked list.
+ * Note that this function frees memory.
+ * @param entries the history entry linked list.
+ * @see history_entry_t.
+ */
+void free_history_entries(history_entry_t *entries);
+
+/**
+ * Destroys the given history and its entries.
+ * Note that this function frees memory.
+ * @param history the history.
+ * @see history_t.
+ */
+void free_history(history_t *history);
+
+#endif
@@ -1,5 +1,13 @@
 #include "html.h"
+#include "../geometry/bake.h"
+#include "../geometry/cull.h"
+#include "../geometry/lod.h"
+#include "../geometry/simplify.h"
+#include "../geometry/transform.h"
+#include "../instrument/instrument.h"
+#include "../models/utils/bbox.h"
 #include <stdio.h>
+#include <stdlib.h>
 
 #define HTML_FILE_START                                                        \
   "<!DOCTYPE html>\n\
@@ -38,6 +46,11 @@ void export_styles_html(FILE *file, style_t *styles) {
           styles->outline->transparent);
   fprintf(file, "fill=\"rgba(%d, %d, %d, %d)\" ", styles->fill->red,
           styles->fill->green, styles->fill->blue, styles->fill->transparent);
+  // Identity transformations, such as the baked shapes ones, are left out.
+  if (styles->translate->x == 0 && styles->translate->y == 0 &&
+      styles->rotate->variant == CIRCULAR &&
+      styles->rotate->rotation.circular == 0)
+    return;
   fprintf(file, "transform=\"translate(%d, %d) ", styles->translate->x,
           styles->translate->y);
   switch (styles->rotate->variant) {
@@ -126,17 +139,39 @@ void export_path_elements_html(FILE *file, path_element_node_t *elements) {
   export_path_element_html(file, node->element);
 }
 
-void export_shapes_html(FILE *file, shape_node_t *shapes, unsigned int depth) {
+html_config_t *new_html_config(bool cull, bool bake, double simplify,
+                               simplify_method_t method) {
+  html_config_t *config = malloc(sizeof(html_config_t));
+  config->cull = cull;
+  config->bake = bake;
+  config->simplify = simplify;
+  config->method = method;
+  config->scale = 1;
+  config->lod = NULL;
+  config->culled = 0;
+  return config;
+}
+
+void free_html_config(html_config_t *config) { free(config); }
+
+void export_shapes_html(FILE *file, shape_node_t *shapes, unsigned int depth,
+                        html_config_t *config, bbox_t *area) {
   shape_node_t *node = shapes;
   if (node == NULL)
     return;
   while (node != NULL) {
-    export_shape_html(file, node->shape, depth);
+    if (is_shape_culled(node->shape, area))
+      config->culled += count_shapes(node->shape);
+    else
+      export_shape_html(file, node->shape, depth, config, area);
     node = node->next;
   }
 }
 
-void export_shape_html(FILE *file, shape_t *shape, unsigned int depth) {
+void export_shape_html(FILE *file, shape_t *shape, unsigned int depth,
+                       html_config_t *config, bbox_t *area) {
+  bbox_t *local_area;
+  INSTRUMENT_START_BYTES(offset, file);
   export_tabs_html(file, depth);
   switch (shape->shape_variant) {
   case ELLIPSE:
@@ -182,27 +217,93 @@ void export_shape_html(FILE *file, shape_t *shape, unsigned int depth) {
     fprintf(file, " />\n");
     break;
   case GROUP:
+    // Instances reference their symbol's definition.
+    if (is_instance(shape)) {
+      fprintf(file, "<use href=\"#%s\" ", shape->symbol->id);
+      export_styles_html(file, shape->styles);
+      fprintf(file, " />\n");
+      break;
+    }
     fprintf(file, "<g ");
     export_styles_html(file, shape->styles);
     fprintf(file, ">\n");
-    export_shapes_html(file, shape->shape->group, depth + 1);
+    local_area =
+        get_group_visible_area(get_local_transform(shape), area);
+    export_shapes_html(file, shape->shape->group, depth + 1, config,
+                       local_area);
+    free_bbox(local_area);
     export_tabs_html(file, depth);
     fprintf(file, "</g>\n");
     break;
   }
+  INSTRUMENT_STOP_BYTES(INSTRUMENT_EXPORT_HTML + shape->shape_variant, offset,
+                        file);
 }
 
-bool export_to_html(svg_t *svg, char *path) {
-  FILE *file = fopen(path, "w");
-  if (file == NULL)
-    return false;
+void export_symbols_html(FILE *file, symbol_node_t *symbols,
+                         unsigned int depth, html_config_t *config) {
+  if (symbols == NULL)
+    return;
+  export_tabs_html(file, depth);
+  fprintf(file, "<defs>\n");
+  for (symbol_node_t *node = symbols; node != NULL; node = node->next) {
+    export_tabs_html(file, depth + 1);
+    fprintf(file, "<g id=\"%s\">\n", node->symbol->id);
+    export_shape_html(file, node->symbol->shape, depth + 2, config, NULL);
+    export_tabs_html(file, depth + 1);
+    fprintf(file, "</g>\n");
+  }
+  export_tabs_html(file, depth);
+  fprintf(file, "</defs>\n");
+}
+
+void export_start_html(FILE *file, svg_t *svg, html_config_t *config) {
   fprintf(file, HTML_FILE_START);
   fprintf(file, "\t\t<svg viewport=\"%d %d %d %d\">\n", svg->viewport->start->x,
           svg->viewport->start->y, svg->viewport->end->x,
           svg->viewport->end->y);
-  export_shapes_html(file, svg->shapes, 3);
+  if (!config->bake)
+    export_symbols_html(file, svg->symbols, 3, config);
+}
+
+void export_svg_shapes_html(FILE *file, shape_node_t *shapes,
+                            html_config_t *config, bbox_t *area) {
+  shape_node_t *copy = NULL, *last = NULL;
+  if (config->bake)
+    bake_shapes(shapes, NULL, &copy, &last);
+  else if (config->simplify > 0)
+    copy = clone_shape_list(shapes);
+  simplify_shapes(copy, config->simplify, config->method);
+  export_shapes_html(file, (copy != NULL) ? copy : shapes, 3, config, area);
+  free_baked_shapes(copy);
+}
+
+void export_end_html(FILE *file) {
   fprintf(file, "\t\t</svg>\n");
   fprintf(file, HTML_FILE_END);
+}
+
+bool export_to_html(svg_t *svg, char *path, html_config_t *config) {
+  html_config_t defaults = {.cull = false,
+                            .bake = false,
+                            .simplify = 0,
+                            .method = SIMPLIFY_DOUGLAS_PEUCKER,
+                            .scale = 1,
+                            .lod = NULL,
+                            .culled = 0};
+  if (config == NULL)
+    config = &defaults;
+  FILE *file = fopen(path, "w");
+  if (file == NULL)
+    return false;
+  export_start_html(file, svg, config);
+  config->culled = 0;
+  bbox_t *area = config->cull ? get_viewport_bbox(svg->viewport) : NULL;
+  lod_level_t *level = get_lod_level(config->lod, svg, config->scale);
+  export_svg_shapes_html(file, (level != NULL) ? level->shapes : svg->shapes,
+                         config, area);
+  free_bbox(area);
+  export_end_html(file);
   fclose(file);
   return true;
 }
@@ -1,10 +1,62 @@
 #ifndef CODA_HTML
 #define CODA_HTML
 
+#include "../geometry/lod.h"
+#include "../geometry/simplify.h"
 #include "../models/shapes/path/path.h"
 #include "../models/shapes/svg.h"
+#include "../models/utils/bbox.h"
+#include <stdbool.h>
 #include <stdio.h>
 
+/**
+ * Defines the HTML export config type.
+ * @param cull   indicates if the shapes outside the svg's viewport are skipped.
+ * @param bake   indicates if the transformations are baked into the shapes
+ * coordinates, producing a flat shape list without groups.
+ * @param simplify the tolerance used to simplify the lines and paths, 0 to
+ * write them down as is.
+ * @param method   the simplification algorithm.
+ * @param scale    the output scale, used to select the level of detail.
+ * @param lod      the svg's level of detail pyramid, whose levels are built by
+ * the exports needing them, NULL to always write down the full detail shapes.
+ * @param culled   the number of shapes skipped by the last export.
+ */
+typedef struct html_config_s {
+  bool cull;
+  bool bake;
+  double simplify;
+  simplify_method_t method;
+  double scale;
+  lod_pyramid_t *lod;
+  unsigned int culled;
+} html_config_t;
+
+/**
+ * Creates a new HTML export config.
+ * The config uses the full detail shapes until its scale and level of detail
+ * pyramid are set.
+ * Note that this function allocates memory.
+ * @param cull indicates if the shapes outside the svg's viewport are skipped.
+ * @param bake indicates if the transformations are baked into the shapes
+ * coordinates.
+ * @param simplify the tolerance used to simplify the lines and paths, 0 to
+ * write them down as is.
+ * @param method   the simplification algorithm.
+ * @return the new HTML export config's pointer.
+ * @see html_config_t.
+ */
+html_config_t *new_html_config(bool cull, bool bake, double simplify,
+                               simplify_method_t method);
+
+/**
+ * Destroys the given HTML export config.
+ * Note that this function frees memory.
+ * @param config the config to destroy.
+ * @see html_config_t.
+ */
+void free_html_config(html_config_t *config);
+
 /**
  * Writes down the given number of tabulations to the given file.
  * @param file   an opened file in writing mode.
@@ -14,6 +66,7 @@ void export_tabs_html(FILE *file, unsigned int amount);
 
 /**
  * Writes down the given styles to the given file in HTML format.
+ * The transform attribute is omitted when it is the identity.
  * @param file   an opened file in writing mode.
  * @param styles the styles to write down.
  * @see style_t.
@@ -49,30 +102,90 @@ void export_path_elements_html(FILE *file, path_element_node_t *elements);
 
 /**
  * Writes down the given shape linked list to the given file in HTML format.
+ * The shapes which do not intersect the given visible area are skipped and
+ * counted in the config.
  * @param file   an opened file in writing mode.
  * @param shapes the shape linked list to write down.
  * @param depth  the number of tabulations to write.
+ * @param config the HTML export config.
+ * @param area   the visible area in the shapes' parent coordinates system, or
+ * NULL to write down all the shapes.
  * @see shape_t.
  * @see shape_node_t.
+ * @see html_config_t.
  */
-void export_shapes_html(FILE *file, shape_node_t *shapes, unsigned int depth);
+void export_shapes_html(FILE *file, shape_node_t *shapes, unsigned int depth,
+                        html_config_t *config, bbox_t *area);
+
+/**
+ * Writes down the given symbols to the given file in HTML format, as groups
+ * of a definitions element referenced by the instances.
+ * @param file    an opened file in writing mode.
+ * @param symbols the symbol linked list to write down.
+ * @param depth   the number of tabulations to write.
+ * @param config  the HTML export config.
+ * @see symbol_node_t.
+ * @see html_config_t.
+ */
+void export_symbols_html(FILE *file, symbol_node_t *symbols,
+                         unsigned int depth, html_config_t *config);
 
 /**
  * Writes down the given shape to the given file in HTML format.
- * @param file  an opened file in writing mode.
- * @param shape the shape to write down.
- * @param depth the number of tabulations to write.
+ * @param file   an opened file in writing mode.
+ * @param shape  the shape to write down.
+ * @param depth  the number of tabulations to write.
+ * @param config the HTML export config.
+ * @param area   the visible area in the shape's parent coordinates system, or
+ * NULL to write down all the group's shapes.
  * @see shape_t.
+ * @see html_config_t.
+ */
+void export_shape_html(FILE *file, shape_t *shape, unsigned int depth,
+                       html_config_t *config, bbox_t *area);
+
+/**
+ * Writes down the start of the HTML document of the given svg, up to its
+ * shapes, i.e. the document's head, the svg element and the symbols'
+ * definitions unless the shapes are baked.
+ * @param file   an opened file in writing mode.
+ * @param svg    the svg.
+ * @param config the HTML export config.
+ * @see export_to_html.
+ */
+void export_start_html(FILE *file, svg_t *svg, html_config_t *config);
+
+/**
+ * Writes down the given svg's shapes to the given file in HTML format, baked,
+ * simplified and culled as set by the config.
+ * Each shape is written down independently of the others, so a part of an
+ * svg's shape linked list gives a part of its document.
+ * Note that this function may allocate and free memory.
+ * @param file   an opened file in writing mode.
+ * @param shapes the shape linked list to write down.
+ * @param config the HTML export config.
+ * @param area   the svg's visible area, NULL to keep all the shapes.
+ * @see export_to_html.
+ */
+void export_svg_shapes_html(FILE *file, shape_node_t *shapes,
+                            html_config_t *config, bbox_t *area);
+
+/**
+ * Writes down the end of an HTML document, after the svg's shapes.
+ * @param file an opened file in writing mode.
+ * @see export_to_html.
  */
-void export_shape_html(FILE *file, shape_t *shape, unsigned int depth);
+void export_end_html(FILE *file);
 
 /**
  * Writes down the given svg to the given file path.
- * @param svg the svg to write down.
- * @param the destination file's path.
+ * @param svg    the svg to write down.
+ * @param path   the destination file's path.
+ * @param config the HTML export config, NULL for the default config.
  * @return returns true if the operation succeeded.
  * @see svg_t.
+ * @see html_config_t.
  */
-bool export_to_html(svg_t *svg, char *path);
+bool export_to_html(svg_t *svg, char *path, html_config_t *config);
 
 #endif
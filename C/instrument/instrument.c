@@ -0,0 +1,106 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "instrument.h"
+#include <time.h>
+
+#define NANOSECONDS 1000000000ULL
+
+#ifdef CODA_INSTRUMENTATION
+static const char *INSTRUMENT_NAMES[INSTRUMENT_EXPORT_SVG] = {
+    "parse_shape",
+    "parse_styles",
+    "parse_points_parameter",
+    "parse_path_elements",
+    "new_point",
+    "new_point_node",
+    "new_color",
+    "new_rotate",
+    "new_style",
+    "new_shape",
+    "new_shape_node",
+    "new_path_element",
+    "new_path_element_node"};
+
+static const char *INSTRUMENT_VARIANT_NAMES[INSTRUMENT_VARIANT_COUNT] = {
+    "ellipse", "rectangle", "line", "multiline", "polygon", "draw", "group"};
+#endif
+
+static instrument_measure_t measures[INSTRUMENT_COUNTER_COUNT];
+
+uint64_t get_instrument_time() {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return (uint64_t)time.tv_sec * NANOSECONDS + time.tv_nsec;
+}
+
+void add_instrument_count(instrument_counter_t counter) {
+  __atomic_fetch_add(&measures[counter].count, 1, __ATOMIC_RELAXED);
+}
+
+void add_instrument_time(instrument_counter_t counter, uint64_t start) {
+  __atomic_fetch_add(&measures[counter].count, 1, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&measures[counter].nanoseconds,
+                     get_instrument_time() - start, __ATOMIC_RELAXED);
+}
+
+void add_instrument_bytes(instrument_counter_t counter, long start, long end) {
+  __atomic_fetch_add(&measures[counter].count, 1, __ATOMIC_RELAXED);
+  // The offsets of pipes are unknown.
+  if (start >= 0 && end >= start)
+    __atomic_fetch_add(&measures[counter].bytes, end - start,
+                       __ATOMIC_RELAXED);
+}
+
+void reset_instrument_counters() {
+  for (int i = 0; i < INSTRUMENT_COUNTER_COUNT; i++) {
+    __atomic_store_n(&measures[i].count, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&measures[i].nanoseconds, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&measures[i].bytes, 0, __ATOMIC_RELAXED);
+  }
+}
+
+void print_instrument_counters(FILE *file) {
+#ifndef CODA_INSTRUMENTATION
+  fprintf(file, "instrumentation disabled, build with make INSTRUMENT=1\n");
+#else
+  fprintf(file, "%-24s %12s %16s %12s %14s\n", "counter", "count",
+          "time (ns)", "ns/call", "bytes");
+  for (int i = 0; i < INSTRUMENT_COUNTER_COUNT; i++) {
+    uint64_t count = __atomic_load_n(&measures[i].count, __ATOMIC_RELAXED);
+    uint64_t nanoseconds =
+        __atomic_load_n(&measures[i].nanoseconds, __ATOMIC_RELAXED);
+    uint64_t bytes = __atomic_load_n(&measures[i].bytes, __ATOMIC_RELAXED);
+    if (count == 0)
+      continue;
+    char name[32];
+    if (i < INSTRUMENT_EXPORT_SVG)
+      snprintf(name, sizeof(name), "%s", INSTRUMENT_NAMES[i]);
+    else if (i < INSTRUMENT_EXPORT_HTML)
+      snprintf(name, sizeof(name), "export_svg %s",
+               INSTRUMENT_VARIANT_NAMES[i - INSTRUMENT_EXPORT_SVG]);
+    else
+      snprintf(name, sizeof(name), "export_html %s",
+               INSTRUMENT_VARIANT_NAMES[i - INSTRUMENT_EXPORT_HTML]);
+    // The counters without durations or bytes leave their columns empty.
+    fprintf(file, "%-24s %12llu", name, (unsigned long long)count);
+    if (nanoseconds > 0)
+      fprintf(file, " %16llu %12.1f", (unsigned long long)nanoseconds,
+              (double)nanoseconds / count);
+    else
+      fprintf(file, " %16s %12s", "-", "-");
+    if (bytes > 0)
+      fprintf(file, " %14llu\n", (unsigned long long)bytes);
+    else
+      fprintf(file, " %14s\n", "-");
+  }
+#endif
+}
+
+void print_instrument_counters_at_exit() {
+  // Nothing is displayed by the commands which measured nothing.
+  for (int i = 0; i < INSTRUMENT_COUNTER_COUNT; i++)
+    if (__atomic_load_n(&measures[i].count, __ATOMIC_RELAXED) > 0) {
+      print_instrument_counters(stderr);
+      return;
+    }
+}
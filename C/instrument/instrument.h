@@ -0,0 +1,118 @@
+#ifndef CODA_INSTRUMENT
+#define CODA_INSTRUMENT
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define INSTRUMENT_VARIANT_COUNT 7
+
+/**
+ * The instrumentation is compiled in with `make INSTRUMENT=1`, which defines
+ * CODA_INSTRUMENTATION. Otherwise the macros below expand to nothing, so the
+ * hot paths pay nothing for it.
+ * The timers include the nested calls, e.g. the time of a group's
+ * parse_shape includes its children's. Likewise the bytes of a group include
+ * its children's.
+ */
+#ifdef CODA_INSTRUMENTATION
+#define INSTRUMENT_COUNT(counter) add_instrument_count(counter)
+#define INSTRUMENT_START(timer) uint64_t timer = get_instrument_time()
+#define INSTRUMENT_STOP(counter, timer) add_instrument_time(counter, timer)
+#define INSTRUMENT_START_BYTES(offset, file) long offset = ftell(file)
+#define INSTRUMENT_STOP_BYTES(counter, offset, file)                          \
+  add_instrument_bytes(counter, offset, ftell(file))
+#define INSTRUMENT_AT_EXIT() atexit(print_instrument_counters_at_exit)
+#else
+#define INSTRUMENT_COUNT(counter)
+#define INSTRUMENT_START(timer)
+#define INSTRUMENT_STOP(counter, timer)
+#define INSTRUMENT_START_BYTES(offset, file)
+#define INSTRUMENT_STOP_BYTES(counter, offset, file)
+#define INSTRUMENT_AT_EXIT()
+#endif
+
+/**
+ * Defines the instrument counter type, the measured calls.
+ * The export counters are followed by one counter per shape variant, indexed
+ * by shape_variants_t.
+ */
+typedef enum instrument_counter_e {
+  INSTRUMENT_PARSE_SHAPE,
+  INSTRUMENT_PARSE_STYLES,
+  INSTRUMENT_PARSE_POINTS_PARAMETER,
+  INSTRUMENT_PARSE_PATH_ELEMENTS,
+  INSTRUMENT_NEW_POINT,
+  INSTRUMENT_NEW_POINT_NODE,
+  INSTRUMENT_NEW_COLOR,
+  INSTRUMENT_NEW_ROTATE,
+  INSTRUMENT_NEW_STYLE,
+  INSTRUMENT_NEW_SHAPE,
+  INSTRUMENT_NEW_SHAPE_NODE,
+  INSTRUMENT_NEW_PATH_ELEMENT,
+  INSTRUMENT_NEW_PATH_ELEMENT_NODE,
+  INSTRUMENT_EXPORT_SVG,
+  INSTRUMENT_EXPORT_HTML = INSTRUMENT_EXPORT_SVG + INSTRUMENT_VARIANT_COUNT,
+  INSTRUMENT_COUNTER_COUNT = INSTRUMENT_EXPORT_HTML + INSTRUMENT_VARIANT_COUNT
+} instrument_counter_t;
+
+/**
+ * Defines the instrument measure type, the totals of a counter.
+ * The measures are updated atomically, from any thread.
+ * @param count       the number of calls.
+ * @param nanoseconds the cumulated duration of the calls.
+ * @param bytes       the cumulated number of bytes written by the calls.
+ */
+typedef struct instrument_measure_s {
+  uint64_t count;
+  uint64_t nanoseconds;
+  uint64_t bytes;
+} instrument_measure_t;
+
+/**
+ * Reads the monotonic clock.
+ * @return the clock's time, in nanoseconds.
+ */
+uint64_t get_instrument_time();
+
+/**
+ * Counts a call.
+ * @param counter the call's counter.
+ */
+void add_instrument_count(instrument_counter_t counter);
+
+/**
+ * Counts a call and its duration.
+ * @param counter the call's counter.
+ * @param start   the call's start time, in nanoseconds.
+ * @see get_instrument_time.
+ */
+void add_instrument_time(instrument_counter_t counter, uint64_t start);
+
+/**
+ * Counts a call and the bytes it wrote, if the file's offsets are known.
+ * @param counter the call's counter.
+ * @param start   the file's offset before the call, -1 if unknown.
+ * @param end     the file's offset after the call, -1 if unknown.
+ */
+void add_instrument_bytes(instrument_counter_t counter, long start, long end);
+
+/**
+ * Sets all the measures back to 0.
+ */
+void reset_instrument_counters();
+
+/**
+ * Displays the measures of the counters which were called, as a table.
+ * @param file an opened file in writing mode.
+ * @see instrument_measure_t.
+ */
+void print_instrument_counters(FILE *file);
+
+/**
+ * Displays the measures to the standard error, as an exit handler, unless
+ * nothing was measured.
+ * @see print_instrument_counters.
+ */
+void print_instrument_counters_at_exit();
+
+#endif
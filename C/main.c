@@ -1,6 +1,11 @@
+#include "batch/batch.h"
 #include "cli/cli.h"
+#include "instrument/instrument.h"
 
-int main(void) {
+int main(int argc, char **argv) {
+  INSTRUMENT_AT_EXIT();
+  if (argc > 1)
+    return batch_main(argc, argv);
   cli_main_menu();
   return EXIT_SUCCESS;
 }
@@ -1,4 +1,5 @@
 #include "ellipse.h"
+#include "../../instrument/instrument.h"
 #include "../styles/style.h"
 #include "shape.h"
 #include <stdio.h>
@@ -18,9 +19,16 @@ shape_t *new_ellipse(int center_x, int center_y, int radius_x, int radius_y,
   sh->ellipse = ellipse;
 
   shape_t *shape = malloc(sizeof(shape_t));
+  INSTRUMENT_COUNT(INSTRUMENT_NEW_SHAPE);
   shape->shape_variant = ELLIPSE;
   shape->shape = sh;
   shape->styles = styles;
+  shape->bbox = NULL;
+  shape->transform = NULL;
+  shape->hash = 0;
+  shape->is_hash_set = false;
+  shape->symbol = NULL;
+  shape->references = 1;
 
   return shape;
 }
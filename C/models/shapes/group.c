@@ -1,4 +1,5 @@
 #include "group.h"
+#include "../../instrument/instrument.h"
 #include "shape.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -8,9 +9,16 @@ shape_t *new_group(shape_node_t *shapes, style_t *styles) {
   sh->group = shapes;
 
   shape_t *shape = malloc(sizeof(shape_t));
+  INSTRUMENT_COUNT(INSTRUMENT_NEW_SHAPE);
   shape->shape_variant = GROUP;
   shape->shape = sh;
   shape->styles = styles;
+  shape->bbox = NULL;
+  shape->transform = NULL;
+  shape->hash = 0;
+  shape->is_hash_set = false;
+  shape->symbol = NULL;
+  shape->references = 1;
 
   return shape;
 }
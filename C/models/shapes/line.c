@@ -1,4 +1,5 @@
 #include "line.h"
+#include "../../instrument/instrument.h"
 #include "../styles/style.h"
 #include "../utils/point.h"
 #include "shape.h"
@@ -16,9 +17,16 @@ shape_t *new_line(point_t *start, point_t *end, style_t *styles) {
   sh->line = line;
 
   shape_t *shape = malloc(sizeof(shape_t));
+  INSTRUMENT_COUNT(INSTRUMENT_NEW_SHAPE);
   shape->shape = sh;
   shape->shape_variant = LINE;
   shape->styles = styles;
+  shape->bbox = NULL;
+  shape->transform = NULL;
+  shape->hash = 0;
+  shape->is_hash_set = false;
+  shape->symbol = NULL;
+  shape->references = 1;
 
   return shape;
 }
@@ -1,4 +1,5 @@
 #include "curve_to.h"
+#include "../../../instrument/instrument.h"
 #include "../../utils/point.h"
 #include "path_element.h"
 #include <stdio.h>
@@ -12,6 +13,7 @@
 path_element_t *new_cubic_curve_to(point_t *control_point_1,
                                    point_t *control_point_2, point_t *end) {
   path_element_t *cubic_curve_to = malloc(sizeof(path_element_t));
+  INSTRUMENT_COUNT(INSTRUMENT_NEW_PATH_ELEMENT);
   path_element_union_t *path_element = malloc(sizeof(path_element_union_t));
   cubic_curve_to_t *cct = malloc(sizeof(cubic_curve_to_t));
   cct->control_point_1 = control_point_1;
@@ -53,6 +55,7 @@ char *cubic_curve_to_string(cubic_curve_to_t *cubic_curve_to) {
 path_element_t *new_cubic_curve_to_shorthand(point_t *control_point,
                                              point_t *end) {
   path_element_t *cubic_curve_to_shorthand = malloc(sizeof(path_element_t));
+  INSTRUMENT_COUNT(INSTRUMENT_NEW_PATH_ELEMENT);
   path_element_union_t *path_element = malloc(sizeof(path_element_union_t));
   shorthand_cubic_curve_to_t *scct = malloc(sizeof(shorthand_cubic_curve_to_t));
   scct->control_point = control_point;
@@ -91,6 +94,7 @@ char *cubic_curve_to_shorthand_to_sting(
 
 path_element_t *new_quadratic_curve_to(point_t *control_point, point_t *end) {
   path_element_t *quadratic_curve_to = malloc(sizeof(path_element_t));
+  INSTRUMENT_COUNT(INSTRUMENT_NEW_PATH_ELEMENT);
   path_element_union_t *path_element = malloc(sizeof(path_element_union_t));
   quadratic_curve_to_t *qct = malloc(sizeof(quadratic_curve_to_t));
   qct->control_point = control_point;
@@ -126,6 +130,7 @@ char *quadratic_curve_to_to_string(quadratic_curve_to_t *quadratic_curve_to) {
 
 path_element_t *new_quadratic_curve_to_shorthand(point_t *end) {
   path_element_t *shorthand_quadratic_curve_to = malloc(sizeof(path_element_t));
+  INSTRUMENT_COUNT(INSTRUMENT_NEW_PATH_ELEMENT);
   path_element_union_t *path_element = malloc(sizeof(path_element_union_t));
   path_element->shorthand_quadratic_curve_to = end;
   shorthand_quadratic_curve_to->path_element = path_element;
@@ -1,4 +1,5 @@
 #include "end_path.h"
+#include "../../../instrument/instrument.h"
 #include "path_element.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -7,6 +8,7 @@
 
 path_element_t *new_end_path() {
   path_element_t *end_path = malloc(sizeof(path_element_t));
+  INSTRUMENT_COUNT(INSTRUMENT_NEW_PATH_ELEMENT);
   path_element_union_t *path_element = malloc(sizeof(path_element_union_t));
   path_element->end_path = malloc(sizeof(end_path_t));
   end_path->path_element = path_element;
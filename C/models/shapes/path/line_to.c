@@ -1,4 +1,5 @@
 #include "line_to.h"
+#include "../../../instrument/instrument.h"
 #include "../../utils/point.h"
 #include "path_element.h"
 #include <stdio.h>
@@ -10,6 +11,7 @@
 
 path_element_t *new_line_to(point_t *point) {
   path_element_t *line_to = malloc(sizeof(path_element_t));
+  INSTRUMENT_COUNT(INSTRUMENT_NEW_PATH_ELEMENT);
   path_element_union_t *path_element = malloc(sizeof(path_element_union_t));
   path_element->line_to = point;
   line_to->path_element = path_element;
@@ -33,6 +35,7 @@ char *line_to_to_string(line_to_t *line_to) {
 
 path_element_t *new_vertical_line_to(int position) {
   path_element_t *vertical_line_to = malloc(sizeof(path_element_t));
+  INSTRUMENT_COUNT(INSTRUMENT_NEW_PATH_ELEMENT);
   path_element_union_t *path_element = malloc(sizeof(path_element_union_t));
   path_element->vertical_line_to = position;
   vertical_line_to->path_element = path_element;
@@ -52,6 +55,7 @@ char *vertical_line_to_to_string(vertical_line_to_t vertical_line_to) {
 
 path_element_t *new_horizontal_line_to(int position) {
   path_element_t *horizontal_line_to = malloc(sizeof(path_element_t));
+  INSTRUMENT_COUNT(INSTRUMENT_NEW_PATH_ELEMENT);
   path_element_union_t *path_element = malloc(sizeof(path_element_union_t));
   path_element->horizontal_line_to = position;
   horizontal_line_to->path_element = path_element;
@@ -1,4 +1,5 @@
 #include "move_to.h"
+#include "../../../instrument/instrument.h"
 #include "../../utils/point.h"
 #include "path_element.h"
 #include <stdio.h>
@@ -8,6 +9,7 @@
 
 path_element_t *new_move_to(point_t *point) {
   path_element_t *move_to = malloc(sizeof(path_element_t));
+  INSTRUMENT_COUNT(INSTRUMENT_NEW_PATH_ELEMENT);
   path_element_union_t *path_element = malloc(sizeof(path_element_union_t));
   path_element->move_to = point;
   move_to->path_element = path_element;
@@ -1,4 +1,5 @@
 #include "path.h"
+#include "../../../instrument/instrument.h"
 #include "../../styles/style.h"
 #include "../shape.h"
 #include "curve_to.h"
@@ -9,6 +10,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#define NODE_INDEX_CAPACITY 16
+
 path_element_t *clone_path_element(path_element_t *element) {
   switch (element->path_element_variant) {
   case MOVE_TO:
@@ -123,8 +126,15 @@ void print_path_element(path_element_t *path_element) {
 path_element_node_t *clone_path_element_list(path_element_node_t *list) {
   path_element_node_t *node = list;
   path_element_node_t *result = NULL;
+  path_element_node_t *last = NULL;
   while (node != NULL) {
-    result = push_path_element_node(result, clone_path_element(node->element));
+    if (last == NULL) {
+      result = push_path_element_node(NULL, clone_path_element(node->element));
+      last = result;
+    } else {
+      push_path_element_node(last, clone_path_element(node->element));
+      last = last->next;
+    }
     node = node->next;
   }
   return result;
@@ -134,6 +144,7 @@ path_element_node_t *push_path_element_node(path_element_node_t *elements,
                                             path_element_t *element) {
   if (elements == NULL) {
     elements = malloc(sizeof(path_element_node_t));
+    INSTRUMENT_COUNT(INSTRUMENT_NEW_PATH_ELEMENT_NODE);
     elements->element = element;
     elements->previous = NULL;
     elements->next = NULL;
@@ -144,12 +155,25 @@ path_element_node_t *push_path_element_node(path_element_node_t *elements,
   while (p->next != NULL)
     p = p->next;
   p->next = malloc(sizeof(path_element_node_t));
+  INSTRUMENT_COUNT(INSTRUMENT_NEW_PATH_ELEMENT_NODE);
   p->next->element = element;
   p->next->next = NULL;
   p->next->previous = p;
   return elements;
 }
 
+void append_path_element_node(path_element_node_t **elements,
+                              path_element_node_t **last,
+                              path_element_t *element) {
+  if (*last == NULL) {
+    *elements = push_path_element_node(NULL, element);
+    *last = *elements;
+  } else {
+    push_path_element_node(*last, element);
+    *last = (*last)->next;
+  }
+}
+
 path_element_node_t *insert_path_element_node_at(path_element_node_t *elements,
                                                  int index,
                                                  path_element_t *element) {
@@ -160,6 +184,7 @@ path_element_node_t *insert_path_element_node_at(path_element_node_t *elements,
   // Inserts the element at the begining of the list
   if (index == 0) {
     path_element_node_t *p = malloc(sizeof(path_element_node_t));
+    INSTRUMENT_COUNT(INSTRUMENT_NEW_PATH_ELEMENT_NODE);
     p->previous = NULL;
     p->next = elements;
     p->element = element;
@@ -176,6 +201,7 @@ path_element_node_t *insert_path_element_node_at(path_element_node_t *elements,
     p2 = p2->next;
     if (i == index) {
       path_element_node_t *p = malloc(sizeof(path_element_node_t));
+      INSTRUMENT_COUNT(INSTRUMENT_NEW_PATH_ELEMENT_NODE);
       p->element = element;
       p->next = p2;
       p->previous = p1;
@@ -192,6 +218,7 @@ path_element_node_t *insert_path_element_node_at(path_element_node_t *elements,
 
   // Inserts the element at the end of the list.
   path_element_node_t *p = malloc(sizeof(path_element_node_t));
+  INSTRUMENT_COUNT(INSTRUMENT_NEW_PATH_ELEMENT_NODE);
   p->element = element;
   p->next = NULL;
   p->previous = p2;
@@ -209,7 +236,9 @@ path_element_node_t *remove_path_element_node_at(path_element_node_t *elements,
   // Removes the element at the start of the list.
   if (index == 0) {
     path_element_node_t *element = elements->next;
-    free(elements->element);
+    if (element != NULL)
+      element->previous = NULL;
+    free_path_element(elements->element);
     free(elements);
     return element;
   }
@@ -221,7 +250,7 @@ path_element_node_t *remove_path_element_node_at(path_element_node_t *elements,
   while (p2->next != NULL) {
     if (i == index) {
       p1->next = p2->next;
-      p2->previous = p1;
+      p2->next->previous = p1;
       free_path_element(p2->element);
       free(p2);
       return elements;
@@ -254,18 +283,14 @@ int get_path_element_node_length(path_element_node_t *elements) {
 }
 
 void free_path_element_nodes(path_element_node_t *elements) {
-  if (elements != NULL)
-    return;
   path_element_node_t *p1 = NULL;
   path_element_node_t *p2 = elements;
   while (p2 != NULL) {
-    free_path_element(p1->element);
-    free(p1);
     p1 = p2;
     p2 = p2->next;
+    free_path_element(p1->element);
+    free(p1);
   }
-  free_path_element(p1->element);
-  free(p1);
 }
 
 shape_t *new_path(path_element_node_t *path_elements, style_t *styles) {
@@ -273,9 +298,16 @@ shape_t *new_path(path_element_node_t *path_elements, style_t *styles) {
   sh->path = path_elements;
 
   shape_t *shape = malloc(sizeof(shape_t));
+  INSTRUMENT_COUNT(INSTRUMENT_NEW_SHAPE);
   shape->shape_variant = PATH;
   shape->shape = sh;
   shape->styles = styles;
+  shape->bbox = NULL;
+  shape->transform = NULL;
+  shape->hash = 0;
+  shape->is_hash_set = false;
+  shape->symbol = NULL;
+  shape->references = 1;
 
   return shape;
 }
@@ -292,3 +324,54 @@ void print_path(path_t *path) {
   }
   printf("] }");
 }
+
+node_index_t *index_path_element_nodes(path_element_node_t *elements) {
+  node_index_t *index = new_node_index(NODE_INDEX_CAPACITY);
+  for (path_element_node_t *node = elements; node != NULL; node = node->next)
+    insert_indexed_node(index, get_node_index_length(index), node);
+  return index;
+}
+
+path_element_node_t *get_indexed_path_element_node(node_index_t *index,
+                                                   int position) {
+  return get_indexed_node(index, position);
+}
+
+path_element_node_t *
+insert_indexed_path_element_node(path_element_node_t *elements,
+                                 node_index_t *index, int position,
+                                 path_element_t *element) {
+  if (position < 0 || position > get_node_index_length(index))
+    return elements;
+
+  path_element_node_t *node = malloc(sizeof(path_element_node_t));
+  INSTRUMENT_COUNT(INSTRUMENT_NEW_PATH_ELEMENT_NODE);
+  node->element = element;
+  node->previous = get_indexed_path_element_node(index, position - 1);
+  node->next = get_indexed_path_element_node(index, position);
+  if (node->previous != NULL)
+    node->previous->next = node;
+  if (node->next != NULL)
+    node->next->previous = node;
+  insert_indexed_node(index, position, node);
+
+  return (position == 0) ? node : elements;
+}
+
+path_element_node_t *
+remove_indexed_path_element_node(path_element_node_t *elements,
+                                 node_index_t *index, int position) {
+  path_element_node_t *node = remove_indexed_node(index, position);
+  if (node == NULL)
+    return elements;
+
+  if (node->previous != NULL)
+    node->previous->next = node->next;
+  if (node->next != NULL)
+    node->next->previous = node->previous;
+  path_element_node_t *result = (node == elements) ? node->next : elements;
+  free_path_element(node->element);
+  free(node);
+
+  return result;
+}
@@ -2,6 +2,7 @@
 #define CODA_PATH
 
 #include "../../styles/style.h"
+#include "../../utils/node_index.h"
 #include "../shape.h"
 #include "curve_to.h"
 #include "end_path.h"
@@ -71,6 +72,21 @@ path_element_node_t *clone_path_element_list(path_element_node_t *list);
 path_element_node_t *push_path_element_node(path_element_node_t *elements,
                                             path_element_t *element);
 
+/**
+ * Appends the given path element to the given linked list in O(1), using a
+ * pointer to the list's last node instead of walking the list.
+ * Note that this function allocates memory.
+ * @param elements a pointer to the linked list's first node, updated when
+ * the list is empty.
+ * @param last     a pointer to the linked list's last node, NULL when
+ * the list is empty.
+ * @param element  the path element to append.
+ * @see path_element_node_t.
+ */
+void append_path_element_node(path_element_node_t **elements,
+                              path_element_node_t **last,
+                              path_element_t *element);
+
 /**
  * Inserts the given given path element at the given index in the given linked
  * list.
@@ -156,4 +172,62 @@ void free_path(path_t *path);
  */
 void print_path(path_t *path);
 
+/**
+ * Indexes the nodes of the given path element linked list by position.
+ * Note that this function allocates memory.
+ * @param elements the linked list.
+ * @return the new node index's pointer.
+ * @see node_index_t.
+ * @see path_element_node_t.
+ */
+node_index_t *index_path_element_nodes(path_element_node_t *elements);
+
+/**
+ * Retrieves the path element node at the given position in O(1).
+ * @param index    the linked list's node index.
+ * @param position the node's position.
+ * @return the node's pointer, NULL if the position is invalid.
+ * @see index_path_element_nodes.
+ */
+path_element_node_t *get_indexed_path_element_node(node_index_t *index,
+                                                   int position);
+
+/**
+ * Inserts the given path element at the given position in the given linked
+ * list, using and updating the list's node index instead of walking the list.
+ * Note that this function allocates memory.
+ * Note that if the position is invalid (position < 0 || position >
+ * length(elements)) the function returns the linked list's pointer.
+ * Note that if the position is 0 the linked list pointer will change hence the
+ * return type.
+ * @param elements the linked list.
+ * @param index    the linked list's node index.
+ * @param position the position of the new node.
+ * @param element  the path element to insert.
+ * @return the updated linked list first node's pointer.
+ * @see index_path_element_nodes.
+ */
+path_element_node_t *
+insert_indexed_path_element_node(path_element_node_t *elements,
+                                 node_index_t *index, int position,
+                                 path_element_t *element);
+
+/**
+ * Removes the path element at the given position from the given linked list,
+ * using and updating the list's node index instead of walking the list.
+ * Note that this function frees memory.
+ * Note that if the position is invalid the function returns the linked list's
+ * pointer.
+ * Note that if the position is 0 the linked list pointer will change hence the
+ * return type.
+ * @param elements the linked list.
+ * @param index    the linked list's node index.
+ * @param position the position of the node to remove.
+ * @return the updated linked list first node's pointer.
+ * @see index_path_element_nodes.
+ */
+path_element_node_t *
+remove_indexed_path_element_node(path_element_node_t *elements,
+                                 node_index_t *index, int position);
+
 #endif
@@ -1,4 +1,5 @@
 #include "polygon.h"
+#include "../../instrument/instrument.h"
 #include "../styles/style.h"
 #include "../utils/point.h"
 #include "shape.h"
@@ -10,9 +11,16 @@ shape_t *new_polygon(point_node_t *points, style_t *styles) {
   sh->polygon = points;
 
   shape_t *shape = malloc(sizeof(shape_t));
+  INSTRUMENT_COUNT(INSTRUMENT_NEW_SHAPE);
   shape->shape_variant = POLYGON;
   shape->shape = sh;
   shape->styles = styles;
+  shape->bbox = NULL;
+  shape->transform = NULL;
+  shape->hash = 0;
+  shape->is_hash_set = false;
+  shape->symbol = NULL;
+  shape->references = 1;
 
   return shape;
 }
@@ -1,4 +1,5 @@
 #include "rectangle.h"
+#include "../../instrument/instrument.h"
 #include "../styles/style.h"
 #include "shape.h"
 #include <stdio.h>
@@ -17,9 +18,16 @@ shape_t *new_rectangle(int x, int y, int width, int height, style_t *styles) {
   sh->rectangle = rectangle;
 
   shape_t *shape = malloc(sizeof(shape_t));
+  INSTRUMENT_COUNT(INSTRUMENT_NEW_SHAPE);
   shape->shape_variant = RECTANGLE;
   shape->shape = sh;
   shape->styles = styles;
+  shape->bbox = NULL;
+  shape->transform = NULL;
+  shape->hash = 0;
+  shape->is_hash_set = false;
+  shape->symbol = NULL;
+  shape->references = 1;
 
   return shape;
 }
@@ -1,4 +1,5 @@
 #include "shape.h"
+#include "../../instrument/instrument.h"
 #include "ellipse.h"
 #include "group.h"
 #include "line.h"
@@ -6,15 +7,23 @@
 #include "path/path.h"
 #include "polygon.h"
 #include "rectangle.h"
+#include "symbol.h"
 #include <stdio.h>
 #include <stdlib.h>
 
+#define NODE_INDEX_CAPACITY 16
+
 shape_t *clone_shape(shape_t *shape) {
+  shape->references++;
+  return shape;
+}
+
+shape_t *copy_shape(shape_t *shape) {
   switch (shape->shape_variant) {
   case ELLIPSE:
     return new_ellipse(
         shape->shape->ellipse->center_x, shape->shape->ellipse->center_y,
-        shape->shape->ellipse->radius_x, shape->shape->ellipse->center_y,
+        shape->shape->ellipse->radius_x, shape->shape->ellipse->radius_y,
         clone_style(shape->styles));
     break;
   case RECTANGLE:
@@ -41,6 +50,9 @@ shape_t *clone_shape(shape_t *shape) {
                     clone_style(shape->styles));
     break;
   case GROUP:
+    if (shape->symbol != NULL)
+      return new_instance(clone_symbol(shape->symbol),
+                          clone_style(shape->styles));
     return new_group(clone_shape_list(shape->shape->group),
                      clone_style(shape->styles));
     break;
@@ -49,7 +61,18 @@ shape_t *clone_shape(shape_t *shape) {
   return NULL;
 }
 
+shape_t *unshare_shape(shape_t **shape) {
+  if ((*shape)->references > 1) {
+    (*shape)->references--;
+    *shape = copy_shape(*shape);
+  }
+  return *shape;
+}
+
 void free_shape(shape_t *shape) {
+  if (--shape->references > 0)
+    return;
+
   switch (shape->shape_variant) {
   case ELLIPSE:
     free_ellipse(shape->shape->ellipse);
@@ -73,7 +96,12 @@ void free_shape(shape_t *shape) {
     free_group(shape->shape->group);
     break;
   }
+  free(shape->shape);
   free_style(shape->styles);
+  free_bbox(shape->bbox);
+  free_transform(shape->transform);
+  if (shape->symbol != NULL)
+    free_symbol(shape->symbol);
   free(shape);
 }
 
@@ -107,11 +135,38 @@ void print_shape(shape_t *shape) {
   printf(" }");
 }
 
+char *get_shape_name(shape_t *shape) {
+  switch (shape->shape_variant) {
+  case ELLIPSE:
+    return "ellipse";
+  case RECTANGLE:
+    return "rectangle";
+  case LINE:
+    return "line";
+  case MULTILINE:
+    return "multiline";
+  case POLYGON:
+    return "polygon";
+  case PATH:
+    return "draw";
+  case GROUP:
+    return "group";
+  }
+  return NULL;
+}
+
 shape_node_t *clone_shape_list(shape_node_t *shapes) {
   shape_node_t *node = shapes;
   shape_node_t *result = NULL;
+  shape_node_t *last = NULL;
   while (node != NULL) {
-    result = push_shape_node(result, clone_shape(node->shape));
+    if (last == NULL) {
+      result = push_shape_node(NULL, clone_shape(node->shape));
+      last = result;
+    } else {
+      push_shape_node(last, clone_shape(node->shape));
+      last = last->next;
+    }
     node = node->next;
   }
   return result;
@@ -120,6 +175,7 @@ shape_node_t *clone_shape_list(shape_node_t *shapes) {
 shape_node_t *push_shape_node(shape_node_t *shapes, shape_t *shape) {
   if (shapes == NULL) {
     shapes = malloc(sizeof(shape_node_t));
+    INSTRUMENT_COUNT(INSTRUMENT_NEW_SHAPE_NODE);
     shapes->shape = shape;
     shapes->previous = NULL;
     shapes->next = NULL;
@@ -130,6 +186,7 @@ shape_node_t *push_shape_node(shape_node_t *shapes, shape_t *shape) {
   while (s->next != NULL)
     s = s->next;
   s->next = malloc(sizeof(shape_node_t));
+  INSTRUMENT_COUNT(INSTRUMENT_NEW_SHAPE_NODE);
   s->next->shape = shape;
   s->next->next = NULL;
   s->next->previous = s;
@@ -137,6 +194,17 @@ shape_node_t *push_shape_node(shape_node_t *shapes, shape_t *shape) {
   return shapes;
 }
 
+void append_shape_node(shape_node_t **shapes, shape_node_t **last,
+                       shape_t *shape) {
+  if (*last == NULL) {
+    *shapes = push_shape_node(NULL, shape);
+    *last = *shapes;
+  } else {
+    push_shape_node(*last, shape);
+    *last = (*last)->next;
+  }
+}
+
 shape_node_t *insert_shape_node_at(shape_node_t *shapes, int index,
                                    shape_t *shape) {
   // Invalid index.
@@ -146,6 +214,7 @@ shape_node_t *insert_shape_node_at(shape_node_t *shapes, int index,
   // Inserts the shape at the begining of the list
   if (index == 0) {
     shape_node_t *s = malloc(sizeof(shape_node_t));
+    INSTRUMENT_COUNT(INSTRUMENT_NEW_SHAPE_NODE);
     s->previous = NULL;
     s->next = shapes;
     s->shape = shape;
@@ -162,6 +231,7 @@ shape_node_t *insert_shape_node_at(shape_node_t *shapes, int index,
     s2 = s2->next;
     if (i == index) {
       shape_node_t *s = malloc(sizeof(shape_node_t));
+      INSTRUMENT_COUNT(INSTRUMENT_NEW_SHAPE_NODE);
       s->shape = shape;
       s->next = s2;
       s->previous = s1;
@@ -178,6 +248,7 @@ shape_node_t *insert_shape_node_at(shape_node_t *shapes, int index,
 
   // Inserts the point at the end of the list.
   shape_node_t *s = malloc(sizeof(shape_node_t));
+  INSTRUMENT_COUNT(INSTRUMENT_NEW_SHAPE_NODE);
   s->shape = shape;
   s->next = NULL;
   s->previous = s2;
@@ -194,7 +265,9 @@ shape_node_t *remove_shape_node_at(shape_node_t *shapes, int index) {
   // Removes the shape at the start of the list.
   if (index == 0) {
     shape_node_t *shape = shapes->next;
-    free(shapes->shape);
+    if (shape != NULL)
+      shape->previous = NULL;
+    free_shape(shapes->shape);
     free(shapes);
     return shape;
   }
@@ -206,8 +279,8 @@ shape_node_t *remove_shape_node_at(shape_node_t *shapes, int index) {
   while (s2->next != NULL) {
     if (i == index) {
       s1->next = s2->next;
-      s2->previous = s1;
-      free(s2->shape);
+      s2->next->previous = s1;
+      free_shape(s2->shape);
       free(s2);
       return shapes;
     }
@@ -222,7 +295,7 @@ shape_node_t *remove_shape_node_at(shape_node_t *shapes, int index) {
 
   // Removes the shape at the end of the list.
   s1->next = NULL;
-  free(s2->shape);
+  free_shape(s2->shape);
   free(s2);
 
   return shapes;
@@ -239,16 +312,60 @@ int get_shape_node_length(shape_node_t *shapes) {
 }
 
 void free_shape_node(shape_node_t *shapes) {
-  if (shapes != NULL)
-    return;
   shape_node_t *s1 = NULL;
   shape_node_t *s2 = shapes;
   while (s2 != NULL) {
-    free(s1->shape);
-    free(s1);
     s1 = s2;
     s2 = s2->next;
+    free_shape(s1->shape);
+    free(s1);
   }
-  free(s1->shape);
-  free(s1);
+}
+
+node_index_t *index_shape_nodes(shape_node_t *shapes) {
+  node_index_t *index = new_node_index(NODE_INDEX_CAPACITY);
+  for (shape_node_t *node = shapes; node != NULL; node = node->next)
+    insert_indexed_node(index, get_node_index_length(index), node);
+  return index;
+}
+
+shape_node_t *get_indexed_shape_node(node_index_t *index, int position) {
+  return get_indexed_node(index, position);
+}
+
+shape_node_t *insert_indexed_shape_node(shape_node_t *shapes,
+                                        node_index_t *index, int position,
+                                        shape_t *shape) {
+  if (position < 0 || position > get_node_index_length(index))
+    return shapes;
+
+  shape_node_t *node = malloc(sizeof(shape_node_t));
+  INSTRUMENT_COUNT(INSTRUMENT_NEW_SHAPE_NODE);
+  node->shape = shape;
+  node->previous = get_indexed_shape_node(index, position - 1);
+  node->next = get_indexed_shape_node(index, position);
+  if (node->previous != NULL)
+    node->previous->next = node;
+  if (node->next != NULL)
+    node->next->previous = node;
+  insert_indexed_node(index, position, node);
+
+  return (position == 0) ? node : shapes;
+}
+
+shape_node_t *remove_indexed_shape_node(shape_node_t *shapes,
+                                        node_index_t *index, int position) {
+  shape_node_t *node = remove_indexed_node(index, position);
+  if (node == NULL)
+    return shapes;
+
+  if (node->previous != NULL)
+    node->previous->next = node->next;
+  if (node->next != NULL)
+    node->next->previous = node->previous;
+  shape_node_t *result = (node == shapes) ? node->next : shapes;
+  free_shape(node->shape);
+  free(node);
+
+  return result;
 }
@@ -2,7 +2,12 @@
 #define CODA_SHAPE_BASE
 
 #include "../styles/style.h"
+#include "../utils/affine.h"
+#include "../utils/bbox.h"
+#include "../utils/node_index.h"
 #include "../utils/point.h"
+#include <stdbool.h>
+#include <stdint.h>
 
 /**
  * Predefines the path element linked list node type.
@@ -19,6 +24,11 @@ typedef struct shape_s shape_t;
  */
 typedef struct shape_node_s shape_node_t;
 
+/**
+ * Predefines the symbol type.
+ */
+typedef struct symbol_s symbol_t;
+
 /**
  * Defines the shape linked list node type.
  * @param previous the linked list's previous node.
@@ -120,26 +130,68 @@ typedef union shape_union_u {
  * @param shape_variant indicates the active shape variant.
  * @param shape         holds the active shape variant.
  * @param styles        the shape's styles.
+ * @param bbox          the shape's cached bounding box, NULL if it has not been
+ * computed yet.
+ * @param transform     the shape's cached transformations, NULL if they have
+ * not been computed yet.
+ * @param hash          the shape's cached content hash.
+ * @param is_hash_set   indicates if the content hash has been computed yet.
+ * @param symbol        the symbol instantiated by the group, NULL if the shape
+ * is not an instance.
+ * @param references    the number of owners sharing the shape, i.e. the
+ * number of lists and pointers it was cloned into.
  */
 struct shape_s {
   shape_variants_t shape_variant;
   shape_union_t *shape;
   style_t *styles;
+  bbox_t *bbox;
+  transform_t *transform;
+  uint64_t hash;
+  bool is_hash_set;
+  symbol_t *symbol;
+  unsigned int references;
 };
 
 /**
- * Duplicates the given shape.
- * Note that this function allocates memory.
- * @param shape the shape to be duplicated.
- * @return the duplicated shape's pointer.
+ * Shares the given shape with a new owner.
+ * The shape is not copied, so cloning costs the same whatever its size. A
+ * shared shape must not be modified: its owners must unshare it first.
+ * @param shape the shape to be shared.
+ * @return the shape's pointer.
+ * @see unshare_shape.
  * @see shape_t.
  */
 shape_t *clone_shape(shape_t *shape);
 
 /**
- * Destroys the given shape.
+ * Copies the given shape one level deep.
+ * The geometry is copied while the styles, the shapes of groups and the
+ * instantiated symbol are shared with the original shape.
+ * Note that this function allocates memory.
+ * @param shape the shape to be copied.
+ * @return the new shape's pointer.
+ * @see clone_shape.
+ * @see shape_t.
+ */
+shape_t *copy_shape(shape_t *shape);
+
+/**
+ * Makes sure the given owner's shape is not shared before modifying it.
+ * A shared shape is replaced by a copy, the other owners keeping the
+ * original.
+ * Note that this function allocates memory.
+ * @param shape a pointer to the owner's shape pointer.
+ * @return the owner's shape pointer, which can be modified.
+ * @see copy_shape.
+ * @see shape_t.
+ */
+shape_t *unshare_shape(shape_t **shape);
+
+/**
+ * Releases the given shape, which is destroyed once it has no owner left.
  * Note that this function frees memory.
- * @param shape the shape to be destroyed.
+ * @param shape the shape to be released.
  * @see shape_t.
  */
 void free_shape(shape_t *shape);
@@ -152,8 +204,18 @@ void free_shape(shape_t *shape);
  */
 void print_shape(shape_t *shape);
 
+/**
+ * Retrieves the name of the given shape's variant, as written in the svg
+ * files.
+ * @param shape the shape.
+ * @return the variant's name.
+ * @see shape_t.
+ */
+char *get_shape_name(shape_t *shape);
+
 /**
  * Duplicates the given shape linked list.
+ * The nodes are copied and the shapes are shared.
  * Note that this function allocates memory.
  * @param shapes the linked list.
  * @return the new linked list's pointer.
@@ -174,6 +236,20 @@ shape_node_t *clone_shape_list(shape_node_t *shapes);
  */
 shape_node_t *push_shape_node(shape_node_t *shapes, shape_t *shape);
 
+/**
+ * Appends the given shape to the given linked list in O(1), using a pointer
+ * to the list's last node instead of walking the list.
+ * Note that this function allocates memory.
+ * @param shapes a pointer to the linked list's first node, updated when
+ * the list is empty.
+ * @param last   a pointer to the linked list's last node, NULL when
+ * the list is empty.
+ * @param shape  the shape to append.
+ * @see shape_node_t.
+ */
+void append_shape_node(shape_node_t **shapes, shape_node_t **last,
+                       shape_t *shape);
+
 /**
  * Inserts the given shape at the given index in the given linked list.
  * Note that this function allocates memory.
@@ -221,4 +297,59 @@ int get_shape_node_length(shape_node_t *shapes);
  */
 void free_shape_node(shape_node_t *shapes);
 
+/**
+ * Indexes the nodes of the given shape linked list by position.
+ * Note that this function allocates memory.
+ * @param shapes the linked list.
+ * @return the new node index's pointer.
+ * @see node_index_t.
+ * @see shape_node_t.
+ */
+node_index_t *index_shape_nodes(shape_node_t *shapes);
+
+/**
+ * Retrieves the shape node at the given position in O(1).
+ * @param index    the linked list's node index.
+ * @param position the node's position.
+ * @return the node's pointer, NULL if the position is invalid.
+ * @see index_shape_nodes.
+ */
+shape_node_t *get_indexed_shape_node(node_index_t *index, int position);
+
+/**
+ * Inserts the given shape at the given position in the given linked list,
+ * using and updating the list's node index instead of walking the list.
+ * Note that this function allocates memory.
+ * Note that if the position is invalid (position < 0 || position >
+ * length(shapes)) the function returns the linked list's pointer.
+ * Note that if the position is 0 the linked list pointer will change hence the
+ * return type.
+ * @param shapes   the linked list.
+ * @param index    the linked list's node index.
+ * @param position the position of the new node.
+ * @param shape    the shape to insert.
+ * @return the updated linked list first node's pointer.
+ * @see index_shape_nodes.
+ */
+shape_node_t *insert_indexed_shape_node(shape_node_t *shapes,
+                                        node_index_t *index, int position,
+                                        shape_t *shape);
+
+/**
+ * Removes the shape at the given position from the given linked list, using
+ * and updating the list's node index instead of walking the list.
+ * Note that this function frees memory.
+ * Note that if the position is invalid the function returns the linked list's
+ * pointer.
+ * Note that if the position is 0 the linked list pointer will change hence the
+ * return type.
+ * @param shapes   the linked list.
+ * @param index    the linked list's node index.
+ * @param position the position of the node to remove.
+ * @return the updated linked list first node's pointer.
+ * @see index_shape_nodes.
+ */
+shape_node_t *remove_indexed_shape_node(shape_node_t *shapes,
+                                        node_index_t *index, int position);
+
 #endif
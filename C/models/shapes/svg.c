@@ -29,10 +29,35 @@ svg_t *new_svg(viewport_t *viewport, shape_node_t *shapes) {
   svg_t *svg = malloc(sizeof(svg_t));
   svg->viewport = viewport;
   svg->shapes = shapes;
+  svg->symbols = NULL;
+  svg->references = 1;
 
   return svg;
 }
 
+svg_t *clone_svg(svg_t *svg) {
+  svg->references++;
+  return svg;
+}
+
+svg_t *copy_svg(svg_t *svg) {
+  viewport_t *viewport = NULL;
+  if (svg->viewport != NULL)
+    viewport = new_viewport(clone_point(svg->viewport->start),
+                            clone_point(svg->viewport->end));
+  svg_t *copy = new_svg(viewport, clone_shape_list(svg->shapes));
+  copy->symbols = clone_symbol_list(svg->symbols);
+  return copy;
+}
+
+svg_t *unshare_svg(svg_t **svg) {
+  if ((*svg)->references > 1) {
+    (*svg)->references--;
+    *svg = copy_svg(*svg);
+  }
+  return *svg;
+}
+
 void print_svg(svg_t *svg) {
   printf("Svg { Viewport = { ");
   print_viewport(svg->viewport);
@@ -47,9 +72,12 @@ void print_svg(svg_t *svg) {
 }
 
 void free_svg(svg_t *svg) {
+  if (--svg->references > 0)
+    return;
   if (svg->viewport != NULL)
     free_viewport(svg->viewport);
   if (svg->shapes != NULL)
     free_shape_node(svg->shapes);
+  free_symbol_node(svg->symbols);
   free(svg);
 }
@@ -4,6 +4,7 @@
 #include "../styles/style.h"
 #include "../utils/point.h"
 #include "shape.h"
+#include "symbol.h"
 
 /**
  * Defines the viewport type.
@@ -44,18 +45,24 @@ void free_viewport(viewport_t *viewport);
 
 /**
  * Definew the svg type.
- * @param viewport the svg's viewport.
- * @param shapes   the svg's shapes.
+ * @param viewport   the svg's viewport.
+ * @param shapes     the svg's shapes.
+ * @param symbols    the symbols defined by the svg, instantiated by its
+ * shapes.
+ * @param references the number of owners sharing the svg.
  * @see viewport_t.
  * @see shape_node_t.
+ * @see symbol_node_t.
  */
 typedef struct svg_s {
   viewport_t *viewport;
   shape_node_t *shapes;
+  symbol_node_t *symbols;
+  unsigned int references;
 } svg_t;
 
 /**
- * Creates a new svg.
+ * Creates a new svg, without any symbol.
  * Note that this function allocates memory.
  * @param viewport the svg's viewport.
  * @param shapes   the svg's shapes.
@@ -67,14 +74,40 @@ typedef struct svg_s {
 svg_t *new_svg(viewport_t *viewport, shape_node_t *shapes);
 
 /**
- * Duplicates the given svg.
- * Note that this function allocates memory.
- * @param svg the svg to duplicate.
- * @return the duplicated svg's pointer.
+ * Shares the given svg with a new owner.
+ * The svg is not copied, so cloning costs the same whatever its size. A
+ * shared svg must not be modified: its owners must unshare it first.
+ * @param svg the svg to share.
+ * @return the svg's pointer.
+ * @see unshare_svg.
  * @see svg_t.
  */
 svg_t *clone_svg(svg_t *svg);
 
+/**
+ * Copies the given svg one level deep.
+ * The viewport and the shape and symbol linked lists are copied while the
+ * shapes and the symbols are shared, so that only the edited shapes get
+ * copied afterwards.
+ * Note that this function allocates memory.
+ * @param svg the svg to copy.
+ * @return the new svg's pointer.
+ * @see clone_shape_list.
+ * @see svg_t.
+ */
+svg_t *copy_svg(svg_t *svg);
+
+/**
+ * Makes sure the given owner's svg is not shared before modifying it.
+ * A shared svg is replaced by a copy.
+ * Note that this function allocates memory.
+ * @param svg a pointer to the owner's svg pointer.
+ * @return the owner's svg pointer, which can be modified.
+ * @see copy_svg.
+ * @see svg_t.
+ */
+svg_t *unshare_svg(svg_t **svg);
+
 /**
  * Prints out the given svg.
  * Note that this function is for debug purposes only.
@@ -84,7 +117,7 @@ svg_t *clone_svg(svg_t *svg);
 void print_svg(svg_t *svg);
 
 /**
- * Destroys the given svg.
+ * Releases the given svg, which is destroyed once it has no owner left.
  * Note that this function frees memory.
  * @param svg the svg to be destroyed.
  * @see svg_t.
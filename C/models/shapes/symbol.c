@@ -0,0 +1,93 @@
+#include "symbol.h"
+#include "group.h"
+#include "shape.h"
+#include <stdlib.h>
+#include <string.h>
+
+symbol_t *new_symbol(char *id, shape_t *shape) {
+  symbol_t *symbol = malloc(sizeof(symbol_t));
+  symbol->id = id;
+  symbol->shape = shape;
+  symbol->references = 1;
+  return symbol;
+}
+
+symbol_t *clone_symbol(symbol_t *symbol) {
+  symbol->references++;
+  return symbol;
+}
+
+void free_symbol(symbol_t *symbol) {
+  if (--symbol->references > 0)
+    return;
+  free_shape(symbol->shape);
+  free(symbol->id);
+  free(symbol);
+}
+
+shape_t *new_instance(symbol_t *symbol, style_t *styles) {
+  shape_t *shape =
+      new_group(push_shape_node(NULL, clone_shape(symbol->shape)), styles);
+  shape->symbol = symbol;
+  return shape;
+}
+
+bool is_instance(shape_t *shape) { return shape->symbol != NULL; }
+
+symbol_t *find_symbol(symbol_node_t *symbols, char *id) {
+  for (symbol_node_t *node = symbols; node != NULL; node = node->next)
+    if (strcmp(node->symbol->id, id) == 0)
+      return node->symbol;
+  return NULL;
+}
+
+symbol_node_t *push_symbol_node(symbol_node_t *symbols, symbol_t *symbol) {
+  symbol_node_t *node = malloc(sizeof(symbol_node_t));
+  node->symbol = symbol;
+  node->next = NULL;
+  if (symbols == NULL) {
+    node->previous = NULL;
+    return node;
+  }
+
+  symbol_node_t *s = symbols;
+  while (s->next != NULL)
+    s = s->next;
+  s->next = node;
+  node->previous = s;
+
+  return symbols;
+}
+
+symbol_node_t *clone_symbol_list(symbol_node_t *symbols) {
+  symbol_node_t *result = NULL;
+  symbol_node_t *last = NULL;
+  for (symbol_node_t *node = symbols; node != NULL; node = node->next) {
+    if (last == NULL) {
+      result = push_symbol_node(NULL, clone_symbol(node->symbol));
+      last = result;
+    } else {
+      push_symbol_node(last, clone_symbol(node->symbol));
+      last = last->next;
+    }
+  }
+  return result;
+}
+
+int get_symbol_node_length(symbol_node_t *symbols) {
+  int i = 0;
+  for (symbol_node_t *s = symbols; s != NULL; s = s->next)
+    i++;
+  return i;
+}
+
+void free_symbol_node(symbol_node_t *symbols) {
+  symbol_node_t *s1 = NULL;
+  symbol_node_t *s2 = symbols;
+  while (s2 != NULL) {
+    s1 = s2;
+    s2 = s2->next;
+    free_symbol(s1->symbol);
+    free(s1);
+  }
+}
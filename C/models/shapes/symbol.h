@@ -0,0 +1,135 @@
+#ifndef CODA_SYMBOL
+#define CODA_SYMBOL
+
+#include "../styles/style.h"
+#include "shape.h"
+
+/**
+ * Defines the symbol type, a shape defined once in an svg and instantiated by
+ * reference.
+ * @param id         the symbol's identifier, unique in its svg.
+ * @param shape      the symbol's content, shared by all its instances.
+ * @param references the number of owners sharing the symbol, i.e. its svgs
+ * and its instances.
+ * @see shape_t.
+ */
+struct symbol_s {
+  char *id;
+  shape_t *shape;
+  unsigned int references;
+};
+
+/**
+ * Predefines the symbol linked list node type.
+ */
+typedef struct symbol_node_s symbol_node_t;
+
+/**
+ * Defines the symbol linked list node type.
+ * @param previous the linked list's previous node.
+ * @param symbol   the node's symbol.
+ * @param next     the linked list's next node.
+ */
+struct symbol_node_s {
+  symbol_node_t *previous;
+  symbol_t *symbol;
+  symbol_node_t *next;
+};
+
+/**
+ * Creates a new symbol.
+ * Note that this function allocates memory.
+ * @param id    the symbol's identifier, which is owned by the symbol.
+ * @param shape the symbol's content.
+ * @return the new symbol's pointer.
+ * @see shape_t.
+ * @see symbol_t.
+ */
+symbol_t *new_symbol(char *id, shape_t *shape);
+
+/**
+ * Shares the given symbol with a new owner.
+ * @param symbol the symbol to be shared.
+ * @return the symbol's pointer.
+ * @see symbol_t.
+ */
+symbol_t *clone_symbol(symbol_t *symbol);
+
+/**
+ * Releases the given symbol, which is destroyed once it has no owner left.
+ * Note that this function frees memory.
+ * @param symbol the symbol to be released.
+ * @see symbol_t.
+ */
+void free_symbol(symbol_t *symbol);
+
+/**
+ * Creates a new instance of the given symbol.
+ * An instance is a group holding the symbol's shared content as its only
+ * shape, so that it is measured, transformed and drawn like any group while
+ * the content is stored once.
+ * Note that this function allocates memory.
+ * @param symbol the instantiated symbol, which is owned by the instance.
+ * @param styles the instance's styles.
+ * @return the new instance's pointer.
+ * @see new_group.
+ * @see symbol_t.
+ */
+shape_t *new_instance(symbol_t *symbol, style_t *styles);
+
+/**
+ * Tests if the given shape is an instance of a symbol.
+ * @param shape the shape.
+ * @return true if the shape is an instance, false otherwise.
+ * @see new_instance.
+ */
+bool is_instance(shape_t *shape);
+
+/**
+ * Looks for the symbol with the given identifier in the given linked list.
+ * @param symbols the linked list.
+ * @param id      the identifier.
+ * @return the symbol's pointer, NULL if there is none.
+ * @see symbol_node_t.
+ */
+symbol_t *find_symbol(symbol_node_t *symbols, char *id);
+
+/**
+ * Appends the given symbol to the given symbol linked list.
+ * Note that this function allocates memory.
+ * Note that if the linked list is NULL (i.e. the linked list is empty) then the
+ * linked list pointer will change hence the result type.
+ * @param symbols the linked list.
+ * @param symbol  the symbol to append.
+ * @return the linked list updated first node's pointer.
+ * @see symbol_node_t.
+ */
+symbol_node_t *push_symbol_node(symbol_node_t *symbols, symbol_t *symbol);
+
+/**
+ * Duplicates the given symbol linked list.
+ * The nodes are copied and the symbols are shared.
+ * Note that this function allocates memory.
+ * @param symbols the linked list.
+ * @return the new linked list's pointer.
+ * @see symbol_node_t.
+ */
+symbol_node_t *clone_symbol_list(symbol_node_t *symbols);
+
+/**
+ * Computes the given symbol linked list length.
+ * @param symbols the linked list.
+ * @return the linked list length.
+ * @see symbol_node_t.
+ */
+int get_symbol_node_length(symbol_node_t *symbols);
+
+/**
+ * Destroys the given symbol linked list, releasing its symbols.
+ * Note that this function frees memory.
+ * @param symbols the symbol linked list to be destroyed.
+ * @see symbol_node_t.
+ */
+void free_symbol_node(symbol_node_t *symbols);
+
+#endif
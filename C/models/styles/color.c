@@ -1,4 +1,5 @@
 #include "color.h"
+#include "../../instrument/instrument.h"
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -6,6 +7,7 @@
 color_t *new_color(unsigned char red, unsigned char green, unsigned char blue,
                    unsigned char transparent) {
   color_t *color = malloc(sizeof(color_t));
+  INSTRUMENT_COUNT(INSTRUMENT_NEW_COLOR);
   color->red = red;
   color->green = green;
   color->blue = blue;
@@ -15,6 +17,7 @@ color_t *new_color(unsigned char red, unsigned char green, unsigned char blue,
 
 color_t *new_default_color() {
   color_t *color = malloc(sizeof(color_t));
+  INSTRUMENT_COUNT(INSTRUMENT_NEW_COLOR);
   color->red = 0;
   color->green = 0;
   color->blue = 0;
@@ -1,9 +1,11 @@
 #include "rotate.h"
+#include "../../instrument/instrument.h"
 #include <stdio.h>
 #include <stdlib.h>
 
 rotate_t *new_flipx() {
   rotate_t *rotate = malloc(sizeof(rotate_t));
+  INSTRUMENT_COUNT(INSTRUMENT_NEW_ROTATE);
   rotate->rotation.flip_x = malloc(sizeof(flipx_t));
   rotate->variant = FLIP_X;
   return rotate;
@@ -11,6 +13,7 @@ rotate_t *new_flipx() {
 
 rotate_t *new_flipy() {
   rotate_t *rotate = malloc(sizeof(rotate_t));
+  INSTRUMENT_COUNT(INSTRUMENT_NEW_ROTATE);
   rotate->rotation.flip_y = malloc(sizeof(flipy_t));
   rotate->variant = FLIP_Y;
   return rotate;
@@ -18,6 +21,7 @@ rotate_t *new_flipy() {
 
 rotate_t *new_circular(int degree) {
   rotate_t *rotate = malloc(sizeof(rotate_t));
+  INSTRUMENT_COUNT(INSTRUMENT_NEW_ROTATE);
   rotate->rotation.circular = degree % 360;
   rotate->variant = CIRCULAR;
   return rotate;
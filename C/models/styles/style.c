@@ -1,4 +1,5 @@
 #include "style.h"
+#include "../../instrument/instrument.h"
 #include "../styles/color.h"
 #include "../styles/rotate.h"
 #include "../utils/point.h"
@@ -8,28 +9,47 @@
 style_t *new_style(color_t *fill, color_t *outline, point_t *translate,
                    rotate_t *rotate) {
   style_t *style = malloc(sizeof(style_t));
+  INSTRUMENT_COUNT(INSTRUMENT_NEW_STYLE);
   style->fill = fill;
   style->outline = outline;
   style->translate = translate;
   style->rotate = rotate;
+  style->references = 1;
   return style;
 }
 
 style_t *new_default_style() {
   style_t *style = malloc(sizeof(style_t));
+  INSTRUMENT_COUNT(INSTRUMENT_NEW_STYLE);
   style->fill = new_default_color();
   style->outline = new_default_color();
   style->translate = new_point(0, 0);
   style->rotate = new_circular(0);
+  style->references = 1;
   return style;
 }
 
 style_t *clone_style(style_t *style) {
+  style->references++;
+  return style;
+}
+
+style_t *copy_style(style_t *style) {
   return new_style(clone_color(style->fill), clone_color(style->outline),
                    clone_point(style->translate), clone_rotate(style->rotate));
 }
 
+style_t *unshare_style(style_t **style) {
+  if ((*style)->references > 1) {
+    (*style)->references--;
+    *style = copy_style(*style);
+  }
+  return *style;
+}
+
 void free_style(style_t *style) {
+  if (--style->references > 0)
+    return;
   free_color(style->fill);
   free_color(style->outline);
   free_point(style->translate);
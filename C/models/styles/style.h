@@ -11,6 +11,7 @@
  * @param outline the outline color.
  * @param translate the translate transformation.
  * @param rotate the rotate transformation.
+ * @param references the number of owners sharing the style.
  * @see color_t.
  * @see rotate_t.
  * @see point_t.
@@ -20,6 +21,7 @@ typedef struct style_s {
   color_t *outline;
   point_t *translate;
   rotate_t *rotate;
+  unsigned int references;
 } style_t;
 
 /**
@@ -54,19 +56,40 @@ style_t *new_style(color_t *fill, color_t *outline, point_t *translate,
 style_t *new_default_style();
 
 /**
- * Duplicates the given styles.
+ * Shares the given styles with a new owner.
+ * A shared style must not be modified: its owners must unshare it first.
+ * @param style the style to be shared.
+ * @return the style's pointer.
+ * @see unshare_style.
+ * @see style_t.
+ */
+style_t *clone_style(style_t *style);
+
+/**
+ * Copies the given styles.
  * Note that this function allocates memory.
- * @param style the style to be duplicated.
- * @return the duplicated style's pointer.
+ * @param style the style to be copied.
+ * @return the new style's pointer.
  * @see color_t.
  * @see rotate_t.
  * @see point_t.
  * @see style_t.
  */
-style_t *clone_style(style_t *style);
+style_t *copy_style(style_t *style);
+
+/**
+ * Makes sure the given owner's style is not shared before modifying it.
+ * A shared style is replaced by a copy.
+ * Note that this function allocates memory.
+ * @param style a pointer to the owner's style pointer.
+ * @return the owner's style pointer, which can be modified.
+ * @see copy_style.
+ * @see style_t.
+ */
+style_t *unshare_style(style_t **style);
 
 /**
- * Destroys the given style.
+ * Releases the given style, which is destroyed once it has no owner left.
  * Note that this function frees memory.
  * @param the style to be destroyed.
  * @see color_t.
@@ -0,0 +1,60 @@
+#include "affine.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+affine_t get_identity_affine() {
+  return (affine_t){.a = 1, .b = 0, .c = 0, .d = 1, .e = 0, .f = 0};
+}
+
+affine_t multiply_affine(affine_t *outer, affine_t *inner) {
+  return (affine_t){
+      .a = outer->a * inner->a + outer->c * inner->b,
+      .b = outer->b * inner->a + outer->d * inner->b,
+      .c = outer->a * inner->c + outer->c * inner->d,
+      .d = outer->b * inner->c + outer->d * inner->d,
+      .e = outer->a * inner->e + outer->c * inner->f + outer->e,
+      .f = outer->b * inner->e + outer->d * inner->f + outer->f};
+}
+
+bool invert_affine(affine_t *affine, affine_t *result) {
+  double determinant = affine->a * affine->d - affine->b * affine->c;
+  if (determinant == 0)
+    return false;
+  result->a = affine->d / determinant;
+  result->b = -affine->b / determinant;
+  result->c = -affine->c / determinant;
+  result->d = affine->a / determinant;
+  result->e = (affine->c * affine->f - affine->d * affine->e) / determinant;
+  result->f = (affine->b * affine->e - affine->a * affine->f) / determinant;
+  return true;
+}
+
+bool are_affines_equal(affine_t *a, affine_t *b) {
+  return a->a == b->a && a->b == b->b && a->c == b->c && a->d == b->d &&
+         a->e == b->e && a->f == b->f;
+}
+
+bool is_affine_identity(affine_t *affine) {
+  affine_t identity = get_identity_affine();
+  return are_affines_equal(affine, &identity);
+}
+
+transform_t *new_transform(affine_t local) {
+  transform_t *transform = malloc(sizeof(transform_t));
+  transform->local = local;
+  transform->parent = get_identity_affine();
+  transform->world = local;
+  transform->has_world = false;
+  return transform;
+}
+
+void free_transform(transform_t *transform) {
+  if (transform != NULL)
+    free(transform);
+}
+
+void print_affine(affine_t *affine) {
+  printf("Affine { A=%g, B=%g, C=%g, D=%g, E=%g, F=%g }", affine->a, affine->b,
+         affine->c, affine->d, affine->e, affine->f);
+}
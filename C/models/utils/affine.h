@@ -0,0 +1,110 @@
+#ifndef CODA_AFFINE
+#define CODA_AFFINE
+
+#include <stdbool.h>
+
+/**
+ * Represents a 2D affine transformation as a 2x3 matrix.
+ * A point (x, y) is mapped to (a * x + c * y + e, b * x + d * y + f), as in
+ * the SVG matrix(a, b, c, d, e, f) transform.
+ * @param a the X scale and rotation coefficient applied to X.
+ * @param b the Y rotation and skew coefficient applied to X.
+ * @param c the X rotation and skew coefficient applied to Y.
+ * @param d the Y scale and rotation coefficient applied to Y.
+ * @param e the X translation.
+ * @param f the Y translation.
+ */
+typedef struct affine_s {
+  double a;
+  double b;
+  double c;
+  double d;
+  double e;
+  double f;
+} affine_t;
+
+/**
+ * Represents the transformations cached on a shape.
+ * @param local     the shape's own style transformation.
+ * @param parent    the parent's world transformation the world transformation
+ * was resolved with.
+ * @param world     the transformation from the shape's coordinates system to
+ * the svg's coordinates system.
+ * @param has_world indicates if the parent and world transformations are set.
+ * @see affine_t.
+ */
+typedef struct transform_s {
+  affine_t local;
+  affine_t parent;
+  affine_t world;
+  bool has_world;
+} transform_t;
+
+/**
+ * Creates the identity transformation.
+ * @return the identity transformation.
+ * @see affine_t.
+ */
+affine_t get_identity_affine();
+
+/**
+ * Composes the given transformations: the inner one is applied first.
+ * @param outer the transformation applied last.
+ * @param inner the transformation applied first.
+ * @return the composed transformation.
+ * @see affine_t.
+ */
+affine_t multiply_affine(affine_t *outer, affine_t *inner);
+
+/**
+ * Computes the inverse of the given transformation.
+ * @param affine the transformation to invert.
+ * @param result a pointer to set the inverse transformation.
+ * @return true if the transformation is invertible, false otherwise.
+ * @see affine_t.
+ */
+bool invert_affine(affine_t *affine, affine_t *result);
+
+/**
+ * Tests if the given transformations are equal.
+ * @param a the first transformation.
+ * @param b the second transformation.
+ * @return true if all the coefficients are equal, false otherwise.
+ * @see affine_t.
+ */
+bool are_affines_equal(affine_t *a, affine_t *b);
+
+/**
+ * Tests if the given transformation is the identity.
+ * @param affine the transformation.
+ * @return true if the transformation is the identity, false otherwise.
+ * @see affine_t.
+ */
+bool is_affine_identity(affine_t *affine);
+
+/**
+ * Creates a new transformation cache with the given local transformation.
+ * Note that this function allocates memory.
+ * @param local the shape's own style transformation.
+ * @return the new transformation cache's pointer.
+ * @see transform_t.
+ */
+transform_t *new_transform(affine_t local);
+
+/**
+ * Destroys the given transformation cache.
+ * Note that this function frees memory.
+ * @param transform the transformation cache to be destroyed, can be NULL.
+ * @see transform_t.
+ */
+void free_transform(transform_t *transform);
+
+/**
+ * Prints out the given transformation.
+ * Note that this function is for debug purposes only.
+ * @param affine the transformation to be printed out.
+ * @see affine_t.
+ */
+void print_affine(affine_t *affine);
+
+#endif
@@ -0,0 +1,67 @@
+#include "bbox.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+bbox_t *new_bbox(double min_x, double min_y, double max_x, double max_y) {
+  bbox_t *bbox = malloc(sizeof(bbox_t));
+  bbox->min_x = min_x;
+  bbox->min_y = min_y;
+  bbox->max_x = max_x;
+  bbox->max_y = max_y;
+  return bbox;
+}
+
+bbox_t *new_empty_bbox() {
+  return new_bbox(INFINITY, INFINITY, -INFINITY, -INFINITY);
+}
+
+bbox_t *clone_bbox(bbox_t *bbox) {
+  return new_bbox(bbox->min_x, bbox->min_y, bbox->max_x, bbox->max_y);
+}
+
+void free_bbox(bbox_t *bbox) {
+  if (bbox != NULL)
+    free(bbox);
+}
+
+void print_bbox(bbox_t *bbox) {
+  if (is_bbox_empty(bbox)) {
+    printf("Bbox { Empty }");
+    return;
+  }
+  printf("Bbox { Min X=%g, Min Y=%g, Max X=%g, Max Y=%g }", bbox->min_x,
+         bbox->min_y, bbox->max_x, bbox->max_y);
+}
+
+bool is_bbox_empty(bbox_t *bbox) {
+  return bbox->min_x > bbox->max_x || bbox->min_y > bbox->max_y;
+}
+
+void extend_bbox(bbox_t *bbox, double x, double y) {
+  if (x < bbox->min_x)
+    bbox->min_x = x;
+  if (x > bbox->max_x)
+    bbox->max_x = x;
+  if (y < bbox->min_y)
+    bbox->min_y = y;
+  if (y > bbox->max_y)
+    bbox->max_y = y;
+}
+
+void merge_bbox(bbox_t *bbox, bbox_t *other) {
+  if (is_bbox_empty(other))
+    return;
+  extend_bbox(bbox, other->min_x, other->min_y);
+  extend_bbox(bbox, other->max_x, other->max_y);
+}
+
+bool bbox_intersects(bbox_t *a, bbox_t *b) {
+  return a->min_x <= b->max_x && b->min_x <= a->max_x &&
+         a->min_y <= b->max_y && b->min_y <= a->max_y;
+}
+
+bool bbox_contains_point(bbox_t *bbox, double x, double y) {
+  return bbox->min_x <= x && x <= bbox->max_x && bbox->min_y <= y &&
+         y <= bbox->max_y;
+}
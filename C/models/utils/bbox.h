@@ -0,0 +1,115 @@
+#ifndef CODA_BBOX
+#define CODA_BBOX
+
+#include <stdbool.h>
+
+/**
+ * Represents an axis-aligned bounding box in a 2D space.
+ * An empty bounding box has its minimum coordinates greater than its maximum
+ * coordinates.
+ * @param min_x the box's left side X coordinate.
+ * @param min_y the box's top side Y coordinate.
+ * @param max_x the box's right side X coordinate.
+ * @param max_y the box's bottom side Y coordinate.
+ */
+typedef struct bbox_s {
+  double min_x;
+  double min_y;
+  double max_x;
+  double max_y;
+} bbox_t;
+
+/**
+ * Creates a new bounding box with the given coordinates.
+ * Note that this function allocates memory.
+ * @param min_x the box's left side X coordinate.
+ * @param min_y the box's top side Y coordinate.
+ * @param max_x the box's right side X coordinate.
+ * @param max_y the box's bottom side Y coordinate.
+ * @return the new bounding box's pointer.
+ * @see bbox_t.
+ */
+bbox_t *new_bbox(double min_x, double min_y, double max_x, double max_y);
+
+/**
+ * Creates a new empty bounding box.
+ * Note that this function allocates memory.
+ * Extending an empty bounding box with a point gives a box containing only
+ * this point.
+ * @return the new bounding box's pointer.
+ * @see bbox_t.
+ */
+bbox_t *new_empty_bbox();
+
+/**
+ * Duplicates the given bounding box.
+ * Note that this function allocates memory.
+ * @param bbox the bounding box to be duplicated.
+ * @return the duplicated bounding box's pointer.
+ * @see bbox_t.
+ */
+bbox_t *clone_bbox(bbox_t *bbox);
+
+/**
+ * Destroys the given bounding box.
+ * Note that this function frees memory.
+ * @param bbox the bounding box to be destroyed.
+ * @see bbox_t.
+ */
+void free_bbox(bbox_t *bbox);
+
+/**
+ * Prints out the given bounding box.
+ * Note that this function is for debug purposes only.
+ * @param bbox the bounding box to be printed out.
+ * @see bbox_t.
+ */
+void print_bbox(bbox_t *bbox);
+
+/**
+ * Checks if the given bounding box is empty.
+ * @param bbox the bounding box to check.
+ * @return true if the bounding box contains no point.
+ * @see bbox_t.
+ */
+bool is_bbox_empty(bbox_t *bbox);
+
+/**
+ * Grows the given bounding box so it contains the given point.
+ * @param bbox the bounding box to grow.
+ * @param x    the point's X coordinate.
+ * @param y    the point's Y coordinate.
+ * @see bbox_t.
+ */
+void extend_bbox(bbox_t *bbox, double x, double y);
+
+/**
+ * Grows the given bounding box so it contains the other bounding box.
+ * Note that merging an empty bounding box does nothing.
+ * @param bbox  the bounding box to grow.
+ * @param other the bounding box to merge in.
+ * @see bbox_t.
+ */
+void merge_bbox(bbox_t *bbox, bbox_t *other);
+
+/**
+ * Checks if the two given bounding boxes overlap.
+ * Boxes sharing only an edge are considered overlapping.
+ * @param a the first bounding box.
+ * @param b the second bounding box.
+ * @return true if the bounding boxes overlap.
+ * @see bbox_t.
+ */
+bool bbox_intersects(bbox_t *a, bbox_t *b);
+
+/**
+ * Checks if the given point lies inside the given bounding box.
+ * @param bbox the bounding box.
+ * @param x    the point's X coordinate.
+ * @param y    the point's Y coordinate.
+ * @return true if the point is inside the bounding box or on its edges.
+ * @see bbox_t.
+ */
+bool bbox_contains_point(bbox_t *bbox, double x, double y);
+
+#endif
@@ -0,0 +1,71 @@
+#include "node_index.h"
+#include <stdlib.h>
+#include <string.h>
+
+node_index_t *new_node_index(int capacity) {
+  node_index_t *index = malloc(sizeof(node_index_t));
+  index->nodes = malloc(sizeof(void *) * capacity);
+  index->capacity = capacity;
+  index->gap_start = 0;
+  index->gap_end = capacity;
+  return index;
+}
+
+int get_node_index_length(node_index_t *index) {
+  return index->capacity - (index->gap_end - index->gap_start);
+}
+
+void *get_indexed_node(node_index_t *index, int position) {
+  if (position < 0 || position >= get_node_index_length(index))
+    return NULL;
+  if (position < index->gap_start)
+    return index->nodes[position];
+  return index->nodes[position + index->gap_end - index->gap_start];
+}
+
+void move_node_index_gap(node_index_t *index, int position) {
+  int count;
+  if (position < index->gap_start) {
+    count = index->gap_start - position;
+    memmove(index->nodes + index->gap_end - count, index->nodes + position,
+            sizeof(void *) * count);
+    index->gap_start -= count;
+    index->gap_end -= count;
+  } else if (position > index->gap_start) {
+    count = position - index->gap_start;
+    memmove(index->nodes + index->gap_start, index->nodes + index->gap_end,
+            sizeof(void *) * count);
+    index->gap_start += count;
+    index->gap_end += count;
+  }
+}
+
+void insert_indexed_node(node_index_t *index, int position, void *node) {
+  move_node_index_gap(index, position);
+  // Doubles the capacity once the gap is filled, the nodes after the gap are
+  // moved to the end of the new array.
+  if (index->gap_start == index->gap_end) {
+    int capacity = index->capacity * 2;
+    int after = index->capacity - index->gap_end;
+    index->nodes = realloc(index->nodes, sizeof(void *) * capacity);
+    memmove(index->nodes + capacity - after, index->nodes + index->gap_end,
+            sizeof(void *) * after);
+    index->gap_end = capacity - after;
+    index->capacity = capacity;
+  }
+  index->nodes[index->gap_start++] = node;
+}
+
+void *remove_indexed_node(node_index_t *index, int position) {
+  if (position < 0 || position >= get_node_index_length(index))
+    return NULL;
+  move_node_index_gap(index, position);
+  return index->nodes[index->gap_end++];
+}
+
+void free_node_index(node_index_t *index) {
+  if (index == NULL)
+    return;
+  free(index->nodes);
+  free(index);
+}
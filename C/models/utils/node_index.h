@@ -0,0 +1,85 @@
+#ifndef CODA_NODE_INDEX
+#define CODA_NODE_INDEX
+
+/**
+ * Represents a random access index over the nodes of a linked list.
+ * The nodes are stored in a gap buffer: an array whose free slots form a gap
+ * kept at the position of the last insertion or removal. Looking a node up by
+ * its position is O(1), inserting or removing a node moves the gap there
+ * first, which is O(1) for consecutive edits at the same place and bounded by
+ * a single memmove otherwise.
+ * @param nodes     the nodes' pointers, the gap excluded.
+ * @param capacity  the number of slots.
+ * @param gap_start the first free slot.
+ * @param gap_end   the first used slot after the gap.
+ */
+typedef struct node_index_s {
+  void **nodes;
+  int capacity;
+  int gap_start;
+  int gap_end;
+} node_index_t;
+
+/**
+ * Creates a new empty node index.
+ * Note that this function allocates memory.
+ * @param capacity the initial number of slots, at least 1.
+ * @return the new node index's pointer.
+ * @see node_index_t.
+ */
+node_index_t *new_node_index(int capacity);
+
+/**
+ * Computes the number of nodes in the given index.
+ * @param index the node index.
+ * @return the number of nodes.
+ * @see node_index_t.
+ */
+int get_node_index_length(node_index_t *index);
+
+/**
+ * Retrieves the node at the given position.
+ * @param index    the node index.
+ * @param position the node's position, in [0, length[.
+ * @return the node's pointer, NULL if the position is invalid.
+ * @see node_index_t.
+ */
+void *get_indexed_node(node_index_t *index, int position);
+
+/**
+ * Moves the gap of the given index to the given position.
+ * @param index    the node index.
+ * @param position the gap's new position, in [0, length].
+ * @see node_index_t.
+ */
+void move_node_index_gap(node_index_t *index, int position);
+
+/**
+ * Inserts the given node at the given position, the following nodes being
+ * shifted by one.
+ * Note that this function allocates memory when the index is full.
+ * @param index    the node index.
+ * @param position the insertion position, in [0, length].
+ * @param node     the node's pointer.
+ * @see node_index_t.
+ */
+void insert_indexed_node(node_index_t *index, int position, void *node);
+
+/**
+ * Removes the node at the given position from the given index.
+ * @param index    the node index.
+ * @param position the node's position, in [0, length[.
+ * @return the removed node's pointer, NULL if the position is invalid.
+ * @see node_index_t.
+ */
+void *remove_indexed_node(node_index_t *index, int position);
+
+/**
+ * Destroys the given node index, leaving the nodes untouched.
+ * Note that this function frees memory.
+ * @param index the node index, or NULL.
+ * @see node_index_t.
+ */
+void free_node_index(node_index_t *index);
+
+#endif
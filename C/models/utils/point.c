@@ -1,9 +1,13 @@
 #include "point.h"
+#include "../../instrument/instrument.h"
 #include <stdio.h>
 #include <stdlib.h>
 
+#define NODE_INDEX_CAPACITY 16
+
 point_t *new_point(int x, int y) {
   point_t *point = malloc(sizeof(point_t));
+  INSTRUMENT_COUNT(INSTRUMENT_NEW_POINT);
   point->x = x;
   point->y = y;
   return point;
@@ -23,8 +27,15 @@ void print_point(point_t *point) {
 point_node_t *clone_point_list(point_node_t *points) {
   point_node_t *node = points;
   point_node_t *result = NULL;
+  point_node_t *last = NULL;
   while (node != NULL) {
-    result = push_point_node(result, clone_point(node->point));
+    if (last == NULL) {
+      result = push_point_node(NULL, clone_point(node->point));
+      last = result;
+    } else {
+      push_point_node(last, clone_point(node->point));
+      last = last->next;
+    }
     node = node->next;
   }
   return result;
@@ -34,6 +45,7 @@ point_node_t *push_point_node(point_node_t *points, point_t *point) {
   // If the linked list is NULL (i.e. the linked list is empty).
   if (points == NULL) {
     points = malloc(sizeof(point_node_t));
+    INSTRUMENT_COUNT(INSTRUMENT_NEW_POINT_NODE);
     points->point = point;
     points->previous = NULL;
     points->next = NULL;
@@ -47,6 +59,7 @@ point_node_t *push_point_node(point_node_t *points, point_t *point) {
 
   // Adds the new node.
   p->next = malloc(sizeof(point_node_t));
+  INSTRUMENT_COUNT(INSTRUMENT_NEW_POINT_NODE);
   p->next->point = point;
   p->next->next = NULL;
   p->next->previous = p;
@@ -54,6 +67,17 @@ point_node_t *push_point_node(point_node_t *points, point_t *point) {
   return points;
 }
 
+void append_point_node(point_node_t **points, point_node_t **last,
+                       point_t *point) {
+  if (*last == NULL) {
+    *points = push_point_node(NULL, point);
+    *last = *points;
+  } else {
+    push_point_node(*last, point);
+    *last = (*last)->next;
+  }
+}
+
 point_node_t *insert_point_node_at(point_node_t *points, int index,
                                    point_t *point) {
   // Invalid index.
@@ -63,6 +87,7 @@ point_node_t *insert_point_node_at(point_node_t *points, int index,
   // Inserts the point at the begining of the list.
   if (index == 0) {
     point_node_t *p = malloc(sizeof(point_node_t));
+    INSTRUMENT_COUNT(INSTRUMENT_NEW_POINT_NODE);
     p->previous = NULL;
     p->next = points;
     p->point = point;
@@ -79,6 +104,7 @@ point_node_t *insert_point_node_at(point_node_t *points, int index,
     p2 = p2->next;
     if (i == index) {
       point_node_t *p = malloc(sizeof(point_node_t));
+      INSTRUMENT_COUNT(INSTRUMENT_NEW_POINT_NODE);
       p->point = point;
       p->next = p2;
       p->previous = p1;
@@ -95,6 +121,7 @@ point_node_t *insert_point_node_at(point_node_t *points, int index,
 
   // Inserts the point at the end of the list.
   point_node_t *p = malloc(sizeof(point_node_t));
+  INSTRUMENT_COUNT(INSTRUMENT_NEW_POINT_NODE);
   p->point = point;
   p->next = NULL;
   p->previous = p2;
@@ -111,7 +138,9 @@ point_node_t *remove_point_node_at(point_node_t *points, int index) {
   // Removes the point at the start of the list.
   if (index == 0) {
     point_node_t *point = points->next;
-    free(points->point);
+    if (point != NULL)
+      point->previous = NULL;
+    free_point(points->point);
     free(points);
     return point;
   }
@@ -123,8 +152,8 @@ point_node_t *remove_point_node_at(point_node_t *points, int index) {
   while (p2->next != NULL) {
     if (i == index) {
       p1->next = p2->next;
-      p2->previous = p1;
-      free(p2->point);
+      p2->next->previous = p1;
+      free_point(p2->point);
       free(p2);
       return points;
     }
@@ -139,7 +168,7 @@ point_node_t *remove_point_node_at(point_node_t *points, int index) {
 
   // Removes the point at the end of the list.
   p1->next = NULL;
-  free(p2->point);
+  free_point(p2->point);
   free(p2);
 
   return points;
@@ -156,16 +185,60 @@ int get_point_node_length(point_node_t *points) {
 }
 
 void free_point_nodes(point_node_t *points) {
-  if (points != NULL)
-    return;
   point_node_t *p1 = NULL;
   point_node_t *p2 = points;
   while (p2 != NULL) {
-    free(p1->point);
-    free(p1);
     p1 = p2;
     p2 = p2->next;
+    free_point(p1->point);
+    free(p1);
   }
-  free(p1->point);
-  free(p1);
+}
+
+node_index_t *index_point_nodes(point_node_t *points) {
+  node_index_t *index = new_node_index(NODE_INDEX_CAPACITY);
+  for (point_node_t *node = points; node != NULL; node = node->next)
+    insert_indexed_node(index, get_node_index_length(index), node);
+  return index;
+}
+
+point_node_t *get_indexed_point_node(node_index_t *index, int position) {
+  return get_indexed_node(index, position);
+}
+
+point_node_t *insert_indexed_point_node(point_node_t *points,
+                                        node_index_t *index, int position,
+                                        point_t *point) {
+  if (position < 0 || position > get_node_index_length(index))
+    return points;
+
+  point_node_t *node = malloc(sizeof(point_node_t));
+  INSTRUMENT_COUNT(INSTRUMENT_NEW_POINT_NODE);
+  node->point = point;
+  node->previous = get_indexed_point_node(index, position - 1);
+  node->next = get_indexed_point_node(index, position);
+  if (node->previous != NULL)
+    node->previous->next = node;
+  if (node->next != NULL)
+    node->next->previous = node;
+  insert_indexed_node(index, position, node);
+
+  return (position == 0) ? node : points;
+}
+
+point_node_t *remove_indexed_point_node(point_node_t *points,
+                                        node_index_t *index, int position) {
+  point_node_t *node = remove_indexed_node(index, position);
+  if (node == NULL)
+    return points;
+
+  if (node->previous != NULL)
+    node->previous->next = node->next;
+  if (node->next != NULL)
+    node->next->previous = node->previous;
+  point_node_t *result = (node == points) ? node->next : points;
+  free_point(node->point);
+  free(node);
+
+  return result;
 }
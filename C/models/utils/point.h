@@ -1,6 +1,8 @@
 #ifndef CODA_POINT
 #define CODA_POINT
 
+#include "node_index.h"
+
 /**
  * Represents a point in a 2D space. Only accepts integer coordinates.
  * @param x the X coordinate.
@@ -88,6 +90,20 @@ point_node_t *clone_point_list(point_node_t *points);
  */
 point_node_t *push_point_node(point_node_t *points, point_t *point);
 
+/**
+ * Appends the given point to the given linked list in O(1), using a pointer
+ * to the list's last node instead of walking the list.
+ * Note that this function allocates memory.
+ * @param points a pointer to the linked list's first node, updated when
+ * the list is empty.
+ * @param last   a pointer to the linked list's last node, NULL when
+ * the list is empty.
+ * @param point  the point to append.
+ * @see point_node_t.
+ */
+void append_point_node(point_node_t **points, point_node_t **last,
+                       point_t *point);
+
 /**
  * Inserts the given point at the given index in the given linked list.
  * Note that this function allocates memory.
@@ -139,4 +155,59 @@ int get_point_node_length(point_node_t *points);
  */
 void free_point_nodes(point_node_t *points);
 
+/**
+ * Indexes the nodes of the given point linked list by position.
+ * Note that this function allocates memory.
+ * @param points the linked list.
+ * @return the new node index's pointer.
+ * @see node_index_t.
+ * @see point_node_t.
+ */
+node_index_t *index_point_nodes(point_node_t *points);
+
+/**
+ * Retrieves the point node at the given position in O(1).
+ * @param index    the linked list's node index.
+ * @param position the node's position.
+ * @return the node's pointer, NULL if the position is invalid.
+ * @see index_point_nodes.
+ */
+point_node_t *get_indexed_point_node(node_index_t *index, int position);
+
+/**
+ * Inserts the given point at the given position in the given linked list,
+ * using and updating the list's node index instead of walking the list.
+ * Note that this function allocates memory.
+ * Note that if the position is invalid (position < 0 || position >
+ * length(points)) the function returns the linked list's pointer.
+ * Note that if the position is 0 the linked list pointer will change hence the
+ * return type.
+ * @param points   the linked list.
+ * @param index    the linked list's node index.
+ * @param position the position of the new node.
+ * @param point    the point to insert.
+ * @return the updated linked list first node's pointer.
+ * @see index_point_nodes.
+ */
+point_node_t *insert_indexed_point_node(point_node_t *points,
+                                        node_index_t *index, int position,
+                                        point_t *point);
+
+/**
+ * Removes the point at the given position from the given linked list, using
+ * and updating the list's node index instead of walking the list.
+ * Note that this function frees memory.
+ * Note that if the position is invalid the function returns the linked list's
+ * pointer.
+ * Note that if the position is 0 the linked list pointer will change hence the
+ * return type.
+ * @param points   the linked list.
+ * @param index    the linked list's node index.
+ * @param position the position of the node to remove.
+ * @return the updated linked list first node's pointer.
+ * @see index_point_nodes.
+ */
+point_node_t *remove_indexed_point_node(point_node_t *points,
+                                        node_index_t *index, int position);
+
 #endif
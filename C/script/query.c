@@ -0,0 +1,291 @@
+#include "query.h"
+#include "../geometry/bounds.h"
+#include "../geometry/transform.h"
+#include "../models/shapes/symbol.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define QUERY_RESULTS_CAPACITY 16
+#define QUERY_PATH_CAPACITY 8
+
+bool parse_query_condition(char **cursor, query_condition_t *condition) {
+  char subject[SCRIPT_TOKEN_BUFFER_SIZE], token[SCRIPT_TOKEN_BUFFER_SIZE];
+  script_operator_t operator;
+  condition->is_negated = false;
+  if (!next_script_token(cursor, subject))
+    return false;
+
+  if (strcmp(subject, "bbox") == 0) {
+    if (!next_script_token(cursor, token))
+      return false;
+    if (strcmp(token, "within") == 0)
+      condition->subject = QUERY_WITHIN;
+    else if (strcmp(token, "intersects") == 0)
+      condition->subject = QUERY_INTERSECTS;
+    else
+      return false;
+    // The area's parenthesis and commas are not tokens.
+    double x1, y1, x2, y2;
+    int length = 0;
+    if (sscanf(*cursor, " ( %lf , %lf , %lf , %lf )%n", &x1, &y1, &x2, &y2,
+               &length) != 4 ||
+        length == 0)
+      return false;
+    *cursor += length;
+    condition->range.min_x = fmin(x1, x2);
+    condition->range.min_y = fmin(y1, y2);
+    condition->range.max_x = fmax(x1, x2);
+    condition->range.max_y = fmax(y1, y2);
+    return true;
+  }
+
+  if (!next_script_token(cursor, token) ||
+      !parse_script_operator(token, &operator) ||
+      !next_script_token(cursor, token))
+    return false;
+  if (parse_script_field(subject, &condition->field.field)) {
+    condition->subject = QUERY_FIELD;
+    condition->field.operator = operator;
+    return parse_script_int(token, &condition->field.value);
+  }
+
+  // The variants and colors are only tested for equality.
+  if (operator != SCRIPT_EQUAL && operator != SCRIPT_NOT_EQUAL)
+    return false;
+  condition->is_negated = operator == SCRIPT_NOT_EQUAL;
+  if (strcmp(subject, "fill") == 0 || strcmp(subject, "outline") == 0) {
+    condition->subject = (subject[0] == 'f') ? QUERY_FILL : QUERY_OUTLINE;
+    return parse_script_color(token, &condition->color);
+  }
+  if (strcmp(subject, "type") != 0)
+    return false;
+  condition->subject = QUERY_TYPE;
+  shape_t shape;
+  for (int v = ELLIPSE; v <= GROUP; v++) {
+    shape.shape_variant = v;
+    if (strcmp(token, get_shape_name(&shape)) == 0) {
+      condition->variant = v;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool parse_query(char *text, query_t *query) {
+  char token[SCRIPT_TOKEN_BUFFER_SIZE];
+  char *cursor = text;
+  query_condition_t *condition;
+  query->count = 0;
+  query->is_spatial = false;
+  if (!next_script_token(&cursor, token))
+    return true;
+
+  cursor = text;
+  do {
+    if (query->count == QUERY_CONDITION_COUNT)
+      return false;
+    condition = &query->conditions[query->count++];
+    if (!parse_query_condition(&cursor, condition))
+      return false;
+    if (condition->subject == QUERY_WITHIN ||
+        condition->subject == QUERY_INTERSECTS) {
+      if (!query->is_spatial)
+        query->range = condition->range;
+      else {
+        query->range.min_x = fmax(query->range.min_x, condition->range.min_x);
+        query->range.min_y = fmax(query->range.min_y, condition->range.min_y);
+        query->range.max_x = fmin(query->range.max_x, condition->range.max_x);
+        query->range.max_y = fmin(query->range.max_y, condition->range.max_y);
+      }
+      query->is_spatial = true;
+    }
+    if (!next_script_token(&cursor, token))
+      return true;
+  } while (strcmp(token, "and") == 0);
+  return false;
+}
+
+query_results_t *new_query_results() {
+  query_results_t *results = malloc(sizeof(query_results_t));
+  results->matches = NULL;
+  results->count = 0;
+  results->capacity = 0;
+  results->tested = 0;
+  return results;
+}
+
+void push_query_match(query_results_t *results, shape_t *shape, int *path,
+                      int depth) {
+  if (results->count == results->capacity) {
+    results->capacity = (results->capacity == 0) ? QUERY_RESULTS_CAPACITY
+                                                 : results->capacity * 2;
+    results->matches =
+        realloc(results->matches, sizeof(query_match_t) * results->capacity);
+  }
+  query_match_t *match = &results->matches[results->count++];
+  match->shape = shape;
+  match->path = malloc(sizeof(int) * depth);
+  memcpy(match->path, path, sizeof(int) * depth);
+  match->depth = depth;
+}
+
+void free_query_results(query_results_t *results) {
+  for (int i = 0; i < results->count; i++)
+    free(results->matches[i].path);
+  free(results->matches);
+  free(results);
+}
+
+int compare_query_shapes(const void *a, const void *b) {
+  uintptr_t x = (uintptr_t)(*(shape_t *const *)a);
+  uintptr_t y = (uintptr_t)(*(shape_t *const *)b);
+  return (x > y) - (x < y);
+}
+
+bool is_query_style_match(query_state_t *state, style_t *styles) {
+  int slot = ((uintptr_t)styles / sizeof(style_t)) % QUERY_STYLE_CACHE_SIZE;
+  if (state->styles[slot] == styles)
+    return state->style_matches[slot];
+
+  query_condition_t *condition;
+  color_t *color;
+  bool match = true, equal;
+  for (int i = 0; i < state->query->count && match; i++) {
+    condition = &state->query->conditions[i];
+    if (condition->subject != QUERY_FILL &&
+        condition->subject != QUERY_OUTLINE)
+      continue;
+    color = (condition->subject == QUERY_FILL) ? styles->fill : styles->outline;
+    equal = color->red == condition->color.red &&
+            color->green == condition->color.green &&
+            color->blue == condition->color.blue &&
+            color->transparent == condition->color.transparent;
+    match = equal != condition->is_negated;
+  }
+  state->styles[slot] = styles;
+  state->style_matches[slot] = match;
+  return match;
+}
+
+bool is_query_match(query_state_t *state, shape_t *shape, affine_t *parent) {
+  query_t *query = state->query;
+  query_condition_t *condition;
+  bool is_styled = false;
+  int *value;
+  state->results->tested++;
+  for (int i = 0; i < query->count; i++) {
+    condition = &query->conditions[i];
+    switch (condition->subject) {
+    case QUERY_TYPE:
+      if ((shape->shape_variant == condition->variant) == condition->is_negated)
+        return false;
+      break;
+    case QUERY_FIELD:
+      value = get_script_field(shape, condition->field.field);
+      if (value == NULL ||
+          !compare_script_values(*value, condition->field.operator,
+                                 condition->field.value))
+        return false;
+      break;
+    case QUERY_FILL:
+    case QUERY_OUTLINE:
+      is_styled = true;
+      break;
+    default:
+      break;
+    }
+  }
+  if (is_styled && !is_query_style_match(state, shape->styles))
+    return false;
+  if (!query->is_spatial)
+    return true;
+
+  // Every shape but the groups is indexed, instances included, so a shape
+  // missing from the candidates is outside the range.
+  if (state->candidates != NULL &&
+      (shape->shape_variant != GROUP || is_instance(shape)) &&
+      (state->candidates->count == 0 ||
+       bsearch(&shape, state->candidates->shapes, state->candidates->count,
+               sizeof(shape_t *), compare_query_shapes) == NULL))
+    return false;
+  bbox_t *bbox = compute_world_bbox(shape, parent);
+  bool match = !is_bbox_empty(bbox);
+  for (int i = 0; i < query->count && match; i++) {
+    condition = &query->conditions[i];
+    if (condition->subject == QUERY_INTERSECTS)
+      match = bbox_intersects(bbox, &condition->range);
+    else if (condition->subject == QUERY_WITHIN)
+      match = bbox->min_x >= condition->range.min_x &&
+              bbox->min_y >= condition->range.min_y &&
+              bbox->max_x <= condition->range.max_x &&
+              bbox->max_y <= condition->range.max_y;
+  }
+  free_bbox(bbox);
+  return match;
+}
+
+void search_query_shapes(query_state_t *state, shape_node_t *shapes,
+                         affine_t *parent) {
+  if (state->depth == state->capacity) {
+    state->capacity =
+        (state->capacity == 0) ? QUERY_PATH_CAPACITY : state->capacity * 2;
+    state->path = realloc(state->path, sizeof(int) * state->capacity);
+  }
+  state->depth++;
+
+  int index = 0;
+  bool is_outside;
+  bbox_t *bbox;
+  shape_t *shape;
+  for (shape_node_t *node = shapes; node != NULL; node = node->next) {
+    shape = node->shape;
+    state->path[state->depth - 1] = index++;
+    if (is_query_match(state, shape, parent))
+      push_query_match(state->results, shape, state->path, state->depth);
+    if (shape->shape_variant != GROUP || is_instance(shape))
+      continue;
+    // The content of a group lies inside the group's bounding box.
+    if (state->query->is_spatial) {
+      bbox = compute_world_bbox(shape, parent);
+      is_outside = !bbox_intersects(bbox, &state->query->range);
+      free_bbox(bbox);
+      if (is_outside)
+        continue;
+    }
+    search_query_shapes(state, shape->shape->group,
+                        get_world_transform(shape, parent));
+  }
+  state->depth--;
+}
+
+query_results_t *query_shapes(shape_node_t *shapes, query_t *query,
+                              rtree_t *index) {
+  query_state_t state = {.query = query,
+                         .candidates = NULL,
+                         .path = NULL,
+                         .depth = 0,
+                         .capacity = 0,
+                         .results = new_query_results()};
+  if (query->is_spatial && index != NULL) {
+    state.candidates = rtree_search(index, &query->range);
+    if (state.candidates->count > 0)
+      qsort(state.candidates->shapes, state.candidates->count,
+            sizeof(shape_t *), compare_query_shapes);
+  }
+  search_query_shapes(&state, shapes, NULL);
+  free(state.path);
+  if (state.candidates != NULL)
+    free_rtree_results(state.candidates);
+  return state.results;
+}
+
+void format_query_path(query_match_t *match, char *buffer, size_t size) {
+  size_t length = 0;
+  buffer[0] = '\0';
+  for (int i = 0; i < match->depth && length < size; i++)
+    length += snprintf(buffer + length, size - length, (i == 0) ? "%d" : "/%d",
+                       match->path[i]);
+}
@@ -0,0 +1,245 @@
+#ifndef CODA_QUERY
+#define CODA_QUERY
+
+#include "../geometry/rtree.h"
+#include "../models/shapes/shape.h"
+#include "../models/styles/color.h"
+#include "../models/styles/style.h"
+#include "../models/utils/affine.h"
+#include "../models/utils/bbox.h"
+#include "script.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#define QUERY_CONDITION_COUNT 8
+#define QUERY_STYLE_CACHE_SIZE 64
+
+/**
+ * Lists what a query condition tests.
+ * - QUERY_TYPE : `type=<variant>`, the shape's variant named as in the files.
+ * - QUERY_FILL : `fill=<#rrggbbaa>`, the shape's fill color.
+ * - QUERY_OUTLINE : `outline=<#rrggbbaa>`, the shape's outline color.
+ * - QUERY_FIELD : `<x|y|width|height><op><value>`, as in the scripts.
+ * - QUERY_WITHIN : `bbox within (x1,y1,x2,y2)`, the shape's bounding box is
+ * inside the area.
+ * - QUERY_INTERSECTS : `bbox intersects (x1,y1,x2,y2)`, the shape's bounding
+ * box overlaps the area.
+ */
+typedef enum query_subject_e {
+  QUERY_TYPE,
+  QUERY_FILL,
+  QUERY_OUTLINE,
+  QUERY_FIELD,
+  QUERY_WITHIN,
+  QUERY_INTERSECTS
+} query_subject_t;
+
+/**
+ * Defines the query condition type.
+ * @param subject    what the condition tests.
+ * @param is_negated indicates if the condition was written with `!=`.
+ * @param variant    the tested variant.
+ * @param color      the tested color.
+ * @param field      the tested field's condition.
+ * @param range      the tested area, in the svg's coordinates system.
+ * @see query_subject_t.
+ */
+typedef struct query_condition_s {
+  query_subject_t subject;
+  bool is_negated;
+  shape_variants_t variant;
+  color_t color;
+  script_condition_t field;
+  bbox_t range;
+} query_condition_t;
+
+/**
+ * Defines the query type, the conditions a shape must all match, e.g.
+ * `type=ellipse and fill=#ff0000ff and bbox within (0,0,100,100)`.
+ * @param conditions the conditions.
+ * @param count      the number of conditions.
+ * @param is_spatial indicates if a condition tests the bounding boxes.
+ * @param range      the area all the matching shapes' bounding boxes
+ * intersect, i.e. the intersection of the spatial conditions' areas.
+ * @see query_condition_t.
+ */
+typedef struct query_s {
+  query_condition_t conditions[QUERY_CONDITION_COUNT];
+  int count;
+  bool is_spatial;
+  bbox_t range;
+} query_t;
+
+/**
+ * Defines the query match type.
+ * @param shape the matching shape.
+ * @param path  the shape's indexes from the svg down to the shape, as in the
+ * scripts' selections.
+ * @param depth the path's length.
+ */
+typedef struct query_match_s {
+  shape_t *shape;
+  int *path;
+  int depth;
+} query_match_t;
+
+/**
+ * Defines the query results type.
+ * @param matches  the matches, in the document's order.
+ * @param count    the number of matches.
+ * @param capacity the matches array's capacity.
+ * @param tested   the number of shapes the conditions were tested on.
+ * @see query_match_t.
+ */
+typedef struct query_results_s {
+  query_match_t *matches;
+  int count;
+  int capacity;
+  unsigned int tested;
+} query_results_t;
+
+/**
+ * Defines the query evaluation state.
+ * The shapes sharing a style, as clones do, are only tested once against the
+ * style conditions: the results are kept in a direct-mapped cache keyed by
+ * the styles' addresses.
+ * @param query         the evaluated query.
+ * @param candidates    the shapes of the spatial index intersecting the
+ * query's range sorted by address, NULL without index.
+ * @param styles        the style cache's keys.
+ * @param style_matches the style cache's results.
+ * @param path          the indexes of the visited shape.
+ * @param depth         the path's length.
+ * @param capacity      the path's capacity.
+ * @param results       the results to fill.
+ * @see query_t.
+ */
+typedef struct query_state_s {
+  query_t *query;
+  rtree_results_t *candidates;
+  style_t *styles[QUERY_STYLE_CACHE_SIZE];
+  bool style_matches[QUERY_STYLE_CACHE_SIZE];
+  int *path;
+  int depth;
+  int capacity;
+  query_results_t *results;
+} query_state_t;
+
+/**
+ * Reads a query's condition.
+ * @param cursor    a pointer to the query's remaining characters.
+ * @param condition the condition to set.
+ * @return returns true if the condition is valid.
+ * @see query_condition_t.
+ */
+bool parse_query_condition(char **cursor, query_condition_t *condition);
+
+/**
+ * Reads a query, i.e. conditions separated by `and`. An empty query matches
+ * all the shapes.
+ * @param text  the query's text.
+ * @param query the query to set.
+ * @return returns true if the query is valid.
+ * @see query_t.
+ */
+bool parse_query(char *text, query_t *query);
+
+/**
+ * Creates a new empty query results.
+ * Note that this function allocates memory.
+ * @return the new results' pointer.
+ * @see query_results_t.
+ */
+query_results_t *new_query_results();
+
+/**
+ * Appends a match to the given results.
+ * Note that this function allocates memory.
+ * @param results the results.
+ * @param shape   the matching shape.
+ * @param path    the shape's path, which is copied.
+ * @param depth   the path's length.
+ * @see query_match_t.
+ */
+void push_query_match(query_results_t *results, shape_t *shape, int *path,
+                      int depth);
+
+/**
+ * Destroys the given query results.
+ * Note that this function frees memory.
+ * Note that the shapes are not freed.
+ * @param results the results to destroy.
+ * @see query_results_t.
+ */
+void free_query_results(query_results_t *results);
+
+/**
+ * Compares two shape pointers by address.
+ * @param a the first shape pointer's pointer.
+ * @param b the second shape pointer's pointer.
+ * @return a negative value, 0 or a positive value as for qsort.
+ */
+int compare_query_shapes(const void *a, const void *b);
+
+/**
+ * Tests the given style against the query's style conditions, through the
+ * state's style cache.
+ * @param state  the evaluation state.
+ * @param styles the style.
+ * @return returns true if the style matches.
+ * @see query_state_t.
+ */
+bool is_query_style_match(query_state_t *state, style_t *styles);
+
+/**
+ * Tests the given shape against the query's conditions, the cheapest first.
+ * The spatial index, when there is one, rejects the shapes outside the query's
+ * range before their bounding box is computed.
+ * Note that this function may allocate memory.
+ * @param state  the evaluation state.
+ * @param shape  the shape.
+ * @param parent the world transformation of the group containing the shape, or
+ * NULL for the svg's shapes.
+ * @return returns true if the shape matches.
+ * @see query_state_t.
+ */
+bool is_query_match(query_state_t *state, shape_t *shape, affine_t *parent);
+
+/**
+ * Appends the matching shapes of the given linked list and of its groups to
+ * the state's results, in the document's order.
+ * The groups outside a spatial query's range are skipped with their content,
+ * and the content of the symbols' instances is never searched.
+ * Note that this function may allocate memory.
+ * @param state  the evaluation state.
+ * @param shapes the linked list.
+ * @param parent the world transformation of the group containing the list, or
+ * NULL for the svg's shapes.
+ * @see query_state_t.
+ */
+void search_query_shapes(query_state_t *state, shape_node_t *shapes,
+                         affine_t *parent);
+
+/**
+ * Searches the shapes of the given linked list matching the given query.
+ * Note that this function allocates memory.
+ * @param shapes the svg's shapes.
+ * @param query  the query.
+ * @param index  the spatial index of the shapes, or NULL.
+ * @return the results' pointer.
+ * @see query_results_t.
+ * @see search_query_shapes.
+ */
+query_results_t *query_shapes(shape_node_t *shapes, query_t *query,
+                              rtree_t *index);
+
+/**
+ * Writes the given match's path, e.g. `3/2`.
+ * @param match  the match.
+ * @param buffer the buffer to write to.
+ * @param size   the buffer's size.
+ * @see query_match_t.
+ */
+void format_query_path(query_match_t *match, char *buffer, size_t size);
+
+#endif
@@ -0,0 +1,470 @@
+#include "script.h"
+#include "../geometry/bounds.h"
+#include "../geometry/transform.h"
+#include "../hash/hash.h"
+#include "../models/shapes/symbol.h"
+#include "../models/styles/style.h"
+#include "../serde/deserialize/parser.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SCRIPT_STATEMENT_BUFFER_SIZE 500
+#define SCRIPT_ERROR_BUFFER_SIZE 600
+#define SCRIPT_OPERATOR_CHARS "<>=!"
+
+bool next_script_token(char **cursor, char *token) {
+  char *c = *cursor;
+  int length = 0;
+  while (*c != '\0' && is_whitespace(*c))
+    c++;
+  if (*c == '\0') {
+    *cursor = c;
+    return false;
+  }
+
+  if (*c == '/')
+    token[length++] = *c++;
+  else if (strchr(SCRIPT_OPERATOR_CHARS, *c) != NULL)
+    while (*c != '\0' && strchr(SCRIPT_OPERATOR_CHARS, *c) != NULL &&
+           length < SCRIPT_TOKEN_BUFFER_SIZE - 1)
+      token[length++] = *c++;
+  else
+    while (*c != '\0' && !is_whitespace(*c) && *c != '/' &&
+           strchr(SCRIPT_OPERATOR_CHARS, *c) == NULL &&
+           length < SCRIPT_TOKEN_BUFFER_SIZE - 1)
+      token[length++] = *c++;
+  token[length] = '\0';
+  *cursor = c;
+  return true;
+}
+
+bool parse_script_int(char *token, int *value) {
+  char *end;
+  long n = strtol(token, &end, 10);
+  if (end == token || *end != '\0')
+    return false;
+  *value = (int)n;
+  return true;
+}
+
+bool parse_script_color(char *token, color_t *color) {
+  if (strlen(token) != 9 || token[0] != '#')
+    return false;
+  for (int i = 1; i < 9; i++)
+    if (!is_char_hexa(token[i]))
+      return false;
+  color->red = 16 * hexa_to_int(token[1]) + hexa_to_int(token[2]);
+  color->green = 16 * hexa_to_int(token[3]) + hexa_to_int(token[4]);
+  color->blue = 16 * hexa_to_int(token[5]) + hexa_to_int(token[6]);
+  color->transparent = 16 * hexa_to_int(token[7]) + hexa_to_int(token[8]);
+  return true;
+}
+
+bool parse_script_field(char *token, script_field_t *field) {
+  if (strcmp(token, "x") == 0)
+    *field = SCRIPT_X;
+  else if (strcmp(token, "y") == 0)
+    *field = SCRIPT_Y;
+  else if (strcmp(token, "width") == 0)
+    *field = SCRIPT_WIDTH;
+  else if (strcmp(token, "height") == 0)
+    *field = SCRIPT_HEIGHT;
+  else
+    return false;
+  return true;
+}
+
+bool parse_script_operator(char *token, script_operator_t *operator) {
+  if (strcmp(token, "<") == 0)
+    *operator = SCRIPT_LESS;
+  else if (strcmp(token, "<=") == 0)
+    *operator = SCRIPT_LESS_EQUAL;
+  else if (strcmp(token, ">") == 0)
+    *operator = SCRIPT_GREATER;
+  else if (strcmp(token, ">=") == 0)
+    *operator = SCRIPT_GREATER_EQUAL;
+  else if (strcmp(token, "=") == 0 || strcmp(token, "==") == 0)
+    *operator = SCRIPT_EQUAL;
+  else if (strcmp(token, "!=") == 0)
+    *operator = SCRIPT_NOT_EQUAL;
+  else
+    return false;
+  return true;
+}
+
+bool parse_script_selection(char **cursor, script_selection_t *selection) {
+  char token[SCRIPT_TOKEN_BUFFER_SIZE];
+  selection->is_set = true;
+  selection->any = true;
+  selection->depth = 0;
+  if (!next_script_token(cursor, token))
+    return true;
+
+  // The variants are named as in the svg files.
+  shape_t shape;
+  bool is_variant = strcmp(token, "all") == 0;
+  for (int v = ELLIPSE; v <= GROUP && !is_variant; v++) {
+    shape.shape_variant = v;
+    if (strcmp(token, get_shape_name(&shape)) == 0) {
+      selection->any = false;
+      selection->variant = v;
+      is_variant = true;
+    }
+  }
+  if (is_variant && !next_script_token(cursor, token))
+    return true;
+
+  int index;
+  while (true) {
+    if (selection->depth == SCRIPT_PATH_SIZE)
+      return false;
+    if (strcmp(token, "*") == 0)
+      selection->path[selection->depth++] = -1;
+    else if (parse_script_int(token, &index) && index >= 0)
+      selection->path[selection->depth++] = index;
+    else
+      return false;
+    if (!next_script_token(cursor, token))
+      return true;
+    if (strcmp(token, "/") != 0 || !next_script_token(cursor, token))
+      return false;
+  }
+}
+
+bool parse_script_conditions(char **cursor, script_statement_t *statement) {
+  char token[SCRIPT_TOKEN_BUFFER_SIZE];
+  script_condition_t *condition;
+  statement->condition_count = 0;
+  if (!next_script_token(cursor, token))
+    return true;
+  if (strcmp(token, "where") != 0)
+    return false;
+
+  do {
+    if (statement->condition_count == SCRIPT_CONDITION_COUNT)
+      return false;
+    condition = &statement->conditions[statement->condition_count++];
+    if (!next_script_token(cursor, token) ||
+        !parse_script_field(token, &condition->field) ||
+        !next_script_token(cursor, token))
+      return false;
+    if (!parse_script_operator(token, &condition->operator) ||
+        !next_script_token(cursor, token) ||
+        !parse_script_int(token, &condition->value))
+      return false;
+    if (!next_script_token(cursor, token))
+      return true;
+  } while (strcmp(token, "and") == 0);
+  return false;
+}
+
+bool parse_script_statement(char *keyword, char **cursor,
+                            script_statement_t *statement) {
+  char property[SCRIPT_TOKEN_BUFFER_SIZE], token[SCRIPT_TOKEN_BUFFER_SIZE];
+  if (strcmp(keyword, "translate") == 0) {
+    statement->action = SCRIPT_TRANSLATE;
+    if (!next_script_token(cursor, token) ||
+        !parse_script_int(token, &statement->x) ||
+        !next_script_token(cursor, token) ||
+        !parse_script_int(token, &statement->y))
+      return false;
+  } else if (strcmp(keyword, "delete") == 0)
+    statement->action = SCRIPT_DELETE;
+  else if (strcmp(keyword, "set") == 0) {
+    if (!next_script_token(cursor, property))
+      return false;
+    if (strcmp(property, "fill") == 0 || strcmp(property, "outline") == 0) {
+      statement->action =
+          (property[0] == 'f') ? SCRIPT_SET_FILL : SCRIPT_SET_OUTLINE;
+      if (!next_script_token(cursor, token) ||
+          !parse_script_color(token, &statement->color))
+        return false;
+    } else if (strcmp(property, "rotate") == 0) {
+      statement->action = SCRIPT_SET_ROTATE;
+      if (!next_script_token(cursor, token))
+        return false;
+      if (strcmp(token, "x") == 0)
+        statement->rotate = FLIP_X;
+      else if (strcmp(token, "y") == 0)
+        statement->rotate = FLIP_Y;
+      else if (parse_script_int(token, &statement->x))
+        statement->rotate = CIRCULAR;
+      else
+        return false;
+    } else if (strcmp(property, "translate") == 0) {
+      statement->action = SCRIPT_SET_TRANSLATE;
+      if (!next_script_token(cursor, token) ||
+          !parse_script_int(token, &statement->x) ||
+          !next_script_token(cursor, token) ||
+          !parse_script_int(token, &statement->y))
+        return false;
+    } else if (parse_script_field(property, &statement->field)) {
+      statement->action = SCRIPT_SET_FIELD;
+      if (!next_script_token(cursor, token) ||
+          !parse_script_int(token, &statement->x))
+        return false;
+    } else
+      return false;
+  } else
+    return false;
+  return parse_script_conditions(cursor, statement);
+}
+
+int *get_script_field(shape_t *shape, script_field_t field) {
+  ellipse_t *ellipse = shape->shape->ellipse;
+  rectangle_t *rectangle = shape->shape->rectangle;
+  switch (shape->shape_variant) {
+  case ELLIPSE:
+    switch (field) {
+    case SCRIPT_X:
+      return &ellipse->center_x;
+    case SCRIPT_Y:
+      return &ellipse->center_y;
+    case SCRIPT_WIDTH:
+      return &ellipse->radius_x;
+    case SCRIPT_HEIGHT:
+      return &ellipse->radius_y;
+    }
+    break;
+  case RECTANGLE:
+    switch (field) {
+    case SCRIPT_X:
+      return &rectangle->x;
+    case SCRIPT_Y:
+      return &rectangle->y;
+    case SCRIPT_WIDTH:
+      return &rectangle->width;
+    case SCRIPT_HEIGHT:
+      return &rectangle->height;
+    }
+    break;
+  default:
+    break;
+  }
+  return NULL;
+}
+
+bool compare_script_values(int value, script_operator_t operator, int other) {
+  switch (operator) {
+  case SCRIPT_LESS:
+    return value < other;
+  case SCRIPT_LESS_EQUAL:
+    return value <= other;
+  case SCRIPT_GREATER:
+    return value > other;
+  case SCRIPT_GREATER_EQUAL:
+    return value >= other;
+  case SCRIPT_EQUAL:
+    return value == other;
+  case SCRIPT_NOT_EQUAL:
+    return value != other;
+  }
+  return false;
+}
+
+bool is_script_match(shape_t *shape, script_statement_t *statement) {
+  script_condition_t *condition;
+  int *value;
+  for (int i = 0; i < statement->condition_count; i++) {
+    condition = &statement->conditions[i];
+    value = get_script_field(shape, condition->field);
+    if (value == NULL ||
+        !compare_script_values(*value, condition->operator, condition->value))
+      return false;
+  }
+  return true;
+}
+
+bool is_script_target(shape_t *shape, script_selection_t *selection,
+                      script_statement_t *statement) {
+  return (selection->any || shape->shape_variant == selection->variant) &&
+         is_script_match(shape, statement) &&
+         (statement->action != SCRIPT_SET_FIELD ||
+          get_script_field(shape, statement->field) != NULL);
+}
+
+void locate_script_selection(script_selection_t *selection, int level,
+                             int index, bool *is_target, bool *is_parent) {
+  *is_target = true;
+  *is_parent = true;
+  if (selection->depth == 0)
+    return;
+  bool on_path =
+      selection->path[level] == -1 || selection->path[level] == index;
+  *is_target = on_path && level == selection->depth - 1;
+  *is_parent = on_path && level < selection->depth - 1;
+}
+
+bool has_script_targets(shape_node_t *shapes, script_selection_t *selection,
+                        int level, script_statement_t *statement) {
+  bool is_target, is_parent;
+  int index = 0;
+  for (shape_node_t *node = shapes; node != NULL; node = node->next, index++) {
+    locate_script_selection(selection, level, index, &is_target, &is_parent);
+    if (is_target && is_script_target(node->shape, selection, statement))
+      return true;
+    if (is_parent && node->shape->shape_variant == GROUP &&
+        !is_instance(node->shape) &&
+        has_script_targets(node->shape->shape->group, selection, level + 1,
+                           statement))
+      return true;
+  }
+  return false;
+}
+
+bool apply_script_statement(shape_node_t *node, script_statement_t *statement) {
+  if (statement->action == SCRIPT_DELETE ||
+      (statement->action == SCRIPT_SET_FIELD &&
+       get_script_field(node->shape, statement->field) == NULL))
+    return false;
+
+  shape_t *shape = unshare_shape(&node->shape);
+  style_t *styles =
+      (statement->action != SCRIPT_SET_FIELD) ? unshare_style(&shape->styles)
+                                              : shape->styles;
+  switch (statement->action) {
+  case SCRIPT_TRANSLATE:
+    styles->translate->x += statement->x;
+    styles->translate->y += statement->y;
+    break;
+  case SCRIPT_SET_FILL:
+    *styles->fill = statement->color;
+    break;
+  case SCRIPT_SET_OUTLINE:
+    *styles->outline = statement->color;
+    break;
+  case SCRIPT_SET_ROTATE:
+    free_rotate(styles->rotate);
+    if (statement->rotate == FLIP_X)
+      styles->rotate = new_flipx();
+    else if (statement->rotate == FLIP_Y)
+      styles->rotate = new_flipy();
+    else
+      styles->rotate = new_circular(statement->x);
+    break;
+  case SCRIPT_SET_TRANSLATE:
+    styles->translate->x = statement->x;
+    styles->translate->y = statement->y;
+    break;
+  case SCRIPT_SET_FIELD:
+    *get_script_field(shape, statement->field) = statement->x;
+    break;
+  case SCRIPT_DELETE:
+    break;
+  }
+  invalidate_shape_bbox(shape);
+  invalidate_shape_transform(shape);
+  invalidate_shape_hash(shape);
+  return true;
+}
+
+bool run_script_statement(shape_node_t **shapes, script_selection_t *selection,
+                          int level, script_statement_t *statement,
+                          script_report_t *report) {
+  bool changed = false, is_target, is_parent;
+  shape_node_t *node = *shapes, *next;
+  for (int index = 0; node != NULL; node = next, index++) {
+    next = node->next;
+    locate_script_selection(selection, level, index, &is_target, &is_parent);
+
+    if (is_target && is_script_target(node->shape, selection, statement)) {
+      if (statement->action == SCRIPT_DELETE) {
+        if (node->previous != NULL)
+          node->previous->next = node->next;
+        else
+          *shapes = node->next;
+        if (node->next != NULL)
+          node->next->previous = node->previous;
+        free_shape(node->shape);
+        free(node);
+        report->deleted++;
+        changed = true;
+        continue;
+      }
+      if (apply_script_statement(node, statement)) {
+        report->edited++;
+        changed = true;
+      }
+    }
+
+    // The content of an instance belongs to its symbol.
+    if (!is_parent || node->shape->shape_variant != GROUP ||
+        is_instance(node->shape))
+      continue;
+    // A shared group's shapes are also its other owners' shapes, it is only
+    // copied when some of them are about to change.
+    if (node->shape->references > 1 &&
+        !has_script_targets(node->shape->shape->group, selection, level + 1,
+                            statement))
+      continue;
+    shape_t *group = unshare_shape(&node->shape);
+    if (run_script_statement(&group->shape->group, selection, level + 1,
+                             statement, report)) {
+      invalidate_shape_bbox(group);
+      invalidate_shape_hash(group);
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+bool run_script_line(svg_t *svg, char *statement,
+                     script_selection_t *selection, script_report_t *report) {
+  char token[SCRIPT_TOKEN_BUFFER_SIZE];
+  char *cursor = statement;
+  script_statement_t action;
+  if (!next_script_token(&cursor, token))
+    return true;
+  if (strcmp(token, "select") == 0)
+    return parse_script_selection(&cursor, selection);
+  if (!selection->is_set || !parse_script_statement(token, &cursor, &action))
+    return false;
+  run_script_statement(&svg->shapes, selection, 0, &action, report);
+  report->statements++;
+  return true;
+}
+
+bool run_script(svg_t *svg, serdelizer_t *serdelizer, script_report_t *report) {
+  char buffer[SCRIPT_STATEMENT_BUFFER_SIZE];
+  char error[SCRIPT_ERROR_BUFFER_SIZE];
+  script_selection_t selection = {.is_set = false};
+  int length = 0, line = serdelizer->line, position = serdelizer->position;
+  bool is_comment = false, is_too_long = false;
+  char c;
+  report->statements = 0;
+  report->edited = 0;
+  report->deleted = 0;
+  do {
+    c = get_next_char(serdelizer);
+    if (c != EOF && c != ';' && c != '\n') {
+      if (length == SCRIPT_STATEMENT_BUFFER_SIZE - 1)
+        is_too_long = true;
+      else
+        buffer[length++] = c;
+      // A statement starting with two slashes comments out the line.
+      buffer[length] = '\0';
+      if (c == '/' && strncmp(buffer + strspn(buffer, " \t\r"), "//", 2) == 0)
+        is_comment = true;
+      continue;
+    }
+    if (c == ';' && is_comment)
+      continue;
+
+    buffer[length] = '\0';
+    if (!is_comment &&
+        (is_too_long || !run_script_line(svg, buffer, &selection, report))) {
+      // Points the error at the statement's start, not past its end.
+      serdelizer->line = line;
+      serdelizer->position = position;
+      sprintf(error, "Invalid statement: %s", buffer);
+      print_serdelizer_error("run_script", error, serdelizer);
+      return false;
+    }
+    length = 0;
+    line = serdelizer->line;
+    position = serdelizer->position;
+    is_comment = false;
+  } while (c != EOF);
+  return true;
+}
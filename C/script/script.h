@@ -0,0 +1,338 @@
+#ifndef CODA_SCRIPT
+#define CODA_SCRIPT
+
+#include "../models/shapes/shape.h"
+#include "../models/shapes/svg.h"
+#include "../models/styles/color.h"
+#include "../models/styles/rotate.h"
+#include "../serde/serde.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#define SCRIPT_PATH_SIZE 16
+#define SCRIPT_CONDITION_COUNT 8
+#define SCRIPT_TOKEN_BUFFER_SIZE 64
+
+/**
+ * Lists the shape fields a script can test and set.
+ * The fields are the rectangles' coordinates and sizes, and the ellipses'
+ * center and radiuses, the other shapes have none.
+ * - SCRIPT_X : the rectangle's x or the ellipse's center x.
+ * - SCRIPT_Y : the rectangle's y or the ellipse's center y.
+ * - SCRIPT_WIDTH : the rectangle's width or the ellipse's radius x.
+ * - SCRIPT_HEIGHT : the rectangle's height or the ellipse's radius y.
+ */
+typedef enum script_field_e {
+  SCRIPT_X,
+  SCRIPT_Y,
+  SCRIPT_WIDTH,
+  SCRIPT_HEIGHT
+} script_field_t;
+
+/**
+ * Lists the comparison operators of a script condition.
+ */
+typedef enum script_operator_e {
+  SCRIPT_LESS,
+  SCRIPT_LESS_EQUAL,
+  SCRIPT_GREATER,
+  SCRIPT_GREATER_EQUAL,
+  SCRIPT_EQUAL,
+  SCRIPT_NOT_EQUAL
+} script_operator_t;
+
+/**
+ * Defines the script condition type, e.g. `width<2`.
+ * @param field    the tested field.
+ * @param operator the comparison operator.
+ * @param value    the value the field is compared with.
+ * @see script_field_t.
+ * @see script_operator_t.
+ */
+typedef struct script_condition_s {
+  script_field_t field;
+  script_operator_t operator;
+  int value;
+} script_condition_t;
+
+/**
+ * Defines the script selection type, the shapes the statements apply to.
+ * A path lists the shapes' indexes from the svg down to the selected shapes,
+ * e.g. `3/2` is the third shape of the svg's fourth shape, `*` standing for
+ * all the shapes of a level. Without a path, the shapes of every level are
+ * selected, the content of the symbols' instances excepted.
+ * @param is_set indicates if a selection was made.
+ * @param any    indicates if the shapes of any variant are selected.
+ * @param variant the selected shapes' variant when any is false.
+ * @param path   the shapes' indexes at each level, -1 for all the shapes.
+ * @param depth  the path's length, 0 for every level.
+ * @see shape_variants_t.
+ */
+typedef struct script_selection_s {
+  bool is_set;
+  bool any;
+  shape_variants_t variant;
+  int path[SCRIPT_PATH_SIZE];
+  int depth;
+} script_selection_t;
+
+/**
+ * Lists the script actions.
+ * - SCRIPT_TRANSLATE : `translate <dx> <dy>`, moves the shapes.
+ * - SCRIPT_SET_FILL : `set fill <#rrggbbaa>`.
+ * - SCRIPT_SET_OUTLINE : `set outline <#rrggbbaa>`.
+ * - SCRIPT_SET_ROTATE : `set rotate <degrees|x|y>`.
+ * - SCRIPT_SET_TRANSLATE : `set translate <x> <y>`.
+ * - SCRIPT_SET_FIELD : `set <x|y|width|height> <value>`.
+ * - SCRIPT_DELETE : `delete`, removes the shapes.
+ */
+typedef enum script_action_e {
+  SCRIPT_TRANSLATE,
+  SCRIPT_SET_FILL,
+  SCRIPT_SET_OUTLINE,
+  SCRIPT_SET_ROTATE,
+  SCRIPT_SET_TRANSLATE,
+  SCRIPT_SET_FIELD,
+  SCRIPT_DELETE
+} script_action_t;
+
+/**
+ * Defines the script statement type, an action applied to the selected shapes
+ * which match all its conditions, e.g. `delete where width<2 and height<2`.
+ * @param action          the action.
+ * @param x               the action's first value.
+ * @param y               the action's second value.
+ * @param field           the field set by the action.
+ * @param color           the color set by the action.
+ * @param rotate          the rotation variant set by the action.
+ * @param conditions      the conditions.
+ * @param condition_count the number of conditions.
+ * @see script_action_t.
+ * @see script_condition_t.
+ */
+typedef struct script_statement_s {
+  script_action_t action;
+  int x;
+  int y;
+  script_field_t field;
+  color_t color;
+  rotation_variants_t rotate;
+  script_condition_t conditions[SCRIPT_CONDITION_COUNT];
+  int condition_count;
+} script_statement_t;
+
+/**
+ * Defines the script report type.
+ * @param statements the number of executed statements.
+ * @param edited     the number of edited shapes.
+ * @param deleted    the number of deleted shapes.
+ */
+typedef struct script_report_s {
+  unsigned int statements;
+  unsigned int edited;
+  unsigned int deleted;
+} script_report_t;
+
+/**
+ * Reads the next token of the given statement.
+ * The tokens are the runs of comparison characters, the slashes and the runs
+ * of other non whitespace characters.
+ * @param cursor a pointer to the statement's remaining characters, moved past
+ * the token.
+ * @param token  the buffer to set, of SCRIPT_TOKEN_BUFFER_SIZE characters.
+ * @return returns false if there is no token left.
+ */
+bool next_script_token(char **cursor, char *token);
+
+/**
+ * Reads a script integer, with an optional sign.
+ * @param token the token.
+ * @param value a pointer to the integer to set.
+ * @return returns true if the token is an integer.
+ */
+bool parse_script_int(char *token, int *value);
+
+/**
+ * Reads a script color, i.e. `#rrggbbaa`.
+ * @param token the token.
+ * @param color a pointer to the color to set.
+ * @return returns true if the token is a color.
+ * @see color_t.
+ */
+bool parse_script_color(char *token, color_t *color);
+
+/**
+ * Reads a script field name.
+ * @param token the token.
+ * @param field a pointer to the field to set.
+ * @return returns true if the token is a field.
+ * @see script_field_t.
+ */
+bool parse_script_field(char *token, script_field_t *field);
+
+/**
+ * Reads a script comparison operator, i.e. `<`, `<=`, `>`, `>=`, `=` or `!=`.
+ * @param token    the token.
+ * @param operator a pointer to the operator to set.
+ * @return returns true if the token is an operator.
+ * @see script_operator_t.
+ */
+bool parse_script_operator(char *token, script_operator_t *operator);
+
+/**
+ * Reads a `select [variant|all] [path]` statement's arguments.
+ * @param cursor    a pointer to the statement's remaining characters.
+ * @param selection the selection to set.
+ * @return returns true if the arguments are valid.
+ * @see script_selection_t.
+ */
+bool parse_script_selection(char **cursor, script_selection_t *selection);
+
+/**
+ * Reads a `where <condition> [and <condition>...]` clause.
+ * @param cursor    a pointer to the statement's remaining characters.
+ * @param statement the statement whose conditions are set.
+ * @return returns true if the clause is valid or absent.
+ * @see script_condition_t.
+ */
+bool parse_script_conditions(char **cursor, script_statement_t *statement);
+
+/**
+ * Reads an action statement, i.e. translate, set or delete.
+ * @param keyword   the statement's first token.
+ * @param cursor    a pointer to the statement's remaining characters.
+ * @param statement the statement to set.
+ * @return returns true if the statement is valid.
+ * @see script_statement_t.
+ */
+bool parse_script_statement(char *keyword, char **cursor,
+                            script_statement_t *statement);
+
+/**
+ * Reads the given shape's field.
+ * @param shape the shape.
+ * @param field the field.
+ * @return a pointer to the field's value, NULL if the shape has no such field.
+ * @see script_field_t.
+ */
+int *get_script_field(shape_t *shape, script_field_t field);
+
+/**
+ * Compares two values with the given operator.
+ * @param value    the left-hand value.
+ * @param operator the operator.
+ * @param other    the right-hand value.
+ * @return returns true if the comparison holds.
+ * @see script_operator_t.
+ */
+bool compare_script_values(int value, script_operator_t operator, int other);
+
+/**
+ * Tests if the given shape matches all the given statement's conditions.
+ * @param shape     the shape.
+ * @param statement the statement.
+ * @return returns true if the shape matches, a shape without a tested field
+ * never matches.
+ * @see script_condition_t.
+ */
+bool is_script_match(shape_t *shape, script_statement_t *statement);
+
+/**
+ * Tests if the given statement applies to the given shape, i.e. the shape
+ * has the selected variant, matches the statement's conditions and has the
+ * field set by the statement, if any.
+ * @param shape     the shape.
+ * @param selection the selection.
+ * @param statement the statement.
+ * @return returns true if the statement edits or deletes the shape.
+ * @see is_script_match.
+ */
+bool is_script_target(shape_t *shape, script_selection_t *selection,
+                      script_statement_t *statement);
+
+/**
+ * Locates the shape at the given index of a linked list at the given level
+ * in the selection's path.
+ * @param selection the selection.
+ * @param level     the linked list's level in the selection's path.
+ * @param index     the shape's index in the linked list.
+ * @param is_target a pointer set to true if the shape can be selected.
+ * @param is_parent a pointer set to true if the shapes of the shape, a group,
+ * can be selected.
+ * @see script_selection_t.
+ */
+void locate_script_selection(script_selection_t *selection, int level,
+                             int index, bool *is_target, bool *is_parent);
+
+/**
+ * Tests if the given statement edits or deletes some of the selected shapes
+ * of the given linked list or of its groups, without changing them.
+ * @param shapes    the linked list.
+ * @param selection the selection.
+ * @param level     the linked list's level in the selection's path.
+ * @param statement the statement.
+ * @return returns true if a shape would be edited or deleted.
+ * @see is_script_target.
+ */
+bool has_script_targets(shape_node_t *shapes, script_selection_t *selection,
+                        int level, script_statement_t *statement);
+
+/**
+ * Applies the given statement to the shape of the given node.
+ * The shape is unshared first then its cached bounding box, transformation
+ * and hash are invalidated.
+ * @param node      the shape's node.
+ * @param statement the statement, which is not a deletion.
+ * @return returns true if the shape was edited.
+ * @see script_statement_t.
+ */
+bool apply_script_statement(shape_node_t *node, script_statement_t *statement);
+
+/**
+ * Applies the given statement to the selected shapes of the given linked
+ * list in one pass, then to the selected shapes of its groups.
+ * The groups holding an edited shape are unshared and their cached bounding
+ * box and hash are invalidated. The shared groups holding no edited shape are
+ * left shared.
+ * @param shapes    a pointer to the linked list's first node, which changes
+ * when it is deleted.
+ * @param selection the selection.
+ * @param level     the linked list's level in the selection's path.
+ * @param statement the statement.
+ * @param report    the report to update.
+ * @return returns true if a shape was edited or deleted.
+ * @see script_selection_t.
+ */
+bool run_script_statement(shape_node_t **shapes, script_selection_t *selection,
+                          int level, script_statement_t *statement,
+                          script_report_t *report);
+
+/**
+ * Executes the given statement, either a selection or an action on the
+ * selected shapes.
+ * @param svg       the svg to edit.
+ * @param statement the statement's text.
+ * @param selection the current selection, updated by a selection statement.
+ * @param report    the report to update.
+ * @return returns true if the statement is valid.
+ * @see run_script_statement.
+ */
+bool run_script_line(svg_t *svg, char *statement,
+                     script_selection_t *selection, script_report_t *report);
+
+/**
+ * Runs the script read from the given serdelizer against the given svg.
+ * The statements are separated by semicolons or new lines, the lines starting
+ * with `//` are ignored. Each statement is executed once read, so the svg
+ * keeps the edits made before an invalid statement, which stops the script.
+ * Note that this function allocates and frees memory.
+ * @param svg        the svg to edit, which must not be shared.
+ * @param serdelizer the script's file accessor.
+ * @param report     the report to set.
+ * @return returns true if all the statements were valid.
+ * @see unshare_svg.
+ * @see script_report_t.
+ */
+bool run_script(svg_t *svg, serdelizer_t *serdelizer, script_report_t *report);
+
+#endif
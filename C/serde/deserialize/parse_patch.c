@@ -0,0 +1,470 @@
+#include "parse_patch.h"
+#include "../../diff/diff.h"
+#include "../../models/shapes/shape.h"
+#include "../../models/shapes/svg.h"
+#include "../../models/shapes/symbol.h"
+#include "../../models/styles/style.h"
+#include "../../models/utils/point.h"
+#include "../serde.h"
+#include "parse_shape.h"
+#include "parse_style.h"
+#include "parser.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define ERROR_MESSAGE_BUFFER_SIZE 500
+
+point_patch_t *parse_point_patch(serdelizer_t *serdelizer) {
+  if (!consume_pattern(serdelizer, "oints")) {
+    print_serdelizer_error("parse_point_patch", "Could not parse points",
+                           serdelizer);
+    return NULL;
+  }
+
+  char c;
+  char buffer[ERROR_MESSAGE_BUFFER_SIZE];
+  int index = 0, removed = 0;
+  bool is_index_set = false, is_count_set = false;
+  point_node_t *points = NULL;
+  int_parsing_result_t integer;
+
+  while ((c = get_next_non_whitespace_char(serdelizer)) != EOF) {
+    switch (c) {
+    case 'i':
+      integer = parse_int_parameter(serdelizer, "ndex");
+      if (!integer.success) {
+        print_serdelizer_error("parse_point_patch",
+                               "Could not parse 'index' parameter.",
+                               serdelizer);
+        free_point_nodes(points);
+        return NULL;
+      }
+      index = integer.value;
+      is_index_set = true;
+      break;
+
+    case 'c':
+      integer = parse_int_parameter(serdelizer, "ount");
+      if (!integer.success) {
+        print_serdelizer_error("parse_point_patch",
+                               "Could not parse 'count' parameter.",
+                               serdelizer);
+        free_point_nodes(points);
+        return NULL;
+      }
+      removed = integer.value;
+      is_count_set = true;
+      break;
+
+    case 'p':
+      free_point_nodes(points);
+      points = parse_points_parameter(serdelizer, "oints");
+      if (points == NULL) {
+        print_serdelizer_error("parse_point_patch",
+                               "Could not parse 'points' parameter.",
+                               serdelizer);
+        return NULL;
+      }
+      break;
+
+    case '/':
+      if (get_next_non_whitespace_char(serdelizer) != '>') {
+        sprintf(buffer, "Expected char '>' got char '%c'",
+                serdelizer->last_consumed);
+        print_serdelizer_error("parse_point_patch", buffer, serdelizer);
+        free_point_nodes(points);
+        return NULL;
+      }
+
+      if (!is_index_set) {
+        print_missing_parameter_error(serdelizer, "points", "index");
+        free_point_nodes(points);
+        return NULL;
+      }
+
+      if (!is_count_set) {
+        print_missing_parameter_error(serdelizer, "points", "count");
+        free_point_nodes(points);
+        return NULL;
+      }
+
+      point_patch_t *hunk = malloc(sizeof(point_patch_t));
+      hunk->previous = NULL;
+      hunk->index = index;
+      hunk->removed = removed;
+      hunk->points = points;
+      hunk->next = NULL;
+      return hunk;
+
+    default:
+      sprintf(buffer, "Could not parse points. Got unexpected char '%c'.",
+              serdelizer->last_consumed);
+      print_serdelizer_error("parse_point_patch", buffer, serdelizer);
+      free_point_nodes(points);
+      return NULL;
+    }
+  }
+
+  free_point_nodes(points);
+  return NULL;
+}
+
+patch_t *parse_remove_patch(serdelizer_t *serdelizer) {
+  if (!consume_pattern(serdelizer, "emove")) {
+    print_serdelizer_error("parse_remove_patch", "Could not parse remove",
+                           serdelizer);
+    return NULL;
+  }
+
+  char c;
+  char buffer[ERROR_MESSAGE_BUFFER_SIZE];
+  int index = 0, count = 0;
+  bool is_index_set = false, is_count_set = false;
+  int_parsing_result_t integer;
+
+  while ((c = get_next_non_whitespace_char(serdelizer)) != EOF) {
+    switch (c) {
+    case 'i':
+      integer = parse_int_parameter(serdelizer, "ndex");
+      if (!integer.success) {
+        print_serdelizer_error("parse_remove_patch",
+                               "Could not parse 'index' parameter.",
+                               serdelizer);
+        return NULL;
+      }
+      index = integer.value;
+      is_index_set = true;
+      break;
+
+    case 'c':
+      integer = parse_int_parameter(serdelizer, "ount");
+      if (!integer.success) {
+        print_serdelizer_error("parse_remove_patch",
+                               "Could not parse 'count' parameter.",
+                               serdelizer);
+        return NULL;
+      }
+      count = integer.value;
+      is_count_set = true;
+      break;
+
+    case '/':
+      if (get_next_non_whitespace_char(serdelizer) != '>') {
+        sprintf(buffer, "Expected char '>' got char '%c'",
+                serdelizer->last_consumed);
+        print_serdelizer_error("parse_remove_patch", buffer, serdelizer);
+        return NULL;
+      }
+
+      if (!is_index_set) {
+        print_missing_parameter_error(serdelizer, "remove", "index");
+        return NULL;
+      }
+
+      if (!is_count_set) {
+        print_missing_parameter_error(serdelizer, "remove", "count");
+        return NULL;
+      }
+
+      patch_t *operation = new_patch(PATCH_REMOVE, index);
+      operation->count = count;
+      return operation;
+
+    default:
+      sprintf(buffer, "Could not parse remove. Got unexpected char '%c'.",
+              serdelizer->last_consumed);
+      print_serdelizer_error("parse_remove_patch", buffer, serdelizer);
+      return NULL;
+    }
+  }
+
+  return NULL;
+}
+
+patch_t *parse_insert_patch(serdelizer_t *serdelizer,
+                            symbol_node_t *symbols) {
+  if (!consume_pattern(serdelizer, "nsert")) {
+    print_serdelizer_error("parse_insert_patch", "Could not parse insert",
+                           serdelizer);
+    return NULL;
+  }
+
+  char c;
+  char buffer[ERROR_MESSAGE_BUFFER_SIZE];
+  int index = 0;
+  bool is_index_set = false;
+  int_parsing_result_t integer;
+
+  // Parsing the header
+  while ((c = get_next_non_whitespace_char(serdelizer)) != EOF && c != '>') {
+    if (c != 'i') {
+      sprintf(buffer, "Could not parse insert. Got unexpected char '%c'.",
+              serdelizer->last_consumed);
+      print_serdelizer_error("parse_insert_patch", buffer, serdelizer);
+      return NULL;
+    }
+    integer = parse_int_parameter(serdelizer, "ndex");
+    if (!integer.success) {
+      print_serdelizer_error("parse_insert_patch",
+                             "Could not parse 'index' parameter.", serdelizer);
+      return NULL;
+    }
+    index = integer.value;
+    is_index_set = true;
+  }
+
+  if (!is_index_set) {
+    print_missing_parameter_error(serdelizer, "insert", "index");
+    return NULL;
+  }
+
+  patch_t *operation = new_patch(PATCH_INSERT, index);
+  shape_node_t *last = NULL;
+  style_t *style = new_default_style();
+  while ((c = get_next_non_whitespace_char(serdelizer)) != EOF) {
+    if (c != '<')
+      continue;
+    if (get_next_non_whitespace_char(serdelizer) == '/')
+      break;
+    shape_t *shape = parse_shape(serdelizer, style, symbols);
+    if (shape == NULL) {
+      print_serdelizer_error("parse_insert_patch",
+                             "Could not parse inserted shapes.", serdelizer);
+      free_style(style);
+      free_patch(operation);
+      return NULL;
+    }
+    append_shape_node(&operation->shapes, &last, shape);
+  }
+  free_style(style);
+
+  if (!consume_pattern(serdelizer, "insert>")) {
+    print_serdelizer_error("parse_insert_patch", "Could not parse insert",
+                           serdelizer);
+    free_patch(operation);
+    return NULL;
+  }
+  return operation;
+}
+
+patch_t *parse_modify_patch(serdelizer_t *serdelizer,
+                            symbol_node_t *symbols) {
+  if (!consume_pattern(serdelizer, "odify")) {
+    print_serdelizer_error("parse_modify_patch", "Could not parse modify",
+                           serdelizer);
+    return NULL;
+  }
+
+  char c;
+  char buffer[ERROR_MESSAGE_BUFFER_SIZE];
+  patch_t *operation = new_patch(PATCH_MODIFY, 0);
+  bool is_index_set = false, is_inline = false;
+  int_parsing_result_t integer;
+
+  // Parsing the header
+  while ((c = get_next_non_whitespace_char(serdelizer)) != EOF && c != '>') {
+    switch (c) {
+    case 'i':
+      integer = parse_int_parameter(serdelizer, "ndex");
+      if (!integer.success) {
+        print_serdelizer_error("parse_modify_patch",
+                               "Could not parse 'index' parameter.",
+                               serdelizer);
+        free_patch(operation);
+        return NULL;
+      }
+      operation->index = integer.value;
+      is_index_set = true;
+      break;
+
+    case '/':
+      is_inline = true;
+      break;
+
+    default:
+      if (operation->styles == NULL)
+        operation->styles = new_default_style();
+      if (!parse_styles(serdelizer, operation->styles, "modify")) {
+        free_patch(operation);
+        return NULL;
+      }
+      break;
+    }
+    if (is_inline)
+      break;
+  }
+
+  if (is_inline && get_next_non_whitespace_char(serdelizer) != '>') {
+    sprintf(buffer, "Expected char '>' got char '%c'",
+            serdelizer->last_consumed);
+    print_serdelizer_error("parse_modify_patch", buffer, serdelizer);
+    free_patch(operation);
+    return NULL;
+  }
+
+  if (!is_index_set) {
+    print_missing_parameter_error(serdelizer, "modify", "index");
+    free_patch(operation);
+    return NULL;
+  }
+
+  if (is_inline)
+    return operation;
+
+  point_patch_t *points_last = NULL;
+  patch_t *children_last = NULL;
+  while ((c = get_next_non_whitespace_char(serdelizer)) != EOF) {
+    if (c != '<')
+      continue;
+    c = get_next_non_whitespace_char(serdelizer);
+    if (c == '/')
+      break;
+
+    if (c == 'p') {
+      point_patch_t *hunk = parse_point_patch(serdelizer);
+      if (hunk == NULL) {
+        print_serdelizer_error("parse_modify_patch",
+                               "Could not parse modified points.", serdelizer);
+        free_patch(operation);
+        return NULL;
+      }
+      hunk->previous = points_last;
+      if (points_last == NULL)
+        operation->points = hunk;
+      else
+        points_last->next = hunk;
+      points_last = hunk;
+      continue;
+    }
+
+    patch_t *child = parse_patch_operation(serdelizer, symbols);
+    if (child == NULL) {
+      print_serdelizer_error("parse_modify_patch",
+                             "Could not parse modified shapes.", serdelizer);
+      free_patch(operation);
+      return NULL;
+    }
+    append_patch(&operation->children, &children_last, child);
+  }
+
+  if (!consume_pattern(serdelizer, "modify>")) {
+    print_serdelizer_error("parse_modify_patch", "Could not parse modify",
+                           serdelizer);
+    free_patch(operation);
+    return NULL;
+  }
+  return operation;
+}
+
+patch_t *parse_patch_operation(serdelizer_t *serdelizer,
+                               symbol_node_t *symbols) {
+  char buffer[ERROR_MESSAGE_BUFFER_SIZE];
+  switch (serdelizer->last_consumed) {
+  case 'r':
+    return parse_remove_patch(serdelizer);
+  case 'i':
+    return parse_insert_patch(serdelizer, symbols);
+  case 'm':
+    return parse_modify_patch(serdelizer, symbols);
+  default:
+    sprintf(buffer, "Char '%c' : Unknown patch operation",
+            serdelizer->last_consumed);
+    print_serdelizer_error("parse_patch_operation", buffer, serdelizer);
+    return NULL;
+  }
+}
+
+svg_patch_t *parse_svg_patch(serdelizer_t *serdelizer,
+                             symbol_node_t *symbols) {
+  char buffer[ERROR_MESSAGE_BUFFER_SIZE];
+  if (!consume_pattern(serdelizer, "<patch")) {
+    print_serdelizer_error("parse_svg_patch", "Could not parse patch",
+                           serdelizer);
+    return NULL;
+  }
+
+  svg_patch_t *patch = malloc(sizeof(svg_patch_t));
+  patch->viewport = NULL;
+  patch->symbols = NULL;
+  patch->clear_symbols = false;
+  patch->shapes = NULL;
+
+  char c = get_next_non_whitespace_char(serdelizer);
+  if (c == 'v') {
+    point_t *start = NULL, *end = NULL;
+    if (!consume_pattern(serdelizer, "iewport=\"") ||
+        (start = parse_point(serdelizer)) == NULL ||
+        (end = parse_point(serdelizer)) == NULL ||
+        (serdelizer->last_consumed != '"' &&
+         get_next_non_whitespace_char(serdelizer) != '"')) {
+      print_serdelizer_error("parse_svg_patch", "Could not parse viewport",
+                             serdelizer);
+      if (start != NULL)
+        free_point(start);
+      if (end != NULL)
+        free_point(end);
+      free_svg_patch(patch);
+      return NULL;
+    }
+    patch->viewport = new_viewport(start, end);
+    c = get_next_non_whitespace_char(serdelizer);
+  }
+  if (c == 's') {
+    if (!consume_pattern(serdelizer, "ymbols=\"none\"")) {
+      print_serdelizer_error("parse_svg_patch", "Could not parse symbols",
+                             serdelizer);
+      free_svg_patch(patch);
+      return NULL;
+    }
+    patch->clear_symbols = true;
+    c = get_next_non_whitespace_char(serdelizer);
+  }
+
+  if (c != '>') {
+    sprintf(buffer, "Expected char '>' got char '%c'",
+            serdelizer->last_consumed);
+    print_serdelizer_error("parse_svg_patch", buffer, serdelizer);
+    free_svg_patch(patch);
+    return NULL;
+  }
+
+  patch_t *last = NULL;
+  while (get_next_non_whitespace_char(serdelizer) != EOF) {
+    if (serdelizer->last_consumed != '<')
+      break;
+    if (get_next_non_whitespace_char(serdelizer) == '/')
+      break;
+    // The redefined symbols come first and replace the source svg's ones.
+    if (serdelizer->last_consumed == 's' && patch->shapes == NULL &&
+        !patch->clear_symbols) {
+      symbol_t *symbol = parse_symbol(serdelizer, patch->symbols);
+      if (symbol == NULL) {
+        print_serdelizer_error("parse_svg_patch", "Could not parse symbols",
+                               serdelizer);
+        free_svg_patch(patch);
+        return NULL;
+      }
+      patch->symbols = push_symbol_node(patch->symbols, symbol);
+      continue;
+    }
+    patch_t *operation = parse_patch_operation(
+        serdelizer, (patch->symbols != NULL || patch->clear_symbols)
+                        ? patch->symbols
+                        : symbols);
+    if (operation == NULL) {
+      print_serdelizer_error("parse_svg_patch", "Could not parse operations",
+                             serdelizer);
+      free_svg_patch(patch);
+      return NULL;
+    }
+    append_patch(&patch->shapes, &last, operation);
+  }
+
+  if (!consume_pattern(serdelizer, "patch>")) {
+    print_serdelizer_error("parse_svg_patch", "Could not parse patch",
+                           serdelizer);
+    free_svg_patch(patch);
+    return NULL;
+  }
+  return patch;
+}
@@ -0,0 +1,94 @@
+#ifndef CODA_PARSE_PATCH
+#define CODA_PARSE_PATCH
+
+#include "../../diff/diff.h"
+#include "../serde.h"
+
+/**
+ * Attempts to parse a point patch.
+ * Note that this function allocates memory.
+ * Note that this function expects that the last consumed char is 'p'. The
+ * function will consume the text pattern 'oints' before parsing the point
+ * patch content. If the parsing fails or if there is a missing parameter the
+ * function returns NULL.
+ * @param serdelizer the file accessor.
+ * @return the new point patch's pointer.
+ * @see point_patch_t.
+ * @see serdelizer_t.
+ */
+point_patch_t *parse_point_patch(serdelizer_t *serdelizer);
+
+/**
+ * Attempts to parse a removal.
+ * Note that this function allocates memory.
+ * Note that this function expects that the last consumed char is 'r'. The
+ * function will consume the text pattern 'emove' before parsing the removal
+ * content. If the parsing fails or if there is a missing parameter the
+ * function returns NULL.
+ * @param serdelizer the file accessor.
+ * @return the new operation's pointer.
+ * @see patch_t.
+ * @see serdelizer_t.
+ */
+patch_t *parse_remove_patch(serdelizer_t *serdelizer);
+
+/**
+ * Attempts to parse an insertion and its shapes.
+ * Note that this function allocates memory.
+ * Note that this function expects that the last consumed char is 'i'. The
+ * function will consume the text pattern 'nsert' before parsing the insertion
+ * content. If the parsing fails or if there is a missing parameter the
+ * function returns NULL.
+ * @param serdelizer the file accessor.
+ * @param symbols    the symbols the inserted shapes may instantiate.
+ * @return the new operation's pointer.
+ * @see patch_t.
+ * @see serdelizer_t.
+ */
+patch_t *parse_insert_patch(serdelizer_t *serdelizer, symbol_node_t *symbols);
+
+/**
+ * Attempts to parse a modification, its point patches and the operations on
+ * a group's shapes.
+ * Note that this function allocates memory.
+ * Note that this function expects that the last consumed char is 'm'. The
+ * function will consume the text pattern 'odify' before parsing the
+ * modification content. If the parsing fails or if there is a missing
+ * parameter the function returns NULL.
+ * @param serdelizer the file accessor.
+ * @param symbols    the symbols the inserted shapes may instantiate.
+ * @return the new operation's pointer.
+ * @see patch_t.
+ * @see serdelizer_t.
+ */
+patch_t *parse_modify_patch(serdelizer_t *serdelizer, symbol_node_t *symbols);
+
+/**
+ * Attempts to parse a shape patch operation, depending on the last consumed
+ * char.
+ * Note that this function allocates memory.
+ * @param serdelizer the file accessor.
+ * @param symbols    the symbols the inserted shapes may instantiate.
+ * @return the new operation's pointer, NULL if the parsing fails.
+ * @see patch_t.
+ * @see serdelizer_t.
+ */
+patch_t *parse_patch_operation(serdelizer_t *serdelizer,
+                               symbol_node_t *symbols);
+
+/**
+ * Attempts to parse an svg patch.
+ * Note that this function allocates memory.
+ * The inserted shapes instantiate the symbols redefined by the patch if any,
+ * the given symbols otherwise. A patch removing all the symbols, written
+ * with a symbols="none" attribute, redefines none.
+ * @param serdelizer the file accessor.
+ * @param symbols    the symbols of the svg the patch applies to.
+ * @return the new svg patch's pointer, NULL if the parsing fails.
+ * @see svg_patch_t.
+ * @see serdelizer_t.
+ */
+svg_patch_t *parse_svg_patch(serdelizer_t *serdelizer,
+                             symbol_node_t *symbols);
+
+#endif
@@ -1,4 +1,5 @@
 #include "parse_path.h"
+#include "../../instrument/instrument.h"
 #include "../../models/shapes/path/curve_to.h"
 #include "../../models/shapes/path/end_path.h"
 #include "../../models/shapes/path/line_to.h"
@@ -259,6 +260,7 @@ path_element_t *parse_path_element(serdelizer_t *serdelizer) {
 
 path_element_node_t *parse_path_elements(serdelizer_t *serdelizer) {
   path_element_node_t *path_elements = NULL;
+  path_element_node_t *last = NULL;
   path_element_t *element;
 
   if (!consume_pattern(serdelizer, "ata=\"")) {
@@ -267,19 +269,22 @@ path_element_node_t *parse_path_elements(serdelizer_t *serdelizer) {
     return false;
   }
 
+  INSTRUMENT_START(start);
   char c = get_next_non_whitespace_char(serdelizer);
   while (c != EOF) {
     switch (c) {
     case '"':
-      if (get_path_element_node_length(path_elements) == 0) {
+      if (path_elements == NULL) {
         print_serdelizer_error(
             "parse_path_elements",
             "Could not parse path elements. Must contain at least 1 element.",
             serdelizer);
         if (path_elements != NULL)
           free_path_element_nodes(path_elements);
+        INSTRUMENT_STOP(INSTRUMENT_PARSE_PATH_ELEMENTS, start);
         return NULL;
       }
+      INSTRUMENT_STOP(INSTRUMENT_PARSE_PATH_ELEMENTS, start);
       return path_elements;
       break;
     default:
@@ -289,9 +294,10 @@ path_element_node_t *parse_path_elements(serdelizer_t *serdelizer) {
                                "Could not parse path elements", serdelizer);
         if (path_elements != NULL)
           free_path_element_nodes(path_elements);
+        INSTRUMENT_STOP(INSTRUMENT_PARSE_PATH_ELEMENTS, start);
         return NULL;
       }
-      path_elements = push_path_element_node(path_elements, element);
+      append_path_element_node(&path_elements, &last, element);
       c = get_next_non_whitespace_char(serdelizer);
       break;
     }
@@ -301,5 +307,6 @@ path_element_node_t *parse_path_elements(serdelizer_t *serdelizer) {
                          serdelizer);
   if (path_elements != NULL)
     free_path_element_nodes(path_elements);
+  INSTRUMENT_STOP(INSTRUMENT_PARSE_PATH_ELEMENTS, start);
   return NULL;
 }
@@ -1,4 +1,5 @@
 #include "parse_shape.h"
+#include "../../instrument/instrument.h"
 #include "../../models/shapes/ellipse.h"
 #include "../../models/shapes/group.h"
 #include "../../models/shapes/line.h"
@@ -6,12 +7,14 @@
 #include "../../models/shapes/polygon.h"
 #include "../../models/shapes/rectangle.h"
 #include "../../models/shapes/shape.h"
+#include "../../models/shapes/symbol.h"
 #include "../../models/styles/style.h"
 #include "../serde.h"
 #include "parse_path.h"
 #include "parse_style.h"
 #include "parser.h"
 #include <stdio.h>
+#include <stdlib.h>
 
 #define ERROR_MESSAGE_BUFFER_SIZE 500
 
@@ -118,7 +121,7 @@ shape_t *parse_ellipse(serdelizer_t *serdelizer, style_t *inherited_styles) {
       break;
 
     default:
-      if (!parse_styles(serdelizer, style, "ellipse")) {
+      if (!parse_styles(serdelizer, unshare_style(&style), "ellipse")) {
         free_style(style);
         return NULL;
       }
@@ -234,7 +237,7 @@ shape_t *parse_rectangle(serdelizer_t *serdelizer, style_t *inherited_styles) {
       break;
 
     default:
-      if (!parse_styles(serdelizer, style, "rectangle")) {
+      if (!parse_styles(serdelizer, unshare_style(&style), "rectangle")) {
         free_style(style);
         return NULL;
       }
@@ -335,7 +338,7 @@ shape_t *parse_line(serdelizer_t *serdelizer, style_t *inherited_styles) {
       break;
 
     default:
-      if (parse_styles(serdelizer, style, "line"))
+      if (parse_styles(serdelizer, unshare_style(&style), "line"))
         break;
       sprintf(buffer, "Could not parse line. Got unexpected char '%c'.",
               serdelizer->last_consumed);
@@ -412,7 +415,7 @@ shape_t *parse_multiline(serdelizer_t *serdelizer, style_t *inherited_styles) {
       break;
 
     default:
-      if (!parse_styles(serdelizer, style, "multiline")) {
+      if (!parse_styles(serdelizer, unshare_style(&style), "multiline")) {
         if (points != NULL)
           free_point_nodes(points);
         free_style(style);
@@ -479,7 +482,7 @@ shape_t *parse_polygon(serdelizer_t *serdelizer, style_t *inherited_styles) {
       break;
 
     default:
-      if (!parse_styles(serdelizer, style, "polygon")) {
+      if (!parse_styles(serdelizer, unshare_style(&style), "polygon")) {
         if (points != NULL)
           free_point_nodes(points);
         free_style(style);
@@ -546,7 +549,7 @@ shape_t *parse_path(serdelizer_t *serdelizer, style_t *inherited_styles) {
       break;
 
     default:
-      if (!parse_styles(serdelizer, style, "polygon")) {
+      if (!parse_styles(serdelizer, unshare_style(&style), "polygon")) {
         if (path_elements != NULL)
           free_path_element_nodes(path_elements);
         free_style(style);
@@ -562,7 +565,8 @@ shape_t *parse_path(serdelizer_t *serdelizer, style_t *inherited_styles) {
   return NULL;
 }
 
-shape_t *parse_group(serdelizer_t *serdelizer, style_t *inherited_styles) {
+shape_t *parse_group(serdelizer_t *serdelizer, style_t *inherited_styles,
+                     symbol_node_t *symbols) {
   if (!consume_pattern(serdelizer, "roup")) {
     print_serdelizer_error("parse_group", "Could not parse group shape",
                            serdelizer);
@@ -578,7 +582,7 @@ shape_t *parse_group(serdelizer_t *serdelizer, style_t *inherited_styles) {
     case '>':
       break;
     default:
-      if (parse_styles(serdelizer, style, "polygon"))
+      if (parse_styles(serdelizer, unshare_style(&style), "polygon"))
         break;
       fprintf(stdout, "[INFO ERR] (%c)\n", serdelizer->last_consumed);
       print_serdelizer_error("parse_group", "Could not parse group header",
@@ -591,6 +595,7 @@ shape_t *parse_group(serdelizer_t *serdelizer, style_t *inherited_styles) {
   }
   shape_t *shape = NULL;
   shape_node_t *node = NULL;
+  shape_node_t *last = NULL;
 
   while ((c = get_next_non_whitespace_char(serdelizer)) != EOF) {
     if (c != '<')
@@ -598,9 +603,9 @@ shape_t *parse_group(serdelizer_t *serdelizer, style_t *inherited_styles) {
     c = get_next_non_whitespace_char(serdelizer);
     if (c == '/')
       break;
-    shape = parse_shape(serdelizer, style);
+    shape = parse_shape(serdelizer, style, symbols);
     if (shape != NULL)
-      node = push_shape_node(node, shape);
+      append_shape_node(&node, &last, shape);
     else {
       free_style(style);
       if (node != NULL)
@@ -622,35 +627,108 @@ shape_t *parse_group(serdelizer_t *serdelizer, style_t *inherited_styles) {
   return new_group(node, style);
 }
 
-shape_t *parse_shape(serdelizer_t *serdelizer, style_t *inherited_styles) {
+shape_t *parse_use(serdelizer_t *serdelizer, style_t *inherited_styles,
+                   symbol_node_t *symbols) {
+  if (!consume_pattern(serdelizer, "se")) {
+    print_serdelizer_error("parse_use", "Could not parse use shape",
+                           serdelizer);
+    return NULL;
+  }
+
+  char c;
   char buffer[ERROR_MESSAGE_BUFFER_SIZE];
+  char *id = NULL;
+  symbol_t *symbol = NULL;
+  style_t *style = clone_style(inherited_styles);
+
+  while ((c = get_next_non_whitespace_char(serdelizer)) != EOF) {
+    switch (c) {
+    case 's':
+      id = parse_string_parameter(serdelizer, "ymbol");
+      if (id == NULL) {
+        print_serdelizer_error(
+            "parse_use", "Could not parse 'symbol' parameter.", serdelizer);
+        free_style(style);
+        return NULL;
+      }
+      symbol = find_symbol(symbols, id);
+      if (symbol == NULL) {
+        sprintf(buffer, "Symbol '%s' is not defined", id);
+        print_serdelizer_error("parse_use", buffer, serdelizer);
+        free(id);
+        free_style(style);
+        return NULL;
+      }
+      free(id);
+      break;
+
+    case '/':
+      if (get_next_non_whitespace_char(serdelizer) != '>') {
+        sprintf(buffer, "Expected char '>' got char '%c'",
+                serdelizer->last_consumed);
+        print_serdelizer_error("parse_use", buffer, serdelizer);
+        free_style(style);
+        return NULL;
+      }
+
+      if (symbol == NULL) {
+        print_missing_parameter_error(serdelizer, "use", "symbol");
+        free_style(style);
+        return NULL;
+      }
+
+      return new_instance(clone_symbol(symbol), style);
+      break;
+
+    default:
+      if (!parse_styles(serdelizer, unshare_style(&style), "use")) {
+        free_style(style);
+        return NULL;
+      }
+      break;
+    }
+  }
+
+  free_style(style);
+  return NULL;
+}
+
+shape_t *parse_shape(serdelizer_t *serdelizer, style_t *inherited_styles,
+                     symbol_node_t *symbols) {
+  char buffer[ERROR_MESSAGE_BUFFER_SIZE];
+  shape_t *shape = NULL;
+  INSTRUMENT_START(start);
   switch (serdelizer->last_consumed) {
   case 'e':
-    return parse_ellipse(serdelizer, inherited_styles);
+    shape = parse_ellipse(serdelizer, inherited_styles);
     break;
   case 'r':
-    return parse_rectangle(serdelizer, inherited_styles);
+    shape = parse_rectangle(serdelizer, inherited_styles);
     break;
   case 'l':
-    return parse_line(serdelizer, inherited_styles);
+    shape = parse_line(serdelizer, inherited_styles);
     break;
   case 'm':
-    return parse_multiline(serdelizer, inherited_styles);
+    shape = parse_multiline(serdelizer, inherited_styles);
     break;
   case 'p':
-    return parse_polygon(serdelizer, inherited_styles);
+    shape = parse_polygon(serdelizer, inherited_styles);
     break;
   case 'd':
-    return parse_path(serdelizer, inherited_styles);
+    shape = parse_path(serdelizer, inherited_styles);
     break;
   case 'g':
-    return parse_group(serdelizer, inherited_styles);
+    shape = parse_group(serdelizer, inherited_styles, symbols);
+    break;
+  case 'u':
+    shape = parse_use(serdelizer, inherited_styles, symbols);
     break;
   default:
     sprintf(buffer, "Char '%c' : Not implemented yet",
             serdelizer->last_consumed);
     print_serdelizer_error("parse_shape", buffer, serdelizer);
-    return NULL;
     break;
   }
+  INSTRUMENT_STOP(INSTRUMENT_PARSE_SHAPE, start);
+  return shape;
 }
@@ -2,6 +2,7 @@
 #define CODA_PARSE_SHAPE
 
 #include "../../models/shapes/shape.h"
+#include "../../models/shapes/symbol.h"
 #include "../../models/styles/style.h"
 #include "../serde.h"
 
@@ -123,29 +124,53 @@ shape_t *parse_path(serdelizer_t *serdelizer, style_t *inherited_styles);
  * returns the new group shape's pointer.
  * @param serdelizer       the file accessor.
  * @param inherited_styles the new group default styles.
+ * @param symbols          the symbols its shapes may instantiate.
  * @return the new group shape's pointer.
  * @see style_t.
  * @see serdelizer_t.
  * @see group_t.
  * @see shape_t.
  */
-shape_t *parse_group(serdelizer_t *serdelizer, style_t *inherited_styles);
+shape_t *parse_group(serdelizer_t *serdelizer, style_t *inherited_styles,
+                     symbol_node_t *symbols);
+
+/**
+ * Attempts to parse an instance of a symbol.
+ * Note that this function allocates memory.
+ * Note that this function expects that the last consumed char is 'u'. The
+ * function will consume the text pattern 'se' before parsing the instance
+ * content. If the parsing fails, if the symbol parameter is missing or if the
+ * symbol is not defined the function returns NULL. If the function succeeds,
+ * it returns the new instance's pointer.
+ * @param serdelizer       the file accessor.
+ * @param inherited_styles the new instance default styles.
+ * @param symbols          the symbols which can be instantiated.
+ * @return the new instance's pointer.
+ * @see style_t.
+ * @see serdelizer_t.
+ * @see symbol_t.
+ * @see new_instance.
+ */
+shape_t *parse_use(serdelizer_t *serdelizer, style_t *inherited_styles,
+                   symbol_node_t *symbols);
 
 /**
  * Attempts to parse a shape.
  * Note that this function allocates memory.
  * Note that this function expects the last consumed char to be is the following
- * list : ['e', 'r', 'l', 'm', 'p', 'd', 'g']. If the function fails to parse a
- * shape it returns NULL. If the function succeeds it returns the new shape's
- * pointer.
+ * list : ['e', 'r', 'l', 'm', 'p', 'd', 'g', 'u']. If the function fails to
+ * parse a shape it returns NULL. If the function succeeds it returns the new
+ * shape's pointer.
  * @param serdelizer       the file accessor.
  * @param inherited_styles the shape's parent styles. It is used as default
  * styles.
+ * @param symbols          the symbols the shape may instantiate.
  * @return the new shape's pointer.
  * @see style_t.
  * @see shape_t.
  * @see serdelizer_t.
  */
-shape_t *parse_shape(serdelizer_t *serdelizer, style_t *inherited_styles);
+shape_t *parse_shape(serdelizer_t *serdelizer, style_t *inherited_styles,
+                     symbol_node_t *symbols);
 
 #endif
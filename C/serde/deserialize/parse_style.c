@@ -1,4 +1,5 @@
 #include "parse_style.h"
+#include "../../instrument/instrument.h"
 #include "../../models/styles/color.h"
 #include "../../models/styles/rotate.h"
 #include "../../models/styles/style.h"
@@ -119,16 +120,22 @@ bool parse_rotate(serdelizer_t *serdelizer, style_t *style, char *shape) {
 }
 
 bool parse_styles(serdelizer_t *serdelizer, style_t *style, char *shape) {
+  bool result = false;
+  INSTRUMENT_START(start);
   switch (serdelizer->last_consumed) {
   case 'f':
-    return parse_fill(serdelizer, style, shape);
+    result = parse_fill(serdelizer, style, shape);
+    break;
   case 'o':
-    return parse_outline(serdelizer, style, shape);
+    result = parse_outline(serdelizer, style, shape);
+    break;
   case 't':
-    return parse_translate(serdelizer, style, shape);
+    result = parse_translate(serdelizer, style, shape);
+    break;
   case 'r':
-    return parse_rotate(serdelizer, style, shape);
-  default:
-    return false;
+    result = parse_rotate(serdelizer, style, shape);
+    break;
   }
+  INSTRUMENT_STOP(INSTRUMENT_PARSE_STYLES, start);
+  return result;
 }
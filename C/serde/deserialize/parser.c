@@ -1,4 +1,5 @@
 #include "parser.h"
+#include "../../instrument/instrument.h"
 #include "parse_shape.h"
 #include <fcntl.h>
 #include <stdio.h>
@@ -6,6 +7,7 @@
 #include <string.h>
 
 #define ERROR_MESSAGE_SIZE 500
+#define STRING_PARAMETER_SIZE 64
 
 bool consume_next_char(serdelizer_t *serdelizer, char c) {
   char ch = get_next_non_whitespace_char(serdelizer);
@@ -123,7 +125,11 @@ int_parsing_result_t parse_int(serdelizer_t *serdelizer, int base,
   while (is_char_digit(c)) {
     temp = result;
     result *= 10;
-    result += char_to_int(c);
+    // Negative values are accumulated downwards so that the sign is kept.
+    if (is_negative)
+      result -= char_to_int(c);
+    else
+      result += char_to_int(c);
     if ((is_negative && temp < result) || (!is_negative && temp > result)) {
       print_serdelizer_error(
           "parse_int",
@@ -134,8 +140,6 @@ int_parsing_result_t parse_int(serdelizer_t *serdelizer, int base,
     c = get_next_char(serdelizer);
   }
 
-  if (is_negative)
-    return (int_parsing_result_t){.value = -result, .success = true};
   return (int_parsing_result_t){.value = result, .success = true};
 }
 
@@ -409,12 +413,24 @@ point_node_t *parse_points_parameter(serdelizer_t *serdelizer,
     return NULL;
   }
 
+  INSTRUMENT_START(start);
   char c;
   point_node_t *points = NULL;
+  point_node_t *last = NULL;
   int a = 0, b = 0;
   bool is_a_set = false, writing_a = false, writing_b = false;
+  bool is_a_negative = false, is_b_negative = false;
 
   while ((c = get_next_char(serdelizer)) != EOF) {
+    if (c == '-' && !is_a_set && !writing_a) {
+      is_a_negative = true;
+      continue;
+    }
+    if (c == '-' && is_a_set && !writing_b) {
+      is_b_negative = true;
+      continue;
+    }
+
     if (is_char_digit(c)) {
       if (is_a_set) {
         writing_b = true;
@@ -436,10 +452,14 @@ point_node_t *parse_points_parameter(serdelizer_t *serdelizer,
       if (is_a_set && !writing_b)
         continue;
       if (is_a_set) {
-        points = push_point_node(points, new_point(a, b));
+        append_point_node(
+            &points, &last,
+            new_point(is_a_negative ? -a : a, is_b_negative ? -b : b));
         writing_b = false;
         is_a_set = false;
         writing_a = false;
+        is_a_negative = false;
+        is_b_negative = false;
         a = 0;
         b = 0;
       }
@@ -450,7 +470,9 @@ point_node_t *parse_points_parameter(serdelizer_t *serdelizer,
   }
 
   if (is_a_set && writing_b) {
-    points = push_point_node(points, new_point(a, b));
+    append_point_node(
+        &points, &last,
+        new_point(is_a_negative ? -a : a, is_b_negative ? -b : b));
     writing_b = false;
     is_a_set = false;
     writing_a = false;
@@ -460,12 +482,54 @@ point_node_t *parse_points_parameter(serdelizer_t *serdelizer,
     print_serdelizer_error("parse_points_parameter", "Missing integer value.",
                            serdelizer);
     free_point_nodes(points);
+    INSTRUMENT_STOP(INSTRUMENT_PARSE_POINTS_PARAMETER, start);
     return NULL;
   }
 
+  INSTRUMENT_STOP(INSTRUMENT_PARSE_POINTS_PARAMETER, start);
   return points;
 }
 
+char *parse_string_parameter(serdelizer_t *serdelizer, char *parameter_name) {
+  if (strlen(parameter_name) != 0 &&
+      !consume_pattern(serdelizer, parameter_name)) {
+    print_serdelizer_error("parse_string_parameter",
+                           "Could not parse string parameter.", serdelizer);
+    return NULL;
+  }
+
+  if (!consume_pattern(serdelizer, "=\"")) {
+    print_serdelizer_error("parse_string_parameter",
+                           "Could not parse string parameter.", serdelizer);
+    return NULL;
+  }
+
+  char buffer[STRING_PARAMETER_SIZE];
+  int length = 0;
+  char c;
+  while ((c = get_next_char(serdelizer)) != EOF && c != '"') {
+    if (is_whitespace(c) || c == '<' || c == '>' ||
+        length == STRING_PARAMETER_SIZE - 1) {
+      print_serdelizer_error("parse_string_parameter",
+                             "Invalid or too long string parameter.",
+                             serdelizer);
+      return NULL;
+    }
+    buffer[length++] = c;
+  }
+
+  if (c != '"' || length == 0) {
+    print_serdelizer_error("parse_string_parameter",
+                           "Missing or empty string parameter.", serdelizer);
+    return NULL;
+  }
+
+  buffer[length] = '\0';
+  char *value = malloc(length + 1);
+  memcpy(value, buffer, length + 1);
+  return value;
+}
+
 void print_missing_parameter_error(serdelizer_t *serdelizer, char *source,
                                    char *parameter) {
   char buffer[ERROR_MESSAGE_SIZE];
@@ -511,6 +575,62 @@ viewport_t *parse_viewport(serdelizer_t *serdelizer) {
   return new_viewport(start, end);
 }
 
+symbol_t *parse_symbol(serdelizer_t *serdelizer, symbol_node_t *symbols) {
+  char buffer[ERROR_MESSAGE_SIZE];
+  if (!consume_pattern(serdelizer, "ymbol") ||
+      get_next_non_whitespace_char(serdelizer) != 'i') {
+    print_serdelizer_error("parse_symbol", "Could not parse symbol",
+                           serdelizer);
+    return NULL;
+  }
+
+  char *id = parse_string_parameter(serdelizer, "d");
+  if (id == NULL) {
+    print_serdelizer_error("parse_symbol", "Could not parse symbol's id",
+                           serdelizer);
+    return NULL;
+  }
+
+  if (find_symbol(symbols, id) != NULL) {
+    sprintf(buffer, "Symbol '%s' is already defined", id);
+    print_serdelizer_error("parse_symbol", buffer, serdelizer);
+    free(id);
+    return NULL;
+  }
+
+  if (get_next_non_whitespace_char(serdelizer) != '>' ||
+      get_next_non_whitespace_char(serdelizer) != '<') {
+    sprintf(buffer, "Expected the symbol's shape got char '%c'",
+            serdelizer->last_consumed);
+    print_serdelizer_error("parse_symbol", buffer, serdelizer);
+    free(id);
+    return NULL;
+  }
+
+  // The content does not inherit any style, its instances give the styles.
+  style_t *styles = new_default_style();
+  get_next_non_whitespace_char(serdelizer);
+  shape_t *shape = parse_shape(serdelizer, styles, symbols);
+  free_style(styles);
+  if (shape == NULL) {
+    print_serdelizer_error("parse_symbol", "Could not parse symbol's shape",
+                           serdelizer);
+    free(id);
+    return NULL;
+  }
+
+  if (get_next_non_whitespace_char(serdelizer) != '<' ||
+      !consume_pattern(serdelizer, "/symbol>")) {
+    print_serdelizer_error("parse_symbol",
+                           "Expected a single shape in symbol", serdelizer);
+    free_shape(shape);
+    free(id);
+    return NULL;
+  }
+
+  return new_symbol(id, shape);
+}
+
 svg_t *parse_svg(serdelizer_t *serdelizer) {
   char buffer[ERROR_MESSAGE_SIZE];
   if (!consume_pattern(serdelizer, "<svg")) {
@@ -534,19 +654,38 @@ svg_t *parse_svg(serdelizer_t *serdelizer) {
   }
 
   shape_node_t *shapes = NULL;
+  shape_node_t *last = NULL;
+  symbol_node_t *symbols = NULL;
   shape_t *shape = NULL;
+  symbol_t *symbol = NULL;
   style_t *styles = new_default_style();
   while (get_next_non_whitespace_char(serdelizer) != EOF) {
     if (serdelizer->last_consumed != '<')
       break;
     if (get_next_non_whitespace_char(serdelizer) == '/')
       break;
-    shape = parse_shape(serdelizer, styles);
+    if (serdelizer->last_consumed == 's') {
+      symbol = parse_symbol(serdelizer, symbols);
+      if (symbol != NULL) {
+        symbols = push_symbol_node(symbols, symbol);
+        continue;
+      }
+      free_viewport(viewport);
+      free_style(styles);
+      free_shape_node(shapes);
+      free_symbol_node(symbols);
+      print_serdelizer_error("parse_svg", "Could not parse svg's symbols",
+                             serdelizer);
+      return NULL;
+    }
+    shape = parse_shape(serdelizer, styles, symbols);
     if (shape != NULL)
-      shapes = push_shape_node(shapes, shape);
+      append_shape_node(&shapes, &last, shape);
     else {
       free_viewport(viewport);
       free_style(styles);
+      free_shape_node(shapes);
+      free_symbol_node(symbols);
       print_serdelizer_error("parse_svg", "Could not parse svg's shapes",
                              serdelizer);
       return NULL;
@@ -557,10 +696,13 @@ svg_t *parse_svg(serdelizer_t *serdelizer) {
     free_viewport(viewport);
     free_style(styles);
     free_shape_node(shapes);
+    free_symbol_node(symbols);
     print_serdelizer_error("parse_svg", "Could not parse svg", serdelizer);
     return NULL;
   }
 
   free_style(styles);
-  return new_svg(viewport, shapes);
+  svg_t *svg = new_svg(viewport, shapes);
+  svg->symbols = symbols;
+  return svg;
 }
@@ -76,7 +76,9 @@ typedef struct int_parsing_result_s {
  * function can parse negative numbers only if the base parameter is 0 otherwise
  * it fails. The function returns after consuming a non digit character. If the
  * must_consume parameter is true and the function immediately consumes a non
- * digit character the function fails.
+ * digit character the function fails. A negative number is accumulated
+ * downwards, so that its sign is kept and the overflow is detected on both
+ * sides.
  * @param serdelizer   the file accessor.
  * @param base         holds the first digit of the number to parse.
  * @param must_consume indicates if the function must consume at least 1 digit
@@ -172,7 +174,8 @@ point_t *parse_point_parameter(serdelizer_t *serdelizer, char *parameter_name);
  * Attempts to parse a points parameter.
  * Note that this function allocates memory.
  * An integer parameter matches the following pattern
- * [parameter_name]="[point], ...". If the parsing fails it returns NULL.
+ * [parameter_name]="[point], ...". Each coordinate may be negative, with a
+ * leading '-'. If the parsing fails it returns NULL.
  * @param serdelizer     the file accessor.
  * @param parameter_name the parameter's name to parse.
  * @return the parsed point linked list's pointer
@@ -182,6 +185,19 @@ point_t *parse_point_parameter(serdelizer_t *serdelizer, char *parameter_name);
 point_node_t *parse_points_parameter(serdelizer_t *serdelizer,
                                      char *parameter_name);
 
+/**
+ * Attempts to parse a string parameter.
+ * Note that this function allocates memory.
+ * A string parameter matches the following pattern [parameter_name]="[string]"
+ * where the string is not empty and holds no whitespace. If the parsing fails
+ * it returns NULL.
+ * @param serdelizer     the file accessor.
+ * @param parameter_name the parameter's name to parse.
+ * @return the parsed null terminated string, to be freed by the caller.
+ * @see serdelizer_t.
+ */
+char *parse_string_parameter(serdelizer_t *serdelizer, char *parameter_name);
+
 /**
  * Displays a formatted error message of a shape's missing parameter.
  * This function displays in red the error message and the cursor's line and
@@ -206,8 +222,25 @@ void print_missing_parameter_error(serdelizer_t *serdelizer, char *source,
  */
 viewport_t *parse_viewport(serdelizer_t *serdelizer);
 
+/**
+ * Attempts to parse a symbol definition and its shape.
+ * Note that this function allocates memory.
+ * Note that this function expects that the last consumed char is 's'. The
+ * function will consume the text pattern 'ymbol' before parsing the symbol
+ * content. A symbol holds a single shape, which may instantiate the symbols
+ * defined before it. If the parsing fails or if the id is already defined the
+ * function returns NULL.
+ * @param serdelizer the file accessor.
+ * @param symbols    the symbols defined so far.
+ * @return the parsed symbol's pointer.
+ * @see serdelizer_t.
+ * @see symbol_t.
+ */
+symbol_t *parse_symbol(serdelizer_t *serdelizer, symbol_node_t *symbols);
+
 /**
  * Attempts to parse a svg.
+ * The symbols must be defined before the shapes instantiating them.
  * Note that this function allocates memory.
  * If the function fails to parse it returns NULL.
  * @param serdelizer the file accessor.
@@ -79,7 +79,10 @@ bool write_to_file(serdelizer_t *serdelizer, char *string) {
   return true;
 }
 
-void free_serdelizer(serdelizer_t *serdelizer) { fclose(serdelizer->file); }
+void free_serdelizer(serdelizer_t *serdelizer) {
+  fclose(serdelizer->file);
+  free(serdelizer);
+}
 
 void print_serdelizer_error(char *source, char *message,
                             serdelizer_t *serdelizer) {
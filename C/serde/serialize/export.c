@@ -1,4 +1,9 @@
 #include "export.h"
+#include "../../geometry/bake.h"
+#include "../../geometry/cull.h"
+#include "../../geometry/lod.h"
+#include "../../geometry/simplify.h"
+#include "../../models/utils/bbox.h"
 #include "../../models/utils/point.h"
 #include "../serde.h"
 #include "export_shape.h"
@@ -14,7 +19,9 @@
 #define INT_BUFFER_SIZE 500
 #define STRING_BUFFER_SIZE 500
 
-export_config_t *new_export_config(int tab_size, bool line_break) {
+export_config_t *new_export_config(int tab_size, bool line_break, bool cull,
+                                   bool bake, double simplify,
+                                   simplify_method_t method) {
 
   if (tab_size <= 0) {
     fprintf(stderr,
@@ -26,6 +33,13 @@ export_config_t *new_export_config(int tab_size, bool line_break) {
   export_config_t *config = malloc(sizeof(export_config_t));
   config->tab_size = tab_size;
   config->line_break = line_break;
+  config->cull = cull;
+  config->bake = bake;
+  config->simplify = simplify;
+  config->method = method;
+  config->scale = 1;
+  config->lod = NULL;
+  config->culled = 0;
   return config;
 }
 
@@ -223,16 +237,40 @@ bool export_svg(svg_t *svg, serdelizer_t *serdelizer, export_config_t *config) {
     return false;
   }
 
-  shape_node_t *shape = svg->shapes;
+  // Baked shapes are expanded, they instantiate no symbol.
+  for (symbol_node_t *node = svg->symbols; node != NULL && !config->bake;
+       node = node->next) {
+    if (!export_symbol(node->symbol, serdelizer, config, 1)) {
+      print_serdelizer_error("export_svg", "Could not export svg", serdelizer);
+      return false;
+    }
+  }
+
+  config->culled = 0;
+  bbox_t *area = config->cull ? get_viewport_bbox(svg->viewport) : NULL;
+  lod_level_t *level = get_lod_level(config->lod, svg, config->scale);
+  shape_node_t *shapes = (level != NULL) ? level->shapes : svg->shapes;
+  shape_node_t *copy = NULL, *last = NULL;
+  if (config->bake)
+    bake_shapes(shapes, NULL, &copy, &last);
+  // Simplifies a copy so that exporting never alters the edited svg.
+  if (!config->bake && config->simplify > 0)
+    copy = clone_shape_list(shapes);
+  simplify_shapes(copy, config->simplify, config->method);
+  shape_node_t *shape = (copy != NULL) ? copy : shapes;
   while (shape != NULL) {
     if (shape->shape == NULL)
       continue;
-    if (!export_shape(shape->shape, serdelizer, config, 1)) {
+    if (!export_visible_shape(shape->shape, serdelizer, config, 1, area)) {
       print_serdelizer_error("export_svg", "Could not export svg", serdelizer);
+      free_bbox(area);
+      free_baked_shapes(copy);
       return false;
     }
     shape = shape->next;
   }
+  free_bbox(area);
+  free_baked_shapes(copy);
 
   if (!write_to_file(serdelizer, "</svg>")) {
     print_serdelizer_error("export_svg", "Could not export svg", serdelizer);
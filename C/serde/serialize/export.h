@@ -1,6 +1,8 @@
 #ifndef CODA_EXPORT
 #define CODA_EXPORT
 
+#include "../../geometry/lod.h"
+#include "../../geometry/simplify.h"
 #include "../../models/shapes/svg.h"
 #include "../../models/styles/color.h"
 #include "../../models/utils/point.h"
@@ -12,22 +14,52 @@
  * @param tab_size   the number of spaces per tab.
  * @param line_break indicates if the programs creates a new line for each
  * parameter.
+ * @param cull       indicates if the shapes outside the svg's viewport are
+ * skipped.
+ * @param bake       indicates if the transformations are baked into the
+ * shapes coordinates, producing a flat shape list without groups.
+ * @param simplify   the tolerance used to simplify the lines and paths, 0 to
+ * write them down as is.
+ * @param method     the simplification algorithm.
+ * @param scale      the output scale, used to select the level of detail.
+ * @param lod        the svg's level of detail pyramid, whose levels are built
+ * by the exports needing them, NULL to always write down the full detail
+ * shapes.
+ * @param culled     the number of shapes skipped by the last export.
  */
 typedef struct export_config_s {
   unsigned int tab_size;
   bool line_break;
+  bool cull;
+  bool bake;
+  double simplify;
+  simplify_method_t method;
+  double scale;
+  lod_pyramid_t *lod;
+  unsigned int culled;
 } export_config_t;
 
 /**
  * Creates a new export config.
+ * The config uses the full detail shapes until its scale and level of detail
+ * pyramid are set.
  * Note that this function allocates memory.
  * @param tab_size   the number of spaces per tab.
  * @param line_break indicates if the programs creates a new line for each
  * parameter.
+ * @param cull       indicates if the shapes outside the svg's viewport are
+ * skipped.
+ * @param bake       indicates if the transformations are baked into the
+ * shapes coordinates.
+ * @param simplify   the tolerance used to simplify the lines and paths, 0 to
+ * write them down as is.
+ * @param method     the simplification algorithm.
  * @return returns the new export config's pointer.
  * @see export_config_t.
  */
-export_config_t *new_export_config(int tab_size, bool line_break);
+export_config_t *new_export_config(int tab_size, bool line_break, bool cull,
+                                   bool bake, double simplify,
+                                   simplify_method_t method);
 
 /**
  * Destroys the given export config.
@@ -156,6 +188,16 @@ bool export_string_parameter(serdelizer_t *serdelizer, export_config_t *config,
 
 /**
  * Writes down the given svg.
+ * If culling is enabled, the shapes and groups whose bounding box does not
+ * intersect the viewport are skipped and counted in the config.
+ * If baking is enabled, the shapes are written down as a flat list with their
+ * world transformations applied to their coordinates.
+ * If a level of detail pyramid is set, the shapes of the level matching the
+ * output scale are written down instead of the svg's shapes.
+ * If simplification is enabled, simplified copies of the multilines, polygons
+ * and paths are written down, the svg is left untouched.
+ * The symbols are written down first, followed by the shapes where each
+ * instance references its symbol, unless baking is enabled.
  * @param svg        the svg to export.
  * @param serdelizer the file accessor.
  * @param config     the export configs.
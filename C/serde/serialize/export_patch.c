@@ -0,0 +1,157 @@
+#include "export_patch.h"
+#include "../../diff/diff.h"
+#include "../../models/shapes/shape.h"
+#include "../../models/shapes/symbol.h"
+#include "../serde.h"
+#include "export.h"
+#include "export_shape.h"
+#include "export_style.h"
+
+bool export_point_patch(point_patch_t *hunk, serdelizer_t *serdelizer,
+                        export_config_t *config, int depth) {
+  if (!export_shape_name(serdelizer, config, "points", depth) ||
+      !export_int_parameter(serdelizer, config, "index", hunk->index,
+                            depth + 1) ||
+      !export_int_parameter(serdelizer, config, "count", hunk->removed,
+                            depth + 1) ||
+      (hunk->points != NULL &&
+       !export_points_parameter(serdelizer, config, "points", hunk->points,
+                                depth + 1)) ||
+      !export_inline_close_shape(serdelizer, config, depth) ||
+      !write_to_file(serdelizer, "\n")) {
+    print_serdelizer_error("export_point_patch", "Could not export points",
+                           serdelizer);
+    return false;
+  }
+  return true;
+}
+
+bool export_patch_operation(patch_t *operation, serdelizer_t *serdelizer,
+                            export_config_t *config, int depth) {
+  char *name = (operation->variant == PATCH_REMOVE)   ? "remove"
+               : (operation->variant == PATCH_INSERT) ? "insert"
+                                                      : "modify";
+  if (!export_shape_name(serdelizer, config, name, depth) ||
+      !export_int_parameter(serdelizer, config, "index", operation->index,
+                            depth + 1) ||
+      (operation->variant == PATCH_REMOVE &&
+       !export_int_parameter(serdelizer, config, "count", operation->count,
+                             depth + 1)) ||
+      (operation->styles != NULL &&
+       !export_styles(operation->styles, serdelizer, config, depth + 1))) {
+    print_serdelizer_error("export_patch_operation",
+                           "Could not export operation", serdelizer);
+    return false;
+  }
+
+  // Removals and modifications of the styles only have no content.
+  if (operation->shapes == NULL && operation->points == NULL &&
+      operation->children == NULL) {
+    if (!export_inline_close_shape(serdelizer, config, depth) ||
+        !write_to_file(serdelizer, "\n")) {
+      print_serdelizer_error("export_patch_operation",
+                             "Could not export operation", serdelizer);
+      return false;
+    }
+    return true;
+  }
+
+  if ((config->line_break &&
+       !write_spaces(serdelizer, config->tab_size * depth)) ||
+      !write_to_file(serdelizer, ">\n")) {
+    print_serdelizer_error("export_patch_operation",
+                           "Could not export operation", serdelizer);
+    return false;
+  }
+
+  for (shape_node_t *node = operation->shapes; node != NULL;
+       node = node->next) {
+    if (!export_shape(node->shape, serdelizer, config, depth + 1)) {
+      print_serdelizer_error("export_patch_operation",
+                             "Could not export inserted shapes", serdelizer);
+      return false;
+    }
+  }
+  for (point_patch_t *hunk = operation->points; hunk != NULL;
+       hunk = hunk->next) {
+    if (!export_point_patch(hunk, serdelizer, config, depth + 1)) {
+      print_serdelizer_error("export_patch_operation",
+                             "Could not export modified points", serdelizer);
+      return false;
+    }
+  }
+  for (patch_t *child = operation->children; child != NULL;
+       child = child->next) {
+    if (!export_patch_operation(child, serdelizer, config, depth + 1)) {
+      print_serdelizer_error("export_patch_operation",
+                             "Could not export modified shapes", serdelizer);
+      return false;
+    }
+  }
+
+  if (!export_close_shape(serdelizer, config, name, depth) ||
+      !write_to_file(serdelizer, "\n")) {
+    print_serdelizer_error("export_patch_operation",
+                           "Could not export operation", serdelizer);
+    return false;
+  }
+  return true;
+}
+
+bool export_svg_patch(svg_patch_t *patch, serdelizer_t *serdelizer,
+                      export_config_t *config) {
+  if (!write_to_file(serdelizer, "<patch")) {
+    print_serdelizer_error("export_svg_patch", "Could not export patch",
+                           serdelizer);
+    return false;
+  }
+
+  if (patch->viewport != NULL &&
+      (!write_to_file(serdelizer, " viewport=\"") ||
+       !export_point(patch->viewport->start, serdelizer) ||
+       !write_to_file(serdelizer, " ") ||
+       !export_point(patch->viewport->end, serdelizer) ||
+       !write_to_file(serdelizer, "\""))) {
+    print_serdelizer_error("export_svg_patch", "Could not export viewport",
+                           serdelizer);
+    return false;
+  }
+
+  if (patch->clear_symbols &&
+      !write_to_file(serdelizer, " symbols=\"none\"")) {
+    print_serdelizer_error("export_svg_patch", "Could not export symbols",
+                           serdelizer);
+    return false;
+  }
+
+  if (!write_to_file(serdelizer, ">\n")) {
+    print_serdelizer_error("export_svg_patch", "Could not export patch",
+                           serdelizer);
+    return false;
+  }
+
+  for (symbol_node_t *node = patch->symbols; node != NULL;
+       node = node->next) {
+    if (!export_symbol(node->symbol, serdelizer, config, 1)) {
+      print_serdelizer_error("export_svg_patch", "Could not export symbols",
+                             serdelizer);
+      return false;
+    }
+  }
+
+  for (patch_t *operation = patch->shapes; operation != NULL;
+       operation = operation->next) {
+    if (!export_patch_operation(operation, serdelizer, config, 1)) {
+      print_serdelizer_error("export_svg_patch", "Could not export patch",
+                             serdelizer);
+      return false;
+    }
+  }
+
+  if (!write_to_file(serdelizer, "</patch>")) {
+    print_serdelizer_error("export_svg_patch", "Could not export patch",
+                           serdelizer);
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,52 @@
+#ifndef CODA_EXPORT_PATCH
+#define CODA_EXPORT_PATCH
+
+#include "../../diff/diff.h"
+#include "../serde.h"
+#include "export.h"
+
+/**
+ * Writes down the given point patch.
+ * @param hunk       the point patch to export.
+ * @param serdelizer the file accessor.
+ * @param config     the export configs.
+ * @param depth      the amount of spacing to write before writing the point
+ * patch.
+ * @return returns true if the operation succeeded.
+ * @see point_patch_t.
+ * @see export_config_t.
+ * @see serdelizer_t.
+ */
+bool export_point_patch(point_patch_t *hunk, serdelizer_t *serdelizer,
+                        export_config_t *config, int depth);
+
+/**
+ * Writes down the given shape patch operation, with the operations of a
+ * modified group.
+ * @param operation  the operation to export.
+ * @param serdelizer the file accessor.
+ * @param config     the export configs.
+ * @param depth      the amount of spacing to write before writing the
+ * operation.
+ * @return returns true if the operation succeeded.
+ * @see patch_t.
+ * @see export_config_t.
+ * @see serdelizer_t.
+ */
+bool export_patch_operation(patch_t *operation, serdelizer_t *serdelizer,
+                            export_config_t *config, int depth);
+
+/**
+ * Writes down the given svg patch.
+ * @param patch      the svg patch to export.
+ * @param serdelizer the file accessor.
+ * @param config     the export configs.
+ * @return returns true if the operation succeeded.
+ * @see svg_patch_t.
+ * @see export_config_t.
+ * @see serdelizer_t.
+ */
+bool export_svg_patch(svg_patch_t *patch, serdelizer_t *serdelizer,
+                      export_config_t *config);
+
+#endif
@@ -1,5 +1,9 @@
 #include "export_shape.h"
+#include "../../geometry/cull.h"
+#include "../../geometry/transform.h"
+#include "../../instrument/instrument.h"
 #include "../../models/shapes/shape.h"
+#include "../../models/shapes/symbol.h"
 #include "../../models/styles/style.h"
 #include "../serde.h"
 #include "export.h"
@@ -54,7 +58,7 @@ bool export_inline_close_shape(serdelizer_t *serdelizer,
 bool export_close_shape(serdelizer_t *serdelizer, export_config_t *config,
                         char *shape_name, int depth) {
   char buffer[SHAPE_NAME_BUFFER_SIZE];
-  sprintf(buffer, "<%s/>", shape_name);
+  sprintf(buffer, "</%s>", shape_name);
   if (!write_spaces(serdelizer, depth * config->tab_size) ||
       !write_to_file(serdelizer, buffer)) {
     print_serdelizer_error("export_inline_close_shape",
@@ -74,9 +78,9 @@ bool export_ellipse(ellipse_t *ellipse, style_t *style,
                             depth + 1) ||
       !export_int_parameter(serdelizer, config, "y", ellipse->center_y,
                             depth + 1) ||
-      !export_int_parameter(serdelizer, config, "width", ellipse->radius_y,
+      !export_int_parameter(serdelizer, config, "width", ellipse->radius_x,
                             depth + 1) ||
-      !export_int_parameter(serdelizer, config, "height", ellipse->radius_x,
+      !export_int_parameter(serdelizer, config, "height", ellipse->radius_y,
                             depth + 1) ||
       !export_inline_close_shape(serdelizer, config, depth)) {
     print_serdelizer_error("export_ellipse", "Could not export ellipse",
@@ -165,7 +169,7 @@ bool export_path(path_t *path, style_t *style, serdelizer_t *serdelizer,
 }
 
 bool export_group(group_t *group, style_t *style, serdelizer_t *serdelizer,
-                  export_config_t *config, int depth) {
+                  export_config_t *config, int depth, bbox_t *area) {
   if (!export_shape_name(serdelizer, config, "group", depth) ||
       !export_styles(style, serdelizer, config, depth + 1) ||
       (config->line_break &&
@@ -176,15 +180,20 @@ bool export_group(group_t *group, style_t *style, serdelizer_t *serdelizer,
     return false;
   }
 
+  affine_t local = get_style_affine(style);
+  bbox_t *local_area = get_group_visible_area(&local, area);
   shape_node_t *node = group;
   while (node != NULL) {
-    if (!export_shape(node->shape, serdelizer, config, depth + 1)) {
+    if (!export_visible_shape(node->shape, serdelizer, config, depth + 1,
+                              local_area)) {
       print_serdelizer_error("export_group", "Could not export group's shapes",
                              serdelizer);
+      free_bbox(local_area);
       return false;
     }
     node = node->next;
   }
+  free_bbox(local_area);
 
   if (!export_close_shape(serdelizer, config, "group", depth)) {
     print_serdelizer_error("export_group", "Could not export group",
@@ -194,9 +203,43 @@ bool export_group(group_t *group, style_t *style, serdelizer_t *serdelizer,
   return true;
 }
 
+bool export_instance(symbol_t *symbol, style_t *style,
+                     serdelizer_t *serdelizer, export_config_t *config,
+                     int depth) {
+  if (!export_shape_name(serdelizer, config, "use", depth) ||
+      !export_string_parameter(serdelizer, config, "symbol", symbol->id,
+                               depth + 1) ||
+      !export_styles(style, serdelizer, config, depth + 1) ||
+      !export_inline_close_shape(serdelizer, config, depth)) {
+    print_serdelizer_error("export_instance", "Could not export instance",
+                           serdelizer);
+    return false;
+  }
+  return true;
+}
+
+bool export_symbol(symbol_t *symbol, serdelizer_t *serdelizer,
+                   export_config_t *config, int depth) {
+  if (!export_shape_name(serdelizer, config, "symbol", depth) ||
+      !export_string_parameter(serdelizer, config, "id", symbol->id,
+                               depth + 1) ||
+      (config->line_break &&
+       !write_spaces(serdelizer, config->tab_size * depth)) ||
+      !write_to_file(serdelizer, ">\n") ||
+      !export_shape(symbol->shape, serdelizer, config, depth + 1) ||
+      !export_close_shape(serdelizer, config, "symbol", depth) ||
+      !write_to_file(serdelizer, "\n")) {
+    print_serdelizer_error("export_symbol", "Could not export symbol",
+                           serdelizer);
+    return false;
+  }
+  return true;
+}
+
 bool export_shape(shape_t *shape, serdelizer_t *serdelizer,
                   export_config_t *config, int depth) {
   bool result = false;
+  INSTRUMENT_START_BYTES(offset, serdelizer->file);
   switch (shape->shape_variant) {
 
   case ELLIPSE:
@@ -224,14 +267,40 @@ bool export_shape(shape_t *shape, serdelizer_t *serdelizer,
                          depth);
     break;
   case GROUP:
-    result = export_group(shape->shape->group, shape->styles, serdelizer,
-                          config, depth);
+    result = is_instance(shape)
+                 ? export_instance(shape->symbol, shape->styles, serdelizer,
+                                   config, depth)
+                 : export_group(shape->shape->group, shape->styles,
+                                serdelizer, config, depth, NULL);
     break;
   }
   result = result & write_to_file(serdelizer, "\n");
+  INSTRUMENT_STOP_BYTES(INSTRUMENT_EXPORT_SVG + shape->shape_variant, offset,
+                        serdelizer->file);
 
   if (!result)
     print_serdelizer_error("export_shape", "Could not export shape",
                            serdelizer);
   return result;
 }
+
+bool export_visible_shape(shape_t *shape, serdelizer_t *serdelizer,
+                          export_config_t *config, int depth, bbox_t *area) {
+  if (area == NULL)
+    return export_shape(shape, serdelizer, config, depth);
+  if (is_shape_culled(shape, area)) {
+    config->culled += count_shapes(shape);
+    return true;
+  }
+  // Instances are written as a whole, their content belongs to the symbol.
+  if (shape->shape_variant != GROUP || is_instance(shape))
+    return export_shape(shape, serdelizer, config, depth);
+
+  bool result = export_group(shape->shape->group, shape->styles, serdelizer,
+                             config, depth, area) &&
+                write_to_file(serdelizer, "\n");
+  if (!result)
+    print_serdelizer_error("export_visible_shape", "Could not export shape",
+                           serdelizer);
+  return result;
+}
@@ -3,7 +3,9 @@
 
 #include "../../models/shapes/ellipse.h"
 #include "../../models/shapes/shape.h"
+#include "../../models/shapes/symbol.h"
 #include "../../models/styles/style.h"
+#include "../../models/utils/bbox.h"
 #include "../serde.h"
 #include "export.h"
 #include "export_style.h"
@@ -158,6 +160,8 @@ bool export_path(path_t *path, style_t *style, serdelizer_t *serdelizer,
  * @param serdelizer the file accessor.
  * @param config     the export configs.
  * @param depth      the amount of spacing to write before writing the group.
+ * @param area       the visible area in the group's parent coordinates system,
+ * or NULL to write down all the group's shapes.
  * @return returns true if the operation suceeded.
  * @see group_t.
  * @see style_t.
@@ -165,7 +169,7 @@ bool export_path(path_t *path, style_t *style, serdelizer_t *serdelizer,
  * @see serdelizer_t.
  */
 bool export_group(group_t *group, style_t *style, serdelizer_t *serdelizer,
-                  export_config_t *config, int depth);
+                  export_config_t *config, int depth, bbox_t *area);
 
 /**
  * Writes down the given shape.
@@ -181,4 +185,53 @@ bool export_group(group_t *group, style_t *style, serdelizer_t *serdelizer,
 bool export_shape(shape_t *shape, serdelizer_t *serdelizer,
                   export_config_t *config, int depth);
 
+/**
+ * Writes down the given instance, referencing its symbol.
+ * @param symbol     the instantiated symbol.
+ * @param style      the instance's style.
+ * @param serdelizer the file accessor.
+ * @param config     the export configs.
+ * @param depth      the amount of spacing to write before writing the
+ * instance.
+ * @return returns true if the operation succeeded.
+ * @see symbol_t.
+ * @see style_t.
+ * @see export_config_t.
+ * @see serdelizer_t.
+ */
+bool export_instance(symbol_t *symbol, style_t *style,
+                     serdelizer_t *serdelizer, export_config_t *config,
+                     int depth);
+
+/**
+ * Writes down the given symbol definition and its shape.
+ * @param symbol     the symbol to export.
+ * @param serdelizer the file accessor.
+ * @param config     the export configs.
+ * @param depth      the amount of spacing to write before writing the symbol.
+ * @return returns true if the operation succeeded.
+ * @see symbol_t.
+ * @see export_config_t.
+ * @see serdelizer_t.
+ */
+bool export_symbol(symbol_t *symbol, serdelizer_t *serdelizer,
+                   export_config_t *config, int depth);
+
+/**
+ * Writes down the given shape if it intersects the given visible area.
+ * Skipped shapes are counted in the config's culled shapes.
+ * @param shape      the shape to export.
+ * @param serdelizer the file accessor.
+ * @param config     the export configs.
+ * @param depth      the amount of spacing to write before writing the shape.
+ * @param area       the visible area in the shape's parent coordinates system,
+ * or NULL to write down the shape unconditionally.
+ * @return returns true if the operation succeeded.
+ * @see shape_t.
+ * @see export_config_t.
+ * @see serdelizer_t.
+ */
+bool export_visible_shape(shape_t *shape, serdelizer_t *serdelizer,
+                          export_config_t *config, int depth, bbox_t *area);
+
 #endif
@@ -17,8 +17,8 @@ bool export_fill(style_t *style, serdelizer_t *serdelizer,
 
 bool export_outline(style_t *style, serdelizer_t *serdelizer,
                     export_config_t *config, int depth) {
-  if (!export_color_parameter(serdelizer, config, "outline", style->fill,
-                              depth)) {
+  if (!export_color_parameter(serdelizer, config, "outline",
+                              style->outline, depth)) {
     print_serdelizer_error("export_outline",
                            "Could not export outline parameter", serdelizer);
     return false;
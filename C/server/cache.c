@@ -0,0 +1,177 @@
+#include "cache.h"
+#include "../history/history.h"
+#include <stdlib.h>
+#include <string.h>
+
+document_cache_t *new_document_cache(size_t capacity) {
+  document_cache_t *cache = malloc(sizeof(document_cache_t));
+  cache->first = NULL;
+  cache->last = NULL;
+  cache->count = 0;
+  cache->size = 0;
+  cache->capacity = capacity;
+  pthread_mutex_init(&cache->lock, NULL);
+  return cache;
+}
+
+void free_document_cache(document_cache_t *cache) {
+  document_t *next;
+  for (document_t *document = cache->first; document != NULL;
+       document = next) {
+    next = document->next;
+    free_document(document);
+  }
+  pthread_mutex_destroy(&cache->lock);
+  free(cache);
+}
+
+void free_document(document_t *document) {
+  free_svg(document->svg);
+  free_lod_pyramid(document->pyramid);
+  free(document->name);
+  pthread_mutex_destroy(&document->lock);
+  free(document);
+}
+
+size_t get_document_size(svg_t *svg) {
+  size_t size = get_svg_size(svg);
+  for (shape_node_t *node = svg->shapes; node != NULL; node = node->next)
+    size += get_shape_size(node->shape, true);
+  return size;
+}
+
+void unlink_document(document_cache_t *cache, document_t *document) {
+  if (document->previous != NULL)
+    document->previous->next = document->next;
+  else
+    cache->first = document->next;
+  if (document->next != NULL)
+    document->next->previous = document->previous;
+  else
+    cache->last = document->previous;
+  document->previous = NULL;
+  document->next = NULL;
+}
+
+void link_document(document_cache_t *cache, document_t *document) {
+  document->previous = NULL;
+  document->next = cache->first;
+  if (cache->first != NULL)
+    cache->first->previous = document;
+  else
+    cache->last = document;
+  cache->first = document;
+}
+
+void remove_document(document_cache_t *cache, document_t *document) {
+  unlink_document(cache, document);
+  cache->count--;
+  cache->size -= document->size;
+  // A held document is freed by its last user.
+  document->is_removed = true;
+  if (document->users == 0)
+    free_document(document);
+}
+
+void evict_documents(document_cache_t *cache) {
+  document_t *document = cache->last, *previous;
+  // The most recently used document is kept even if it is larger than the
+  // cache.
+  while (document != NULL && document != cache->first &&
+         cache->size > cache->capacity) {
+    previous = document->previous;
+    if (document->users == 0)
+      remove_document(cache, document);
+    document = previous;
+  }
+}
+
+document_t *find_document(document_cache_t *cache, char *name) {
+  for (document_t *document = cache->first; document != NULL;
+       document = document->next)
+    if (strcmp(document->name, name) == 0)
+      return document;
+  return NULL;
+}
+
+void put_document(document_cache_t *cache, char *name, svg_t *svg) {
+  document_t *document = malloc(sizeof(document_t));
+  document->name = malloc(strlen(name) + 1);
+  strcpy(document->name, name);
+  document->svg = svg;
+  document->pyramid = NULL;
+  // The size is measured outside the cache's lock.
+  document->size = get_document_size(svg);
+  document->users = 0;
+  document->is_removed = false;
+  pthread_mutex_init(&document->lock, NULL);
+
+  pthread_mutex_lock(&cache->lock);
+  document_t *previous = find_document(cache, name);
+  if (previous != NULL)
+    remove_document(cache, previous);
+  link_document(cache, document);
+  cache->count++;
+  cache->size += document->size;
+  evict_documents(cache);
+  pthread_mutex_unlock(&cache->lock);
+}
+
+document_t *acquire_document(document_cache_t *cache, char *name) {
+  pthread_mutex_lock(&cache->lock);
+  document_t *document = find_document(cache, name);
+  if (document != NULL) {
+    unlink_document(cache, document);
+    link_document(cache, document);
+    document->users++;
+  }
+  pthread_mutex_unlock(&cache->lock);
+  if (document != NULL)
+    pthread_mutex_lock(&document->lock);
+  return document;
+}
+
+void release_document(document_cache_t *cache, document_t *document,
+                      bool is_edited) {
+  // The size is measured under the document's lock but stored under the
+  // cache's.
+  size_t size = 0;
+  if (is_edited) {
+    size = get_document_size(document->svg);
+    // The levels were reduced from the svg before the edit.
+    free_lod_pyramid(document->pyramid);
+    document->pyramid = NULL;
+  }
+  pthread_mutex_unlock(&document->lock);
+
+  pthread_mutex_lock(&cache->lock);
+  document->users--;
+  if (document->is_removed) {
+    if (document->users == 0)
+      free_document(document);
+  } else if (is_edited) {
+    cache->size = cache->size - document->size + size;
+    document->size = size;
+    evict_documents(cache);
+  }
+  pthread_mutex_unlock(&cache->lock);
+}
+
+bool drop_document(document_cache_t *cache, char *name) {
+  pthread_mutex_lock(&cache->lock);
+  document_t *document = find_document(cache, name);
+  if (document != NULL)
+    remove_document(cache, document);
+  pthread_mutex_unlock(&cache->lock);
+  return document != NULL;
+}
+
+void print_documents(document_cache_t *cache, FILE *file) {
+  pthread_mutex_lock(&cache->lock);
+  fprintf(file, "%d document(s), %zu of %zu bytes\n", cache->count,
+          cache->size, cache->capacity);
+  for (document_t *document = cache->first; document != NULL;
+       document = document->next)
+    fprintf(file, "%s %zu\n", document->name, document->size);
+  pthread_mutex_unlock(&cache->lock);
+}
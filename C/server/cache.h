@@ -0,0 +1,202 @@
+#ifndef CODA_CACHE
+#define CODA_CACHE
+
+#include "../geometry/lod.h"
+#include "../models/shapes/svg.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * Defines the cached document type, a named svg kept in memory between
+ * requests.
+ * A document is only used by one request at a time, through its lock, since
+ * the exports fill the shapes' cached bounding boxes and transformations.
+ * @param name       the document's name.
+ * @param svg        the document's svg.
+ * @param pyramid    the svg's level of detail pyramid, kept between the
+ * exports and discarded when the svg is edited, NULL if none was needed yet.
+ * @param size       the estimated memory used by the svg.
+ * @param users      the number of requests holding the document.
+ * @param is_removed indicates if the document was removed from the cache
+ * while held, it is then freed by its last user.
+ * @param lock       the mutex held by the request using the svg.
+ * @param previous   the more recently used document.
+ * @param next       the less recently used document.
+ * @see document_cache_t.
+ */
+typedef struct document_s {
+  char *name;
+  svg_t *svg;
+  lod_pyramid_t *pyramid;
+  size_t size;
+  unsigned int users;
+  bool is_removed;
+  pthread_mutex_t lock;
+  struct document_s *previous;
+  struct document_s *next;
+} document_t;
+
+/**
+ * Defines the document cache type, the documents ordered from the most to the
+ * least recently used.
+ * The least recently used documents are evicted when the documents' size
+ * exceeds the cache's capacity, the held documents and the most recently used
+ * one excepted.
+ * @param first    the most recently used document.
+ * @param last     the least recently used document.
+ * @param count    the number of documents.
+ * @param size     the estimated memory used by the documents.
+ * @param capacity the maximum memory used by the documents.
+ * @param lock     the mutex guarding the cache's list and counters.
+ * @see document_t.
+ */
+typedef struct document_cache_s {
+  document_t *first;
+  document_t *last;
+  int count;
+  size_t size;
+  size_t capacity;
+  pthread_mutex_t lock;
+} document_cache_t;
+
+/**
+ * Creates a new empty document cache.
+ * Note that this function allocates memory.
+ * @param capacity the maximum memory used by the documents, in bytes.
+ * @return the new cache's pointer.
+ * @see document_cache_t.
+ */
+document_cache_t *new_document_cache(size_t capacity);
+
+/**
+ * Destroys the given document cache and its documents.
+ * Note that this function frees memory.
+ * @param cache the cache to destroy, whose documents must not be held.
+ * @see document_cache_t.
+ */
+void free_document_cache(document_cache_t *cache);
+
+/**
+ * Destroys the given document, its svg and its pyramid.
+ * Note that this function frees memory.
+ * @param document the document to destroy.
+ * @see document_t.
+ */
+void free_document(document_t *document);
+
+/**
+ * Estimates the memory used by the given svg, the shapes of its groups
+ * included.
+ * @param svg the svg.
+ * @return the size in bytes.
+ * @see get_svg_size.
+ * @see get_shape_size.
+ */
+size_t get_document_size(svg_t *svg);
+
+/**
+ * Unlinks the given document from the given cache.
+ * The cache's lock must be held.
+ * @param cache    the cache.
+ * @param document the document.
+ * @see document_cache_t.
+ */
+void unlink_document(document_cache_t *cache, document_t *document);
+
+/**
+ * Links the given document to the given cache as the most recently used one.
+ * The cache's lock must be held.
+ * @param cache    the cache.
+ * @param document the document.
+ * @see document_cache_t.
+ */
+void link_document(document_cache_t *cache, document_t *document);
+
+/**
+ * Removes the given document from the given cache, freeing it unless it is
+ * held.
+ * The cache's lock must be held.
+ * Note that this function may free memory.
+ * @param cache    the cache.
+ * @param document the document.
+ * @see unlink_document.
+ */
+void remove_document(document_cache_t *cache, document_t *document);
+
+/**
+ * Removes the least recently used documents which are not held until the
+ * documents fit in the cache's capacity. The most recently used document is
+ * never removed.
+ * The cache's lock must be held.
+ * Note that this function may free memory.
+ * @param cache the cache.
+ * @see document_cache_t.
+ */
+void evict_documents(document_cache_t *cache);
+
+/**
+ * Searches the document of the given name.
+ * The cache's lock must be held.
+ * @param cache the cache.
+ * @param name  the document's name.
+ * @return the document's pointer, NULL if there is none.
+ * @see document_t.
+ */
+document_t *find_document(document_cache_t *cache, char *name);
+
+/**
+ * Adds the given svg to the given cache as the most recently used document,
+ * replacing the document of the same name.
+ * Note that this function allocates memory.
+ * @param cache the cache.
+ * @param name  the document's name, which is copied.
+ * @param svg   the svg, which now belongs to the cache.
+ * @see document_t.
+ */
+void put_document(document_cache_t *cache, char *name, svg_t *svg);
+
+/**
+ * Holds the document of the given name, marks it as the most recently used
+ * and locks it.
+ * @param cache the cache.
+ * @param name  the document's name.
+ * @return the document's pointer, NULL if there is none.
+ * @see release_document.
+ */
+document_t *acquire_document(document_cache_t *cache, char *name);
+
+/**
+ * Unlocks and releases the given document, held by acquire_document. The
+ * document's size is measured again and its pyramid discarded if it was
+ * edited.
+ * Note that this function may free memory.
+ * @param cache     the cache.
+ * @param document  the document.
+ * @param is_edited indicates if the document's svg was edited.
+ * @see acquire_document.
+ */
+void release_document(document_cache_t *cache, document_t *document,
+                      bool is_edited);
+
+/**
+ * Removes the document of the given name from the given cache.
+ * Note that this function may free memory.
+ * @param cache the cache.
+ * @param name  the document's name.
+ * @return returns true if the document existed.
+ * @see remove_document.
+ */
+bool drop_document(document_cache_t *cache, char *name);
+
+/**
+ * Writes down the names and sizes of the given cache's documents, from the
+ * most to the least recently used.
+ * @param cache the cache.
+ * @param file  the file to write to.
+ * @see document_cache_t.
+ */
+void print_documents(document_cache_t *cache, FILE *file);
+
+#endif
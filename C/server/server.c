@@ -0,0 +1,469 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "server.h"
+#include "../instrument/instrument.h"
+#include "../script/script.h"
+#include "../serde/serde.h"
+#include <errno.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define SERVER_BACKLOG 64
+#define SERVER_EVENT_COUNT 64
+#define SERVER_ARGUMENT_COUNT 32
+#define SERVER_RESPONSE_SIZE 512
+#define SERVER_WAIT_MILLISECONDS 500
+
+volatile sig_atomic_t is_server_stopped = 0;
+
+void stop_server(int number) { is_server_stopped = 1; }
+
+server_t *new_server(char *path, size_t memory) {
+  struct sockaddr_un address;
+  if (strlen(path) >= sizeof(address.sun_path)) {
+    fprintf(stderr, "Socket path too long: %s\n", path);
+    return NULL;
+  }
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strcpy(address.sun_path, path);
+
+  // Only a socket is replaced, never a regular file.
+  struct stat status;
+  if (stat(path, &status) == 0 && S_ISSOCK(status.st_mode))
+    unlink(path);
+  int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listener < 0 ||
+      bind(listener, (struct sockaddr *)&address, sizeof(address)) != 0 ||
+      listen(listener, SERVER_BACKLOG) != 0) {
+    fprintf(stderr, "Could not listen on %s: %s\n", path, strerror(errno));
+    if (listener >= 0)
+      close(listener);
+    return NULL;
+  }
+  int epoll = epoll_create1(0);
+  struct epoll_event event = {.events = EPOLLIN, .data.ptr = NULL};
+  if (epoll < 0 || epoll_ctl(epoll, EPOLL_CTL_ADD, listener, &event) != 0) {
+    fprintf(stderr, "Could not wait on %s: %s\n", path, strerror(errno));
+    if (epoll >= 0)
+      close(epoll);
+    close(listener);
+    unlink(path);
+    return NULL;
+  }
+
+  server_t *server = malloc(sizeof(server_t));
+  server->listener = listener;
+  server->epoll = epoll;
+  server->cache = new_document_cache(memory);
+  server->connections = NULL;
+  server->first = NULL;
+  server->last = NULL;
+  server->is_stopping = false;
+  pthread_mutex_init(&server->lock, NULL);
+  pthread_cond_init(&server->available, NULL);
+  return server;
+}
+
+void free_server(server_t *server) {
+  while (server->connections != NULL)
+    close_server_connection(server, server->connections);
+  close(server->epoll);
+  close(server->listener);
+  free_document_cache(server->cache);
+  pthread_mutex_destroy(&server->lock);
+  pthread_cond_destroy(&server->available);
+  free(server);
+}
+
+void accept_server_connections(server_t *server) {
+  // The listener is level-triggered, each pending connection wakes the loop
+  // up again.
+  int client = accept(server->listener, NULL, NULL);
+  if (client < 0)
+    return;
+  server_connection_t *connection = malloc(sizeof(server_connection_t));
+  connection->socket = client;
+  connection->length = 0;
+  connection->previous = NULL;
+  connection->ready = NULL;
+  pthread_mutex_lock(&server->lock);
+  connection->next = server->connections;
+  if (server->connections != NULL)
+    server->connections->previous = connection;
+  server->connections = connection;
+  pthread_mutex_unlock(&server->lock);
+
+  struct epoll_event event = {.events = EPOLLIN | EPOLLONESHOT,
+                              .data.ptr = connection};
+  if (epoll_ctl(server->epoll, EPOLL_CTL_ADD, client, &event) != 0)
+    close_server_connection(server, connection);
+}
+
+void close_server_connection(server_t *server,
+                             server_connection_t *connection) {
+  pthread_mutex_lock(&server->lock);
+  if (connection->previous != NULL)
+    connection->previous->next = connection->next;
+  else
+    server->connections = connection->next;
+  if (connection->next != NULL)
+    connection->next->previous = connection->previous;
+  pthread_mutex_unlock(&server->lock);
+  epoll_ctl(server->epoll, EPOLL_CTL_DEL, connection->socket, NULL);
+  close(connection->socket);
+  free(connection);
+}
+
+void queue_server_connection(server_t *server,
+                             server_connection_t *connection) {
+  pthread_mutex_lock(&server->lock);
+  connection->ready = NULL;
+  if (server->last != NULL)
+    server->last->ready = connection;
+  else
+    server->first = connection;
+  server->last = connection;
+  pthread_cond_signal(&server->available);
+  pthread_mutex_unlock(&server->lock);
+}
+
+server_connection_t *take_server_connection(server_t *server) {
+  pthread_mutex_lock(&server->lock);
+  while (server->first == NULL && !server->is_stopping)
+    pthread_cond_wait(&server->available, &server->lock);
+  server_connection_t *connection = server->first;
+  if (connection != NULL && !server->is_stopping) {
+    server->first = connection->ready;
+    if (server->first == NULL)
+      server->last = NULL;
+  } else
+    connection = NULL;
+  pthread_mutex_unlock(&server->lock);
+  return connection;
+}
+
+bool send_server_data(server_connection_t *connection, char *data,
+                      size_t length) {
+  ssize_t sent;
+  while (length > 0) {
+    // A client leaving early must not kill the server.
+    sent = send(connection->socket, data, length, MSG_NOSIGNAL);
+    if (sent < 0 && errno == EINTR)
+      continue;
+    if (sent <= 0)
+      return false;
+    data += sent;
+    length -= sent;
+  }
+  return true;
+}
+
+bool send_server_response(server_connection_t *connection, const char *format,
+                          ...) {
+  char buffer[SERVER_RESPONSE_SIZE];
+  va_list arguments;
+  va_start(arguments, format);
+  int length = vsnprintf(buffer, SERVER_RESPONSE_SIZE - 1, format, arguments);
+  va_end(arguments);
+  if (length < 0)
+    return false;
+  if (length > SERVER_RESPONSE_SIZE - 2)
+    length = SERVER_RESPONSE_SIZE - 2;
+  buffer[length++] = '\n';
+  return send_server_data(connection, buffer, length);
+}
+
+bool send_server_payload(server_connection_t *connection, char *data,
+                         size_t length) {
+  return send_server_response(connection, "OK %zu", length) &&
+         send_server_data(connection, data, length);
+}
+
+char *next_server_token(char **cursor) {
+  char *token = *cursor + strspn(*cursor, " \t");
+  if (*token == '\0')
+    return NULL;
+  char *end = token + strcspn(token, " \t");
+  *cursor = (*end != '\0') ? end + 1 : end;
+  *end = '\0';
+  return token;
+}
+
+bool parse_server_options(char *cursor, batch_options_t *options) {
+  char *arguments[SERVER_ARGUMENT_COUNT];
+  int count = 0;
+  char *token;
+  while ((token = next_server_token(&cursor)) != NULL) {
+    if (count == SERVER_ARGUMENT_COUNT)
+      return false;
+    arguments[count++] = token;
+  }
+  return batch_parse_options(count, arguments, options) == 0;
+}
+
+lod_pyramid_t *get_server_pyramid(document_t *document,
+                                  batch_options_t *options) {
+  if (options->scale >= 1)
+    return NULL;
+  if (document->pyramid != NULL &&
+      document->pyramid->method != options->method) {
+    free_lod_pyramid(document->pyramid);
+    document->pyramid = NULL;
+  }
+  if (document->pyramid == NULL)
+    document->pyramid = new_batch_lod_pyramid(options);
+  return document->pyramid;
+}
+
+bool handle_server_load(server_t *server, server_connection_t *connection,
+                        char *name, char *cursor) {
+  char *path = next_server_token(&cursor);
+  if (path == NULL || next_server_token(&cursor) != NULL)
+    return send_server_response(connection, "ERROR usage: load <name> <path>");
+  // The file is parsed before the cache is locked.
+  svg_t *svg = batch_open_svg(path);
+  if (svg == NULL)
+    return send_server_response(connection, "ERROR could not load %s", path);
+  put_document(server->cache, name, svg);
+  return send_server_response(connection, "OK");
+}
+
+bool handle_server_edit(server_t *server, server_connection_t *connection,
+                        char *name, char *script) {
+  if (strspn(script, " \t") == strlen(script))
+    return send_server_response(connection,
+                                "ERROR usage: edit <name> <script>");
+  FILE *file = fmemopen(script, strlen(script), "r");
+  if (file == NULL)
+    return send_server_response(connection, "ERROR could not read the script");
+  document_t *document = acquire_document(server->cache, name);
+  if (document == NULL) {
+    fclose(file);
+    return send_server_response(connection, "ERROR unknown document %s",
+                                name);
+  }
+  script_report_t report;
+  serdelizer_t *serdelizer = new_serdelizer(file);
+  bool success = run_script(document->svg, serdelizer, &report);
+  free_serdelizer(serdelizer);
+  release_document(server->cache, document,
+                   report.edited > 0 || report.deleted > 0);
+  // The statements before an invalid one are kept.
+  return send_server_response(connection, "%s %u %u %u",
+                              success ? "OK" : "ERROR invalid script",
+                              report.statements, report.edited,
+                              report.deleted);
+}
+
+bool handle_server_export(server_t *server, server_connection_t *connection,
+                          char *name, char *cursor) {
+  batch_options_t options;
+  char *path = next_server_token(&cursor);
+  if (path == NULL || !parse_server_options(cursor, &options))
+    return send_server_response(
+        connection, "ERROR usage: export <name> <path> [options]");
+  document_t *document = acquire_document(server->cache, name);
+  if (document == NULL)
+    return send_server_response(connection, "ERROR unknown document %s",
+                                name);
+  bool success =
+      batch_export_svg(document->svg, path, &options,
+                       get_server_pyramid(document, &options), NULL);
+  release_document(server->cache, document, false);
+  return success ? send_server_response(connection, "OK")
+                 : send_server_response(connection,
+                                        "ERROR could not export %s", path);
+}
+
+bool handle_server_render(server_t *server, server_connection_t *connection,
+                          char *name, char *cursor) {
+  batch_options_t options;
+  if (!parse_server_options(cursor, &options))
+    return send_server_response(connection,
+                                "ERROR usage: render <name> [options]");
+  document_t *document = acquire_document(server->cache, name);
+  if (document == NULL)
+    return send_server_response(connection, "ERROR unknown document %s",
+                                name);
+  char *data = NULL;
+  size_t length = 0;
+  FILE *file = open_memstream(&data, &length);
+  bool success = file != NULL &&
+                 batch_write_svg(document->svg, file, &options,
+                                 get_server_pyramid(document, &options), NULL);
+  release_document(server->cache, document, false);
+  if (file != NULL)
+    fclose(file);
+  success = success ? send_server_payload(connection, data, length)
+                    : send_server_response(connection,
+                                           "ERROR could not render %s", name);
+  free(data);
+  return success;
+}
+
+bool handle_server_list(server_t *server, server_connection_t *connection) {
+  char *data = NULL;
+  size_t length = 0;
+  FILE *file = open_memstream(&data, &length);
+  if (file == NULL)
+    return send_server_response(connection, "ERROR could not list");
+  print_documents(server->cache, file);
+  fclose(file);
+  bool success = send_server_payload(connection, data, length);
+  free(data);
+  return success;
+}
+
+bool handle_server_stats(server_connection_t *connection) {
+  char *data = NULL;
+  size_t length = 0;
+  FILE *file = open_memstream(&data, &length);
+  if (file == NULL)
+    return send_server_response(connection, "ERROR could not read stats");
+  print_instrument_counters(file);
+  fclose(file);
+  bool success = send_server_payload(connection, data, length);
+  free(data);
+  return success;
+}
+
+bool handle_server_request(server_t *server, server_connection_t *connection,
+                           char *line) {
+  char *cursor = line;
+  char *command = next_server_token(&cursor);
+  if (command == NULL)
+    return true;
+  if (strcmp(command, "list") == 0)
+    return handle_server_list(server, connection);
+  if (strcmp(command, "stats") == 0)
+    return handle_server_stats(connection);
+
+  char *name = next_server_token(&cursor);
+  if (name == NULL)
+    return send_server_response(connection, "ERROR missing document name");
+  if (strcmp(command, "load") == 0)
+    return handle_server_load(server, connection, name, cursor);
+  if (strcmp(command, "edit") == 0)
+    return handle_server_edit(server, connection, name, cursor);
+  if (strcmp(command, "export") == 0)
+    return handle_server_export(server, connection, name, cursor);
+  if (strcmp(command, "render") == 0)
+    return handle_server_render(server, connection, name, cursor);
+  if (strcmp(command, "unload") == 0)
+    return drop_document(server->cache, name)
+               ? send_server_response(connection, "OK")
+               : send_server_response(connection, "ERROR unknown document %s",
+                                      name);
+  return send_server_response(connection, "ERROR unknown request %s",
+                              command);
+}
+
+bool serve_server_connection(server_t *server,
+                             server_connection_t *connection) {
+  ssize_t received;
+  do
+    received = recv(connection->socket, connection->buffer + connection->length,
+                    SERVER_LINE_SIZE - 1 - connection->length, 0);
+  while (received < 0 && errno == EINTR);
+  if (received <= 0)
+    return false;
+  connection->length += received;
+  connection->buffer[connection->length] = '\0';
+
+  char *line = connection->buffer, *end;
+  while ((end = strchr(line, '\n')) != NULL) {
+    *end = '\0';
+    if (end > line && end[-1] == '\r')
+      end[-1] = '\0';
+    if (!handle_server_request(server, connection, line))
+      return false;
+    line = end + 1;
+  }
+  connection->length -= line - connection->buffer;
+  if (connection->length == SERVER_LINE_SIZE - 1) {
+    send_server_response(connection, "ERROR line too long");
+    return false;
+  }
+  memmove(connection->buffer, line, connection->length);
+  return true;
+}
+
+void *run_server_worker(void *argument) {
+  server_t *server = argument;
+  server_connection_t *connection;
+  struct epoll_event event = {.events = EPOLLIN | EPOLLONESHOT};
+  bool is_open;
+  while ((connection = take_server_connection(server)) != NULL) {
+    event.data.ptr = connection;
+    is_open = serve_server_connection(server, connection);
+    // The connection is registered again under the lock taken to queue it,
+    // so that its next worker sees the buffer left by this one.
+    pthread_mutex_lock(&server->lock);
+    is_open = is_open && epoll_ctl(server->epoll, EPOLL_CTL_MOD,
+                                   connection->socket, &event) == 0;
+    pthread_mutex_unlock(&server->lock);
+    if (!is_open)
+      close_server_connection(server, connection);
+  }
+  return NULL;
+}
+
+bool run_server(char *path, unsigned int jobs, size_t memory) {
+  server_t *server = new_server(path, memory);
+  if (server == NULL)
+    return false;
+
+  int threads = (jobs > 0) ? jobs : sysconf(_SC_NPROCESSORS_ONLN);
+  if (threads <= 0)
+    threads = 1;
+  pthread_t *workers = malloc(sizeof(pthread_t) * threads);
+  int started = 0;
+  while (started < threads &&
+         pthread_create(&workers[started], NULL, run_server_worker, server) ==
+             0)
+    started++;
+
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = stop_server;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGINT, &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+  if (started > 0)
+    fprintf(stderr, "Serving on %s with %d thread(s).\n", path, started);
+
+  struct epoll_event events[SERVER_EVENT_COUNT];
+  int count;
+  // The wait is bounded so that a signal caught by a worker stops the loop.
+  while (started > 0 && !is_server_stopped) {
+    count = epoll_wait(server->epoll, events, SERVER_EVENT_COUNT,
+                       SERVER_WAIT_MILLISECONDS);
+    if (count < 0 && errno != EINTR)
+      break;
+    for (int i = 0; i < count; i++)
+      if (events[i].data.ptr == NULL)
+        accept_server_connections(server);
+      else
+        queue_server_connection(server, events[i].data.ptr);
+  }
+
+  pthread_mutex_lock(&server->lock);
+  server->is_stopping = true;
+  pthread_cond_broadcast(&server->available);
+  pthread_mutex_unlock(&server->lock);
+  for (int i = 0; i < started; i++)
+    pthread_join(workers[i], NULL);
+  free(workers);
+  free_server(server);
+  unlink(path);
+  return started > 0;
+}
@@ -0,0 +1,315 @@
+#ifndef CODA_SERVER
+#define CODA_SERVER
+
+#include "../batch/batch.h"
+#include "cache.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define SERVER_LINE_SIZE 4096
+
+/**
+ * Defines the server connection type, a client's socket and its unfinished
+ * request line.
+ * @param socket   the client's socket.
+ * @param buffer   the received characters not handled yet.
+ * @param length   the number of received characters.
+ * @param previous the previous connection of the server.
+ * @param next     the next connection of the server.
+ * @param ready    the next connection waiting for a worker.
+ * @see server_t.
+ */
+typedef struct server_connection_s {
+  int socket;
+  char buffer[SERVER_LINE_SIZE];
+  size_t length;
+  struct server_connection_s *previous;
+  struct server_connection_s *next;
+  struct server_connection_s *ready;
+} server_connection_t;
+
+/**
+ * Defines the server type, a daemon keeping documents in memory between the
+ * requests of its clients.
+ * The main thread waits on the sockets with epoll and queues the connections
+ * with pending data. Each connection is registered as one-shot, so it is only
+ * handled by one worker at a time, and is registered again once its complete
+ * lines are answered.
+ * @param listener    the listening socket.
+ * @param epoll       the epoll instance.
+ * @param cache       the loaded documents.
+ * @param connections the open connections.
+ * @param first       the first connection waiting for a worker.
+ * @param last        the last connection waiting for a worker.
+ * @param is_stopping indicates if the workers must stop.
+ * @param lock        the mutex guarding the connections and the queue.
+ * @param available   the condition signaled when a connection is queued.
+ * @see server_connection_t.
+ * @see document_cache_t.
+ */
+typedef struct server_s {
+  int listener;
+  int epoll;
+  document_cache_t *cache;
+  server_connection_t *connections;
+  server_connection_t *first;
+  server_connection_t *last;
+  bool is_stopping;
+  pthread_mutex_t lock;
+  pthread_cond_t available;
+} server_t;
+
+/**
+ * Requests the running server to stop, as the handler of the interruption and
+ * termination signals.
+ * @param number the signal's number.
+ * @see run_server.
+ */
+void stop_server(int number);
+
+/**
+ * Creates a new server listening on the Unix socket at the given path. A
+ * socket left by a previous server is replaced.
+ * Note that this function allocates memory.
+ * @param path   the socket's path.
+ * @param memory the maximum memory used by the documents, in bytes.
+ * @return the new server's pointer, NULL if the socket could not be opened.
+ * @see server_t.
+ */
+server_t *new_server(char *path, size_t memory);
+
+/**
+ * Destroys the given server, closing its connections and freeing its
+ * documents.
+ * Note that this function frees memory.
+ * @param server the server to destroy, whose workers must be stopped.
+ * @see server_t.
+ */
+void free_server(server_t *server);
+
+/**
+ * Accepts a pending connection of the given server.
+ * Note that this function allocates memory.
+ * @param server the server.
+ * @see server_connection_t.
+ */
+void accept_server_connections(server_t *server);
+
+/**
+ * Closes the given connection and removes it from the given server.
+ * Note that this function frees memory.
+ * @param server     the server.
+ * @param connection the connection.
+ * @see server_connection_t.
+ */
+void close_server_connection(server_t *server,
+                             server_connection_t *connection);
+
+/**
+ * Queues the given connection for the workers of the given server.
+ * @param server     the server.
+ * @param connection the connection with pending data.
+ * @see take_server_connection.
+ */
+void queue_server_connection(server_t *server,
+                             server_connection_t *connection);
+
+/**
+ * Waits for a queued connection of the given server.
+ * @param server the server.
+ * @return the connection's pointer, NULL once the server stops.
+ * @see queue_server_connection.
+ */
+server_connection_t *take_server_connection(server_t *server);
+
+/**
+ * Sends the given data to the given connection's client.
+ * @param connection the connection.
+ * @param data       the data.
+ * @param length     the data's length.
+ * @return returns true if all the data was sent.
+ */
+bool send_server_data(server_connection_t *connection, char *data,
+                      size_t length);
+
+/**
+ * Sends a response to the given connection's client, i.e. a line starting
+ * with `OK` or `ERROR`.
+ * @param connection the connection.
+ * @param format     the printf-like format of the line, new line excluded.
+ * @return returns true if the line was sent.
+ */
+bool send_server_response(server_connection_t *connection, const char *format,
+                          ...);
+
+/**
+ * Sends a response carrying the given payload, i.e. `OK <length>` followed by
+ * the payload's bytes.
+ * @param connection the connection.
+ * @param data       the payload.
+ * @param length     the payload's length.
+ * @return returns true if the response was sent.
+ */
+bool send_server_payload(server_connection_t *connection, char *data,
+                         size_t length);
+
+/**
+ * Reads the next token of a request line, i.e. the next run of characters
+ * other than spaces and tabs.
+ * @param cursor a pointer to the line's remaining characters, moved past the
+ * token.
+ * @return the token, terminated in place, NULL if there is none left.
+ */
+char *next_server_token(char **cursor);
+
+/**
+ * Reads the export options ending a request line.
+ * @param cursor  the line's remaining characters, which are modified.
+ * @param options the options to set.
+ * @return returns true if the options are valid and are not followed by other
+ * arguments.
+ * @see batch_parse_options.
+ */
+bool parse_server_options(char *cursor, batch_options_t *options);
+
+/**
+ * Gets the level of detail pyramid of the given document used by the given
+ * export options, replacing the document's pyramid if it was reduced with
+ * another method. The document must be held.
+ * Note that this function may allocate and free memory.
+ * @param document the document.
+ * @param options  the export options.
+ * @return the pyramid's pointer, NULL if the options ask for the full detail.
+ * @see new_batch_lod_pyramid.
+ */
+lod_pyramid_t *get_server_pyramid(document_t *document,
+                                  batch_options_t *options);
+
+/**
+ * Handles a `load <name> <path>` request.
+ * Note that this function allocates memory.
+ * @param server     the server.
+ * @param connection the connection.
+ * @param name       the document's name.
+ * @param cursor     the request's remaining characters.
+ * @return returns false if the response could not be sent.
+ * @see put_document.
+ */
+bool handle_server_load(server_t *server, server_connection_t *connection,
+                        char *name, char *cursor);
+
+/**
+ * Handles an `edit <name> <script>` request, responding with the number of
+ * statements run and of shapes edited and deleted.
+ * Note that this function may allocate and free memory.
+ * @param server     the server.
+ * @param connection the connection.
+ * @param name       the document's name.
+ * @param script     the script's text.
+ * @return returns false if the response could not be sent.
+ * @see run_script.
+ */
+bool handle_server_edit(server_t *server, server_connection_t *connection,
+                        char *name, char *script);
+
+/**
+ * Handles an `export <name> <path> [options]` request.
+ * @param server     the server.
+ * @param connection the connection.
+ * @param name       the document's name.
+ * @param cursor     the request's remaining characters.
+ * @return returns false if the response could not be sent.
+ * @see batch_export_svg.
+ */
+bool handle_server_export(server_t *server, server_connection_t *connection,
+                          char *name, char *cursor);
+
+/**
+ * Handles a `render <name> [options]` request, responding with the svg as a
+ * payload.
+ * @param server     the server.
+ * @param connection the connection.
+ * @param name       the document's name.
+ * @param cursor     the request's remaining characters.
+ * @return returns false if the response could not be sent.
+ * @see batch_write_svg.
+ */
+bool handle_server_render(server_t *server, server_connection_t *connection,
+                          char *name, char *cursor);
+
+/**
+ * Handles a `list` request, responding with the documents as a payload.
+ * @param server     the server.
+ * @param connection the connection.
+ * @return returns false if the response could not be sent.
+ * @see print_documents.
+ */
+bool handle_server_list(server_t *server, server_connection_t *connection);
+
+/**
+ * Handles a `stats` request, responding with the instrumentation counters as
+ * a payload.
+ * @param connection the connection.
+ * @return returns false if the response could not be sent.
+ * @see print_instrument_counters.
+ */
+bool handle_server_stats(server_connection_t *connection);
+
+/**
+ * Handles a request line of the given connection.
+ * The requests are:
+ * - load <name> <path> : parses the svg file and keeps it as the named
+ * document, replacing the document of the same name.
+ * - edit <name> <script> : runs an edit script, its statements separated by
+ * semicolons, against the document.
+ * - export <name> <path> [options] : writes down the document, as html if the
+ * path ends with ".html".
+ * - render <name> [options] : sends the document written down as an svg.
+ * - unload <name> : removes the document.
+ * - list : sends the documents' names and sizes.
+ * - stats : sends the instrumentation counters, if they are compiled in.
+ * The options are the batch commands' export options.
+ * Note that this function may allocate and free memory.
+ * @param server     the server.
+ * @param connection the connection.
+ * @param line       the request line, which is modified.
+ * @return returns false if the response could not be sent.
+ * @see batch_parse_options.
+ */
+bool handle_server_request(server_t *server, server_connection_t *connection,
+                           char *line);
+
+/**
+ * Reads the pending data of the given connection and handles its complete
+ * request lines.
+ * Note that this function may allocate and free memory.
+ * @param server     the server.
+ * @param connection the connection.
+ * @return returns false if the connection must be closed.
+ * @see handle_server_request.
+ */
+bool serve_server_connection(server_t *server,
+                             server_connection_t *connection);
+
+/**
+ * Handles the queued connections of the given server until it stops.
+ * @param argument the server.
+ * @return NULL.
+ * @see take_server_connection.
+ */
+void *run_server_worker(void *argument);
+
+/**
+ * Runs a server on the Unix socket at the given path until the process is
+ * interrupted or terminated.
+ * Note that this function allocates and frees memory.
+ * @param path   the socket's path.
+ * @param jobs   the number of worker threads, 0 for one per processor.
+ * @param memory the maximum memory used by the documents, in bytes.
+ * @return returns true if the server ran.
+ * @see server_t.
+ */
+bool run_server(char *path, unsigned int jobs, size_t memory);
+
+#endif
@@ -0,0 +1,483 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "watch.h"
+#include "../geometry/cull.h"
+#include "../hash/hash.h"
+#include "../serde/deserialize/parse_shape.h"
+#include "../serde/deserialize/parser.h"
+#include "../serde/serde.h"
+#include <errno.h>
+#include <libgen.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <time.h>
+#include <unistd.h>
+
+#define WATCH_ELEMENT_CAPACITY 64
+#define WATCH_EVENT_BUFFER_SIZE 4096
+
+volatile sig_atomic_t is_watch_stopped = 0;
+
+watch_state_t *new_watch_state(char *input, char *output,
+                               batch_options_t *options) {
+  watch_state_t *state = malloc(sizeof(watch_state_t));
+  state->input = input;
+  state->output = output;
+  state->options = options;
+  state->config = new_html_config(options->cull, options->bake,
+                                  options->simplify, options->method);
+  state->source = NULL;
+  state->length = 0;
+  state->header = 0;
+  state->elements = NULL;
+  state->count = 0;
+  state->svg = NULL;
+  state->head = NULL;
+  state->head_size = 0;
+  state->reparsed = 0;
+  state->rewritten = 0;
+  return state;
+}
+
+void free_watch_elements(watch_element_t *elements, int count) {
+  for (int i = 0; i < count; i++)
+    free(elements[i].html);
+  free(elements);
+}
+
+void free_watch_state(watch_state_t *state) {
+  free_watch_elements(state->elements, state->count);
+  if (state->svg != NULL)
+    free_svg(state->svg);
+  free(state->source);
+  free(state->head);
+  free_html_config(state->config);
+  free(state);
+}
+
+char *read_watch_source(char *path, size_t *length) {
+  FILE *file = fopen(path, "rb");
+  if (file == NULL)
+    return NULL;
+  char *source = NULL;
+  long size = -1;
+  if (fseek(file, 0, SEEK_END) == 0 && (size = ftell(file)) >= 0 &&
+      fseek(file, 0, SEEK_SET) == 0) {
+    source = malloc(size + 1);
+    *length = fread(source, 1, size, file);
+    source[*length] = '\0';
+  }
+  fclose(file);
+  return source;
+}
+
+size_t find_watch_element_end(char *source, size_t length, size_t start) {
+  int depth = 0;
+  bool is_quoted = false, is_closing = false;
+  char previous = '\0';
+  size_t next;
+  for (size_t i = start; i < length; i++) {
+    if (source[i] == '"')
+      is_quoted = !is_quoted;
+    else if (is_quoted)
+      continue;
+    else if (source[i] == '<') {
+      for (next = i + 1; next < length && is_whitespace(source[next]); next++)
+        ;
+      is_closing = next < length && source[next] == '/';
+    } else if (source[i] == '>') {
+      // Self-closing elements do not change the depth.
+      if (is_closing)
+        depth--;
+      else if (previous != '/')
+        depth++;
+      if (depth <= 0)
+        return i + 1;
+    }
+    if (!is_whitespace(source[i]))
+      previous = source[i];
+  }
+  return 0;
+}
+
+bool split_watch_source(char *source, size_t length, size_t *header,
+                        watch_element_t **elements, int *count) {
+  int capacity = 0, line = 0;
+  size_t i = 0, counted = 0, end, name;
+  bool is_quoted = false;
+  watch_element_t *element;
+  *elements = NULL;
+  *count = 0;
+
+  for (; i < length && is_whitespace(source[i]); i++)
+    ;
+  if (strncmp(source + i, "<svg", 4) != 0)
+    return false;
+  for (; i < length && (is_quoted || source[i] != '>'); i++)
+    if (source[i] == '"')
+      is_quoted = !is_quoted;
+  if (i == length)
+    return false;
+  *header = i + 1;
+
+  for (i = *header;; i = end) {
+    for (; i < length && is_whitespace(source[i]); i++)
+      ;
+    if (i == length || source[i] != '<')
+      break;
+    for (name = i + 1; name < length && is_whitespace(source[name]); name++)
+      ;
+    // The svg's closing element ends the top-level elements.
+    if (name < length && source[name] == '/')
+      return true;
+    end = find_watch_element_end(source, length, i);
+    if (end == 0)
+      break;
+
+    for (; counted < i; counted++)
+      if (source[counted] == '\n')
+        line++;
+    if (*count == capacity) {
+      capacity = (capacity == 0) ? WATCH_ELEMENT_CAPACITY : capacity * 2;
+      *elements = realloc(*elements, sizeof(watch_element_t) * capacity);
+    }
+    element = &(*elements)[(*count)++];
+    element->start = i;
+    element->length = end - i;
+    element->line = line;
+    element->hash = hash_bytes(source + i, end - i);
+    element->is_symbol = strncmp(source + name, "symbol", 6) == 0;
+    element->shape = NULL;
+    element->html = NULL;
+    element->html_size = 0;
+  }
+  free(*elements);
+  *elements = NULL;
+  *count = 0;
+  return false;
+}
+
+bool are_watch_elements_equal(watch_element_t *a, char *a_source,
+                              watch_element_t *b, char *b_source) {
+  return a->hash == b->hash && a->length == b->length &&
+         memcmp(a_source + a->start, b_source + b->start, a->length) == 0;
+}
+
+shape_t *parse_watch_element(char *source, watch_element_t *element,
+                             symbol_node_t *symbols) {
+  FILE *file = fmemopen(source + element->start, element->length, "r");
+  if (file == NULL)
+    return NULL;
+  serdelizer_t *serdelizer = new_serdelizer(file);
+  // The errors are reported at the element's lines in the whole file.
+  serdelizer->line = element->line;
+  style_t *styles = new_default_style();
+  shape_t *shape = NULL;
+  // As in parse_svg, the element's '<' and first letter are consumed first.
+  if (get_next_non_whitespace_char(serdelizer) == '<') {
+    get_next_non_whitespace_char(serdelizer);
+    shape = parse_shape(serdelizer, styles, symbols);
+  }
+  free_style(styles);
+  free_serdelizer(serdelizer);
+  return shape;
+}
+
+void export_watch_element(watch_state_t *state, watch_element_t *element,
+                          bbox_t *area) {
+  if (element->is_symbol || element->html != NULL)
+    return;
+  FILE *file = open_memstream(&element->html, &element->html_size);
+  if (file == NULL)
+    return;
+  shape_node_t node = {.previous = NULL, .shape = element->shape, .next = NULL};
+  export_svg_shapes_html(file, &node, state->config, area);
+  fclose(file);
+}
+
+bool parse_watch_source(watch_state_t *state, char *source, size_t length,
+                        size_t header, watch_element_t *elements, int count) {
+  FILE *file = fmemopen(source, length, "r");
+  if (file == NULL)
+    return false;
+  serdelizer_t *serdelizer = new_serdelizer(file);
+  svg_t *svg = parse_svg(serdelizer);
+  free_serdelizer(serdelizer);
+  if (svg == NULL)
+    return false;
+
+  int shapes = 0;
+  bool is_split = true;
+  shape_node_t *node = svg->shapes;
+  for (int i = 0; i < count && is_split; i++) {
+    if (elements[i].is_symbol)
+      continue;
+    is_split = node != NULL;
+    if (is_split) {
+      elements[i].shape = node->shape;
+      node = node->next;
+      shapes++;
+    }
+  }
+  if (!is_split || node != NULL) {
+    fprintf(stderr, "Could not split %s into its shapes\n", state->input);
+    free_svg(svg);
+    return false;
+  }
+
+  free_watch_elements(state->elements, state->count);
+  if (state->svg != NULL)
+    free_svg(state->svg);
+  free(state->source);
+  state->source = source;
+  state->length = length;
+  state->header = header;
+  state->elements = elements;
+  state->count = count;
+  state->svg = svg;
+  state->reparsed = shapes;
+  return true;
+}
+
+bool patch_watch_source(watch_state_t *state, char *source, size_t length,
+                        watch_element_t *elements, int count, int first,
+                        int last) {
+  for (int i = first; i < count - last; i++) {
+    elements[i].shape =
+        parse_watch_element(source, &elements[i], state->svg->symbols);
+    if (elements[i].shape != NULL)
+      continue;
+    for (int j = first; j < i; j++)
+      free_shape(elements[j].shape);
+    return false;
+  }
+
+  // The unchanged elements keep their shapes and HTML.
+  watch_element_t *old = state->elements;
+  int shift = state->count - count;
+  for (int i = 0; i < count; i++) {
+    if (i >= first && i < count - last)
+      continue;
+    elements[i].shape = old[i < first ? i : i + shift].shape;
+    elements[i].html = old[i < first ? i : i + shift].html;
+    elements[i].html_size = old[i < first ? i : i + shift].html_size;
+    old[i < first ? i : i + shift].html = NULL;
+  }
+  shape_node_t *node = state->svg->shapes, *next;
+  for (; node != NULL; node = next) {
+    next = node->next;
+    free(node);
+  }
+  for (int i = first; i < state->count - last; i++)
+    free_shape(old[i].shape);
+  shape_node_t *shapes = NULL, *tail = NULL;
+  for (int i = 0; i < count; i++)
+    if (!elements[i].is_symbol)
+      append_shape_node(&shapes, &tail, elements[i].shape);
+  state->svg->shapes = shapes;
+
+  free_watch_elements(old, state->count);
+  free(state->source);
+  state->source = source;
+  state->length = length;
+  state->elements = elements;
+  state->count = count;
+  state->reparsed = count - last - first;
+  return true;
+}
+
+bool write_watch_output(watch_state_t *state, int first, bool is_head_changed) {
+  FILE *file;
+  if (is_head_changed) {
+    free(state->head);
+    state->head = NULL;
+    file = open_memstream(&state->head, &state->head_size);
+    if (file == NULL)
+      return false;
+    export_start_html(file, state->svg, state->config);
+    fclose(file);
+  }
+  bbox_t *area =
+      state->config->cull ? get_viewport_bbox(state->svg->viewport) : NULL;
+  for (int i = 0; i < state->count; i++)
+    export_watch_element(state, &state->elements[i], area);
+  free_bbox(area);
+
+  // The HTML before the first changed shape is already in the file.
+  size_t offset = 0;
+  file = is_head_changed ? NULL : fopen(state->output, "r+");
+  if (file != NULL) {
+    offset = state->head_size;
+    for (int i = 0; i < first; i++)
+      offset += state->elements[i].html_size;
+    if (fseek(file, offset, SEEK_SET) != 0) {
+      fclose(file);
+      file = NULL;
+    }
+  }
+  if (file == NULL) {
+    offset = 0;
+    first = 0;
+    file = fopen(state->output, "w");
+  }
+  if (file == NULL) {
+    fprintf(stderr, "Could not open %s\n", state->output);
+    return false;
+  }
+  if (offset == 0)
+    fwrite(state->head, 1, state->head_size, file);
+  for (int i = first; i < state->count; i++)
+    if (state->elements[i].html != NULL)
+      fwrite(state->elements[i].html, 1, state->elements[i].html_size, file);
+  export_end_html(file);
+  fflush(file);
+  long end = ftell(file);
+  bool success = end >= 0 && ftruncate(fileno(file), end) == 0;
+  fclose(file);
+  state->rewritten = (end >= 0) ? end - offset : 0;
+  return success;
+}
+
+bool update_watch_state(watch_state_t *state) {
+  size_t length, header;
+  watch_element_t *elements;
+  int count;
+  char *source = read_watch_source(state->input, &length);
+  if (source == NULL) {
+    fprintf(stderr, "Could not open %s\n", state->input);
+    return false;
+  }
+  if (!split_watch_source(source, length, &header, &elements, &count)) {
+    fprintf(stderr, "Could not read the elements of %s\n", state->input);
+    free(source);
+    return false;
+  }
+
+  int first = 0, last = 0;
+  bool is_head_changed = state->svg == NULL || header != state->header ||
+                         memcmp(source, state->source, header) != 0;
+  if (!is_head_changed) {
+    int limit = (count < state->count) ? count : state->count;
+    while (first < limit &&
+           are_watch_elements_equal(&elements[first], source,
+                                    &state->elements[first], state->source))
+      first++;
+    while (last < limit - first &&
+           are_watch_elements_equal(&elements[count - 1 - last], source,
+                                    &state->elements[state->count - 1 - last],
+                                    state->source))
+      last++;
+    if (first == count && count == state->count) {
+      free_watch_elements(elements, count);
+      free(source);
+      state->reparsed = 0;
+      state->rewritten = 0;
+      return true;
+    }
+    // The instances reference the symbols, which are only parsed with the
+    // whole file.
+    for (int i = first; i < count - last; i++)
+      is_head_changed = is_head_changed || elements[i].is_symbol;
+    for (int i = first; i < state->count - last; i++)
+      is_head_changed = is_head_changed || state->elements[i].is_symbol;
+  }
+
+  bool success =
+      is_head_changed
+          ? parse_watch_source(state, source, length, header, elements, count)
+          : patch_watch_source(state, source, length, elements, count, first,
+                               last);
+  if (!success) {
+    free_watch_elements(elements, count);
+    free(source);
+    return false;
+  }
+  return write_watch_output(state, is_head_changed ? 0 : first,
+                            is_head_changed);
+}
+
+void stop_watch(int number) { is_watch_stopped = 1; }
+
+bool run_watch(char *input, char *output, batch_options_t *options) {
+  char *directory_path = strdup(input), *name_path = strdup(input);
+  char *directory = dirname(directory_path), *name = basename(name_path);
+  int notify = inotify_init();
+  if (notify < 0 ||
+      inotify_add_watch(notify, directory, IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+    fprintf(stderr, "Could not watch %s: %s\n", input, strerror(errno));
+    if (notify >= 0)
+      close(notify);
+    free(directory_path);
+    free(name_path);
+    return false;
+  }
+
+  // No SA_RESTART, so that a signal interrupts the wait for events.
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = stop_watch;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGINT, &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+
+  // Only the HTML exports at full scale are split by shape.
+  bool is_incremental = is_batch_html_path(output) && options->scale >= 1;
+  watch_state_t *state = new_watch_state(input, output, options);
+  union {
+    struct inotify_event event;
+    char bytes[WATCH_EVENT_BUFFER_SIZE];
+  } buffer;
+  struct inotify_event *event;
+  struct timespec start, end;
+  svg_t *svg;
+  ssize_t size;
+  bool is_changed = true, success;
+  fprintf(stderr, "Watching %s, press Ctrl+C to stop.\n", input);
+  while (!is_watch_stopped) {
+    if (is_changed) {
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      if (is_incremental)
+        success = update_watch_state(state);
+      else {
+        svg = batch_open_svg(input);
+        success = svg != NULL &&
+                  batch_export_svg(svg, output, options, NULL, NULL);
+        if (svg != NULL)
+          free_svg(svg);
+      }
+      clock_gettime(CLOCK_MONOTONIC, &end);
+      double seconds =
+          (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+      if (success && is_incremental)
+        fprintf(stderr,
+                "Updated %s in %.3f s, %d shape(s) parsed, %zu byte(s) "
+                "written.\n",
+                output, seconds, state->reparsed, state->rewritten);
+      else if (success)
+        fprintf(stderr, "Updated %s in %.3f s.\n", output, seconds);
+      else
+        fprintf(stderr, "Kept %s, %s is invalid.\n", output, input);
+    }
+
+    size = read(notify, buffer.bytes, WATCH_EVENT_BUFFER_SIZE);
+    if (size < 0 && errno != EINTR)
+      break;
+    // The events of the other files of the directory are ignored.
+    is_changed = false;
+    for (char *cursor = buffer.bytes; size > 0 && cursor < buffer.bytes + size;
+         cursor += sizeof(struct inotify_event) + event->len) {
+      event = (struct inotify_event *)cursor;
+      if (event->len > 0 && strcmp(event->name, name) == 0)
+        is_changed = true;
+    }
+  }
+
+  free_watch_state(state);
+  close(notify);
+  free(directory_path);
+  free(name_path);
+  return true;
+}
@@ -0,0 +1,265 @@
+#ifndef CODA_WATCH
+#define CODA_WATCH
+
+#include "../batch/batch.h"
+#include "../html/html.h"
+#include "../models/shapes/shape.h"
+#include "../models/shapes/svg.h"
+#include "../models/utils/bbox.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Defines the watched element type, a top-level element of the watched file,
+ * i.e. a shape or a symbol of the svg.
+ * @param start     the offset of the element's first character in the file.
+ * @param length    the element's number of characters.
+ * @param line      the number of lines before the element.
+ * @param hash      the FNV-1a hash of the element's characters.
+ * @param is_symbol indicates if the element is a symbol.
+ * @param shape     the element's parsed shape, NULL for a symbol.
+ * @param html      the shape written down in HTML format, NULL until it is.
+ * @param html_size the HTML's number of characters.
+ */
+typedef struct watch_element_s {
+  size_t start;
+  size_t length;
+  int line;
+  uint64_t hash;
+  bool is_symbol;
+  shape_t *shape;
+  char *html;
+  size_t html_size;
+} watch_element_t;
+
+/**
+ * Defines the watch state type, the last successful parse and export of a
+ * watched file.
+ * The file is split into its top-level elements, which are compared by hash to
+ * the previous ones when the file changes: the unchanged elements at the start
+ * and at the end keep their shapes and HTML, only the elements in between are
+ * parsed and written down again. The HTML file is rewritten from the first
+ * changed shape.
+ * A change of the svg's header or symbols parses the whole file again, since
+ * the instances reference the symbols.
+ * @param input     the watched file's path.
+ * @param output    the HTML file's path.
+ * @param options   the export options.
+ * @param config    the HTML export config.
+ * @param source    the watched file's content.
+ * @param length    the content's number of characters.
+ * @param header    the number of characters of the svg's opening element.
+ * @param elements  the top-level elements.
+ * @param count     the number of elements.
+ * @param svg       the parsed svg, whose shapes are the elements' ones.
+ * @param head      the HTML before the shapes.
+ * @param head_size the head's number of characters.
+ * @param reparsed  the number of shapes parsed by the last update.
+ * @param rewritten the number of characters written by the last update.
+ * @see watch_element_t.
+ */
+typedef struct watch_state_s {
+  char *input;
+  char *output;
+  batch_options_t *options;
+  html_config_t *config;
+  char *source;
+  size_t length;
+  size_t header;
+  watch_element_t *elements;
+  int count;
+  svg_t *svg;
+  char *head;
+  size_t head_size;
+  int reparsed;
+  size_t rewritten;
+} watch_state_t;
+
+/**
+ * Creates a new watch state, without any parse yet.
+ * Note that this function allocates memory.
+ * @param input   the watched file's path.
+ * @param output  the HTML file's path.
+ * @param options the export options, which must outlive the state.
+ * @return the new state's pointer.
+ * @see watch_state_t.
+ */
+watch_state_t *new_watch_state(char *input, char *output,
+                               batch_options_t *options);
+
+/**
+ * Destroys the given watch elements' HTML.
+ * Note that this function frees memory.
+ * Note that the shapes are not freed.
+ * @param elements the elements.
+ * @param count    the number of elements.
+ * @see watch_element_t.
+ */
+void free_watch_elements(watch_element_t *elements, int count);
+
+/**
+ * Destroys the given watch state and its svg.
+ * Note that this function frees memory.
+ * @param state the state to destroy.
+ * @see watch_state_t.
+ */
+void free_watch_state(watch_state_t *state);
+
+/**
+ * Reads the whole file at the given path.
+ * Note that this function allocates memory.
+ * @param path   the file's path.
+ * @param length a pointer to the content's length, set by the function.
+ * @return the null terminated content, NULL if the file could not be read.
+ */
+char *read_watch_source(char *path, size_t *length);
+
+/**
+ * Finds the end of the element starting at the given offset, nested elements
+ * included.
+ * @param source the file's content.
+ * @param length the content's length.
+ * @param start  the offset of the element's '<' character.
+ * @return the offset following the element's last '>', 0 if the element is
+ * not closed.
+ */
+size_t find_watch_element_end(char *source, size_t length, size_t start);
+
+/**
+ * Splits the given svg file's content into its opening element and its
+ * top-level elements, without parsing them.
+ * Note that this function allocates memory.
+ * @param source   the file's content.
+ * @param length   the content's length.
+ * @param header   a pointer to the opening element's length, set by the
+ * function.
+ * @param elements a pointer to the elements, set by the function.
+ * @param count    a pointer to the number of elements, set by the function.
+ * @return returns true if the content is a sequence of closed elements
+ * ending with the svg's closing element.
+ * @see watch_element_t.
+ */
+bool split_watch_source(char *source, size_t length, size_t *header,
+                        watch_element_t **elements, int *count);
+
+/**
+ * Tests if two elements of two contents have the same characters.
+ * @param a        the first element.
+ * @param a_source the first element's content.
+ * @param b        the second element.
+ * @param b_source the second element's content.
+ * @return returns true if the elements are equal.
+ * @see watch_element_t.
+ */
+bool are_watch_elements_equal(watch_element_t *a, char *a_source,
+                              watch_element_t *b, char *b_source);
+
+/**
+ * Parses a top-level shape of the given content, with the given symbols.
+ * Note that this function allocates memory.
+ * @param source  the file's content.
+ * @param element the shape's element.
+ * @param symbols the svg's symbols.
+ * @return the new shape's pointer, NULL if the element is invalid.
+ * @see parse_shape.
+ */
+shape_t *parse_watch_element(char *source, watch_element_t *element,
+                             symbol_node_t *symbols);
+
+/**
+ * Writes down the given element's shape in HTML format, if it is not yet.
+ * Note that this function allocates memory.
+ * @param state   the watch state.
+ * @param element the element.
+ * @param area    the svg's visible area, NULL to keep all the shapes.
+ * @see export_svg_shapes_html.
+ */
+void export_watch_element(watch_state_t *state, watch_element_t *element,
+                          bbox_t *area);
+
+/**
+ * Parses the whole given content, replacing the state's svg and elements.
+ * Note that this function allocates and frees memory.
+ * @param state    the watch state.
+ * @param source   the new content, which belongs to the state if the parse
+ * succeeds.
+ * @param length   the content's length.
+ * @param header   the svg's opening element's length.
+ * @param elements the content's elements, which belong to the state if the
+ * parse succeeds.
+ * @param count    the number of elements.
+ * @return returns true if the content is a valid svg.
+ * @see parse_svg.
+ */
+bool parse_watch_source(watch_state_t *state, char *source, size_t length,
+                        size_t header, watch_element_t *elements, int count);
+
+/**
+ * Parses the elements of the given content which differ from the state's,
+ * reusing the shapes of the unchanged elements at the start and at the end,
+ * and replaces the state's elements.
+ * Note that this function allocates and frees memory.
+ * @param state    the watch state, holding a previous parse with the same
+ * header and symbols.
+ * @param source   the new content, which belongs to the state if the parse
+ * succeeds.
+ * @param length   the content's length.
+ * @param elements the content's elements, which belong to the state if the
+ * parse succeeds.
+ * @param count    the number of elements.
+ * @param first    the number of unchanged elements at the start.
+ * @param last     the number of unchanged elements at the end.
+ * @return returns true if the changed elements are valid shapes.
+ * @see parse_watch_element.
+ */
+bool patch_watch_source(watch_state_t *state, char *source, size_t length,
+                        watch_element_t *elements, int count, int first,
+                        int last);
+
+/**
+ * Writes the state's HTML file from the given element, the characters before
+ * it being unchanged.
+ * Note that this function may allocate memory.
+ * @param state the watch state.
+ * @param first           the index of the first changed element.
+ * @param is_head_changed indicates if the HTML's head changed, the whole file
+ * being rewritten.
+ * @return returns true if the file was written.
+ * @see export_watch_element.
+ */
+bool write_watch_output(watch_state_t *state, int first, bool is_head_changed);
+
+/**
+ * Reads the watched file again and updates the HTML file.
+ * An invalid file leaves the state and the HTML file as they were.
+ * Note that this function allocates and frees memory.
+ * @param state the watch state.
+ * @return returns true if the HTML file is up to date.
+ * @see watch_state_t.
+ */
+bool update_watch_state(watch_state_t *state);
+
+/**
+ * Requests the running watch to stop, as the handler of the interruption and
+ * termination signals.
+ * @param number the signal's number.
+ * @see run_watch.
+ */
+void stop_watch(int number);
+
+/**
+ * Exports the given file, then exports it again each time it is saved, until
+ * the process is interrupted or terminated.
+ * The HTML exports at full scale are incremental, the other exports write the
+ * whole file.
+ * Note that this function allocates and frees memory.
+ * @param input   the watched file's path.
+ * @param output  the exported file's path.
+ * @param options the export options.
+ * @return returns true if the file could be watched.
+ * @see update_watch_state.
+ */
+bool run_watch(char *input, char *output, batch_options_t *options);
+
+#endif